@@ -0,0 +1,515 @@
+/**
+ * @file chip8_bench.c
+ * @brief Speed benchmarks for the CHIP-8 core.
+ *
+ * chip8-bench runs every ROM given on the command line headless for a fixed
+ * instruction budget and reports instructions per second, nanoseconds per
+ * instruction and the share of time spent in DXYN and pixel conversion. It
+ * then times isolated kernels: opcode decoding, dispatch in each CPU
+ * engine, sprite drawing and display-to-ARGB conversion.
+ *
+ * Every figure is the best of several repeats, which filters out most
+ * scheduler noise, so results can be compared between builds to catch
+ * regressions in the core.
+ *
+ * Usage:
+ *   chip8-bench [options] <rom>...
+ */
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "config.h"
+#include "headless.h"
+#include "profiler.h"
+#include "rom.h"
+#include "sdl_interface.h"
+#include "cli_logger.h"
+
+#define BENCH_DEFAULT_CYCLES 5000000ULL /**< Instructions per ROM run */
+#define BENCH_DEFAULT_REPEATS 5         /**< Runs per figure; the fastest is kept */
+#define BENCH_MICRO_OPS 20000000ULL     /**< Operations per micro-benchmark run */
+
+/**
+ * @struct bench_opts_t
+ * @brief Settings shared by all benchmarks.
+ */
+typedef struct
+{
+    uint64_t cycles;           /**< Instruction budget per ROM run */
+    uint32_t cycles_per_frame; /**< Virtual frame length (timer tick rate) */
+    int repeats;               /**< Runs per figure */
+    uint8_t core;              /**< config_core_t of the ROM runs */
+    bool csv;                  /**< Print "kind,name,metric,value" rows instead of tables */
+} bench_opts_t;
+
+/** @brief Defeats dead-code elimination of benchmark results. */
+static volatile uint64_t bench_sink;
+
+static void print_bench_usage(const char *prog_name, FILE *out)
+{
+    fprintf(out,
+            "Usage: %s [options] <rom>...\n\n"
+            "Options:\n"
+            "  -n, --cycles <n>           Instructions per ROM run (default: 5000000)\n"
+            "  -c, --cycles-per-frame <n> Instructions per virtual frame (default: 12)\n"
+            "  -r, --repeats <n>          Runs per figure, fastest kept (default: 5)\n"
+            "      --core <engine>        CPU engine of the ROM runs: cached, table or threaded\n"
+            "                             (default: cached)\n"
+            "      --csv                  Print kind,name,metric,value rows\n"
+            "  -?, --help                 Show this help message and exit\n",
+            prog_name);
+}
+
+static double ticks_to_seconds(uint64_t ticks)
+{
+    return (double)ticks / (double)SDL_GetPerformanceFrequency();
+}
+
+static const char *base_name(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static void print_csv_row(const char *kind, const char *name, const char *metric, double value)
+{
+    printf("%s,%s,%s,%.3f\n", kind, name, metric, value);
+}
+
+/* --------------------------------------------------------------------------
+   ROM benchmarks
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Resets @p emu and loads @p path with the default seed and @p core.
+ */
+static bool bench_load(chip8_t *emu, const char *path, uint8_t core)
+{
+    chip8_init(emu);
+    chip8_seed(emu, CHIP8_DEFAULT_SEED);
+    chip8_set_core(emu, core);
+    return chip8_load_program(emu, path);
+}
+
+/**
+ * @brief Runs one ROM and reports its speed and cost breakdown.
+ *
+ * Speed comes from unprofiled headless runs and counts only the
+ * instructions they executed, not idle-loop iterations fast-forwarded
+ * past. The breakdown comes from one extra profiled run that also
+ * converts the dirty band of the display to ARGB once per virtual frame,
+ * as the windowed frontend would.
+ */
+static bool bench_rom(const char *path, const bench_opts_t *opts, chip8_t *emu, profiler_t *prof)
+{
+    emulation_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.cycles_per_frame = opts->cycles_per_frame;
+    cfg.max_cycles = opts->cycles;
+
+    double best = 0.0;
+    uint64_t cycles = 0;
+    for (int r = 0; r < opts->repeats; r++)
+    {
+        headless_result_t result;
+        if (!bench_load(emu, path, opts->core) || !headless_run(emu, &cfg, NULL, NULL, NULL, &result))
+        {
+            print_error("Benchmark run failed: %s", path);
+            return false;
+        }
+        if (r == 0 || result.elapsed_seconds < best)
+            best = result.elapsed_seconds;
+        cycles = result.executed;
+    }
+
+    // Cost breakdown
+    uint32_t pixels[CHIP8_HIRES_WIDTH * CHIP8_HIRES_HEIGHT];
+    memset(prof, 0, sizeof(*prof));
+    bench_load(emu, path, opts->core);
+    profiler_start(prof);
+    for (uint64_t i = 0; i < opts->cycles && emu->state == CHIP8_RUNNING;)
+    {
+        for (uint32_t c = 0; c < opts->cycles_per_frame && emu->state == CHIP8_RUNNING; c++, i++)
+            profiler_cycle(prof, emu);
+        chip8_timers_decrement(emu);
+
+        uint64_t dirty = emu->dirty_rows;
+        if (dirty)
+        {
+            uint64_t start = SDL_GetPerformanceCounter();
+            // dirty_rows covers 64 rows; low resolution has 32
+            int height = (int)chip8_display_height(emu);
+            int first = __builtin_ctzll(dirty);
+            int last = 63 - __builtin_clzll(dirty);
+            if (last >= height)
+                last = height - 1;
+            sdl_convert_rows(emu->display, emu->hires, &emu->config, pixels,
+                             (int)(chip8_display_width(emu) * sizeof(uint32_t)), first, last, 1);
+            profiler_add_render(prof, SDL_GetPerformanceCounter() - start);
+            emu->dirty_rows = 0;
+        }
+    }
+    profiler_stop(prof);
+    bench_sink += pixels[0];
+
+    double profiled = ticks_to_seconds(prof->elapsed_ticks);
+    double draw = ticks_to_seconds(prof->draw_ticks);
+    double render = ticks_to_seconds(prof->render_ticks);
+
+    double ips = best > 0.0 ? (double)cycles / best : 0.0;
+    double ns_per_instr = cycles ? best * 1e9 / (double)cycles : 0.0;
+    double draw_pct = profiled > 0.0 ? 100.0 * draw / profiled : 0.0;
+    double ns_per_draw = prof->draw_calls ? draw * 1e9 / (double)prof->draw_calls : 0.0;
+    double ns_per_frame = prof->render_calls ? render * 1e9 / (double)prof->render_calls : 0.0;
+
+    const char *name = base_name(path);
+    if (opts->csv)
+    {
+        print_csv_row("rom", name, "ips", ips);
+        print_csv_row("rom", name, "ns_per_instr", ns_per_instr);
+        print_csv_row("rom", name, "draw_pct", draw_pct);
+        print_csv_row("rom", name, "ns_per_draw", ns_per_draw);
+        print_csv_row("rom", name, "ns_per_frame", ns_per_frame);
+    }
+    else
+    {
+        printf("%-24s %12.0f %9.2f %7.1f %9.1f %9.1f\n",
+               name, ips, ns_per_instr, draw_pct, ns_per_draw, ns_per_frame);
+    }
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+   Micro-benchmarks
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Writes big-endian opcodes into memory starting at @p addr.
+ */
+static void poke_program(chip8_t *emu, uint16_t addr, const uint16_t *opcodes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        emu->memory[addr + 2 * i] = (uint8_t)(opcodes[i] >> 8);
+        emu->memory[addr + 2 * i + 1] = (uint8_t)opcodes[i];
+    }
+}
+
+/**
+ * @brief Builds a block of 7XNN instructions closed by a jump to its start.
+ */
+static void build_alu_loop(chip8_t *emu, uint16_t addr, size_t length)
+{
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        uint16_t opcode = (uint16_t)(0x7001 | (i & 0xF) << 8);
+        poke_program(emu, (uint16_t)(addr + 2 * i), &opcode, 1);
+    }
+    uint16_t jump = (uint16_t)(0x1000 | addr);
+    poke_program(emu, (uint16_t)(addr + 2 * (length - 1)), &jump, 1);
+}
+
+/**
+ * @brief Returns the best wall time of @p repeats runs of @p cycles instructions.
+ *
+ * Runs chip8_run() batches, so the engine selected in @p emu is timed.
+ */
+static double time_cycles(chip8_t *emu, uint16_t entry, uint64_t cycles, int repeats)
+{
+    double best = 0.0;
+    for (int r = 0; r < repeats; r++)
+    {
+        emu->pc = entry;
+        emu->state = CHIP8_RUNNING;
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        chip8_exit_t reason;
+        for (uint64_t i = 0; i < cycles && emu->state == CHIP8_RUNNING && !chip8_waiting_for_key(emu);)
+            i += chip8_run(emu, (uint32_t)(cycles - i), &reason);
+        double seconds = ticks_to_seconds(SDL_GetPerformanceCounter() - start);
+
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+    return best;
+}
+
+static double bench_decode(const bench_opts_t *opts)
+{
+    double best = 0.0;
+    for (int r = 0; r < opts->repeats; r++)
+    {
+        uint64_t sum = 0;
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (uint64_t i = 0; i < BENCH_MICRO_OPS; i++)
+        {
+            uint16_t opcode = (uint16_t)(i * 0x9E37u);
+            chip8_instr_t instr = chip8_decode_opcode(opcode);
+            sum += instr.nnn + instr.kk + instr.x + instr.y + instr.n + chip8_classify_opcode(opcode, CONFIG_MACHINE_CHIP8);
+        }
+        double seconds = ticks_to_seconds(SDL_GetPerformanceCounter() - start);
+        bench_sink += sum;
+
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+    return best * 1e9 / (double)BENCH_MICRO_OPS;
+}
+
+static double bench_dispatch(const bench_opts_t *opts, chip8_t *emu, uint8_t core)
+{
+    chip8_init(emu);
+    chip8_set_core(emu, core);
+
+    build_alu_loop(emu, CHIP8_ROM_ENTRY_POINT, 128);
+    chip8_flush_decode_cache(emu);
+
+    return time_cycles(emu, CHIP8_ROM_ENTRY_POINT, BENCH_MICRO_OPS, opts->repeats) * 1e9 / (double)BENCH_MICRO_OPS;
+}
+
+/**
+ * @brief Net cost of one DXYN: an 8x15 sprite at a drifting, unaligned x.
+ *
+ * Times a 4-instruction loop around DXYN, then the same loop with DXYN
+ * replaced by 7XNN, and reports the difference per iteration.
+ */
+static double bench_sprite(const bench_opts_t *opts, chip8_t *emu)
+{
+    const uint16_t draw_loop[] = {0xA300, 0xD01F, 0x7003, 0x7101, 0x1202};
+    const uint16_t base_loop[] = {0xA300, 0x7205, 0x7003, 0x7101, 0x1202};
+    const uint64_t iterations = BENCH_MICRO_OPS / 16;
+    const uint64_t cycles = 1 + iterations * 4;
+
+    chip8_init(emu);
+    memset(&emu->memory[0x300], 0xA5, 15);
+
+    poke_program(emu, CHIP8_ROM_ENTRY_POINT, draw_loop, sizeof(draw_loop) / sizeof(draw_loop[0]));
+    chip8_flush_decode_cache(emu);
+    double with_draw = time_cycles(emu, CHIP8_ROM_ENTRY_POINT, cycles, opts->repeats);
+
+    poke_program(emu, CHIP8_ROM_ENTRY_POINT, base_loop, sizeof(base_loop) / sizeof(base_loop[0]));
+    chip8_flush_decode_cache(emu);
+    double without_draw = time_cycles(emu, CHIP8_ROM_ENTRY_POINT, cycles, opts->repeats);
+
+    double net = with_draw > without_draw ? with_draw - without_draw : 0.0;
+    return net * 1e9 / (double)iterations;
+}
+
+/**
+ * @brief Cost of converting a whole frame, unscaled or scaled in software.
+ *
+ * @return ns per frame, or 0 if the destination cannot be allocated.
+ */
+static double bench_convert(const bench_opts_t *opts, chip8_t *emu, int scale)
+{
+    const uint64_t frames = BENCH_MICRO_OPS / 1000 / (uint64_t)(scale * scale);
+    const int pitch = CHIP8_DISPLAY_WIDTH * scale * (int)sizeof(uint32_t);
+    const size_t count = (size_t)CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT * scale * scale;
+    uint32_t *pixels = malloc(count * sizeof(uint32_t));
+    if (!pixels)
+        return 0.0;
+
+    chip8_init(emu);
+    emu->config.fg_color = CONFIG_DEFAULT_FG_COLOR;
+    emu->config.bg_color = CONFIG_DEFAULT_BG_COLOR;
+
+    // Deterministic, roughly half-lit screen
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        emu->display[y] = x;
+    }
+
+    double best = 0.0;
+    for (int r = 0; r < opts->repeats; r++)
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (uint64_t f = 0; f < frames; f++)
+        {
+            sdl_convert_rows(emu->display, false, &emu->config, pixels, pitch, 0, CHIP8_DISPLAY_HEIGHT - 1, scale);
+            bench_sink += pixels[f % count];
+        }
+        double seconds = ticks_to_seconds(SDL_GetPerformanceCounter() - start);
+
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+    free(pixels);
+    return best * 1e9 / (double)frames;
+}
+
+/**
+ * @brief Cost of returning to a pristine machine after a short run.
+ *
+ * Each iteration executes A300 FF55 (sixteen stores to 0x300) from a
+ * full-size ROM, then either rebuilds the machine with chip8_init() and
+ * chip8_load_buffer() or rolls it back with chip8_reset().
+ */
+static double bench_reset(const bench_opts_t *opts, chip8_t *emu, bool incremental)
+{
+    const uint64_t resets = BENCH_MICRO_OPS / 100;
+    static uint8_t data[4096 - 0x200];
+    rom_image_t rom;
+
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 0x9Du);
+    const uint8_t prologue[] = {0xA3, 0x00, 0xFF, 0x55};
+    memcpy(data, prologue, sizeof(prologue));
+    rom_image_from_buffer(&rom, data, sizeof(data), "reset");
+
+    chip8_init(emu);
+    chip8_reset(emu, &rom);
+
+    double best = 0.0;
+    for (int r = 0; r < opts->repeats; r++)
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (uint64_t i = 0; i < resets; i++)
+        {
+            chip8_cycle(emu);
+            chip8_cycle(emu);
+            if (incremental)
+                chip8_reset(emu, &rom);
+            else
+            {
+                chip8_init(emu);
+                chip8_load_buffer(emu, rom.data, rom.size);
+            }
+        }
+        double seconds = ticks_to_seconds(SDL_GetPerformanceCounter() - start);
+        bench_sink += emu->memory[0x300];
+
+        if (r == 0 || seconds < best)
+            best = seconds;
+    }
+    return best * 1e9 / (double)resets;
+}
+
+static void print_micro(const bench_opts_t *opts, const char *name, const char *unit, double ns)
+{
+    if (opts->csv)
+        print_csv_row("micro", name, unit, ns);
+    else
+        printf("%-36s %9.2f  %s\n", name, ns, unit);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_opts_t opts = {
+        .cycles = BENCH_DEFAULT_CYCLES,
+        .cycles_per_frame = CONFIG_DEFAULT_CYCLES_PER_FRAME,
+        .repeats = BENCH_DEFAULT_REPEATS,
+        .core = CONFIG_CORE_CACHED,
+        .csv = false,
+    };
+
+    set_log_level(LOG_LEVEL_WARNING);
+
+    const char **roms = calloc((size_t)argc, sizeof(char *));
+    int rom_count = 0;
+    if (!roms)
+        return EXIT_FAILURE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "-?") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_bench_usage(argv[0], stdout);
+            free(roms);
+            return EXIT_SUCCESS;
+        }
+        else if ((strcmp(arg, "-n") == 0 || strcmp(arg, "--cycles") == 0) && has_value)
+            opts.cycles = strtoull(argv[++i], NULL, 10);
+        else if ((strcmp(arg, "-c") == 0 || strcmp(arg, "--cycles-per-frame") == 0) && has_value)
+            opts.cycles_per_frame = (uint32_t)atoi(argv[++i]);
+        else if ((strcmp(arg, "-r") == 0 || strcmp(arg, "--repeats") == 0) && has_value)
+            opts.repeats = atoi(argv[++i]);
+        else if (strcmp(arg, "--core") == 0 && has_value)
+        {
+            const char *name = argv[++i];
+            opts.core = CONFIG_CORE_COUNT;
+            for (uint8_t c = 0; c < CONFIG_CORE_COUNT; c++)
+            {
+                if (strcmp(name, chip8_core_name(c)) == 0)
+                    opts.core = c;
+            }
+            if (opts.core == CONFIG_CORE_COUNT)
+            {
+                print_error("Unknown core: %s", name);
+                free(roms);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(arg, "--csv") == 0)
+            opts.csv = true;
+        else if (arg[0] == '-')
+        {
+            print_error("Invalid option: %s", arg);
+            print_bench_usage(argv[0], stderr);
+            free(roms);
+            return EXIT_FAILURE;
+        }
+        else
+            roms[rom_count++] = arg;
+    }
+
+    if (opts.cycles_per_frame == 0)
+        opts.cycles_per_frame = CONFIG_DEFAULT_CYCLES_PER_FRAME;
+    if (opts.repeats < 1)
+        opts.repeats = 1;
+
+    chip8_t *emu = malloc(sizeof(chip8_t));
+    profiler_t *prof = profiler_create();
+    if (!emu || !prof)
+    {
+        print_error("Out of memory.");
+        free(emu);
+        profiler_destroy(prof);
+        free(roms);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    if (opts.csv)
+        printf("kind,name,metric,value\n");
+
+    if (rom_count > 0)
+    {
+        if (!opts.csv)
+            printf("%-24s %12s %9s %7s %9s %9s\n",
+                   "ROM", "instr/s", "ns/instr", "DXYN%", "ns/DXYN", "ns/frame");
+        for (int i = 0; i < rom_count; i++)
+            failures += !bench_rom(roms[i], &opts, emu, prof);
+        if (!opts.csv)
+            printf("\n");
+    }
+
+    print_micro(&opts, "decode+classify", "ns/op", bench_decode(&opts));
+    char label[64];
+    for (uint8_t core = 0; core < CONFIG_CORE_COUNT; core++)
+    {
+        snprintf(label, sizeof(label), "dispatch (--core %s)", chip8_core_name(core));
+        print_micro(&opts, label, "ns/instr", bench_dispatch(&opts, emu, core));
+    }
+    print_micro(&opts, "sprite DXYN 8x15 unaligned", "ns/draw", bench_sprite(&opts, emu));
+    snprintf(label, sizeof(label), "convert 64x32 to ARGB8888 (%s)", sdl_convert_kernel());
+    print_micro(&opts, label, "ns/frame", bench_convert(&opts, emu, 1));
+    print_micro(&opts, "convert 640x320 to ARGB8888 (x10)", "ns/frame", bench_convert(&opts, emu, 10));
+    print_micro(&opts, "reset (chip8_init + load_buffer)", "ns/reset", bench_reset(&opts, emu, false));
+    print_micro(&opts, "reset (chip8_reset, 1 dirty page)", "ns/reset", bench_reset(&opts, emu, true));
+
+    profiler_destroy(prof);
+    free(emu);
+    free(roms);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
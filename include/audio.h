@@ -1,16 +1,22 @@
 /**
  * @file audio.h
- * @brief Audio module for playing beep sounds in the CHIP-8 emulator.
+ * @brief Audio module for the CHIP-8 beeper.
  *
- * This header declares a simple interface for initializing and managing
- * continuous beep audio using SDL2_mixer. The actual implementation details
- * are hidden in audio.c, following an OOP-like design pattern in C.
+ * The beep is a square wave synthesized in the SDL audio callback, so
+ * nothing is loaded at startup and no mixer runs. Turning it on and off is
+ * a single atomic store, cheap enough to do from the emulation thread after
+ * every frame; the callback picks the change up at its next buffer, whose
+ * size (--audio-buffer) bounds the latency. The audio device itself is only
+ * opened when the first beep is requested, so ROMs that never set the sound
+ * timer never pay for audio at all. The implementation details are
+ * hidden in audio.c, following an OOP-like design pattern in C.
  */
 
 #ifndef AUDIO_H
 #define AUDIO_H
 
 #include <stdbool.h>
+#include "config.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -18,73 +24,65 @@ extern "C"
 #endif
 
     /**
-     * @brief Initializes the audio system and loads a beep sound.
+     * @brief Enables audio with the given settings.
      *
-     * This function sets up the SDL2_mixer library and loads the specified
-     * WAV file into memory. The loaded sound is used for continuous playback
-     * when the CHIP-8 sound timer is non-zero.
+     * Nothing is opened yet: audio_update() opens the device the first time
+     * a beep is requested.
      *
-     * @param wav_path The file path to the .wav file to load.
+     * @param config Volume, tone frequency and buffer size.
      * @return True on success, false on failure.
      *
      * Example usage:
      * @code
-     *   if (!audio_init("assets/beep.wav")) {
+     *   if (!audio_init(&app_cfg.audio_cfg)) {
      *       fprintf(stderr, "Failed to init audio.\n");
      *       return EXIT_FAILURE;
      *   }
      * @endcode
      */
-    bool audio_init(const char *wav_path);
+    bool audio_init(const audio_config_t *config);
 
     /**
-     * @brief Plays the beep sound in a continuous loop.
+     * @brief Opens the audio device once a beep has been requested.
      *
-     * If the sound is already playing, this function will do nothing.
-     * Otherwise, it starts looping the beep indefinitely on a free channel.
+     * Call regularly from the thread that owns SDL (the presenter), never
+     * from the emulation thread: opening a device can take tens of
+     * milliseconds. If it fails, audio stays off with a warning.
      *
      * Example usage:
      * @code
-     *   // Start the beep when sound_timer is set
-     *   audio_play_beep_loop();
+     *   // Once per main loop iteration
+     *   audio_update();
      * @endcode
      */
-    void audio_play_beep_loop(void);
+    void audio_update(void);
 
     /**
-     * @brief Stops the looping beep sound.
+     * @brief Turns the beep on or off.
      *
-     * This function halts playback on the channel currently playing the beep.
-     * If no beep is playing, it does nothing.
+     * Safe to call from any thread, and a no-op while audio is not
+     * enabled. The tone always starts at the beginning of a period.
      *
      * Example usage:
      * @code
-     *   // Stop the beep when sound_timer reaches zero
-     *   audio_stop_beep();
+     *   // After each emulated frame
+     *   audio_set_beep(chip8_sound_active(emu));
      * @endcode
      */
-    void audio_stop_beep(void);
+    void audio_set_beep(bool on);
 
     /**
-     * @brief Checks if the beep sound is currently playing.
+     * @brief Checks if the beep is currently requested.
      *
-     * @return True if the beep is playing, false otherwise.
-     *
-     * Example usage:
-     * @code
-     *   if (!audio_is_beep_playing()) {
-     *       audio_play_beep_loop();
-     *   }
-     * @endcode
+     * @return True if the beep is on, false otherwise.
      */
     bool audio_is_beep_playing(void);
 
     /**
-     * @brief Cleans up audio resources and shuts down SDL_mixer.
+     * @brief Stops the tone generator and closes the audio device, if open.
      *
-     * This function frees the loaded sound chunk and calls Mix_CloseAudio().
-     * It should be invoked once before your program exits to properly
-     * release any allocated resources.
+     * This function should be invoked once before your program exits to
+     * properly release the device.
      *
      * Example usage:
      * @code
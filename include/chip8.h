@@ -11,11 +11,61 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "config.h"
+#include "rom.h"
 
 // CHIP-8 architectural constants
 static const uint16_t CHIP8_MEMORY_SIZE = 4096;      // Total memory size in bytes
 static const uint16_t CHIP8_ROM_ENTRY_POINT = 0x200; // Entry point for ROM loading
+static const uint64_t CHIP8_DEFAULT_SEED = 1;        // PRNG seed applied by chip8_init
+
+// Display geometry (macros so they can size arrays)
+#define CHIP8_DISPLAY_WIDTH 64  /**< Low-resolution pixels per row; one uint64_t per row */
+#define CHIP8_DISPLAY_HEIGHT 32 /**< Low-resolution rows */
+#define CHIP8_HIRES_WIDTH 128   /**< SUPER-CHIP high-resolution pixels per row; two words per row */
+#define CHIP8_HIRES_HEIGHT 64   /**< SUPER-CHIP high-resolution rows */
+#define CHIP8_DISPLAY_WORDS (CHIP8_HIRES_WIDTH / 64 * CHIP8_HIRES_HEIGHT) /**< Words in chip8_t::display */
+#define CHIP8_ALL_ROWS_DIRTY UINT64_MAX /**< dirty_rows value forcing a full redraw */
+
+// Memory write tracking for chip8_reset()
+#define CHIP8_PAGE_SHIFT 8                /**< Pages are 256 bytes */
+#define CHIP8_PAGE_SIZE (1u << CHIP8_PAGE_SHIFT)
+#define CHIP8_ALL_PAGES_DIRTY 0xFFFFu     /**< dirty_pages value forcing a full reload */
+
+// Idle-loop detection (see chip8_run_until_tick())
+#define CHIP8_IDLE_MAX_LOOP 16    /**< Longest loop body, in instructions, recognized as idle */
+#define CHIP8_IDLE_MAX_BACKOFF 32 /**< Most slices skipped between probes of busy code */
+
+// FX0A: chip8_t::key_wait holds CHIP8_KEY_WAIT | x while waiting for a key into Vx
+#define CHIP8_KEY_WAIT 0x80u
+
+// chip8_t::events: what the instructions of the current chip8_run() raised
+#define CHIP8_EVENT_DRAW 0x01u       /**< The display changed */
+#define CHIP8_EVENT_SOUND 0x02u      /**< The buzzer was switched on or off */
+#define CHIP8_EVENT_KEY_WAIT 0x04u   /**< FX0A started waiting */
+#define CHIP8_EVENT_STACK 0x08u      /**< CALL overflowed or RET underflowed the stack */
+#define CHIP8_EVENT_STOP 0x10u       /**< The CPU stopped itself */
+#define CHIP8_EVENT_BREAKPOINT 0x20u /**< The next instruction is at a breakpoint, or a condition holds */
+#define CHIP8_EVENT_WATCH 0x40u      /**< An instruction touched a watched address */
+#define CHIP8_EVENT_STEP 0x80u       /**< chip8_step() ran the instruction before the PC */
+
+// Host-side conditional breaks (see chip8_add_condition())
+#define CHIP8_MAX_CONDITIONS 8      /**< Conditions chip8_t holds at once */
+#define CHIP8_COND_ANY_ADDR 0xFFFFu /**< chip8_condition_t::addr of a condition checked at every instruction */
+#define CHIP8_COND_REG_I 16u        /**< chip8_condition_t::reg: the index register (0..15 are V0..VF) */
+#define CHIP8_COND_REG_DT 17u       /**< chip8_condition_t::reg: the delay timer */
+#define CHIP8_COND_REG_ST 18u       /**< chip8_condition_t::reg: the sound timer */
+
+// SUPER-CHIP extras
+#define CHIP8_BIG_FONT_ADDR 0x50 /**< Address of the 8x10 digits (FX30), right after the 4x5 ones */
+#define CHIP8_RPL_FLAGS 8        /**< FX75/FX85 flag registers */
+
+// Binary instruction trace (--trace-file): a header, then one record per instruction
+#define CHIP8_TRACE_MAGIC "CH8TRACE" /**< First 8 bytes of a trace file */
+#define CHIP8_TRACE_VERSION 1        /**< Format version after the magic */
+#define CHIP8_TRACE_HEADER_SIZE 16   /**< Magic, u16 version, u16 record size, machine, quirks, 2 zero bytes */
+#define CHIP8_TRACE_RECORD_SIZE 24   /**< Little-endian u16 PC, opcode, I; u8 SP, DT; V0..VF */
 
 /**
  * @brief CHIP-8 fontset for hexadecimal digits 0-F.
@@ -43,18 +93,99 @@ static const uint8_t chip8_fontset[80] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
+/**
+ * @brief SUPER-CHIP 8x10 fontset for hexadecimal digits 0-F (FX30).
+ *
+ * Loaded at CHIP8_BIG_FONT_ADDR on machines with the SUPER-CHIP
+ * instructions; each character is 10 bytes (rows).
+ */
+static const uint8_t chip8_big_fontset[160] = {
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, // 0
+    0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, // 1
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // 2
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 3
+    0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, // 4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 5
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 6
+    0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, // 7
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 8
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 9
+    0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+    0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+    0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
 /**
  * @enum chip8_state_t
  * @brief Represents the current state of the CHIP-8 emulator.
  */
 typedef enum
 {
-    CHIP8_RUNNING, /**< Emulator is actively executing instructions */
-    CHIP8_PAUSED,  /**< Emulator is paused (waiting for input or debugging) */
-    CHIP8_STOPPED, /**< Emulator has stopped or terminated */
-    CHIP8_ERROR    /**< Emulator encountered an error */
+    CHIP8_RUNNING,   /**< Emulator is actively executing instructions */
+    CHIP8_PAUSED,    /**< Emulator is paused (waiting for input or debugging) */
+    CHIP8_REWINDING, /**< Frontend is stepping back through saved frames */
+    CHIP8_STOPPED,   /**< Emulator has stopped or terminated */
+    CHIP8_ERROR      /**< Emulator encountered an error */
 } chip8_state_t;
 
+/**
+ * @enum chip8_idle_t
+ * @brief What chip8_run_until_tick() found the CPU doing.
+ */
+typedef enum
+{
+    CHIP8_IDLE_NONE,  /**< Real work, or nothing recognized */
+    CHIP8_IDLE_TIMER, /**< Spinning until the delay timer changes (the loop reads DT) */
+    CHIP8_IDLE_INPUT, /**< Spinning on nothing but the keypad; only a key change can end it */
+} chip8_idle_t;
+
+/**
+ * @enum chip8_exit_t
+ * @brief Why chip8_run() returned.
+ */
+typedef enum
+{
+    CHIP8_EXIT_BUDGET,      /**< Every instruction of the budget ran */
+    CHIP8_EXIT_DRAW,        /**< An instruction changed the display: sprite, clear, scroll or resolution switch */
+    CHIP8_EXIT_SOUND,       /**< FX18 switched the buzzer on or off */
+    CHIP8_EXIT_KEY_WAIT,    /**< The CPU is halted in FX0A until a key press */
+    CHIP8_EXIT_STACK_FAULT, /**< CALL with a full stack (the CPU stops) or RET with an empty one (skipped) */
+    CHIP8_EXIT_BREAKPOINT,  /**< The next instruction is at a breakpoint, or a condition holds */
+    CHIP8_EXIT_WATCHPOINT,  /**< The last instruction read or wrote a watched address */
+    CHIP8_EXIT_STOPPED,     /**< The CPU is not RUNNING: 00FD, PC out of range, or paused by the host */
+} chip8_exit_t;
+
+/**
+ * @enum chip8_cond_op_t
+ * @brief Comparison of a conditional break, register on the left.
+ */
+typedef enum
+{
+    CHIP8_COND_EQ, /**< == */
+    CHIP8_COND_NE, /**< != */
+    CHIP8_COND_LT, /**< < */
+    CHIP8_COND_LE, /**< <= */
+    CHIP8_COND_GT, /**< > */
+    CHIP8_COND_GE, /**< >= */
+} chip8_cond_op_t;
+
+/**
+ * @struct chip8_condition_t
+ * @brief A break on a register value, see chip8_add_condition().
+ */
+typedef struct
+{
+    uint16_t addr;  /**< Instruction address it is checked at, or CHIP8_COND_ANY_ADDR */
+    uint16_t value; /**< Right-hand side */
+    uint8_t reg;    /**< 0..15 for V0..VF, or CHIP8_COND_REG_I, _DT, _ST */
+    uint8_t op;     /**< chip8_cond_op_t */
+    bool armed;     /**< CHIP8_COND_ANY_ADDR only: the condition was false at the last check */
+    uint8_t reserved;
+} chip8_condition_t;
+
 /**
  * @struct chip8_instr_t
  * @brief Represents a decoded CHIP-8 instruction (opcode).
@@ -71,6 +202,113 @@ typedef struct
     uint8_t n;       /**< The lowest 4 bits (4th nibble) */
 } chip8_instr_t;
 
+/**
+ * @enum chip8_op_t
+ * @brief Identifies the leaf handler for a fully decoded instruction.
+ *
+ * Unlike the high-nibble opcode table, every sub-opcode of the 0x0, 0x8,
+ * 0xD, 0xE and 0xF groups gets its own value, so a single table lookup
+ * reaches the handler. The SUPER-CHIP classes come last and are only
+ * produced for machines that have those instructions.
+ */
+typedef enum
+{
+    CHIP8_OP_UNDECODED = 0, /**< Decode cache slot not filled yet */
+    CHIP8_OP_CLS,           /**< 00E0 */
+    CHIP8_OP_RET,           /**< 00EE */
+    CHIP8_OP_SYS,           /**< 0NNN (unimplemented) */
+    CHIP8_OP_JP,            /**< 1NNN */
+    CHIP8_OP_CALL,          /**< 2NNN */
+    CHIP8_OP_SE_VX_KK,      /**< 3XNN */
+    CHIP8_OP_SNE_VX_KK,     /**< 4XNN */
+    CHIP8_OP_SE_VX_VY,      /**< 5XY0 */
+    CHIP8_OP_LD_VX_KK,      /**< 6XNN */
+    CHIP8_OP_ADD_VX_KK,     /**< 7XNN */
+    CHIP8_OP_LD_VX_VY,      /**< 8XY0 */
+    CHIP8_OP_OR_VX_VY,      /**< 8XY1 */
+    CHIP8_OP_AND_VX_VY,     /**< 8XY2 */
+    CHIP8_OP_XOR_VX_VY,     /**< 8XY3 */
+    CHIP8_OP_ADD_VX_VY,     /**< 8XY4 */
+    CHIP8_OP_SUB_VX_VY,     /**< 8XY5 */
+    CHIP8_OP_SHR_VX,        /**< 8XY6 */
+    CHIP8_OP_SUBN_VX_VY,    /**< 8XY7 */
+    CHIP8_OP_SHL_VX,        /**< 8XYE */
+    CHIP8_OP_8XXX_UNKNOWN,  /**< Other 8XY_ */
+    CHIP8_OP_SNE_VX_VY,     /**< 9XY0 */
+    CHIP8_OP_LD_I_NNN,      /**< ANNN */
+    CHIP8_OP_JP_V0_NNN,     /**< BNNN */
+    CHIP8_OP_RND_VX_KK,     /**< CXNN */
+    CHIP8_OP_DRW,           /**< DXYN */
+    CHIP8_OP_SKP_VX,        /**< EX9E */
+    CHIP8_OP_SKNP_VX,       /**< EXA1 */
+    CHIP8_OP_EXXX_UNKNOWN,  /**< Other EX__ */
+    CHIP8_OP_LD_VX_DT,      /**< FX07 */
+    CHIP8_OP_LD_VX_K,       /**< FX0A */
+    CHIP8_OP_LD_DT_VX,      /**< FX15 */
+    CHIP8_OP_LD_ST_VX,      /**< FX18 */
+    CHIP8_OP_ADD_I_VX,      /**< FX1E */
+    CHIP8_OP_LD_F_VX,       /**< FX29 */
+    CHIP8_OP_LD_B_VX,       /**< FX33 */
+    CHIP8_OP_LD_MEM_VX,     /**< FX55 */
+    CHIP8_OP_LD_VX_MEM,     /**< FX65 */
+    CHIP8_OP_FXXX_UNKNOWN,  /**< Other FX__ */
+    CHIP8_OP_SCD,           /**< 00CN: scroll down N rows (SUPER-CHIP) */
+    CHIP8_OP_SCR,           /**< 00FB: scroll right 4 pixels */
+    CHIP8_OP_SCL,           /**< 00FC: scroll left 4 pixels */
+    CHIP8_OP_EXIT,          /**< 00FD: stop the interpreter */
+    CHIP8_OP_LOW,           /**< 00FE: low resolution */
+    CHIP8_OP_HIGH,          /**< 00FF: high resolution */
+    CHIP8_OP_DRW16,         /**< DXY0: 16x16 sprite */
+    CHIP8_OP_LD_HF_VX,      /**< FX30: I = 8x10 digit Vx */
+    CHIP8_OP_LD_R_VX,       /**< FX75: flags = V0..Vx */
+    CHIP8_OP_LD_VX_R,       /**< FX85: V0..Vx = flags */
+    CHIP8_OP_COUNT          /**< Number of entries (not an opcode) */
+} chip8_op_t;
+
+/**
+ * @struct chip8_decoded_t
+ * @brief One pre-decoded instruction in the decode cache.
+ *
+ * Stores a handler index rather than a function pointer so that chip8_t
+ * stays a flat, pointer-free structure.
+ */
+typedef struct
+{
+    chip8_instr_t instr; /**< Decoded operands */
+    uint8_t op;          /**< chip8_op_t of the handler, CHIP8_OP_UNDECODED if empty */
+} chip8_decoded_t;
+
+/**
+ * @struct chip8_machine_t
+ * @brief A machine profile: what a config_machine_t adds to the base CHIP-8.
+ */
+typedef struct
+{
+    const char *name; /**< Name used by --machine */
+    uint16_t width;   /**< Widest screen, in pixels */
+    uint16_t height;  /**< Tallest screen, in pixels */
+    bool extended;    /**< SUPER-CHIP instructions: scrolling, 16x16 sprites, resolution switch, big font, flags */
+} chip8_machine_t;
+
+/**
+ * @struct chip8_quirks_t
+ * @brief A quirk profile: how the instructions CHIP-8 variants disagree on behave.
+ *
+ * Each profile has its own handler table, specialized at compile time, so
+ * none of these flags is tested while a ROM runs.
+ */
+typedef struct
+{
+    const char *name;    /**< Name used by --quirks and the quirk database */
+    bool shift_vy;       /**< 8XY6/8XYE shift Vy into Vx (VIP) rather than Vx in place */
+    bool load_store_inc; /**< FX55/FX65 leave I pointing past the last register (VIP) */
+    bool jump_vx;        /**< BXNN jumps to XNN + VX (SUPER-CHIP) rather than NNN + V0 */
+    bool vf_reset;       /**< 8XY1/8XY2/8XY3 clear VF (VIP) */
+} chip8_quirks_t;
+
+/** Decode cache slots: one per even address in 0x200..0xFFF */
+#define CHIP8_DECODE_CACHE_SIZE ((4096 - 0x200) / 2)
+
 /**
  * @struct chip8_t
  * @brief Holds the state of the CHIP-8 emulator.
@@ -78,37 +316,144 @@ typedef struct
 typedef struct
 {
     /* 8-byte aligned fields first */
-    uint64_t last_timer_ticks; /**< Last time timers were updated (8 bytes) */
-    chip8_state_t state;       /**< Current emulator state (4 bytes) */
+    uint64_t timer_epoch;      /**< Counter value the 60 Hz timer schedule started at, 0 before (8 bytes) */
+    uint64_t timer_ticks;      /**< Ticks chip8_timers_tick_60hz() delivered since timer_epoch (8 bytes) */
+    uint64_t idle_skipped;     /**< Instructions chip8_run_until_tick() counted without executing (8 bytes) */
+    uint64_t rng_state;        /**< CXNN xorshift64* state, never zero (8 bytes) */
+    uint64_t seed;             /**< Seed last passed to chip8_seed (8 bytes) */
+    uintptr_t rom_data;        /**< Image data chip8_reset() last loaded (8 bytes) */
+
+    /* Bit-packed display: rows of chip8_row_words() words, bit 63 of the first is x = 0 */
+    uint64_t display[CHIP8_DISPLAY_WORDS]; /**< 1024 bytes; low resolution uses the first 256 */
+    uint64_t dirty_rows;                   /**< Bit y set when display row y changed since the last present */
+
+    chip8_state_t state; /**< Current emulator state (4 bytes) */
 
     /* 16-bit arrays (stack) and registers grouped */
-    uint16_t stack[16]; /**< 32 bytes */
-    uint16_t I;         /**< Index register (2 bytes) */
-    uint16_t pc;        /**< Program counter (2 bytes) */
+    uint16_t stack[16];        /**< 32 bytes */
+    uint16_t I;                /**< Index register (2 bytes) */
+    uint16_t pc;               /**< Program counter (2 bytes) */
+    uint16_t rom_size;         /**< Size of the image chip8_reset() last loaded (2 bytes) */
+    uint16_t dirty_pages;      /**< Bit p set when memory page p may differ from that image */
+    uint16_t keys;             /**< Bit k set while key k (0x0..0xF) is held */
+    uint16_t breakpoint_count; /**< Addresses with a breakpoint, see chip8_set_breakpoint() */
+    uint16_t watch_count;      /**< Addresses watched, see chip8_set_watchpoint() */
+    uint16_t watch_addr;       /**< First watched address the last CHIP8_EVENT_WATCH instruction touched */
 
     /* 8-bit fields */
-    uint8_t sp;          /**< Stack pointer (1 byte) */
-    uint8_t delay_timer; /**< Delay timer (1 byte) */
-    uint8_t sound_timer; /**< Sound timer (1 byte) */
-    uint8_t pad1;        /**< Padding to align to 8 bytes */
+    uint8_t sp;           /**< Stack pointer (1 byte) */
+    uint8_t delay_timer;  /**< Delay timer (1 byte) */
+    uint8_t sound_timer;  /**< Sound timer (1 byte) */
+    uint8_t key_wait;     /**< 0, or CHIP8_KEY_WAIT | x while FX0A waits for a key press (1 byte) */
+    uint8_t idle_wait;    /**< Slices left before the next idle-loop probe (1 byte) */
+    uint8_t idle_backoff; /**< Slices to wait after the next failed probe (1 byte) */
+    uint8_t machine;      /**< config_machine_t, set with chip8_set_machine() (1 byte) */
+    uint8_t hires;        /**< 1 in SUPER-CHIP high resolution, else 0 (1 byte) */
+    uint8_t quirks;       /**< config_quirks_t, set with chip8_set_quirks() (1 byte) */
+    uint8_t core;         /**< config_core_t, set with chip8_set_core() (1 byte) */
+    uint8_t events;       /**< CHIP8_EVENT_* raised since chip8_run() started (1 byte) */
+    uint8_t condition_count; /**< Conditions in use, see chip8_add_condition() (1 byte) */
+    bool watch_store;     /**< The CHIP8_EVENT_WATCH access was a store, not a read */
+    bool code_hints;      /**< code_map and idle_map describe memory, see chip8_set_code_hints() */
+    bool trace;           /**< Log every instruction (TRACE=1 builds only) */
 
     /* 8-bit arrays */
-    uint8_t V[16]; /**< CPU registers V0..VF (16 bytes) */
-    bool keys[16]; /**< Input keys 0x0..0xF (16 bytes if bool is 1 byte) */
-
-    /* Large bool array (display) */
-    uint8_t display[64 * 32]; /**< 2048 bytes */
+    uint8_t V[16];                /**< CPU registers V0..VF (16 bytes) */
+    uint8_t rpl[CHIP8_RPL_FLAGS]; /**< SUPER-CHIP flag registers (8 bytes) */
 
     /* Largest array last: 4K memory */
     uint8_t memory[4096]; /**< 4096 bytes */
 
+    /* Host-side breakpoints, one bit per address */
+    uint8_t breakpoints[4096 / 8]; /**< Bit a: chip8_run() stops before the instruction at address a */
+    uint8_t watchpoints[4096 / 8]; /**< Bit a: chip8_run() stops after an instruction that touches address a */
+    chip8_condition_t conditions[CHIP8_MAX_CONDITIONS]; /**< The first condition_count are in use */
+
+    /* Load-time analysis of the program, one bit per address */
+    uint8_t code_map[4096 / 8]; /**< Bit a: an instruction reachable from 0x200 starts at address a */
+    uint8_t idle_map[4096 / 8]; /**< Bit a: the instruction at a may lie on an idle loop */
+
     /* Decoded instruction */
     chip8_instr_t current_instr; /**< Holds the currently decoded instruction */
 
     /* The display config structure */
     display_config_t config; /**< Aligned to 8 bytes to avoid extra padding */
+
+    /* Pre-decoded instructions for the program area, filled lazily or by chip8_set_code_hints() */
+    chip8_decoded_t decode_cache[CHIP8_DECODE_CACHE_SIZE]; /**< 17920 bytes */
 } chip8_t;
 
+/**
+ * @struct chip8_snapshot_t
+ * @brief The machine state of a chip8_t, for save states and rewind.
+ *
+ * Holds everything a ROM can observe: memory, registers, timers, display
+ * and the CXNN generator. Host-side fields (run state, keys, display
+ * config, quirk profile, decode cache) are not part of a snapshot; the
+ * machine is, so a snapshot is never restored into a different machine.
+ * The layout has no implicit padding, so snapshots can be compared and
+ * XOR-ed bytewise.
+ */
+typedef struct
+{
+    uint64_t rng_state;                    /**< CXNN generator state */
+    uint64_t seed;                         /**< Seed the generator was started from */
+    uint64_t display[CHIP8_DISPLAY_WORDS]; /**< Bit-packed display, as chip8_t::display */
+    uint16_t stack[16];                    /**< Call stack */
+    uint16_t I;                            /**< Index register */
+    uint16_t pc;                           /**< Program counter */
+    uint8_t sp;                            /**< Stack pointer */
+    uint8_t delay_timer;                   /**< Delay timer */
+    uint8_t sound_timer;                   /**< Sound timer */
+    uint8_t key_wait;                      /**< FX0A wait, as chip8_t::key_wait */
+    uint8_t V[16];                         /**< Registers V0..VF */
+    uint8_t rpl[CHIP8_RPL_FLAGS];          /**< SUPER-CHIP flag registers */
+    uint8_t machine;                       /**< config_machine_t the state belongs to */
+    uint8_t hires;                         /**< High resolution, as chip8_t::hires */
+    uint8_t reserved[6];                   /**< Zero */
+    uint8_t memory[4096];                  /**< RAM */
+} chip8_snapshot_t;
+
+/**
+ * @brief Returns the words per display row: 1 in low resolution, 2 in high.
+ *
+ * Row y of the display starts at word y * chip8_row_words(), so a
+ * low-resolution screen is laid out exactly as on a plain CHIP-8.
+ */
+static inline unsigned chip8_row_words(const chip8_t *emu)
+{
+    return 1u << emu->hires;
+}
+
+/**
+ * @brief Returns the width of the current screen in pixels (64 or 128).
+ */
+static inline unsigned chip8_display_width(const chip8_t *emu)
+{
+    return (unsigned)CHIP8_DISPLAY_WIDTH << emu->hires;
+}
+
+/**
+ * @brief Returns the height of the current screen in pixels (32 or 64).
+ */
+static inline unsigned chip8_display_height(const chip8_t *emu)
+{
+    return (unsigned)CHIP8_DISPLAY_HEIGHT << emu->hires;
+}
+
+/**
+ * @brief Returns whether the display pixel at (x, y) is lit.
+ *
+ * @param emu Pointer to the emulator.
+ * @param x   Column, 0..chip8_display_width()-1.
+ * @param y   Row, 0..chip8_display_height()-1.
+ */
+static inline bool chip8_get_pixel(const chip8_t *emu, unsigned x, unsigned y)
+{
+    const uint64_t *row = &emu->display[y << emu->hires];
+    return (row[x >> 6] >> (63 - (x & 63))) & 1;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -122,6 +467,64 @@ extern "C"
      */
     bool chip8_init(chip8_t *emu);
 
+    /**
+     * @brief Returns the profile of a machine.
+     *
+     * @param machine config_machine_t value.
+     * @return Static profile; the CHIP-8 one for out-of-range values.
+     */
+    const chip8_machine_t *chip8_machine_info(uint8_t machine);
+
+    /**
+     * @brief Switches @p emu to another machine.
+     *
+     * Installs the machine's fonts, returns to low resolution with a blank
+     * screen and clears the flag registers. Call after chip8_init() and
+     * before loading a ROM; chip8_reset() keeps the machine.
+     *
+     * @param emu     Pointer to the chip8_t struct.
+     * @param machine config_machine_t value.
+     */
+    void chip8_set_machine(chip8_t *emu, uint8_t machine);
+
+    /**
+     * @brief Returns a quirk profile.
+     *
+     * @param quirks config_quirks_t value.
+     * @return Static profile; the modern one for out-of-range values.
+     */
+    const chip8_quirks_t *chip8_quirks_info(uint8_t quirks);
+
+    /**
+     * @brief Selects the quirk profile @p emu runs with.
+     *
+     * Takes effect at the next instruction and may be called at any time;
+     * no state is reset. chip8_init() selects CONFIG_QUIRKS_MODERN.
+     *
+     * @param emu    Pointer to the chip8_t struct.
+     * @param quirks config_quirks_t value.
+     */
+    void chip8_set_quirks(chip8_t *emu, uint8_t quirks);
+
+    /**
+     * @brief Returns the name of a CPU engine, as used by --core.
+     *
+     * @param core config_core_t value.
+     * @return Static string; "cached" for out-of-range values.
+     */
+    const char *chip8_core_name(uint8_t core);
+
+    /**
+     * @brief Selects the CPU engine chip8_run() uses.
+     *
+     * Engines share all machine state, so this may be called at any time.
+     * chip8_init() selects CONFIG_CORE_CACHED.
+     *
+     * @param emu  Pointer to the chip8_t struct.
+     * @param core config_core_t value.
+     */
+    void chip8_set_core(chip8_t *emu, uint8_t core);
+
     /**
      * @brief Loads a CHIP-8 program into memory.
      *
@@ -131,6 +534,98 @@ extern "C"
      */
     bool chip8_load_program(chip8_t *emu, const char *filepath);
 
+    /**
+     * @brief Copies ROM bytes from memory to 0x200 and flushes the decode cache.
+     *
+     * Use this in place of chip8_load_program() when the ROM is already in
+     * memory (see rom.h), so that loads involve no filesystem access.
+     *
+     * @param emu  Pointer to the CHIP-8 emulator structure.
+     * @param data ROM bytes.
+     * @param size ROM size in bytes.
+     * @return true on success, false if the ROM does not fit.
+     */
+    bool chip8_load_buffer(chip8_t *emu, const uint8_t *data, size_t size);
+
+    /**
+     * @brief Returns @p emu to the power-on state with @p rom loaded.
+     *
+     * Equivalent to chip8_init() followed by chip8_load_buffer(), but only
+     * the memory pages written since the last reset (tracked in
+     * emu->dirty_pages) are rebuilt from the fontset and the image, and
+     * only their decode cache slots are dropped. Resetting to the image
+     * that was loaded last is therefore a few hundred bytes of work in
+     * the common case. The image is recognized by its data pointer and
+     * size, so its bytes must not change between resets.
+     *
+     * The display config and trace flag are preserved and the generator is
+     * reseeded with emu->seed. @p emu must have been set up with
+     * chip8_init() once beforehand.
+     *
+     * @param emu Pointer to the CHIP-8 emulator structure.
+     * @param rom Image to load.
+     * @return true on success, false if the ROM does not fit (emu untouched).
+     */
+    bool chip8_reset(chip8_t *emu, const rom_image_t *rom);
+
+    /**
+     * @brief Decodes the raw 16-bit opcode into a chip8_instr_t struct.
+     *
+     * @param opcode The raw 16-bit opcode fetched from memory.
+     * @return A fully populated chip8_instr_t.
+     */
+    chip8_instr_t chip8_decode_opcode(uint16_t opcode);
+
+    /**
+     * @brief Maps a raw opcode to the chip8_op_t of its leaf handler.
+     *
+     * @param opcode  The raw 16-bit opcode.
+     * @param machine config_machine_t whose instruction set applies; on a
+     *                plain CHIP-8, 00FF is a SYS call and DXY0 draws nothing.
+     * @return The handler index; never CHIP8_OP_UNDECODED.
+     */
+    chip8_op_t chip8_classify_opcode(uint16_t opcode, uint8_t machine);
+
+    /**
+     * @brief Returns the opcode pattern of an instruction class, e.g. "8XY4".
+     *
+     * @param op Instruction class.
+     * @return Static string; "????" for out-of-range values.
+     */
+    const char *chip8_op_name(chip8_op_t op);
+
+    /**
+     * @brief Copies the machine state of @p emu into @p snap.
+     *
+     * @param emu  Emulator to capture.
+     * @param snap Receives the snapshot.
+     */
+    void chip8_snapshot(const chip8_t *emu, chip8_snapshot_t *snap);
+
+    /**
+     * @brief Replaces the machine state of @p emu with @p snap.
+     *
+     * The run state, keys and display config are left alone. The decode
+     * cache is flushed (memory may differ) and every display row is marked
+     * dirty so the next present shows the restored screen.
+     *
+     * @param emu  Emulator to overwrite.
+     * @param snap Snapshot taken with chip8_snapshot().
+     */
+    void chip8_restore(chip8_t *emu, const chip8_snapshot_t *snap);
+
+    /**
+     * @brief Discards every pre-decoded instruction.
+     *
+     * The decode cache is kept coherent with the CPU's own stores (FX33,
+     * FX55). Any other code that writes to emu->memory directly must call
+     * this afterwards. It also marks every memory page dirty, so the next
+     * chip8_reset() reloads all of memory.
+     *
+     * @param emu Pointer to the chip8_t struct.
+     */
+    void chip8_flush_decode_cache(chip8_t *emu);
+
     /**
      * @brief Logs the current instruction for debugging purposes.
      *
@@ -138,20 +633,293 @@ extern "C"
      * including the program counter (PC), opcode, and various components
      * of the instruction (x, y, kk, nnn, n).
      *
+     * chip8_cycle() only calls this in builds compiled with CHIP8_TRACE
+     * (make TRACE=1) and only while emu->trace is set. While a trace file
+     * is open, a binary record is queued instead of a text line.
+     *
      * @param emu Pointer to the chip8_t structure representing the emulator state.
      */
     void debug_log_instruction(const chip8_t *emu);
 
+    /**
+     * @brief Fills the header of a binary trace file for @p emu.
+     *
+     * @param emu Emulator whose machine and quirks are recorded.
+     * @param out Receives CHIP8_TRACE_HEADER_SIZE bytes.
+     */
+    void chip8_trace_header(const chip8_t *emu, uint8_t out[CHIP8_TRACE_HEADER_SIZE]);
+
+    /**
+     * @brief Fills the trace record of the instruction about to execute.
+     *
+     * debug_log_instruction() writes these instead of text while a trace
+     * file is open (see log_trace_open()).
+     *
+     * @param emu Emulator, with current_instr decoded.
+     * @param out Receives CHIP8_TRACE_RECORD_SIZE bytes.
+     */
+    void chip8_trace_record(const chip8_t *emu, uint8_t out[CHIP8_TRACE_RECORD_SIZE]);
+
     /**
      * @brief Executes one CPU cycle of the CHIP-8 CPU.
      *
      * Fetches an opcode from memory, decodes it, and executes it,
-     * then advances the program counter.
+     * then advances the program counter. Instructions at even addresses in
+     * the program area are decoded once and served from the decode cache
+     * afterwards, except with CONFIG_CORE_TABLE, which decodes every fetch.
+     * The threaded engine has no single-step form; with it selected, this
+     * steps like CONFIG_CORE_CACHED.
      *
      * @param emu Pointer to the chip8_t struct representing the emulator state.
      */
     void chip8_cycle(chip8_t *emu);
 
+    /**
+     * @brief Runs up to @p budget instructions, stopping early at the first event.
+     *
+     * The batch ends after the instruction that changes the display,
+     * switches the buzzer with FX18, halts in FX0A or faults the stack, or
+     * when the CPU stops; after one that touches a watchpoint; and before
+     * an instruction at a breakpoint or whose condition holds, unless the
+     * previous batch (or chip8_step()) stopped right there, so calling
+     * again continues past it.
+     * Nothing runs if the CPU is already halted in FX0A or not RUNNING.
+     * Timer ticks happen outside, so the buzzer running out on its own is
+     * not an event.
+     *
+     * The loop runs on the engine chosen with chip8_set_core(). Under
+     * CONFIG_CORE_THREADED the whole batch stays inside one function: PC
+     * and I live in locals, dispatch is a computed goto through a label
+     * table per quirk profile (a switch where the compiler lacks computed
+     * goto), and only drawing, scrolling and the rarer SUPER-CHIP
+     * instructions go through the shared handlers. emu->current_instr is
+     * then only updated for those. Instructions are traced (TRACE=1
+     * builds) by the table and cached engines only; the threaded one steps
+     * with chip8_cycle() while emu->trace is set.
+     *
+     * @param emu         Pointer to the CHIP-8 emulator instance.
+     * @param budget      Maximum number of instructions.
+     * @param exit_reason Receives why the batch ended. A CALL overflow
+     *                    reports CHIP8_EXIT_STACK_FAULT, although it stops
+     *                    the CPU as well.
+     * @return Instructions executed, at most @p budget.
+     */
+    uint32_t chip8_run(chip8_t *emu, uint32_t budget, chip8_exit_t *exit_reason);
+
+    /**
+     * @brief Runs up to @p budget instructions, fast-forwarding idle loops.
+     *
+     * Callers pick @p budget so that the slice ends at the next timer tick
+     * (or earlier). The slice starts with a probe: if, within
+     * CHIP8_IDLE_MAX_LOOP instructions free of side effects (no stores,
+     * draws, calls, CXNN or timer writes), the CPU returns to its starting
+     * PC with V, I and SP unchanged, it is in a loop whose every iteration
+     * is identical until a timer tick or a key change. The remaining whole
+     * iterations of the slice are then counted without being executed,
+     * which leaves the machine exactly where real execution would.
+     * Probes of busy code back off exponentially, so their cost stays
+     * negligible.
+     *
+     * Stops early when the CPU leaves the RUNNING state, halts in FX0A or
+     * stops at a breakpoint, condition or watchpoint (emu->events tells
+     * which). Skipped iterations are not traced; they are added up in
+     * emu->idle_skipped, so speed can be measured from what actually ran.
+     *
+     * @param emu    Pointer to the CHIP-8 emulator instance.
+     * @param budget Instructions until the next timer tick.
+     * @param idle   Receives what the probe found; with CHIP8_IDLE_INPUT and
+     *               no new input, every later slice would be idle as well.
+     * @return Instructions executed or skipped, at most @p budget.
+     */
+    uint32_t chip8_run_until_tick(chip8_t *emu, uint32_t budget, chip8_idle_t *idle);
+
+    /**
+     * @brief Returns whether an instruction class can be part of an idle loop.
+     *
+     * These are the instructions whose only effects are on V, I and the
+     * PC: jumps, skips, ALU operations, I arithmetic, FX65 and the timer
+     * and key reads, which chip8_run_until_tick() keeps constant within a
+     * slice. A loop built from them alone repeats exactly until a timer
+     * tick or a key change.
+     */
+    bool chip8_idle_safe(chip8_op_t op);
+
+    /**
+     * @brief Installs what a static analysis of the loaded program found.
+     *
+     * Pre-decodes every instruction of @p code_map into the decode cache,
+     * and lets chip8_run_until_tick() skip the idle probe wherever the PC
+     * is on a known instruction outside @p idle_map, since no loop the
+     * probe accepts passes there. PCs the analysis did not reach (BNNN
+     * targets, code below 0x200) are probed as before. The hints are
+     * dropped when the CPU stores into an instruction of @p code_map, when
+     * memory is replaced (chip8_load_program(), chip8_set_machine(),
+     * chip8_flush_decode_cache(), chip8_reset() with another image) and
+     * when chip8_restore() brings in different instructions; they only
+     * ever save work, so running without them is always correct.
+     *
+     * @param emu      Pointer to the CHIP-8 emulator instance, program loaded.
+     * @param code_map One bit per address (4096 / 8 bytes), set where a
+     *                 reachable instruction starts; NULL drops the hints.
+     * @param idle_map One bit per address, set on every instruction that
+     *                 may lie on an idle loop of at most CHIP8_IDLE_MAX_LOOP
+     *                 instructions.
+     */
+    void chip8_set_code_hints(chip8_t *emu, const uint8_t *code_map, const uint8_t *idle_map);
+
+    /**
+     * @brief Sets or clears a breakpoint at @p addr.
+     *
+     * Breakpoints belong to the host: chip8_reset() and chip8_restore()
+     * keep them, snapshots do not include them, and chip8_init() clears
+     * them. The same goes for watchpoints and conditions. While any of the
+     * three is set, chip8_run() checks the PC before every instruction,
+     * the threaded engine steps like the cached one and
+     * chip8_run_until_tick() does not look for idle loops; with none set,
+     * they cost one test per batch and one per FX33, FX55, FX65 or DXYN.
+     *
+     * @param emu  Pointer to the CHIP-8 emulator instance.
+     * @param addr Address of the instruction, 0x000..0xFFF.
+     * @param on   true to set, false to clear.
+     */
+    void chip8_set_breakpoint(chip8_t *emu, uint16_t addr, bool on);
+
+    /**
+     * @brief Clears every breakpoint.
+     */
+    void chip8_clear_breakpoints(chip8_t *emu);
+
+    /**
+     * @brief Reports whether a breakpoint is set at @p addr.
+     */
+    static inline bool chip8_has_breakpoint(const chip8_t *emu, uint16_t addr)
+    {
+        return (emu->breakpoints[(addr >> 3) & 0x1FF] >> (addr & 7)) & 1;
+    }
+
+    /**
+     * @brief Sets or clears watchpoints on the addresses @p first..@p last.
+     *
+     * A watched address stops chip8_run() after the instruction that
+     * touches it, with CHIP8_EXIT_WATCHPOINT; emu->watch_addr and
+     * emu->watch_store then tell which byte and how. Stores are FX33 and
+     * FX55, reads are FX65 and the sprite data of DXYN. Like breakpoints,
+     * watchpoints belong to the host and make chip8_run() step.
+     *
+     * @param emu   Pointer to the CHIP-8 emulator instance.
+     * @param first First address, 0x000..0xFFF.
+     * @param last  Last address, at least @p first.
+     * @param on    true to watch, false to stop watching.
+     */
+    void chip8_set_watchpoint(chip8_t *emu, uint16_t first, uint16_t last, bool on);
+
+    /**
+     * @brief Clears every watchpoint.
+     */
+    void chip8_clear_watchpoints(chip8_t *emu);
+
+    /**
+     * @brief Reports whether a watchpoint is set at @p addr.
+     */
+    static inline bool chip8_has_watchpoint(const chip8_t *emu, uint16_t addr)
+    {
+        return (emu->watchpoints[(addr >> 3) & 0x1FF] >> (addr & 7)) & 1;
+    }
+
+    /**
+     * @brief Adds a break on a register value.
+     *
+     * With an address, chip8_run() stops before the instruction at @p addr
+     * whenever the condition holds there, like a breakpoint that only
+     * fires sometimes. With CHIP8_COND_ANY_ADDR it is checked before every
+     * instruction and stops once each time it becomes true, so continuing
+     * does not stop again until it has been false in between. Either way
+     * the exit reason is CHIP8_EXIT_BREAKPOINT.
+     *
+     * @param emu   Pointer to the CHIP-8 emulator instance.
+     * @param addr  Instruction address, or CHIP8_COND_ANY_ADDR.
+     * @param reg   0..15 for V0..VF, or CHIP8_COND_REG_I, _DT or _ST.
+     * @param op    Comparison, register on the left.
+     * @param value Right-hand side.
+     * @return false if CHIP8_MAX_CONDITIONS are already set or @p reg is invalid.
+     */
+    bool chip8_add_condition(chip8_t *emu, uint16_t addr, uint8_t reg, chip8_cond_op_t op, uint16_t value);
+
+    /**
+     * @brief Removes every condition.
+     */
+    void chip8_clear_conditions(chip8_t *emu);
+
+    /**
+     * @brief Executes exactly one instruction for a debugger.
+     *
+     * Breakpoints and conditions are not checked, so this steps off one;
+     * watchpoints are, and report CHIP8_EXIT_WATCHPOINT. The next
+     * chip8_run() starts with the instruction at the new PC unchecked, as
+     * after a breakpoint: continuing from where a debugger stepped to
+     * never stops again on the spot.
+     *
+     * @param emu         Pointer to the CHIP-8 emulator instance.
+     * @param exit_reason Receives what the instruction raised, as for chip8_run().
+     * @return 1, or 0 if the CPU is not RUNNING or waits in FX0A.
+     */
+    uint32_t chip8_step(chip8_t *emu, chip8_exit_t *exit_reason);
+
+    /**
+     * @brief Seeds the emulator's private random number generator (CXNN).
+     *
+     * Each instance owns its generator, so instances on different threads
+     * never contend and identical seeds reproduce identical runs. The seed
+     * is remembered in emu->seed.
+     *
+     * @param emu  Pointer to the CHIP-8 emulator instance.
+     * @param seed Any 64-bit value (0 is valid).
+     */
+    void chip8_seed(chip8_t *emu, uint64_t seed);
+
+    /**
+     * @brief Reports whether the buzzer should currently sound.
+     *
+     * The core never drives audio itself; frontends poll this once per
+     * frame and start or stop their tone accordingly.
+     *
+     * @param emu Pointer to the CHIP-8 emulator instance.
+     * @return true while the sound timer is non-zero.
+     */
+    static inline bool chip8_sound_active(const chip8_t *emu)
+    {
+        return emu->sound_timer > 0;
+    }
+
+    /**
+     * @brief Reports whether the CPU is halted in FX0A until a key is pressed.
+     *
+     * chip8_cycle() does nothing in this state, so frontends can skip the
+     * frame's instruction batch entirely; timers keep running.
+     *
+     * @param emu Pointer to the CHIP-8 emulator instance.
+     * @return true while waiting for a key press.
+     */
+    static inline bool chip8_waiting_for_key(const chip8_t *emu)
+    {
+        return emu->key_wait != 0;
+    }
+
+    /**
+     * @brief Updates the keypad and resumes a pending FX0A.
+     *
+     * @p held becomes the state EX9E and EXA1 test. If FX0A is waiting, the
+     * lowest key in @p pressed is stored in its register and execution
+     * resumes at the next chip8_cycle().
+     *
+     * @param emu     Pointer to the CHIP-8 emulator instance.
+     * @param held    Keys currently down (bit k for key k).
+     * @param pressed Keys that went down since the previous call, including
+     *                ones already released again; pass held & ~emu->keys
+     *                when only the held state is known.
+     */
+    void chip8_set_keys(chip8_t *emu, uint16_t held, uint16_t pressed);
+
     /**
      * @brief Decrements CHIP-8 emulator timers.
      *
@@ -168,11 +936,39 @@ extern "C"
      *
      * This routine updates the internal timers to emulate the original CHIP-8
      * behavior, where both the delay and sound timers count down at a rate of
-     * 60 times per second.
+     * 60 times per second. The wall-clock reference is kept per instance in
+     * emu->timer_epoch. Tick n is due at timer_epoch + n * freq / 60,
+     * computed from the tick count, so rounding never accumulates into
+     * drift however often this is called.
+     *
+     * @param emu Pointer to the CHIP-8 emulator instance.
+     * @return Ticks delivered by this call.
+     */
+    unsigned chip8_timers_tick_60hz(chip8_t *emu);
+
+    /**
+     * @brief Computes a 64-bit FNV-1a hash of the display buffer.
+     *
+     * Two emulator runs that end with identical screens produce identical
+     * hashes, which makes this suitable for regression checks. Only the
+     * rows of the current resolution are hashed, so low-resolution screens
+     * hash the same on every machine.
+     *
+     * @param emu Pointer to the CHIP-8 emulator instance.
+     * @return Hash of the current display contents.
+     */
+    uint64_t chip8_display_hash(const chip8_t *emu);
+
+    /**
+     * @brief Computes a 64-bit FNV-1a hash of the 4 KB memory.
+     *
+     * Complements chip8_display_hash(): game state such as scores usually
+     * lives in memory before it is drawn.
      *
      * @param emu Pointer to the CHIP-8 emulator instance.
+     * @return Hash of the current memory contents.
      */
-    void chip8_timers_tick_60hz(chip8_t *emu);
+    uint64_t chip8_memory_hash(const chip8_t *emu);
 
 #ifdef __cplusplus
 }
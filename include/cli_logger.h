@@ -4,6 +4,18 @@
  *
  * This file contains the declarations of functions used for logging
  * informational, warning, error, and timestamped messages to the CLI.
+ *
+ * Debug and info messages go to stdout, warnings and errors to stderr,
+ * colored only when the stream is a terminal. Messages below the log level
+ * return before any formatting, and a warning repeated more than LOG_BURST
+ * times in a second is counted instead of printed.
+ *
+ * After log_start(), a message is formatted straight into a ring buffer
+ * owned by the calling thread and written by a background thread, so a
+ * warning raised at instruction rate costs a vsnprintf() and no I/O. A
+ * thread whose ring is full waits for the writer, so nothing is lost.
+ * Messages are written in the order their calls started, across threads
+ * as well. Without log_start(), messages are written at once.
  */
 
 #ifndef CLI_LOGGER_H
@@ -11,6 +23,7 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // ANSI color codes for terminal
 #define RESET_COLOR "\033[0m"      // Reset to default color
@@ -19,6 +32,89 @@
 #define COLOR_ERROR "\033[1;31m"   // Red
 #define COLOR_DEBUG "\033[0;32m"   // Green
 
+#define LOG_LINE_MAX 496     /**< Longest message kept, and largest trace record; longer ones are cut */
+#define LOG_RING_SLOTS 128   /**< Messages one thread can have waiting (a power of two) */
+#define LOG_MAX_THREADS 32   /**< Threads with a ring; further ones write synchronously */
+#define LOG_BURST 8          /**< Times per second the same warning is printed */
+#define LOG_REPEAT_SLOTS 8   /**< Distinct warnings per thread tracked for LOG_BURST */
+
+/**
+ * @enum log_level_t
+ * @brief Message severities, in increasing order.
+ */
+typedef enum
+{
+    LOG_LEVEL_DEBUG,   /**< print_debug and everything above (default) */
+    LOG_LEVEL_INFO,    /**< print_info and everything above */
+    LOG_LEVEL_WARNING, /**< print_warning and print_error */
+    LOG_LEVEL_ERROR    /**< print_error only */
+} log_level_t;
+
+/**
+ * @brief Sets the minimum severity that is printed.
+ *
+ * Messages below the level return before any formatting is done.
+ *
+ * @param level Lowest level to print.
+ */
+void set_log_level(log_level_t level);
+
+/**
+ * @brief Starts the background writer; messages are queued from now on.
+ *
+ * @return false if the thread could not be created; logging stays synchronous.
+ */
+bool log_start(void);
+
+/**
+ * @brief Waits until everything logged so far has been written.
+ *
+ * Call before writing to stdout or stderr directly, so the output keeps
+ * its order.
+ */
+void log_flush(void);
+
+/**
+ * @brief Writes what is queued, reports suppressed warnings,
+ *        closes the trace file and stops the background writer.
+ *
+ * Call once the other threads have stopped logging; logging is
+ * synchronous again afterwards. Safe without log_start().
+ */
+void log_stop(void);
+
+/**
+ * @brief Opens a binary trace file and writes its header.
+ *
+ * @param path   File to create.
+ * @param header Bytes written first.
+ * @param size   Size of @p header.
+ * @return false if the file cannot be written.
+ */
+bool log_trace_open(const char *path, const void *header, size_t size);
+
+/**
+ * @brief Returns whether a trace file is open.
+ */
+bool log_trace_active(void);
+
+/**
+ * @brief Appends one record to the trace file.
+ *
+ * Records go through the ring like messages, in order with them.
+ *
+ * @param record Bytes of the record.
+ * @param size   At most LOG_LINE_MAX.
+ */
+void log_trace_write(const void *record, size_t size);
+
+/**
+ * @brief Flushes and closes the trace file.
+ *
+ * @return false if a write failed.
+ */
+bool log_trace_close(void);
+
 /**
  * @brief Prints an informational message to the CLI.
  *
@@ -21,8 +21,63 @@
 #define CONFIG_DEFAULT_FG_COLOR 0xFFFFFFFF        /**< Default foreground color (white) */
 #define CONFIG_DEFAULT_BG_COLOR 0x00000000        /**< Default background color (black) */
 #define CONFIG_DEFAULT_SCALE_FACTOR 10            /**< Default scale factor for enlarging the display */
-#define CONFIG_DEFAULT_WAV_PATH "assets/beep.wav" /**< Default path to the beep .wav file */
 #define CONFIG_DEFAULT_VOLUME 128                 /**< Default audio volume (0-128) */
+#define CONFIG_DEFAULT_TONE_HZ 440                /**< Default beep frequency */
+#define CONFIG_DEFAULT_AUDIO_BUFFER 256           /**< Default audio buffer, in samples (about 6 ms) */
+#define CONFIG_FRAME_RATE 60                      /**< Emulated frames per second (timer rate) */
+#define CONFIG_DEFAULT_CYCLES_PER_FRAME 12        /**< Default instructions per frame (720 IPS) */
+#define CONFIG_DEFAULT_MAX_CYCLES 10000000ULL     /**< Default headless cycle budget */
+#define CONFIG_DEFAULT_REWIND_SECONDS 10          /**< Default rewind history length */
+#define CONFIG_MAX_REWIND_SECONDS 3600            /**< Longest --rewind history (about 55 MB) */
+
+/**
+ * @enum config_renderer_t
+ * @brief Presentation backend of the window.
+ */
+typedef enum
+{
+    CONFIG_RENDERER_SDL, /**< SDL_Renderer with a CPU-converted ARGB8888 texture */
+    CONFIG_RENDERER_GL   /**< OpenGL shader over the packed 1-bit framebuffer (see gl_renderer.h) */
+} config_renderer_t;
+
+/**
+ * @enum config_machine_t
+ * @brief Machine the ROM is written for (see chip8_machine_info()).
+ */
+typedef enum
+{
+    CONFIG_MACHINE_CHIP8, /**< COSMAC VIP CHIP-8: 64x32, the base instruction set */
+    CONFIG_MACHINE_SCHIP, /**< SUPER-CHIP 1.1: adds 128x64, scrolling, 16x16 sprites, big font, flags */
+    CONFIG_MACHINE_COUNT  /**< Number of machines (not a machine) */
+} config_machine_t;
+
+/**
+ * @enum config_quirks_t
+ * @brief Interpreter behaviour a ROM expects where CHIP-8 variants disagree
+ *        (see chip8_quirks_info()).
+ */
+typedef enum
+{
+    CONFIG_QUIRKS_MODERN,     /**< Common modern behaviour: shifts use Vx, FX55/FX65 keep I, BNNN uses V0 */
+    CONFIG_QUIRKS_VIP,        /**< COSMAC VIP: shifts use Vy, FX55/FX65 advance I, 8XY1-3 clear VF */
+    CONFIG_QUIRKS_SCHIP,      /**< SUPER-CHIP 1.1: as modern, but BXNN jumps to XNN + VX */
+    CONFIG_QUIRKS_COUNT,      /**< Number of profiles (not a profile) */
+    CONFIG_QUIRKS_AUTO = 0xFF /**< Look the ROM up in the quirk database (see quirks_db.h) */
+} config_quirks_t;
+
+/**
+ * @enum config_core_t
+ * @brief CPU engine that executes instructions (see chip8_run()).
+ *
+ * All engines behave identically; they differ only in speed.
+ */
+typedef enum
+{
+    CONFIG_CORE_CACHED,   /**< Decode cache with one handler call per instruction */
+    CONFIG_CORE_TABLE,    /**< Decode every fetch and dispatch on the high nibble */
+    CONFIG_CORE_THREADED, /**< Single-function interpreter with registers in locals */
+    CONFIG_CORE_COUNT     /**< Number of engines (not an engine) */
+} config_core_t;
 
 /**
  * @struct display_config_t
@@ -35,7 +90,10 @@ typedef struct
     uint32_t fg_color;      /**< Foreground color (white) */
     uint32_t bg_color;      /**< Background color (black) */
     uint32_t scale_factor;  /**< Scale factor for enlarging the CHIP-8 display */
-    uint8_t padding[4];     /**< Padding to align to 8 bytes */
+    uint8_t renderer;       /**< config_renderer_t */
+    bool crt;               /**< GL renderer: scanlines and vignette */
+    bool ghost;             /**< GL renderer: fading trail of pixels turned off recently */
+    uint8_t padding[1];     /**< Padding to align to 8 bytes */
 } display_config_t;
 
 /**
@@ -45,18 +103,66 @@ typedef struct
 typedef struct
 {
     bool enabled;       /**< Whether audio is enabled */
-    char wav_path[256]; /**< Path to the beep .wav file */
     int volume;         /**< Audio volume (0-128) */
+    int tone_hz;        /**< Beep frequency in Hz */
+    int buffer_samples; /**< Audio device buffer in samples (a power of two) */
 } audio_config_t;
 
+/**
+ * @struct input_config_t
+ * @brief Holds keyboard settings.
+ */
+typedef struct
+{
+    char keymap_path[256]; /**< Keymap file (see sdl_keymap_load()); empty for the built-in layout */
+} input_config_t;
+
+/**
+ * @struct emulation_config_t
+ * @brief Holds CPU scheduling parameters for the emulator.
+ */
+typedef struct
+{
+    uint32_t cycles_per_frame; /**< CHIP-8 instructions executed per 60 Hz frame */
+    uint8_t machine;           /**< config_machine_t */
+    uint8_t quirks;            /**< config_quirks_t; CONFIG_QUIRKS_AUTO picks one per ROM */
+    char quirks_db[256];       /**< Quirk database; empty for quirks.db next to the ROM */
+    uint8_t core;              /**< config_core_t */
+    bool headless;             /**< Run without window/audio, as fast as possible */
+    bool dump_display;         /**< Headless: print the final display as ASCII */
+    bool trace;                /**< Log every executed instruction (TRACE=1 builds) */
+    char trace_file[256];      /**< Binary instruction trace; empty to log as text */
+    uint64_t max_cycles;       /**< Headless: instruction budget before exiting */
+    uint64_t seed;             /**< CXNN random seed (valid when seed_set) */
+    bool seed_set;             /**< --seed given; otherwise the frontend picks one */
+    bool profile;              /**< Collect an instruction profile and report it on exit */
+    char profile_out[256];     /**< Profile file (.csv or JSON); empty for none */
+    uint32_t stats_seconds;    /**< Seconds between logged metrics lines; 0 for none */
+    char metrics_out[256];     /**< Metrics JSON written on exit; empty for none */
+    uint32_t rewind_seconds;   /**< Rewind history in seconds; 0 disables rewind */
+    char save_state[256];      /**< Save state written on exit; empty for none */
+    char load_state[256];      /**< Save state loaded after the ROM; empty for none */
+    char record_path[256];     /**< Frame recording written while running (see recorder.h); empty for none */
+    char record_input[256];    /**< Input log written on exit (see replay.h); empty for none */
+    char replay_path[256];     /**< Input log replayed headless; empty for none */
+    uint64_t expect_hash;      /**< Headless: required final display hash (valid when expect_hash_set) */
+    bool expect_hash_set;      /**< --expect-hash given */
+    char breakpoints[256];     /**< --break addresses, comma-separated; empty for none */
+    char watchpoints[256];     /**< --watch address ranges, comma-separated; empty for none */
+    char conditions[256];      /**< --break-if conditions, comma-separated; empty for none */
+    uint16_t debug_port;       /**< TCP port of the debugger command line; 0 for none */
+} emulation_config_t;
+
 /**
  * @struct app_config_t
- * @brief Combines both display and audio configs, plus the ROM path.
+ * @brief Combines display, audio, input and emulation configs, plus the ROM path.
  */
 typedef struct
 {
-    display_config_t display_cfg; /**< Display-related configuration */
-    audio_config_t audio_cfg;     /**< Audio-related configuration */
+    display_config_t display_cfg;  /**< Display-related configuration */
+    audio_config_t audio_cfg;      /**< Audio-related configuration */
+    input_config_t input_cfg;      /**< Keyboard configuration */
+    emulation_config_t emu_cfg;    /**< CPU scheduling configuration */
     char rom_path[256];           /**< Path to the CHIP-8 ROM file */
 } app_config_t;
 
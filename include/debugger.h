@@ -0,0 +1,136 @@
+/**
+ * @file debugger.h
+ * @brief Breakpoints, watchpoints, conditional breaks and single-stepping.
+ *
+ * The core keeps the checks themselves (see chip8_set_breakpoint()): one
+ * bit per address for breakpoints and for watchpoints, and a handful of
+ * register conditions, none of which cost anything until one is set. This
+ * module arms them from the command line, reports where the CPU stopped,
+ * steps it, and serves a small gdb-like command line over TCP:
+ *
+ *     nc 127.0.0.1 <port>
+ *     break 2A4            stop before the instruction at 0x2A4
+ *     break 2A4 if V3==5   ... only when V3 is 5 there
+ *     break if I>=0xF00    stop wherever I becomes >= 0xF00
+ *     watch 3F0-3F2        stop after FX33/FX55/FX65/DXYN touch 0x3F0..0x3F2
+ *     delete [addr]        clear one breakpoint, or everything
+ *     unwatch [lo[-hi]]    clear watchpoints, or all of them
+ *     pause | continue     stop or resume the emulator
+ *     step [n]             execute n instructions (default 1) while paused
+ *     regs                 show the registers
+ *     x <addr> [len]       dump memory (hex, up to 256 bytes)
+ *
+ * Addresses are hexadecimal, with or without 0x; condition values are
+ * decimal unless written 0x... Every stop is also logged to the console,
+ * so a breakpoint with --headless acts as a tracepoint.
+ *
+ * All calls must come from the thread that owns the emulator.
+ */
+
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chip8.h"
+#include "config.h"
+
+#define DEBUGGER_LINE_MAX 256 /**< Longest command line accepted */
+
+/**
+ * @enum debugger_action_t
+ * @brief Run state change a command asked for.
+ */
+typedef enum
+{
+    DEBUGGER_NONE,     /**< Nothing to change */
+    DEBUGGER_PAUSE,    /**< "pause": stop a running emulator */
+    DEBUGGER_CONTINUE, /**< "continue": resume a paused one */
+    DEBUGGER_STEP,     /**< "step": execute debugger_t::step_count instructions of a paused one */
+} debugger_action_t;
+
+/**
+ * @struct debugger_t
+ * @brief Command port state.
+ */
+typedef struct
+{
+    int listen_fd;                /**< Listening socket, or -1 without a port */
+    int client_fd;                /**< Connected client, or -1 */
+    char input[1024];             /**< Received from the client, not yet executed */
+    size_t input_len;             /**< Bytes in input */
+    uint32_t step_count;          /**< Instructions the last DEBUGGER_STEP asked for */
+} debugger_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Arms the --break, --watch and --break-if lists and opens --debug-port.
+     *
+     * @param dbg Debugger to initialize.
+     * @param emu Emulator the lists apply to.
+     * @param cfg Emulation settings holding the lists and the port.
+     * @return false if an entry does not parse; a port that cannot be
+     *         opened only warns.
+     */
+    bool debugger_init(debugger_t *dbg, chip8_t *emu, const emulation_config_t *cfg);
+
+    /**
+     * @brief Accepts a client and executes the command lines it sent, without blocking.
+     *
+     * Breakpoint, watch and inspection commands take effect at once.
+     * Pause, continue and step are returned to the caller, which owns the
+     * run state and the frame the steps belong to; the lines after one
+     * wait for the next call, so they see its effect. A step is only
+     * accepted while @p emu is PAUSED.
+     *
+     * @param dbg Debugger from debugger_init().
+     * @param emu Emulator the commands apply to.
+     * @return The pause, continue or step received, else DEBUGGER_NONE.
+     */
+    debugger_action_t debugger_poll(debugger_t *dbg, chip8_t *emu);
+
+    /**
+     * @brief Single-steps a paused emulator with chip8_step().
+     *
+     * Stops early at a watchpoint, in FX0A or when the CPU stops. The
+     * emulator is PAUSED again afterwards unless the CPU stopped. Report
+     * the result with debugger_report().
+     *
+     * @param emu   Emulator in the PAUSED state.
+     * @param count Instructions to execute.
+     * @return Instructions executed.
+     */
+    uint32_t debugger_step(chip8_t *emu, uint32_t count);
+
+    /**
+     * @brief Logs why the last chip8_run() stopped for the debugger, with the registers.
+     *
+     * Sent to the connected client as well. Only breakpoints, conditions
+     * and watchpoints (and steps) are reported; other reasons are ignored.
+     */
+    void debugger_report(debugger_t *dbg, const chip8_t *emu);
+
+    /**
+     * @brief Returns whether the last chip8_run() stopped for a breakpoint,
+     *        condition or watchpoint.
+     */
+    static inline bool debugger_stopped(const chip8_t *emu)
+    {
+        return (emu->events & (CHIP8_EVENT_BREAKPOINT | CHIP8_EVENT_WATCH)) != 0;
+    }
+
+    /**
+     * @brief Closes the command port.
+     */
+    void debugger_cleanup(debugger_t *dbg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEBUGGER_H */
@@ -0,0 +1,124 @@
+/**
+ * @file disasm.h
+ * @brief Static control flow analysis and disassembly of CHIP-8 programs.
+ *
+ * disasm_analyze() follows the program from CHIP8_ROM_ENTRY_POINT along
+ * every edge the CPU can take without knowing its registers: 1NNN to the
+ * target, 2NNN to the target and to the return address, skips to both
+ * the next instruction and the one after it, everything else to the next
+ * instruction. 00EE, 00FD and undefined opcodes end a path, and so does
+ * BNNN, whose target depends on V0. What the walk reaches is code and
+ * is split into basic blocks; the rest of the image is data.
+ *
+ * The same pass finds where chip8_run_until_tick() can possibly detect an
+ * idle loop, so the core does not have to discover it by probing; see
+ * chip8_set_code_hints().
+ */
+
+#ifndef DISASM_H
+#define DISASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chip8.h"
+
+/* Per-address flags in disasm_t::flags */
+#define DISASM_CODE 0x01u        /**< An instruction starts here */
+#define DISASM_OPERAND 0x02u     /**< Second byte of an instruction */
+#define DISASM_LEADER 0x04u      /**< First instruction of a basic block */
+#define DISASM_JUMP_TARGET 0x08u /**< Target of a 1NNN */
+#define DISASM_CALL_TARGET 0x10u /**< Target of a 2NNN */
+#define DISASM_DATA_REF 0x20u    /**< Loaded into I by an ANNN */
+#define DISASM_IDLE 0x40u        /**< An idle loop may start here */
+
+#define DISASM_ADDRESSES 4096                        /**< CHIP8_MEMORY_SIZE as a constant expression */
+#define DISASM_MAX_BLOCKS (DISASM_ADDRESSES - 0x200) /**< One per program address at most */
+#define DISASM_TEXT_MAX 24                           /**< Longest disasm_format() text */
+
+/**
+ * @enum disasm_end_t
+ * @brief How control leaves a basic block.
+ */
+typedef enum
+{
+    DISASM_END_FALLTHROUGH, /**< Into the next block, which is a branch target */
+    DISASM_END_JUMP,        /**< 1NNN */
+    DISASM_END_CALL,        /**< 2NNN: the target, then the next instruction */
+    DISASM_END_SKIP,        /**< Conditional skip: the next or the one after */
+    DISASM_END_RETURN,      /**< 00EE */
+    DISASM_END_INDIRECT,    /**< BNNN: not followed */
+    DISASM_END_HALT,        /**< 00FD, an undefined opcode or the end of memory */
+} disasm_end_t;
+
+/**
+ * @struct disasm_block_t
+ * @brief A basic block: instructions entered only at the first and left only after the last.
+ */
+typedef struct
+{
+    uint16_t start;     /**< Address of the first instruction */
+    uint16_t end;       /**< Address after the last instruction */
+    uint16_t succ[2];   /**< Successor addresses, first succ_count valid */
+    uint8_t succ_count; /**< 0..2 */
+    uint8_t exit;       /**< disasm_end_t */
+} disasm_block_t;
+
+/**
+ * @struct disasm_t
+ * @brief Result of disasm_analyze().
+ */
+typedef struct
+{
+    uint8_t flags[DISASM_ADDRESSES];          /**< DISASM_* per address */
+    uint8_t code_map[DISASM_ADDRESSES / 8];   /**< Bit a: DISASM_CODE at a, for chip8_set_code_hints() */
+    uint8_t idle_map[DISASM_ADDRESSES / 8];   /**< Bit a: DISASM_IDLE at a, for chip8_set_code_hints() */
+    disasm_block_t blocks[DISASM_MAX_BLOCKS]; /**< In address order */
+    uint16_t block_count;                     /**< Blocks in use */
+    uint16_t instructions;                    /**< Addresses with DISASM_CODE */
+    uint16_t idle_starts;                     /**< Addresses with DISASM_IDLE */
+    uint16_t indirect_jumps;                  /**< BNNN instructions reached */
+} disasm_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Analyzes the program loaded in @p emu.
+     *
+     * Instructions are classified for emu->machine. An address is marked
+     * DISASM_IDLE when the instruction there can begin a loop the idle
+     * probe accepts: a cycle back to it of at most CHIP8_IDLE_MAX_LOOP
+     * chip8_idle_safe() instructions, or a path of them to a BNNN or out
+     * of the analyzed code, where nothing is known. Runs in a few
+     * milliseconds at most, so it is done once per load.
+     *
+     * @param dis Receives the result.
+     * @param emu Emulator with the program in memory.
+     */
+    void disasm_analyze(disasm_t *dis, const chip8_t *emu);
+
+    /**
+     * @brief Formats one instruction, e.g. "LD VA, 0x02" or "DRW V0, V1, 5".
+     *
+     * Undefined opcodes come out as "DW 0xNNNN".
+     *
+     * @param buf     Output, at least DISASM_TEXT_MAX bytes for the whole text.
+     * @param size    Size of @p buf.
+     * @param opcode  Instruction word.
+     * @param machine config_machine_t to decode for.
+     */
+    void disasm_format(char *buf, size_t size, uint16_t opcode, uint8_t machine);
+
+    /**
+     * @brief Returns the block starting at @p addr, or NULL.
+     */
+    const disasm_block_t *disasm_block_at(const disasm_t *dis, uint16_t addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISASM_H */
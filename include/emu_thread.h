@@ -0,0 +1,173 @@
+/**
+ * @file emu_thread.h
+ * @brief Runs the emulator on its own thread, decoupled from presentation.
+ *
+ * The emulation thread owns the chip8_t while it runs: it paces 60 Hz
+ * frames, executes instructions, ticks the timers, switches the beep and
+ * records rewind history. Each finished frame is published through a
+ * lock-free triple buffer, so a slow SDL_RenderPresent() or a modal dialog
+ * on the SDL thread never delays emulation. Input travels the other way as
+ * atomics: the keys held, the keys pressed since the last frame and the
+ * requested run state.
+ *
+ * The debugger runs on the emulation thread too. A frame cut short by a
+ * breakpoint or watchpoint is finished when the emulator resumes or is
+ * stepped, before its timers tick, so stopping never changes what the ROM
+ * computes, and an input log stays replayable. The debugger can also
+ * change the run state itself (a breakpoint pauses, the port's continue
+ * resumes); the presenter adopts such changes with emu_thread_debug_state().
+ */
+
+#ifndef EMU_THREAD_H
+#define EMU_THREAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "chip8.h"
+#include "config.h"
+#include "profiler.h"
+#include "savestate.h"
+#include "recorder.h"
+#include "replay.h"
+#include "debugger.h"
+#include "metrics.h"
+
+#define EMU_FRAME_FRESH 4 /**< Flag in emu_thread_t::middle: the shared slot holds an unread frame */
+
+/**
+ * @struct emu_frame_t
+ * @brief What the presenter needs from one emulated frame.
+ */
+typedef struct
+{
+    uint64_t display[CHIP8_DISPLAY_WORDS];  /**< Screen at the end of the frame */
+    bool hires;                             /**< display is in the 128x64 layout */
+    uint64_t frame;                         /**< Frames emulated so far */
+    chip8_state_t state;                    /**< Emulator state at the end of the frame */
+    uint64_t published;                     /**< Counter value when the frame was handed over */
+    metrics_emu_t metrics;                  /**< Emulation counters at the end of the frame */
+} emu_frame_t;
+
+/**
+ * @struct emu_thread_t
+ * @brief Emulation thread plus the state it shares with the presenter.
+ *
+ * Of the three frame slots, one is written by the emulation thread
+ * (`back`), one is held by the presenter (`front`) and one is in flight
+ * (`middle`). Publishing and acquiring each swap one private slot with
+ * the middle one in a single atomic exchange, so neither side ever waits;
+ * frames the presenter is too slow to pick up are overwritten.
+ */
+typedef struct
+{
+    chip8_t *emu;                   /**< Owned by the thread between start and stop */
+    const emulation_config_t *cfg;  /**< Cycles per frame */
+    profiler_t *prof;               /**< Optional profiler, or NULL */
+    rewind_t *rewind;               /**< Optional rewind history, or NULL */
+    recorder_t *rec;                /**< Optional frame recorder, or NULL */
+    replay_t *input;                /**< Optional input log, or NULL */
+    debugger_t *dbg;                /**< Optional debugger, or NULL */
+    uint32_t frame_left;            /**< Instructions the interrupted frame still owes; 0 between frames */
+    metrics_emu_t metrics;          /**< Counters published with every frame (emulation thread only) */
+
+    emu_frame_t frames[3];          /**< Triple buffer slots */
+    SDL_atomic_t middle;            /**< Slot index in flight, ORed with EMU_FRAME_FRESH */
+    int back;                       /**< Slot being written (emulation thread only) */
+    int front;                      /**< Slot being presented (presenter only) */
+
+    SDL_atomic_t keys;              /**< CHIP-8 keys held, set by the presenter */
+    SDL_atomic_t presses;           /**< CHIP-8 keys pressed since the thread last looked */
+    SDL_atomic_t requested;         /**< chip8_state_t requested by the presenter */
+    SDL_atomic_t steps;             /**< Instructions the presenter asked to single-step */
+    SDL_atomic_t debug_state;       /**< 1 + chip8_state_t the debugger switched to, until requested matches; else 0 */
+    SDL_Thread *thread;             /**< The emulation thread */
+} emu_thread_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Starts emulating @p emu on a new thread.
+     *
+     * The emulator must not be touched by the caller until emu_thread_stop()
+     * returns. The first frame is published before this returns, so
+     * emu_thread_acquire() always has something to show.
+     *
+     * @param et     Thread state to initialize.
+     * @param emu    Emulator to run, already loaded.
+     * @param cfg    Emulation settings (read, not copied).
+     * @param prof   Profiler fed by every cycle, or NULL.
+     * @param rewind Rewind history fed once per frame, or NULL.
+     * @param rec    Recorder fed the screen of every emulated frame, or NULL.
+     * @param input  Input log fed the keys of every emulated frame, or NULL.
+     * @param dbg    Debugger polled once per frame and told about stops, or NULL.
+     * @return false if the thread could not be created.
+     */
+    bool emu_thread_start(emu_thread_t *et, chip8_t *emu, const emulation_config_t *cfg,
+                          profiler_t *prof, rewind_t *rewind, recorder_t *rec, replay_t *input,
+                          debugger_t *dbg);
+
+    /**
+     * @brief Hands the current input to the emulation thread.
+     *
+     * Takes effect at the start of the next emulated frame (see
+     * chip8_set_keys()). Presses accumulate, so a key tapped and released
+     * within one frame still releases FX0A; presses made while paused or
+     * rewinding are discarded. Requesting CHIP8_STOPPED ends the thread.
+     *
+     * @param et      Running emulation thread.
+     * @param keys    CHIP-8 keys held.
+     * @param pressed CHIP-8 keys pressed since the previous call.
+     * @param state   RUNNING, PAUSED, REWINDING or STOPPED.
+     */
+    void emu_thread_set_input(emu_thread_t *et, uint16_t keys, uint16_t pressed, chip8_state_t state);
+
+    /**
+     * @brief Asks the emulation thread to single-step @p count instructions.
+     *
+     * Steps only happen while paused; requests made while running are
+     * dropped. Each step is reported on the console (see debugger_report()).
+     * Does nothing without a debugger.
+     */
+    void emu_thread_step(emu_thread_t *et, uint32_t count);
+
+    /**
+     * @brief Reports a run state the debugger switched to on its own.
+     *
+     * A breakpoint pauses the emulator and a "continue" on the debugger
+     * port resumes it; the presenter should make @p state its requested
+     * state, which the emulation thread keeps until it does.
+     *
+     * @return true and sets @p state if there is such a change pending.
+     */
+    bool emu_thread_debug_state(emu_thread_t *et, chip8_state_t *state);
+
+    /**
+     * @brief Takes the newest published frame, if there is one.
+     *
+     * @param et Running emulation thread.
+     * @return The new frame (valid until the next call), or NULL if no frame
+     *         was published since the last call.
+     */
+    const emu_frame_t *emu_thread_acquire(emu_thread_t *et);
+
+    /**
+     * @brief Returns the frame taken by the last emu_thread_acquire().
+     */
+    const emu_frame_t *emu_thread_current(const emu_thread_t *et);
+
+    /**
+     * @brief Stops the emulation thread and waits for it to exit.
+     *
+     * Afterwards the caller owns the emulator again.
+     */
+    void emu_thread_stop(emu_thread_t *et);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMU_THREAD_H */
@@ -0,0 +1,100 @@
+/**
+ * @file gl_renderer.h
+ * @brief OpenGL presentation backend that keeps the framebuffer 1 bit per pixel.
+ *
+ * The SDL renderer path expands every frame into 8 KiB of ARGB8888 pixels
+ * on the CPU before uploading it. This backend instead uploads the packed
+ * display itself, 256 bytes per frame (1 KiB at 128x64), into a 16x64
+ * single-channel texture and lets a fragment shader unpack the bits, apply
+ * the palette, scale to the window and add the optional CRT and ghosting
+ * effects.
+ *
+ * GL entry points are resolved through SDL_GL_GetProcAddress(), so the
+ * binary does not link against libGL and still starts where no GL 2.1
+ * driver is available; sdl_init() then falls back to the SDL renderer.
+ */
+
+#ifndef GL_RENDERER_H
+#define GL_RENDERER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "config.h"
+#include "chip8.h"
+
+#define GL_RENDERER_HISTORY 4 /**< Frames kept in the bit texture for ghosting, newest included */
+
+/**
+ * @struct gl_renderer_t
+ * @brief GL context plus the objects drawn with it.
+ *
+ * GL names are kept as plain unsigned ints so this header does not need
+ * the GL headers.
+ */
+typedef struct
+{
+    SDL_Window *window;        /**< Window the context renders to */
+    SDL_GLContext context;     /**< Context current on the presenting thread */
+    unsigned int program;      /**< Bit-unpacking shader program */
+    unsigned int texture;      /**< GL_RENDERER_HISTORY stacked 16x64 frames of packed bits */
+    unsigned int vertices;     /**< Full-window quad */
+    int u_rows;                /**< Uniform: texture row of each history frame */
+    int u_ghost;               /**< Uniform: ghosting strength (0 = off) */
+    int u_crt;                 /**< Uniform: CRT effect strength (0 = off) */
+    int u_fg;                  /**< Uniform: foreground colour */
+    int u_bg;                  /**< Uniform: background colour */
+    int u_size;                /**< Uniform: resolution of the frames in the history */
+    int width;                 /**< Largest screen of the machine; the viewport is a multiple of it */
+    int height;                /**< Largest screen of the machine; the viewport is a multiple of it */
+    bool hires;                /**< Resolution of the frames in the history */
+    uint32_t bg_color;         /**< Colour of the letterbox bars */
+    bool ghost;                /**< Ghosting enabled */
+    int head;                  /**< History slot holding the newest frame */
+    int unchanged;             /**< Presents since the display last changed */
+} gl_renderer_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Creates a GL 2.1 context on @p window and builds the shader.
+     *
+     * The window must have been created with SDL_WINDOW_OPENGL. On failure
+     * everything created so far is released and a warning says why.
+     *
+     * @param gl     Renderer to initialize.
+     * @param window Window to render to.
+     * @param config Colours and the crt/ghost switches.
+     * @param machine Profile of the emulated machine.
+     * @return false if GL or the shader is unavailable.
+     */
+    bool gl_renderer_init(gl_renderer_t *gl, SDL_Window *window, const display_config_t *config,
+                          const chip8_machine_t *machine);
+
+    /**
+     * @brief Uploads a display and presents it.
+     *
+     * With ghosting off, or once the trail of the last change has faded,
+     * a present with @p dirty zero returns without touching GL. A change of
+     * resolution drops the ghost trail, whose frames have the old layout.
+     *
+     * @param gl      Initialized renderer.
+     * @param display Bit-packed rows in the chip8_t::display layout.
+     * @param hires   display is in the high-resolution layout (chip8_t::hires).
+     * @param dirty   Bit y set for every row that differs from the last present.
+     */
+    void gl_renderer_present(gl_renderer_t *gl, const uint64_t *display, bool hires, uint64_t dirty);
+
+    /**
+     * @brief Deletes the GL objects and the context.
+     */
+    void gl_renderer_cleanup(gl_renderer_t *gl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GL_RENDERER_H */
@@ -0,0 +1,91 @@
+/**
+ * @file headless.h
+ * @brief Windowless, unthrottled execution of the CHIP-8 core.
+ *
+ * Headless mode runs the emulator without SDL video or audio, as fast as the
+ * host allows. Timers are driven by a virtual clock (one tick per frame's
+ * worth of instructions) instead of wall-clock time, so results are
+ * reproducible and independent of host speed.
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "chip8.h"
+#include "config.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "replay.h"
+#include "debugger.h"
+
+/**
+ * @struct headless_result_t
+ * @brief Summary of a completed headless run.
+ */
+typedef struct
+{
+    uint64_t cycles;        /**< Instructions executed, idle-loop iterations skipped included */
+    uint64_t executed;      /**< Of those, the ones actually executed; measure speed with this */
+    uint64_t frames;        /**< Virtual 60 Hz frames (timer ticks) elapsed */
+    uint64_t display_hash;  /**< chip8_display_hash() of the final screen */
+    uint64_t memory_hash;   /**< chip8_memory_hash() of the final memory */
+    double elapsed_seconds; /**< Host wall-clock time spent executing */
+} headless_result_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Runs the emulator headless until it stops or the budget is spent.
+     *
+     * @param emu    Pointer to an initialized emulator with a ROM loaded.
+     * @param cfg    Emulation settings (cycles per frame, cycle budget).
+     * @param prof   Profiler to record into, or NULL to run unprofiled.
+     * @param rec    Recorder fed the screen of every completed frame, or NULL.
+     * @param dbg    Debugger told about every breakpoint or watchpoint hit, or
+     *               NULL. Nobody can answer headless, so the run continues.
+     * @param result Receives the run summary.
+     * @return true if the run ended without an emulator error.
+     */
+    bool headless_run(chip8_t *emu, const emulation_config_t *cfg, profiler_t *prof,
+                      recorder_t *rec, debugger_t *dbg, headless_result_t *result);
+
+    /**
+     * @brief Replays an input log headless, frame by frame.
+     *
+     * Frames are run the way the emulation thread runs them: the logged
+     * input is applied at the start of a frame, then up to the log's cycles
+     * per frame execute and the timers tick once. A ROM waiting in FX0A
+     * therefore keeps passing frames until the log presses a key. The run
+     * ends with the log, when the ROM stops, or when cfg->max_cycles is spent.
+     *
+     * @param emu    Emulator seeded with replay->seed, in the state the log started from.
+     * @param cfg    Emulation settings (cycle budget).
+     * @param replay Log read with replay_read().
+     * @param prof   Profiler to record into, or NULL to run unprofiled.
+     * @param rec    Recorder fed the screen of every frame, or NULL.
+     * @param dbg    Debugger told about every breakpoint or watchpoint hit, or NULL.
+     * @param result Receives the run summary; frames equals replay->frames
+     *               if the whole log was replayed.
+     * @return true if the run ended without an emulator error.
+     */
+    bool headless_replay(chip8_t *emu, const emulation_config_t *cfg, const replay_t *replay,
+                         profiler_t *prof, recorder_t *rec, debugger_t *dbg, headless_result_t *result);
+
+    /**
+     * @brief Prints the display buffer as ASCII art ('#' on, '.' off).
+     *
+     * @param emu Pointer to the emulator whose display should be printed.
+     * @param out Output stream.
+     */
+    void headless_print_display(const chip8_t *emu, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEADLESS_H */
@@ -0,0 +1,144 @@
+/**
+ * @file metrics.h
+ * @brief Runtime health counters: throughput, frame pacing and presentation.
+ *
+ * Unlike the profiler, the metrics are cheap enough to keep on every run:
+ * a few counters per frame and no per-instruction work. The emulation
+ * thread keeps a metrics_emu_t and publishes a copy with every frame (see
+ * emu_frame_t); the presenter folds those into a metrics_t together with
+ * its own counters. Timings are in SDL performance-counter ticks.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define METRICS_BUCKETS 10           /**< Histogram buckets; the last one is open-ended */
+#define METRICS_FIRST_BUCKET_US 250u /**< Upper bound of bucket 0; each next bound doubles */
+#define METRICS_LINE_MAX 160         /**< Longest metrics_sample() line */
+
+/**
+ * @struct metrics_hist_t
+ * @brief Latency histogram with power-of-two buckets from 0.25 ms to 64 ms.
+ */
+typedef struct
+{
+    uint64_t counts[METRICS_BUCKETS]; /**< Samples per bucket */
+    uint64_t samples;                 /**< Samples added */
+    uint64_t total_ticks;             /**< Sum of the samples */
+    uint64_t max_ticks;               /**< Largest sample */
+} metrics_hist_t;
+
+/**
+ * @struct metrics_emu_t
+ * @brief Counters kept by the emulation thread.
+ */
+typedef struct
+{
+    uint64_t instructions; /**< Instructions executed, single steps included */
+    uint64_t idle_skipped; /**< Idle-loop iterations fast-forwarded instead of executed */
+    uint64_t frames;       /**< 60 Hz frames scheduled, paused ones included */
+    uint64_t timer_ticks;  /**< Delay and sound timer ticks delivered */
+    uint64_t resyncs;      /**< Times the schedule was re-anchored after a stall */
+    uint64_t drift_ticks;  /**< Wall-clock time not covered by frames, lost to resyncs */
+    metrics_hist_t late;   /**< How late each frame finished after its deadline */
+} metrics_emu_t;
+
+/**
+ * @struct metrics_t
+ * @brief Everything the presenter knows about the run.
+ */
+typedef struct
+{
+    metrics_emu_t emu;         /**< Newest copy from the emulation thread */
+    uint32_t cycles_per_frame; /**< Configured instructions per frame */
+    uint64_t presented;        /**< Frames drawn by sdl_present() */
+    uint64_t unchanged;        /**< Frames not drawn because no row changed */
+    uint64_t skipped;          /**< Emulated frames replaced before the presenter took them */
+    uint64_t last_frame;       /**< Number of the newest frame taken */
+    metrics_hist_t render;     /**< Time spent in sdl_present() */
+    metrics_hist_t latency;    /**< From a frame's publication to the end of its present */
+    uint64_t start_ticks;      /**< Counter value at metrics_init() */
+} metrics_t;
+
+/**
+ * @struct metrics_mark_t
+ * @brief Where a metrics_sample() interval starts; one per consumer.
+ */
+typedef struct
+{
+    uint64_t ticks;        /**< Counter value */
+    uint64_t instructions; /**< metrics_emu_t::instructions */
+    uint64_t frames;       /**< metrics_t::presented + metrics_t::unchanged */
+} metrics_mark_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Clears @p m and starts its clock.
+     *
+     * @param m                Metrics to initialize.
+     * @param cycles_per_frame Configured instructions per frame, for the report.
+     */
+    void metrics_init(metrics_t *m, uint32_t cycles_per_frame);
+
+    /**
+     * @brief Adds one sample of @p ticks to @p hist.
+     */
+    void metrics_hist_add(metrics_hist_t *hist, uint64_t ticks);
+
+    /**
+     * @brief Takes the counters published with frame number @p frame.
+     *
+     * Frames numbered between the previous one taken and @p frame were
+     * never shown, and are counted as skipped.
+     */
+    void metrics_frame(metrics_t *m, const metrics_emu_t *emu, uint64_t frame);
+
+    /**
+     * @brief Records one present.
+     *
+     * @param m             Metrics.
+     * @param drawn         false if sdl_present() had no changed row to draw.
+     * @param render_ticks  Time spent in sdl_present().
+     * @param latency_ticks Time since the frame was published, or 0 for a redraw of an old frame.
+     */
+    void metrics_present(metrics_t *m, bool drawn, uint64_t render_ticks, uint64_t latency_ticks);
+
+    /**
+     * @brief Starts a sampling interval at the current counters.
+     */
+    void metrics_mark(const metrics_t *m, metrics_mark_t *mark);
+
+    /**
+     * @brief Formats the rates since @p mark, e.g.
+     *        "ips=720 fps=60.0 render=0.41ms latency=1.20ms skipped=0 drift=0.000s",
+     *        and starts the next interval.
+     *
+     * Rates cover the interval; the latencies are means over the whole run.
+     *
+     * @param m    Metrics.
+     * @param mark Start of the interval; moved to now.
+     * @param buf  Output, METRICS_LINE_MAX bytes hold any line.
+     * @param size Size of @p buf.
+     */
+    void metrics_sample(const metrics_t *m, metrics_mark_t *mark, char *buf, size_t size);
+
+    /**
+     * @brief Writes all counters and histograms as JSON.
+     *
+     * @return false if the file cannot be written.
+     */
+    bool metrics_write_file(const metrics_t *m, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,147 @@
+/**
+ * @file profiler.h
+ * @brief Instruction-level profiler for CHIP-8 ROMs.
+ *
+ * The profiler counts executions per PC and per instruction class, tracks
+ * backward 1NNN jumps (the loops a ROM spends its time in) and measures
+ * host time spent in DXYN and in presenting frames. It is driven through
+ * profiler_cycle(), which wraps chip8_cycle(), so unprofiled runs pay
+ * nothing for it.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "chip8.h"
+
+/**
+ * @struct profiler_t
+ * @brief Counters accumulated over one profiled run.
+ *
+ * Timings are in SDL performance-counter ticks. The structure is large
+ * (~100 KB); allocate it with profiler_create().
+ */
+typedef struct
+{
+    uint64_t pc_counts[4096];                /**< Executions per instruction address */
+    uint64_t loop_counts[4096];              /**< Backward 1NNN jumps per target address */
+    uint64_t op_counts[CHIP8_OP_COUNT];      /**< Executions per instruction class */
+    uint64_t group_counts[16];               /**< Executions per opcode high nibble */
+    uint64_t cycles;                         /**< Instructions executed */
+    uint64_t draw_calls;                     /**< DXYN instructions executed */
+    uint64_t draw_ticks;                     /**< Time spent executing DXYN */
+    uint64_t render_calls;                   /**< Frames presented */
+    uint64_t render_ticks;                   /**< Time spent in sdl_update_screen() */
+    uint64_t start_ticks;                    /**< Counter value at profiler_start() */
+    uint64_t elapsed_ticks;                  /**< Run length, set by profiler_stop() */
+} profiler_t;
+
+#define PROFILER_MAX_PHASES 16 /**< Startup phases profiler_startup_mark() can record */
+
+/**
+ * @struct profiler_startup_t
+ * @brief Wall-clock split of process startup into named phases.
+ *
+ * Unlike profiler_t this is cheap enough to keep unconditionally, so the
+ * clock can start before the command line says whether it is wanted.
+ */
+typedef struct
+{
+    const char *names[PROFILER_MAX_PHASES]; /**< Phase names (string literals) */
+    uint64_t ticks[PROFILER_MAX_PHASES];    /**< Duration of each phase */
+    int count;                              /**< Phases recorded */
+    uint64_t origin;                        /**< Counter value at profiler_startup_begin() */
+    uint64_t last;                          /**< Counter value at the end of the newest phase */
+} profiler_startup_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Starts the startup clock.
+     */
+    void profiler_startup_begin(profiler_startup_t *st);
+
+    /**
+     * @brief Ends the current phase and names it; the next phase starts now.
+     *
+     * @param st    Startup clock.
+     * @param phase Name for the time since the previous mark (a string literal).
+     */
+    void profiler_startup_mark(profiler_startup_t *st, const char *phase);
+
+    /**
+     * @brief Prints each phase with its share of the total.
+     */
+    void profiler_startup_print(const profiler_startup_t *st, FILE *out);
+
+    /**
+     * @brief Allocates a zeroed profiler.
+     *
+     * @return The profiler, or NULL on allocation failure.
+     */
+    profiler_t *profiler_create(void);
+
+    /**
+     * @brief Frees a profiler created with profiler_create().
+     */
+    void profiler_destroy(profiler_t *prof);
+
+    /**
+     * @brief Marks the beginning of the profiled run.
+     */
+    void profiler_start(profiler_t *prof);
+
+    /**
+     * @brief Marks the end of the profiled run; used for the IPS figure.
+     */
+    void profiler_stop(profiler_t *prof);
+
+    /**
+     * @brief Executes one instruction via chip8_cycle() and records it.
+     *
+     * @param prof Profiler to update.
+     * @param emu  Emulator to step.
+     */
+    void profiler_cycle(profiler_t *prof, chip8_t *emu);
+
+    /**
+     * @brief Adds the duration of one presented frame.
+     *
+     * @param prof  Profiler to update.
+     * @param ticks Performance-counter ticks spent rendering.
+     */
+    void profiler_add_render(profiler_t *prof, uint64_t ticks);
+
+    /**
+     * @brief Prints a human-readable hot-spot report.
+     *
+     * @param prof Profiler to report on.
+     * @param emu  Emulator the profile was taken from (used to show opcodes).
+     * @param out  Output stream.
+     */
+    void profiler_print_report(const profiler_t *prof, const chip8_t *emu, FILE *out);
+
+    /**
+     * @brief Writes the full profile to a file.
+     *
+     * The format follows the extension: ".csv" writes one "section,key,name,count"
+     * row per non-zero counter, anything else writes JSON.
+     *
+     * @param prof Profiler to report on.
+     * @param emu  Emulator the profile was taken from.
+     * @param path Destination file.
+     * @return true on success, false if the file could not be written.
+     */
+    bool profiler_write_file(const profiler_t *prof, const chip8_t *emu, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
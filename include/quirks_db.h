@@ -0,0 +1,55 @@
+/**
+ * @file quirks_db.h
+ * @brief Per-ROM quirk database, keyed by a hash of the ROM file.
+ *
+ * CHIP-8 interpreters disagree on a handful of instructions (see
+ * chip8_quirks_t), and a ROM only runs correctly with the behaviour it was
+ * written for. The database maps ROMs to the quirk profile they need, so
+ * --quirks auto can pick it when the ROM is loaded.
+ *
+ * The database is a text file, one ROM per line:
+ *
+ *     # comment
+ *     <FNV-1a 64 hash of the ROM file, hex> <vip|schip|modern>   # name
+ *
+ * By default it is read from quirks.db in the ROM's directory. Unknown ROMs
+ * get the fallback profile; their hash is logged so they can be added.
+ */
+
+#ifndef QUIRKS_DB_H
+#define QUIRKS_DB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define QUIRKS_DB_FILE "quirks.db" /**< Database looked for next to the ROM */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Returns the key of a ROM in the database: FNV-1a 64 of its bytes.
+     */
+    uint64_t quirks_db_rom_hash(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Picks the quirk profile of a ROM.
+     *
+     * Logs the profile and where it came from. A database that does not
+     * exist is only reported when @p db_path names it explicitly; malformed
+     * lines are reported and skipped.
+     *
+     * @param db_path  Database file; NULL or empty for QUIRKS_DB_FILE next to the ROM.
+     * @param rom_path ROM file to look up.
+     * @param fallback config_quirks_t for ROMs the database does not list.
+     * @return The config_quirks_t to run the ROM with.
+     */
+    uint8_t quirks_db_select(const char *db_path, const char *rom_path, uint8_t fallback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUIRKS_DB_H */
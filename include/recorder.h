@@ -0,0 +1,180 @@
+/**
+ * @file recorder.h
+ * @brief Frame-accurate recording of the display to a compact 1 bpp stream.
+ *
+ * A recording holds one entry per emulated 60 Hz frame. Frames are stored
+ * as the XOR against the previous frame, run-length coded over zero bytes,
+ * and runs of identical frames collapse into a single hold record, so a
+ * minute of gameplay usually takes a few kilobytes where raw ARGB would
+ * take 30 MB. tools/chip8_video.c converts recordings to GIF, Y4M or PNG.
+ *
+ * File layout (integers little-endian):
+ *
+ *     "CH8VIDEO" u8 version, u8 width, u8 height, u8 fps, u32 reserved
+ *     records:
+ *       RECORDER_DELTA  RLE(256 XOR bytes)  new screen, shown for one frame
+ *       RECORDER_HOLD   varint n            current screen, n more frames
+ *       RECORDER_END    varint frames       total frame count, then EOF
+ *
+ * Screens are height rows of width / 8 bytes, leftmost pixel in the MSB
+ * of the first byte; decoding starts from a blank screen. The size is the
+ * largest screen of the machine (64x32, or 128x64 for SUPER-CHIP), and
+ * low-resolution frames of a 128x64 recording are stored pixel-doubled.
+ * In the RLE, a control byte c below 0x80 stands for c + 1 zero bytes, and
+ * c >= 0x80 is followed by c - 0x7F literal bytes.
+ *
+ * Encoding runs on a background thread fed through a bounded queue, so the
+ * caller only pays for a compare of the display words in use, and a copy
+ * when the screen changed, per frame.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "chip8.h"
+
+#define RECORDER_MAGIC "CH8VIDEO"  /**< First 8 bytes of a recording */
+#define RECORDER_VERSION 1         /**< Current recording version */
+#define RECORDER_HEADER_SIZE 16    /**< Bytes before the first record */
+#define RECORDER_QUEUE_FRAMES 256  /**< Screens buffered between emulation and encoder */
+#define RECORDER_WAKE_FRAMES 64    /**< Queued screens that wake a sleeping encoder */
+#define RECORDER_MAX_SCREEN_BYTES (CHIP8_HIRES_WIDTH / 8 * CHIP8_HIRES_HEIGHT) /**< 1024 */
+
+/**
+ * @brief Record types.
+ */
+enum
+{
+    RECORDER_END = 0x00,   /**< Trailer with the total frame count */
+    RECORDER_DELTA = 0x01, /**< XOR delta to a new screen */
+    RECORDER_HOLD = 0x02   /**< Current screen repeated */
+};
+
+/**
+ * @struct recorder_frame_t
+ * @brief One queue slot: a screen and how many frames it stays up.
+ */
+typedef struct
+{
+    uint64_t display[CHIP8_DISPLAY_WORDS]; /**< Rows in the chip8_t::display layout */
+    uint32_t frames;                       /**< Frames shown; 0 asks the encoder to finish */
+    bool hires;                            /**< display is in the high-resolution layout */
+} recorder_frame_t;
+
+/**
+ * @struct recorder_t
+ * @brief Recording in progress: the queue and the encoder thread.
+ */
+typedef struct
+{
+    FILE *file;                                   /**< Output, written by the encoder only */
+    char path[256];                               /**< Output path, for messages */
+    bool lossless;                                /**< Producer waits for space instead of dropping */
+    uint8_t width;                                /**< Screen width in pixels, as in the header */
+    uint8_t height;                               /**< Screen height in pixels */
+    uint32_t screen_bytes;                        /**< Bytes per screen */
+
+    recorder_frame_t queue[RECORDER_QUEUE_FRAMES]; /**< Ring of pending frames */
+    uint32_t head;                                /**< Next slot to fill (guarded by lock) */
+    uint32_t tail;                                /**< Next slot to encode (guarded by lock) */
+    bool encoder_waiting;                         /**< Encoder sleeps on cond until a frame arrives */
+    bool producer_waiting;                        /**< Producer sleeps on cond until a slot frees up */
+    SDL_mutex *lock;                              /**< Guards the indices and the waiting flags */
+    SDL_cond *cond;                               /**< Wakes whichever side is waiting */
+    SDL_Thread *thread;                           /**< Encoder thread */
+
+    uint64_t last[CHIP8_DISPLAY_WORDS];           /**< Producer: newest screen, not queued yet */
+    bool last_hires;                              /**< Producer: last is in the high-resolution layout */
+    uint32_t held;                                /**< Producer: frames last has been shown for */
+    uint64_t frames;                              /**< Producer: frames pushed */
+    uint64_t dropped;                             /**< Producer: frames whose screen was dropped (queue full) */
+
+    uint8_t screen[RECORDER_MAX_SCREEN_BYTES];    /**< Encoder: last screen written */
+    uint64_t hold;                                /**< Encoder: frames of screen not yet written */
+    uint64_t bytes;                               /**< Encoder: bytes written so far */
+    bool io_error;                                /**< Encoder: a write failed */
+} recorder_t;
+
+/**
+ * @struct recording_reader_t
+ * @brief Sequential decoder for a recording.
+ */
+typedef struct
+{
+    FILE *file;                                /**< Input */
+    uint8_t fps;                               /**< Frame rate from the header */
+    uint8_t width;                             /**< Screen width in pixels, from the header */
+    uint8_t height;                            /**< Screen height in pixels, from the header */
+    uint32_t screen_bytes;                     /**< Bytes per screen: width / 8 * height */
+    uint8_t screen[RECORDER_MAX_SCREEN_BYTES]; /**< Screen after the last record read */
+    uint64_t frames;                           /**< Frames decoded so far */
+} recording_reader_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Creates @p path and starts the encoder thread.
+     *
+     * @param path     Output file.
+     * @param lossless If true, recorder_push() waits when the queue is full
+     *                 (headless runs, where nothing is real time). If false
+     *                 it never blocks: a full queue drops a screen, and the
+     *                 one after it is shown for its frames as well.
+     * @param machine  Profile whose largest screen sets the recording size.
+     * @return The recorder, or NULL on error.
+     */
+    recorder_t *recorder_open(const char *path, bool lossless, const chip8_machine_t *machine);
+
+    /**
+     * @brief Queues a screen that stays up for @p frames frames.
+     *
+     * A screen equal to the previous one only extends it; the newest screen
+     * is queued once a different one arrives or the recorder is closed.
+     *
+     * @param rec     Recorder from recorder_open().
+     * @param display Rows in the chip8_t::display layout.
+     * @param hires   display is in the high-resolution layout (chip8_t::hires).
+     * @param frames  Frames the screen is shown for (at least 1).
+     */
+    void recorder_push(recorder_t *rec, const uint64_t *display, bool hires, uint32_t frames);
+
+    /**
+     * @brief Drains the queue, writes the trailer, stops the thread and frees @p rec.
+     *
+     * @return false if writing failed at any point.
+     */
+    bool recorder_close(recorder_t *rec);
+
+    /**
+     * @brief Opens a recording and checks its header.
+     *
+     * @return false if the file is missing or not a supported recording.
+     */
+    bool recording_open(recording_reader_t *reader, const char *path);
+
+    /**
+     * @brief Decodes the next screen.
+     *
+     * @param reader Open reader; reader->screen receives the screen.
+     * @param frames Receives the number of frames the screen is shown for.
+     * @return 1 for a screen, 0 at the end of the recording, -1 if it is truncated or corrupt.
+     */
+    int recording_next(recording_reader_t *reader, uint32_t *frames);
+
+    /**
+     * @brief Closes a reader.
+     */
+    void recording_close(recording_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECORDER_H */
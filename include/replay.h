@@ -0,0 +1,119 @@
+/**
+ * @file replay.h
+ * @brief Input logs for deterministic, headless replay of play sessions.
+ *
+ * With the random generator seeded, the only outside influence on a run is
+ * the keypad, and the frontend applies keys once per 60 Hz frame. Logging
+ * the keys held and pressed at each emulated frame where they change is
+ * therefore enough to reproduce a session exactly: replayed headless, the
+ * same frames see the same input and end on the same display and memory.
+ * A log carries those final hashes, so a replay checks itself.
+ *
+ * File layout (integers little-endian):
+ *
+ *     "CH8INPUT" u16 version, u16 start keys, u32 cycles per frame,
+ *     u64 seed, u64 start memory hash, u64 frames,
+ *     u64 final display hash, u64 final memory hash,
+ *     u32 event count, u8 machine, u8 quirks, u8[2] reserved
+ *     events: u32 frame, u16 keys held, u16 keys pressed
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "chip8.h"
+
+#define REPLAY_VERSION 1       /**< Current input log version */
+#define REPLAY_HEADER_SIZE 64  /**< Bytes before the first event */
+#define REPLAY_EVENT_SIZE 8    /**< Bytes per event */
+
+/**
+ * @struct replay_event_t
+ * @brief Input applied at the start of one emulated frame.
+ */
+typedef struct
+{
+    uint32_t frame;   /**< Emulated frames before this one */
+    uint16_t held;    /**< Keys held from this frame on */
+    uint16_t pressed; /**< Keys pressed since the previous frame */
+} replay_event_t;
+
+/**
+ * @struct replay_t
+ * @brief An input log being recorded or replayed.
+ */
+typedef struct
+{
+    replay_event_t *events;    /**< Events in frame order */
+    uint32_t count;            /**< Events held */
+    uint32_t capacity;         /**< Events allocated */
+    bool overflow;             /**< Recording: an allocation failed, the log is incomplete */
+
+    uint32_t cycles_per_frame; /**< Instructions per frame of the session */
+    uint8_t machine;           /**< Machine of the session (config_machine_t) */
+    uint8_t quirks;            /**< Quirk profile of the session (config_quirks_t) */
+    uint64_t seed;             /**< CXNN seed of the session */
+    uint64_t start_hash;       /**< chip8_memory_hash() when the session started */
+    uint16_t start_keys;       /**< Keys held when the session started */
+    uint16_t held;             /**< Recording: keys held after the newest event */
+    uint64_t frames;           /**< Frames emulated (recording) or in the log (replay) */
+    uint64_t display_hash;     /**< Replay: display hash the session ended with */
+    uint64_t memory_hash;      /**< Replay: memory hash the session ended with */
+} replay_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Starts an empty log for a session beginning with the state of @p emu.
+     *
+     * @param rp               Log to initialize.
+     * @param emu              Emulator about to run, ROM (and save state) loaded.
+     * @param cycles_per_frame Instructions per emulated frame.
+     */
+    void replay_begin(replay_t *rp, const chip8_t *emu, uint32_t cycles_per_frame);
+
+    /**
+     * @brief Logs the input of the next emulated frame, then counts the frame.
+     *
+     * Only frames where the held keys change or a key is pressed add an event.
+     *
+     * @param rp      Log started with replay_begin().
+     * @param held    Keys passed to chip8_set_keys() for this frame.
+     * @param pressed Presses passed to chip8_set_keys() for this frame.
+     */
+    void replay_frame(replay_t *rp, uint16_t held, uint16_t pressed);
+
+    /**
+     * @brief Forgets the newest emulated frame and its input, after a rewind step.
+     */
+    void replay_rewind(replay_t *rp);
+
+    /**
+     * @brief Writes the log with the final hashes of @p emu.
+     *
+     * @return false on I/O error.
+     */
+    bool replay_write(const replay_t *rp, const chip8_t *emu, const char *path);
+
+    /**
+     * @brief Reads an input log.
+     *
+     * @return false if the file is missing, truncated or out of order.
+     */
+    bool replay_read(replay_t *rp, const char *path);
+
+    /**
+     * @brief Frees the events of a log.
+     */
+    void replay_free(replay_t *rp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPLAY_H */
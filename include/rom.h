@@ -0,0 +1,141 @@
+/**
+ * @file rom.h
+ * @brief ROM images and ROM corpora loaded once and shared between runs.
+ *
+ * A rom_image_t is a read-only view of ROM bytes: a memory-mapped file, a
+ * caller-supplied buffer or a slice of a corpus. Loading an image into an
+ * emulator is a single memcpy into memory[0x200...], so batch and fuzzing
+ * loops can reset an instance without touching the filesystem.
+ *
+ * A rom_corpus_t holds many images at once, read from a directory of .ch8
+ * files or mapped from a pack archive written by rom_pack_write().
+ */
+
+#ifndef ROM_H
+#define ROM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ROM_NAME_MAX 256     /**< Bytes reserved for an image name, including NUL */
+#define ROM_PACK_VERSION 1   /**< Current pack archive version */
+#define ROM_PACK_NAME_MAX 56 /**< Bytes per entry name in a pack index, including NUL */
+
+/**
+ * @struct rom_image_t
+ * @brief Read-only ROM bytes plus whatever keeps them alive.
+ */
+typedef struct
+{
+    const uint8_t *data;     /**< ROM bytes; NULL when size is 0 */
+    size_t size;             /**< ROM size in bytes */
+    char name[ROM_NAME_MAX]; /**< File path or pack entry name */
+    void *mapping;           /**< mmap() base owned by this image, or NULL */
+    size_t mapping_size;     /**< Length of mapping */
+    uint8_t *owned;          /**< Heap copy owned by this image, or NULL */
+} rom_image_t;
+
+/**
+ * @struct rom_corpus_t
+ * @brief A set of ROM images backed by one allocation or one mapping.
+ */
+typedef struct
+{
+    rom_image_t *roms;   /**< Images; their data points into blob or mapping */
+    size_t count;        /**< Number of images */
+    uint8_t *blob;       /**< Concatenated ROM bytes (directory corpora) */
+    void *mapping;       /**< Mapped pack archive (pack corpora) */
+    size_t mapping_size; /**< Length of mapping */
+} rom_corpus_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Wraps a caller-owned buffer; no copy is made.
+     *
+     * The buffer must outlive the image and every load from it.
+     *
+     * @param rom  Image to initialize.
+     * @param data ROM bytes.
+     * @param size ROM size in bytes.
+     * @param name Name used in messages (may be NULL).
+     * @return false if the ROM does not fit in CHIP-8 program memory.
+     */
+    bool rom_image_from_buffer(rom_image_t *rom, const void *data, size_t size, const char *name);
+
+    /**
+     * @brief Maps a ROM file read-only (read into memory where mmap is unavailable).
+     *
+     * @param rom  Image to initialize.
+     * @param path ROM file.
+     * @return false if the file cannot be opened or is too large.
+     */
+    bool rom_image_map(rom_image_t *rom, const char *path);
+
+    /**
+     * @brief Releases whatever the image owns; borrowed data is left alone.
+     */
+    void rom_image_release(rom_image_t *rom);
+
+    /**
+     * @brief Loads every regular *.ch8 file of a directory into one allocation.
+     *
+     * Images are sorted by name so runs over a corpus are reproducible.
+     *
+     * @param corpus Corpus to initialize.
+     * @param dir    Directory to scan (not recursive).
+     * @return false on I/O or allocation failure.
+     */
+    bool rom_corpus_load_dir(rom_corpus_t *corpus, const char *dir);
+
+    /**
+     * @brief Maps a pack archive and indexes its entries without copying.
+     *
+     * @param corpus Corpus to initialize.
+     * @param path   Pack file written by rom_pack_write().
+     * @return false if the file is missing or malformed.
+     */
+    bool rom_corpus_load_pack(rom_corpus_t *corpus, const char *path);
+
+    /**
+     * @brief Returns true if @p path names an existing directory.
+     */
+    bool rom_path_is_directory(const char *path);
+
+    /**
+     * @brief Loads a directory with rom_corpus_load_dir(), anything else as a pack.
+     */
+    bool rom_corpus_load(rom_corpus_t *corpus, const char *path);
+
+    /**
+     * @brief Returns the image called @p name, or NULL.
+     */
+    const rom_image_t *rom_corpus_find(const rom_corpus_t *corpus, const char *name);
+
+    /**
+     * @brief Frees a corpus and invalidates its images.
+     */
+    void rom_corpus_free(rom_corpus_t *corpus);
+
+    /**
+     * @brief Writes images into a pack archive: header, index, then ROM data.
+     *
+     * Entry names are the base names of the images, truncated to
+     * ROM_PACK_NAME_MAX - 1 bytes.
+     *
+     * @param path  Destination file.
+     * @param roms  Images to store.
+     * @param count Number of images.
+     * @return false on I/O error.
+     */
+    bool rom_pack_write(const char *path, const rom_image_t *roms, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROM_H */
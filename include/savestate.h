@@ -0,0 +1,118 @@
+/**
+ * @file savestate.h
+ * @brief Save states on disk and an in-memory rewind buffer.
+ *
+ * Both are built on chip8_snapshot_t and share one codec: a snapshot is
+ * XOR-ed against a reference (the previous frame for rewind, all zeros for
+ * files) and the result is stored as runs of skipped zero bytes and
+ * literal bytes. Consecutive frames differ in a few dozen bytes, so a
+ * rewind frame typically costs well under 100 bytes.
+ */
+
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "chip8.h"
+
+#define SAVESTATE_VERSION 2                  /**< Current on-disk format version */
+#define SAVESTATE_REWIND_BYTES_PER_FRAME 256 /**< Average delta budget per rewind frame */
+
+/**
+ * @struct rewind_frame_t
+ * @brief Location of one encoded delta in the rewind arena.
+ */
+typedef struct
+{
+    uint32_t offset; /**< Start in the arena (the delta may wrap around its end) */
+    uint32_t length; /**< Encoded size in bytes */
+} rewind_frame_t;
+
+/**
+ * @struct rewind_t
+ * @brief Ring of per-frame deltas, newest last.
+ *
+ * `current` holds the full snapshot of the newest frame. Each delta turns
+ * a frame into its predecessor, so stepping back is one decode into
+ * `current` followed by chip8_restore(). When the frame or byte budget
+ * runs out, the oldest frames are dropped.
+ */
+typedef struct
+{
+    uint8_t *arena;           /**< Byte ring holding the encoded deltas */
+    uint32_t arena_size;      /**< Capacity of the arena in bytes */
+    uint32_t arena_head;      /**< Where the next delta is written */
+    uint32_t arena_used;      /**< Bytes held by live deltas */
+    rewind_frame_t *frames;   /**< Frame ring */
+    uint32_t capacity;        /**< Maximum number of frames */
+    uint32_t first;           /**< Index of the oldest frame */
+    uint32_t count;           /**< Number of frames held */
+    uint8_t *scratch;         /**< Encode/decode buffer */
+    chip8_snapshot_t current; /**< Snapshot of the newest frame */
+    chip8_snapshot_t next;    /**< Staging area for rewind_push() */
+    bool has_current;         /**< false until the first push */
+} rewind_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Writes the machine state of @p emu to a save-state file.
+     *
+     * @param emu  Emulator to save.
+     * @param path Destination file.
+     * @return true on success, false on I/O error.
+     */
+    bool savestate_write(const chip8_t *emu, const char *path);
+
+    /**
+     * @brief Loads a save-state file into @p emu via chip8_restore().
+     *
+     * The file is fully validated before @p emu is touched.
+     *
+     * @param emu  Emulator to overwrite.
+     * @param path Save-state file.
+     * @return true on success, false if the file is missing or malformed.
+     */
+    bool savestate_read(chip8_t *emu, const char *path);
+
+    /**
+     * @brief Allocates a rewind buffer holding up to @p seconds of 60 Hz frames.
+     *
+     * @param rw      Rewind buffer to initialize.
+     * @param seconds History length; must be at least 1.
+     * @return true on success, false on allocation failure or a length
+     *         whose arena would not fit 32-bit offsets.
+     */
+    bool rewind_init(rewind_t *rw, uint32_t seconds);
+
+    /**
+     * @brief Frees the memory of a rewind buffer.
+     */
+    void rewind_cleanup(rewind_t *rw);
+
+    /**
+     * @brief Records the current state of @p emu as the newest frame.
+     *
+     * Call once per emulated frame.
+     */
+    void rewind_push(rewind_t *rw, const chip8_t *emu);
+
+    /**
+     * @brief Restores the frame before the newest one and drops the newest.
+     *
+     * @param rw  Rewind buffer.
+     * @param emu Emulator to restore into.
+     * @return false once the history is exhausted.
+     */
+    bool rewind_step_back(rewind_t *rw, chip8_t *emu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAVESTATE_H */
@@ -13,6 +13,7 @@
 #include <SDL2/SDL.h>
 #include "config.h"
 #include "chip8.h"
+#include "gl_renderer.h"
 
 /**
  * @struct sdl_t
@@ -22,9 +23,45 @@ typedef struct
 {
     SDL_Window *window;     /**< SDL window handle */
     SDL_Renderer *renderer; /**< SDL renderer handle */
-    SDL_Texture *texture;   /**< SDL texture for the 64x32 display */
+    SDL_Texture *texture;   /**< SDL texture for the largest screen of the machine */
+    gl_renderer_t *gl;      /**< OpenGL backend; when set, renderer and texture are NULL */
+    int scale;              /**< Texture pixels per pixel of the largest screen (above 1 for the software renderer) */
+    int width;              /**< Largest screen of the machine, in CHIP-8 pixels */
+    int height;             /**< Largest screen of the machine, in CHIP-8 pixels */
 } sdl_t;
 
+#define SDL_KEYMAP_UNMAPPED 0xFF /**< sdl_keymap_t entry of a key without a CHIP-8 binding */
+
+/**
+ * @struct sdl_keymap_t
+ * @brief Lookup table from SDL scancodes to CHIP-8 keys.
+ *
+ * Indexed by scancode, so a key event costs one load regardless of the
+ * bindings. Several scancodes may map to the same CHIP-8 key.
+ */
+typedef struct
+{
+    uint8_t keys[SDL_NUM_SCANCODES]; /**< CHIP-8 key 0x0..0xF, or SDL_KEYMAP_UNMAPPED */
+} sdl_keymap_t;
+
+/**
+ * @struct sdl_input_t
+ * @brief What the user asked for through the window, written by sdl_handle_event().
+ *
+ * Kept apart from chip8_t so events can be handled on a thread that does
+ * not own the emulator (see emu_thread.h).
+ */
+typedef struct
+{
+    const sdl_keymap_t *keymap; /**< Key bindings */
+    uint16_t keys;              /**< Bit k set while CHIP-8 key k is held */
+    uint16_t pressed;           /**< Bit k set when key k went down; the caller clears it */
+    chip8_state_t state;        /**< Requested run state: RUNNING, PAUSED, REWINDING or STOPPED */
+    uint16_t steps;             /**< F10 presses while paused (single steps); the caller clears it */
+    bool redraw;                /**< Window contents were lost; the caller clears this after a full present */
+    bool overlay;               /**< F3 toggles the metrics in the window title */
+} sdl_input_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -35,18 +72,54 @@ extern "C"
      *
      * This function initializes SDL, creates a window, renderer, and texture,
      * and sets the initial render color based on the background color.
+     * With config->renderer set to CONFIG_RENDERER_GL it tries the OpenGL
+     * backend first and falls back to the SDL renderer if that fails.
+     * Without an accelerated renderer it uses SDL's software renderer with
+     * a texture of scale_factor times the display size, so frames are
+     * scaled while converting instead of by SDL_RenderCopy().
+     *
+     * The texture covers the largest screen of @p machine; low-resolution
+     * frames of a SUPER-CHIP are scaled up 2x while converting.
      *
      * @param sdl Pointer to the SDL interface structure to initialize.
      * @param config Pointer to the display configuration structure.
+     * @param machine Profile of the emulated machine.
      * @return true if initialization is successful, false otherwise.
      */
-    bool sdl_init(sdl_t *sdl, const display_config_t *config);
+    bool sdl_init(sdl_t *sdl, const display_config_t *config, const chip8_machine_t *machine);
+
+    /**
+     * @brief Converts display rows into ARGB8888 pixels.
+     *
+     * Lit pixels get the configured foreground colour, others the background.
+     * Each display row becomes @p scale rows of width * @p scale pixels; the
+     * first is written at @p pixels, each following one @p pitch bytes
+     * further on, so the destination can be a locked texture directly.
+     * Unscaled rows use the SIMD kernel named by sdl_convert_kernel(), one
+     * 64-pixel word at a time.
+     *
+     * @param display Bit-packed rows in the chip8_t::display layout.
+     * @param hires   display is 128x64 (two words per row) rather than 64x32.
+     * @param config  Supplies fg_color and bg_color.
+     * @param pixels  Destination for (last - first + 1) * scale rows.
+     * @param pitch   Bytes between the starts of consecutive destination rows.
+     * @param first   First display row to convert.
+     * @param last    Last display row to convert (inclusive).
+     * @param scale   Integer scale factor, at least 1.
+     */
+    void sdl_convert_rows(const uint64_t *display, bool hires, const display_config_t *config,
+                          void *pixels, int pitch, int first, int last, int scale);
+
+    /**
+     * @brief Returns the conversion kernel compiled in: "avx2", "sse2", "neon" or "scalar".
+     */
+    const char *sdl_convert_kernel(void);
 
     /**
      * @brief Renders the CHIP-8 display to the SDL window.
      *
-     * This function converts the CHIP-8's display buffer into ARGB8888 pixel data,
-     * updates the SDL texture, and presents the rendered frame.
+     * This function converts the CHIP-8's display buffer into ARGB8888 pixel data
+     * directly in the locked SDL texture and presents the rendered frame.
      *
      * @param sdl Pointer to the SDL interface structure.
      * @param emu Pointer to the CHIP-8 emulator structure.
@@ -54,28 +127,74 @@ extern "C"
     void sdl_render(const sdl_t *sdl, const chip8_t *emu);
 
     /**
-     * @brief Handles SDL events and updates the CHIP-8 emulator state accordingly.
+     * @brief Fills @p keymap with the built-in layout (1234/QWER/ASDF/ZXCV by position).
+     */
+    void sdl_keymap_default(sdl_keymap_t *keymap);
+
+    /**
+     * @brief Replaces @p keymap with the bindings of a keymap file.
      *
-     * This function processes SDL events such as quitting the application, key presses,
-     * and key releases, updating the emulator's state and key buffer as necessary.
+     * Each non-blank line binds one key: a CHIP-8 key in hex, then an SDL
+     * scancode name such as `Q`, `Keypad 7` or `Left`, e.g. `C 4` or
+     * `0 Space`. `#` starts a comment. Keys the file does not mention are
+     * unbound. @p keymap is left untouched if the file has an error.
      *
-     * @param emu Pointer to the CHIP-8 emulator structure.
+     * @param keymap Keymap to replace.
+     * @param path   Keymap file.
+     * @return true on success, false if the file is missing or malformed.
+     */
+    bool sdl_keymap_load(sdl_keymap_t *keymap, const char *path);
+
+    /**
+     * @brief Applies one SDL event to the user's input state.
+     *
+     * Key presses and releases are looked up in input->keymap and update
+     * the CHIP-8 key masks; quit, pause and rewind requests update the
+     * requested run state. Escape asks for confirmation in a modal message
+     * box, which blocks only the calling thread.
+     *
+     * @param input Input state to update.
      * @param event Pointer to the SDL event structure.
      */
-    void sdl_handle_event(chip8_t *emu, const SDL_Event *event);
+    void sdl_handle_event(sdl_input_t *input, const SDL_Event *event);
 
     /**
-     * @brief Updates the SDL texture and renders the display if changes are detected.
+     * @brief Uploads the given rows of a display and presents them.
      *
-     * This function compares the current display buffer with the previous frame to
-     * determine if rendering is necessary. If changes are detected, it updates the
-     * texture and presents the new frame.
+     * If @p dirty is zero this returns without touching the renderer;
+     * otherwise only the band of rows between the lowest and highest set
+     * bit is converted through SDL_LockTexture before the frame is
+     * presented. The OpenGL backend uploads the packed rows instead and
+     * uses the colours given to sdl_init().
+     *
+     * @param sdl     Pointer to the SDL interface structure.
+     * @param display Bit-packed rows in the chip8_t::display layout.
+     * @param hires   display is in the high-resolution layout (chip8_t::hires).
+     * @param config  Supplies the colours.
+     * @param dirty   Bit y set for every row that differs from the texture;
+     *                a change of resolution needs every bit set.
+     */
+    void sdl_present(const sdl_t *sdl, const uint64_t *display, bool hires, const display_config_t *config,
+                     uint64_t dirty);
+
+    /**
+     * @brief Uploads the rows drawn since the last present and presents them.
+     *
+     * Uses the dirty-row bits maintained by the core (CLS, DXYN, scrolls) with
+     * sdl_present(). Call at most once per emulated frame.
      *
      * @param sdl Pointer to the SDL interface structure.
-     * @param emu Pointer to the CHIP-8 emulator structure.
-     * @param previous_frame Pointer to the buffer holding the previous frame's state.
+     * @param emu Pointer to the CHIP-8 emulator structure; its dirty rows are cleared.
+     */
+    void sdl_update_screen(const sdl_t *sdl, chip8_t *emu);
+
+    /**
+     * @brief Shows a status line in the window title, or restores the title.
+     *
+     * @param sdl    Pointer to the SDL interface structure.
+     * @param status Text after the emulator's name, or NULL for the name alone.
      */
-    void sdl_update_screen(const sdl_t *sdl, const chip8_t *emu, uint8_t *previous_frame);
+    void sdl_show_status(const sdl_t *sdl, const char *status);
 
     /**
      * @brief Cleans up and destroys SDL window, renderer, and texture.
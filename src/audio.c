@@ -2,77 +2,127 @@
  * @file audio.c
  * @brief Implementation of the audio module for CHIP-8 beep sounds.
  *
- * This file contains the private data and definitions for handling
- * audio playback via SDL2_mixer. The public API is in audio.h.
+ * This file contains the private data and the SDL audio callback that
+ * synthesizes the beep. The public API is in audio.h.
  */
 
 #include "audio.h"
 #include "cli_logger.h"
-#include <SDL2/SDL_mixer.h>
-#include <stdio.h>
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <string.h>
 
-static Mix_Chunk *gBeepChunk = NULL;
-static int gBeepChannel = -1; // Store which channel is playing (-1 if none)
+#define AUDIO_SAMPLE_RATE 44100   /**< Requested output rate; the device may pick another */
+#define AUDIO_MAX_AMPLITUDE 8192  /**< Square wave peak at full volume, about -12 dBFS */
 
-bool audio_init(const char *wav_path)
+static SDL_AudioDeviceID gDevice = 0;
+static SDL_atomic_t gBeepOn;      // Written by any thread, read by the callback
+static uint32_t gPhase = 0;       // Callback only: position in the period, 2^32 per period
+static uint32_t gPhaseStep = 0;   // Phase advance per sample
+static int16_t gAmplitude = 0;
+static audio_config_t gConfig;    // Settings for the device, opened on first use
+static bool gArmed = false;       // audio_init() called and the device may still be opened
+
+/**
+ * @brief SDL audio callback: fills one buffer with the tone or with silence.
+ */
+static void generate_tone(void *userdata, Uint8 *stream, int len)
 {
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
+    (void)userdata;
+
+    if (!SDL_AtomicGet(&gBeepOn))
     {
-        print_error("Mix_OpenAudio error: %s\n", Mix_GetError());
+        memset(stream, 0, (size_t)len);
+        gPhase = 0; // The next beep starts at the beginning of a period
+        return;
+    }
+
+    int16_t *out = (int16_t *)stream;
+    int samples = len / (int)sizeof(int16_t);
+    for (int i = 0; i < samples; i++)
+    {
+        out[i] = gPhase < 0x80000000u ? gAmplitude : (int16_t)-gAmplitude;
+        gPhase += gPhaseStep;
+    }
+}
+
+/**
+ * @brief Opens the device with the armed configuration and starts it, silent.
+ */
+static bool open_device(void)
+{
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        print_error("SDL audio init error: %s\n", SDL_GetError());
         return false;
     }
 
-    gBeepChunk = Mix_LoadWAV(wav_path);
-    if (!gBeepChunk)
+    SDL_AudioSpec want;
+    SDL_AudioSpec have;
+    memset(&want, 0, sizeof(want));
+    want.freq = AUDIO_SAMPLE_RATE;
+    want.format = AUDIO_S16SYS;
+    want.channels = 1;
+    want.samples = (Uint16)gConfig.buffer_samples;
+    want.callback = generate_tone;
+
+    gDevice = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (gDevice == 0)
     {
-        print_error("Failed to load %s: %s\n", wav_path, Mix_GetError());
+        print_error("SDL_OpenAudioDevice error: %s\n", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
         return false;
     }
 
-    // Optionally reserve a channel if you like (not strictly required)
-    Mix_ReserveChannels(1);
+    // Set before the device unpauses, so the callback never sees them change
+    gPhase = 0;
+    gPhaseStep = (uint32_t)(((uint64_t)gConfig.tone_hz << 32) / (uint64_t)have.freq);
+    gAmplitude = (int16_t)(gConfig.volume * AUDIO_MAX_AMPLITUDE / 128);
 
+    print_info("Audio: %d Hz tone, %d Hz output, %u-sample buffer (%.1f ms)",
+               gConfig.tone_hz, have.freq, have.samples, 1000.0 * have.samples / have.freq);
+
+    SDL_PauseAudioDevice(gDevice, 0);
     return true;
 }
 
-void audio_play_beep_loop(void)
+bool audio_init(const audio_config_t *config)
 {
-    // If already playing, do nothing
-    if (gBeepChannel >= 0 && Mix_Playing(gBeepChannel))
-        return;
+    gConfig = *config;
+    gArmed = true;
+    SDL_AtomicSet(&gBeepOn, 0);
+    return true;
+}
 
-    // Play on first free channel (-1) with loop = -1 (infinite)
-    gBeepChannel = Mix_PlayChannel(-1, gBeepChunk, -1);
-    if (gBeepChannel == -1)
+void audio_update(void)
+{
+    // Most ROMs never beep, or not before the first screen is up
+    if (gArmed && gDevice == 0 && SDL_AtomicGet(&gBeepOn))
     {
-        print_error("Mix_PlayChannel error: %s\n", Mix_GetError());
+        if (!open_device())
+            print_warning("Audio disabled.");
+        gArmed = gDevice != 0;
     }
 }
 
-void audio_stop_beep(void)
+void audio_set_beep(bool on)
 {
-    if (gBeepChannel >= 0)
-    {
-        Mix_HaltChannel(gBeepChannel);
-        gBeepChannel = -1;
-    }
+    SDL_AtomicSet(&gBeepOn, on);
 }
 
 bool audio_is_beep_playing(void)
 {
-    if (gBeepChannel >= 0)
-    {
-        return Mix_Playing(gBeepChannel) != 0; // nonzero if still playing
-    }
-    return false;
+    return gDevice != 0 && SDL_AtomicGet(&gBeepOn) != 0;
 }
 
 void audio_cleanup(void)
 {
-    if (gBeepChunk)
+    if (gDevice != 0)
     {
-        Mix_FreeChunk(gBeepChunk);
-        gBeepChunk = NULL;
+        SDL_CloseAudioDevice(gDevice);
+        gDevice = 0;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
     }
-    Mix_CloseAudio();
+    gArmed = false;
+    SDL_AtomicSet(&gBeepOn, 0);
 }
@@ -10,7 +10,24 @@
 
 #include "cli_logger.h"
 #include "chip8.h"
-#include "audio.h"
+
+/**
+ * @brief Emits a per-instruction debug message when tracing is active.
+ *
+ * Compiles to nothing unless the build defines CHIP8_TRACE, so the
+ * fetch/decode/execute path carries no logging calls or branches in
+ * regular builds.
+ */
+#ifdef CHIP8_TRACE
+#define CHIP8_TRACE_LOG(emu, ...)        \
+    do                                   \
+    {                                    \
+        if ((emu)->trace)                \
+            print_debug(__VA_ARGS__);    \
+    } while (0)
+#else
+#define CHIP8_TRACE_LOG(emu, ...) ((void)(emu))
+#endif
 
 /**
  * @brief Function type for CHIP-8 opcode handlers.
@@ -20,13 +37,7 @@
  */
 typedef void (*chip8_opcode_handler_t)(chip8_t *, chip8_instr_t);
 
-/**
- * @brief Decodes the raw 16-bit opcode into a chip8_instr_t struct.
- *
- * @param opcode The raw 16-bit opcode fetched from memory.
- * @return A fully populated chip8_instr_t.
- */
-static chip8_instr_t decode_opcode(uint16_t opcode)
+chip8_instr_t chip8_decode_opcode(uint16_t opcode)
 {
     chip8_instr_t instr;
     instr.opcode = opcode;
@@ -40,6 +51,69 @@ static chip8_instr_t decode_opcode(uint16_t opcode)
     return instr;
 }
 
+/**
+ * @brief Machine profiles, indexed by config_machine_t.
+ */
+static const chip8_machine_t machines[CONFIG_MACHINE_COUNT] = {
+    [CONFIG_MACHINE_CHIP8] = {"chip8", CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT, false},
+    [CONFIG_MACHINE_SCHIP] = {"schip", CHIP8_HIRES_WIDTH, CHIP8_HIRES_HEIGHT, true},
+};
+
+/**
+ * @brief CPU engine names, indexed by config_core_t.
+ */
+static const char *const core_names[CONFIG_CORE_COUNT] = {
+    [CONFIG_CORE_CACHED] = "cached",
+    [CONFIG_CORE_TABLE] = "table",
+    [CONFIG_CORE_THREADED] = "threaded",
+};
+
+_Static_assert(CHIP8_BIG_FONT_ADDR >= sizeof(chip8_fontset), "the big font must follow the small one");
+_Static_assert(CHIP8_BIG_FONT_ADDR + sizeof(chip8_big_fontset) <= CHIP8_PAGE_SIZE, "fonts must fit in page 0");
+
+/**
+ * @brief Returns the number of display words the current resolution uses.
+ *
+ * Words past these are kept zero, so clearing and hashing a
+ * low-resolution screen touches 256 bytes, as on a plain CHIP-8.
+ */
+static inline size_t display_words(const chip8_t *emu)
+{
+    return (size_t)chip8_display_height(emu) * chip8_row_words(emu);
+}
+
+/**
+ * @brief Marks display rows changed, for the next present and for chip8_run().
+ */
+static inline void mark_rows_dirty(chip8_t *emu, uint64_t rows)
+{
+    emu->dirty_rows |= rows;
+    emu->events |= CHIP8_EVENT_DRAW;
+}
+
+/**
+ * @brief Checks an access to @p len bytes from @p first against the watchpoints.
+ *
+ * The first watched byte raises CHIP8_EVENT_WATCH; the caller's instruction
+ * still completes.
+ */
+static inline void watch_access(chip8_t *emu, unsigned first, unsigned len, bool store)
+{
+    if (!emu->watch_count)
+        return;
+
+    for (unsigned addr = first; addr < first + len && addr < CHIP8_MEMORY_SIZE; addr++)
+    {
+        if (chip8_has_watchpoint(emu, (uint16_t)addr))
+        {
+            emu->events |= CHIP8_EVENT_WATCH;
+            emu->watch_addr = (uint16_t)addr;
+            emu->watch_store = store;
+            return;
+        }
+    }
+}
+
 /* --------------------------------------------------------------------------
    Opcode Handlers
    -------------------------------------------------------------------------- */
@@ -51,8 +125,9 @@ static void handle_cls(chip8_t *emu, chip8_instr_t instr)
 {
     (void)instr; // Not used
 
-    // Clear the entire 64x32 display (bool array)
-    memset(emu->display, false, sizeof(emu->display));
+    // Clear the rows of the current resolution
+    memset(emu->display, 0, display_words(emu) * sizeof(uint64_t));
+    mark_rows_dirty(emu, CHIP8_ALL_ROWS_DIRTY);
     emu->pc += 2;
 }
 
@@ -72,29 +147,19 @@ static void handle_ret(chip8_t *emu, chip8_instr_t instr)
     else
     {
         print_warning("Stack underflow on RET");
+        emu->events |= CHIP8_EVENT_STACK;
         emu->pc += 2; // Prevent getting stuck by skipping RET opcode
     }
 }
 
 /**
- * @brief Sub-dispatch for 0x0___ instructions.
+ * @brief Handler for 0x0NNN: SYS addr (call RCA 1802 machine code).
  */
-static void handle_0xxx(chip8_t *emu, chip8_instr_t instr)
+static void handle_sys(chip8_t *emu, chip8_instr_t instr)
 {
-    switch (instr.opcode)
-    {
-    case 0x00E0: // CLS
-        handle_cls(emu, instr);
-        break;
-    case 0x00EE: // RET
-        handle_ret(emu, instr);
-        break;
-    default:
-        // Some interpreters handle 0NNN calls to RCA 1802 programs.
-        print_warning("Unimplemented 0x0NNN opcode: 0x%04X", instr.opcode);
-        emu->pc += 2;
-        break;
-    }
+    // Some interpreters handle 0NNN calls to RCA 1802 programs.
+    print_warning("Unimplemented 0x0NNN opcode: 0x%04X", instr.opcode);
+    emu->pc += 2;
 }
 
 /**
@@ -112,7 +177,7 @@ static void handle_call(chip8_t *emu, chip8_instr_t instr)
 {
     if (emu->sp < 16) // CHIP-8 has a stack depth of 16
     {
-        emu->stack[emu->sp++] = emu->pc;
+        emu->stack[emu->sp++] = emu->pc + 2; // Return to the next instruction
         emu->pc = instr.nnn;
     }
     else
@@ -120,6 +185,7 @@ static void handle_call(chip8_t *emu, chip8_instr_t instr)
         print_warning("Stack overflow on CALL 0x%03X", instr.nnn);
         // Decide how to handle overflow (e.g., stop emulator)
         emu->state = CHIP8_STOPPED;
+        emu->events |= CHIP8_EVENT_STACK | CHIP8_EVENT_STOP;
     }
 }
 
@@ -175,60 +241,114 @@ static void handle_add_vx_kk(chip8_t *emu, chip8_instr_t instr)
 }
 
 /**
- * @brief Sub-dispatch for 0x8XY_ instructions.
+ * @brief Handler for 0x8XY0: LD Vx, Vy.
  */
-static void handle_8xxx(chip8_t *emu, chip8_instr_t instr)
+static void handle_ld_vx_vy(chip8_t *emu, chip8_instr_t instr)
 {
-    switch (instr.n)
-    {
-    case 0x0: // LD Vx, Vy
-        emu->V[instr.x] = emu->V[instr.y];
-        break;
-    case 0x1: // OR Vx, Vy
-        emu->V[instr.x] |= emu->V[instr.y];
-        break;
-    case 0x2: // AND Vx, Vy
-        emu->V[instr.x] &= emu->V[instr.y];
-        break;
-    case 0x3: // XOR Vx, Vy
-        emu->V[instr.x] ^= emu->V[instr.y];
-        break;
-    case 0x4: // ADD Vx, Vy (with carry)
-    {
-        uint16_t sum = emu->V[instr.x] + emu->V[instr.y];
-        emu->V[0xF] = (sum > 0xFF) ? 1 : 0; // Carry flag
-        emu->V[instr.x] = (uint8_t)(sum & 0xFF);
-        break;
-    }
-    case 0x5: // SUB Vx, Vy (with borrow)
-    {
-        emu->V[0xF] = (emu->V[instr.x] >= emu->V[instr.y]) ? 1 : 0;
-        emu->V[instr.x] -= emu->V[instr.y];
-        break;
-    }
-    case 0x6: // SHR Vx
-    {
-        emu->V[0xF] = emu->V[instr.x] & 0x1; // Least significant bit
-        emu->V[instr.x] >>= 1;
-        break;
-    }
-    case 0x7: // SUBN Vx, Vy
-    {
-        emu->V[0xF] = (emu->V[instr.y] >= emu->V[instr.x]) ? 1 : 0;
-        emu->V[instr.x] = emu->V[instr.y] - emu->V[instr.x];
-        break;
-    }
-    case 0xE: // SHL Vx
-    {
-        emu->V[0xF] = (emu->V[instr.x] & 0x80) >> 7; // Most significant bit
-        emu->V[instr.x] <<= 1;
-        break;
-    }
-    default:
-        print_warning("Unknown 0x8 opcode: 0x%04X", instr.opcode);
-        break;
-    }
+    emu->V[instr.x] = emu->V[instr.y];
+    emu->pc += 2;
+}
+
+/*
+ * Quirk-dependent instructions are written once as always-inlined bodies
+ * taking the quirk as a parameter. CHIP8_QUIRK_HANDLERS() below
+ * instantiates them per profile with constant arguments, so each profile
+ * gets handlers with the quirk folded away.
+ */
+#define QUIRK_BODY static inline __attribute__((always_inline)) void
+
+/**
+ * @brief Body of 0x8XY1: OR Vx, Vy; VF = 0 with the vf_reset quirk.
+ */
+QUIRK_BODY or_vx_vy(chip8_t *emu, chip8_instr_t instr, bool vf_reset)
+{
+    emu->V[instr.x] |= emu->V[instr.y];
+    if (vf_reset)
+        emu->V[0xF] = 0;
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0x8XY2: AND Vx, Vy; VF = 0 with the vf_reset quirk.
+ */
+QUIRK_BODY and_vx_vy(chip8_t *emu, chip8_instr_t instr, bool vf_reset)
+{
+    emu->V[instr.x] &= emu->V[instr.y];
+    if (vf_reset)
+        emu->V[0xF] = 0;
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0x8XY3: XOR Vx, Vy; VF = 0 with the vf_reset quirk.
+ */
+QUIRK_BODY xor_vx_vy(chip8_t *emu, chip8_instr_t instr, bool vf_reset)
+{
+    emu->V[instr.x] ^= emu->V[instr.y];
+    if (vf_reset)
+        emu->V[0xF] = 0;
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0x8XY4: ADD Vx, Vy (with carry).
+ */
+static void handle_add_vx_vy(chip8_t *emu, chip8_instr_t instr)
+{
+    uint16_t sum = emu->V[instr.x] + emu->V[instr.y];
+    emu->V[0xF] = (sum > 0xFF) ? 1 : 0; // Carry flag
+    emu->V[instr.x] = (uint8_t)(sum & 0xFF);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0x8XY5: SUB Vx, Vy (with borrow).
+ */
+static void handle_sub_vx_vy(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->V[0xF] = (emu->V[instr.x] >= emu->V[instr.y]) ? 1 : 0;
+    emu->V[instr.x] -= emu->V[instr.y];
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0x8XY6: SHR Vx (Vx = Vy >> 1 with the shift_vy quirk).
+ */
+QUIRK_BODY shr_vx(chip8_t *emu, chip8_instr_t instr, bool shift_vy)
+{
+    uint8_t value = emu->V[shift_vy ? instr.y : instr.x];
+    emu->V[0xF] = value & 0x1; // Least significant bit
+    emu->V[instr.x] = (uint8_t)(value >> 1);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0x8XY7: SUBN Vx, Vy.
+ */
+static void handle_subn_vx_vy(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->V[0xF] = (emu->V[instr.y] >= emu->V[instr.x]) ? 1 : 0;
+    emu->V[instr.x] = emu->V[instr.y] - emu->V[instr.x];
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0x8XYE: SHL Vx (Vx = Vy << 1 with the shift_vy quirk).
+ */
+QUIRK_BODY shl_vx(chip8_t *emu, chip8_instr_t instr, bool shift_vy)
+{
+    uint8_t value = emu->V[shift_vy ? instr.y : instr.x];
+    emu->V[0xF] = (value & 0x80) >> 7; // Most significant bit
+    emu->V[instr.x] = (uint8_t)(value << 1);
+    emu->pc += 2;
+}
 
+/**
+ * @brief Handler for undefined 0x8XY_ opcodes.
+ */
+static void handle_8xxx_unknown(chip8_t *emu, chip8_instr_t instr)
+{
+    print_warning("Unknown 0x8 opcode: 0x%04X", instr.opcode);
     emu->pc += 2;
 }
 
@@ -253,11 +373,26 @@ static void handle_ld_i_nnn(chip8_t *emu, chip8_instr_t instr)
 }
 
 /**
- * @brief Handler for 0xBNNN: JP V0, NNN
+ * @brief Body of 0xBNNN: JP V0, NNN (JP Vx, XNN with the jump_vx quirk).
  */
-static void handle_jp_v0_nnn(chip8_t *emu, chip8_instr_t instr)
+QUIRK_BODY jp_v0_nnn(chip8_t *emu, chip8_instr_t instr, bool jump_vx)
 {
-    emu->pc = (emu->V[0] + instr.nnn) & 0xFFF; // Ensure PC wraps to 12 bits
+    emu->pc = (emu->V[jump_vx ? instr.x : 0] + instr.nnn) & 0xFFF; // Ensure PC wraps to 12 bits
+}
+
+/**
+ * @brief Advances the CXNN generator and returns its next byte.
+ */
+static inline uint8_t next_random(chip8_t *emu)
+{
+    // xorshift64*: per-instance state, no locks, reproducible from the seed
+    uint64_t state = emu->rng_state;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    emu->rng_state = state;
+
+    return (uint8_t)((state * 0x2545F4914F6CDD1DULL) >> 56);
 }
 
 /**
@@ -265,234 +400,830 @@ static void handle_jp_v0_nnn(chip8_t *emu, chip8_instr_t instr)
  */
 static void handle_rnd_vx_kk(chip8_t *emu, chip8_instr_t instr)
 {
-    uint8_t rnd = (uint8_t)(rand() & 0xFF);
-    emu->V[instr.x] = rnd & instr.kk;
+    emu->V[instr.x] = next_random(emu) & instr.kk;
     emu->pc += 2;
 }
 
 /**
- * @brief Handler for 0xDXYN: DRW Vx, Vy, N
+ * @brief XORs one sprite row into display row @p y, starting at column @p x.
  *
- * Draws N rows of 8 bits from memory[I].
- * Each bit toggles (XOR) the display pixel at (x+col, y+row).
- * VF = 1 if any pixel flipped from set (true) to unset (false).
+ * @p bits holds the sprite row left-aligned (first pixel in bit 63). Rows
+ * of 8 or 16 pixels span at most two display words, so every row costs
+ * one or two shifts whatever the resolution; pixels past the right edge
+ * fall off the end of the row.
+ *
+ * @return true if a lit pixel was turned off.
  */
-static void handle_drw_vx_vy_n(chip8_t *emu, chip8_instr_t instr)
+static inline bool draw_row(chip8_t *emu, unsigned y, unsigned x, uint64_t bits)
 {
-    uint8_t x = emu->V[instr.x] % 64; // Fixed screen width for CHIP-8
-    uint8_t y = emu->V[instr.y] % 32; // Fixed screen height for CHIP-8
-    uint8_t height = instr.n;
+    const unsigned words = chip8_row_words(emu);
+    const unsigned shift = x & 63;
+    uint64_t *dst = &emu->display[y * words + (x >> 6)];
+
+    uint64_t first = bits >> shift;
+    uint64_t second = (shift && (x >> 6) + 1 < words) ? bits << (64 - shift) : 0;
+
+    bool hit = (dst[0] & first) != 0;
+    dst[0] ^= first;
+    if (second)
+    {
+        hit |= (dst[1] & second) != 0;
+        dst[1] ^= second;
+    }
+
+    if (first | second)
+        mark_rows_dirty(emu, (uint64_t)1 << y);
+    return hit;
+}
 
-    // print_debug("Drawing sprite at (%d, %d) with height %d, I=0x%03X", x, y, height, emu->I);
+/**
+ * @brief Draws @p rows sprite rows of @p row_bytes bytes each from memory[I].
+ *
+ * The start position wraps around the screen; rows past the bottom edge
+ * are skipped, so sprites clip rather than wrap.
+ * VF = 1 if any pixel flipped from set (true) to unset (false).
+ */
+static void draw_sprite(chip8_t *emu, chip8_instr_t instr, unsigned rows, unsigned row_bytes)
+{
+    const unsigned width = chip8_display_width(emu);
+    const unsigned height = chip8_display_height(emu);
+    unsigned x = emu->V[instr.x] % width;
+    unsigned y = emu->V[instr.y] % height;
 
     emu->V[0xF] = 0; // Reset collision flag
+    watch_access(emu, emu->I, rows * row_bytes, false);
 
-    for (uint8_t row = 0; row < height; row++)
+    for (unsigned row = 0; row < rows; row++)
     {
         // Prevent reading beyond memory bounds
-        if (emu->I + row >= CHIP8_MEMORY_SIZE)
+        unsigned addr = emu->I + row * row_bytes;
+        if (addr + row_bytes > CHIP8_MEMORY_SIZE)
         {
-            print_warning("Sprite row out of memory bounds: I=0x%03X, row=%d", emu->I, row);
+            print_warning("Sprite row out of memory bounds: I=0x%03X, row=%u", emu->I, row);
             break;
         }
 
-        uint8_t sprite_byte = emu->memory[emu->I + row];
-        // print_debug("Sprite row %d: 0x%02X", row, sprite_byte);
-
-        for (uint8_t col = 0; col < 8; col++)
+        unsigned dst_y = y + row;
+        if (dst_y >= height)
         {
-            uint8_t pixel = (sprite_byte >> (7 - col)) & 1;
-            uint16_t dst_x = x + col;
-            uint16_t dst_y = y + row;
+            CHIP8_TRACE_LOG(emu, "Skipping sprite row out of bounds at y=%u", dst_y);
+            continue;
+        }
 
-            if (dst_x >= 64 || dst_y >= 32)
-            {
-                print_debug("Skipping pixel out of bounds at (%d, %d)", dst_x, dst_y);
-                continue;
-            }
+        uint64_t bits = (uint64_t)emu->memory[addr] << 56;
+        if (row_bytes == 2)
+            bits |= (uint64_t)emu->memory[addr + 1] << 48;
 
-            uint16_t screen_idx = dst_y * 64 + dst_x;
-            uint8_t *screen_pixel = &emu->display[screen_idx];
+        if (draw_row(emu, dst_y, x, bits))
+            emu->V[0xF] = 1;
+    }
 
-            // Debug: Print pixel status before XOR
-            // print_debug("Pixel before: %d, Sprite pixel: %d at (%d, %d)", *screen_pixel, pixel, dst_x, dst_y);
+    emu->pc += 2;
+}
 
-            if (*screen_pixel && pixel)
-                emu->V[0xF] = 1;
+/**
+ * @brief Handler for 0xDXYN: DRW Vx, Vy, N
+ *
+ * Draws N rows of 8 bits from memory[I].
+ * Each bit toggles (XOR) the display pixel at (x+col, y+row).
+ */
+static void handle_drw_vx_vy_n(chip8_t *emu, chip8_instr_t instr)
+{
+    draw_sprite(emu, instr, instr.n, 1);
+}
 
-            *screen_pixel ^= pixel;
+/**
+ * @brief Handler for 0xDXY0 (SUPER-CHIP): DRW Vx, Vy, 0
+ *
+ * Draws a 16x16 sprite: 16 rows of two bytes from memory[I], in either
+ * resolution.
+ */
+static void handle_drw16(chip8_t *emu, chip8_instr_t instr)
+{
+    draw_sprite(emu, instr, 16, 2);
+}
 
-            // Debug: Print pixel status after XOR
-            // print_debug("Pixel after: %d at (%d, %d)", *screen_pixel, dst_x, dst_y);
-        }
-    }
+/**
+ * @brief Handler for 0x00CN (SUPER-CHIP): SCD N (scroll down N rows).
+ *
+ * Rows are whole words in the display layout, so scrolling is one memmove.
+ * Like the draw instructions, the scroll amounts of 00CN, 00FB and 00FC
+ * count pixels of the current resolution.
+ */
+static void handle_scd(chip8_t *emu, chip8_instr_t instr)
+{
+    const size_t total = display_words(emu);
+    const size_t shift = (size_t)instr.n * chip8_row_words(emu);
 
+    memmove(&emu->display[shift], emu->display, (total - shift) * sizeof(uint64_t));
+    memset(emu->display, 0, shift * sizeof(uint64_t));
+    if (shift)
+        mark_rows_dirty(emu, CHIP8_ALL_ROWS_DIRTY);
     emu->pc += 2;
 }
 
 /**
- * @brief Sub-dispatch for 0xE___ instructions (EX9E, EXA1).
+ * @brief Handler for 0x00FB (SUPER-CHIP): SCR (scroll right 4 pixels).
+ *
+ * Each word shifts by 4 and takes the low pixels of the word to its left.
  */
-static void handle_exxx(chip8_t *emu, chip8_instr_t instr)
+static void handle_scr(chip8_t *emu, chip8_instr_t instr)
 {
-    switch (instr.kk)
+    (void)instr; // Not used
+
+    const unsigned words = chip8_row_words(emu);
+    const unsigned height = chip8_display_height(emu);
+    for (unsigned y = 0; y < height; y++)
     {
-    case 0x9E: // SKP Vx
-        if (emu->keys[emu->V[instr.x]])
-            emu->pc += 4;
-        else
-            emu->pc += 2;
-        break;
-    case 0xA1: // SKNP Vx
-        if (!emu->keys[emu->V[instr.x]])
-            emu->pc += 4;
-        else
-            emu->pc += 2;
-        break;
-    default:
-        print_warning("Unknown 0xE opcode: 0x%04X", instr.opcode);
-        emu->pc += 2;
-        break;
+        uint64_t *row = &emu->display[y * words];
+        for (unsigned w = words - 1; w > 0; w--)
+            row[w] = row[w] >> 4 | row[w - 1] << 60;
+        row[0] >>= 4;
     }
+    mark_rows_dirty(emu, CHIP8_ALL_ROWS_DIRTY);
+    emu->pc += 2;
 }
 
 /**
- * @brief Sub-dispatch for 0xF___ instructions (FX07, FX0A, FX15, etc.).
+ * @brief Handler for 0x00FC (SUPER-CHIP): SCL (scroll left 4 pixels).
  */
-static void handle_fxxx(chip8_t *emu, chip8_instr_t instr)
+static void handle_scl(chip8_t *emu, chip8_instr_t instr)
 {
-    switch (instr.kk)
-    {
-    case 0x07: // LD Vx, DT
-        emu->V[instr.x] = emu->delay_timer;
-        emu->pc += 2;
-        break;
-    case 0x0A: // LD Vx, K (wait for keypress)
-    {
-        bool key_pressed = false;
-        for (int i = 0; i < 16; i++)
-        {
-            if (emu->keys[i])
-            {
-                emu->V[instr.x] = (uint8_t)i;
-                key_pressed = true;
-                break;
-            }
-        }
-        if (!key_pressed)
-        {
-            // Retry same opcode until a key is pressed
-            return; // Do NOT pc += 2
-        }
-        emu->pc += 2;
-        break;
-    }
-    case 0x15: // LD DT, Vx
-        emu->delay_timer = emu->V[instr.x];
-        emu->pc += 2;
-        break;
-    case 0x18: // LD ST, Vx
-        emu->sound_timer = emu->V[instr.x];
-        emu->pc += 2;
-        break;
-    case 0x1E: // ADD I, Vx
-        emu->I += emu->V[instr.x];
-        emu->pc += 2;
-        break;
-    case 0x29: // LD F, Vx (I = location of sprite for digit in Vx)
-        emu->I = (uint16_t)(emu->V[instr.x] * 5);
-        emu->pc += 2;
-        break;
-    case 0x33: // LD B, Vx (store BCD of Vx)
-    {
-        uint8_t value = emu->V[instr.x];
-        if (emu->I + 2 < CHIP8_MEMORY_SIZE)
-        {
-            emu->memory[emu->I + 0] = (uint8_t)(value / 100);
-            emu->memory[emu->I + 1] = (uint8_t)((value / 10) % 10);
-            emu->memory[emu->I + 2] = (uint8_t)(value % 10);
-        }
-        else
-        {
-            print_warning("BCD write out of memory bounds: I=0x%03X", emu->I);
-        }
-        emu->pc += 2;
-        break;
-    }
-    case 0x55: // LD [I], V0..Vx
-    {
-        for (int i2 = 0; i2 <= instr.x; i2++)
-        {
-            if (emu->I + i2 < CHIP8_MEMORY_SIZE)
-                emu->memory[emu->I + i2] = emu->V[i2];
-            else
-                print_warning("LD [I], Vx out of memory bounds: I+%d=0x%03X", i2, emu->I + i2);
-        }
-        // Some interpreters modify I here; ours does not
-        emu->pc += 2;
-        break;
-    }
-    case 0x65: // LD V0..Vx, [I]
+    (void)instr; // Not used
+
+    const unsigned words = chip8_row_words(emu);
+    const unsigned height = chip8_display_height(emu);
+    for (unsigned y = 0; y < height; y++)
     {
-        for (int i2 = 0; i2 <= instr.x; i2++)
-        {
-            if (emu->I + i2 < CHIP8_MEMORY_SIZE)
-                emu->V[i2] = emu->memory[emu->I + i2];
-            else
-                print_warning("LD Vx, [I] out of memory bounds: I+%d=0x%03X", i2, emu->I + i2);
-        }
-        emu->pc += 2;
-        break;
-    }
-    default:
-        print_warning("Unknown 0xF opcode: 0x%04X", instr.opcode);
-        emu->pc += 2;
-        break;
+        uint64_t *row = &emu->display[y * words];
+        for (unsigned w = 0; w + 1 < words; w++)
+            row[w] = row[w] << 4 | row[w + 1] >> 60;
+        row[words - 1] <<= 4;
     }
+    mark_rows_dirty(emu, CHIP8_ALL_ROWS_DIRTY);
+    emu->pc += 2;
 }
 
-/* --------------------------------------------------------------------------
-   LOOKUP TABLE - DISPATCH by the high nibble
-   -------------------------------------------------------------------------- */
+/**
+ * @brief Handler for 0x00FD (SUPER-CHIP): EXIT.
+ */
+static void handle_exit(chip8_t *emu, chip8_instr_t instr)
+{
+    (void)instr; // Not used
 
-static chip8_opcode_handler_t opcode_table[16] = {
-    [0x0] = handle_0xxx,        // 0xxx opcodes -> sub-dispatch
-    [0x1] = handle_jp,          // 0x1NNN
-    [0x2] = handle_call,        // 0x2NNN
-    [0x3] = handle_se_vx_kk,    // 0x3XNN
-    [0x4] = handle_sne_vx_kk,   // 0x4XNN
-    [0x5] = handle_se_vx_vy,    // 0x5XY0
-    [0x6] = handle_ld_vx_kk,    // 0x6XNN
-    [0x7] = handle_add_vx_kk,   // 0x7XNN
-    [0x8] = handle_8xxx,        // 0x8XY_ -> sub-dispatch
-    [0x9] = handle_sne_vx_vy,   // 0x9XY0
-    [0xA] = handle_ld_i_nnn,    // 0xANNN
-    [0xB] = handle_jp_v0_nnn,   // 0xBNNN
-    [0xC] = handle_rnd_vx_kk,   // 0xCXNN
-    [0xD] = handle_drw_vx_vy_n, // 0xDXYN
-    [0xE] = handle_exxx,        // 0xEX__
-    [0xF] = handle_fxxx         // 0xFX__
-};
+    print_info("Program exited (00FD) at PC=0x%03X", emu->pc);
+    emu->state = CHIP8_STOPPED;
+    emu->events |= CHIP8_EVENT_STOP;
+}
 
-/* --------------------------------------------------------------------------
-   Emulator Lifecycle
-   -------------------------------------------------------------------------- */
+/**
+ * @brief Switches resolution and blanks the screen.
+ *
+ * The two resolutions lay rows out differently, so the old contents would
+ * be meaningless in the new layout; XO-CHIP clears on a switch as well.
+ */
+static void set_resolution(chip8_t *emu, uint8_t hires)
+{
+    emu->hires = hires;
+    memset(emu->display, 0, sizeof(emu->display));
+    mark_rows_dirty(emu, CHIP8_ALL_ROWS_DIRTY);
+}
 
-bool chip8_init(chip8_t *emu)
+/**
+ * @brief Handler for 0x00FE (SUPER-CHIP): LOW (64x32).
+ */
+static void handle_low(chip8_t *emu, chip8_instr_t instr)
 {
-    memset(emu, 0, sizeof(chip8_t));
-    emu->state = CHIP8_RUNNING;
+    (void)instr; // Not used
 
-    // Program counter starts at 0x200 (standard for most CHIP-8)
-    emu->pc = CHIP8_ROM_ENTRY_POINT;
+    set_resolution(emu, 0);
+    emu->pc += 2;
+}
 
-    // Load standard fontset into memory starting at 0x000
-    memcpy(emu->memory, chip8_fontset, sizeof(chip8_fontset));
+/**
+ * @brief Handler for 0x00FF (SUPER-CHIP): HIGH (128x64).
+ */
+static void handle_high(chip8_t *emu, chip8_instr_t instr)
+{
+    (void)instr; // Not used
 
-    return true;
+    set_resolution(emu, 1);
+    emu->pc += 2;
 }
 
-bool chip8_load_program(chip8_t *emu, const char *filepath)
+/**
+ * @brief Handler for 0xEX9E: SKP Vx (skip next if key Vx is pressed).
+ */
+static void handle_skp_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    if (emu->keys & (1u << (emu->V[instr.x] & 0xF)))
+        emu->pc += 4;
+    else
+        emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xEXA1: SKNP Vx (skip next if key Vx is not pressed).
+ */
+static void handle_sknp_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    if (!(emu->keys & (1u << (emu->V[instr.x] & 0xF))))
+        emu->pc += 4;
+    else
+        emu->pc += 2;
+}
+
+/**
+ * @brief Handler for undefined 0xEX__ opcodes.
+ */
+static void handle_exxx_unknown(chip8_t *emu, chip8_instr_t instr)
+{
+    print_warning("Unknown 0xE opcode: 0x%04X", instr.opcode);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX07: LD Vx, DT.
+ */
+static void handle_ld_vx_dt(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->V[instr.x] = emu->delay_timer;
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX0A: LD Vx, K (wait for keypress).
+ *
+ * Halts the CPU instead of re-executing the opcode every cycle;
+ * chip8_set_keys() stores the pressed key in Vx and resumes.
+ */
+static void handle_ld_vx_k(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->key_wait = (uint8_t)(CHIP8_KEY_WAIT | instr.x);
+    emu->events |= CHIP8_EVENT_KEY_WAIT;
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX15: LD DT, Vx.
+ */
+static void handle_ld_dt_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->delay_timer = emu->V[instr.x];
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX18: LD ST, Vx.
+ */
+static void handle_ld_st_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    if ((emu->sound_timer != 0) != (emu->V[instr.x] != 0))
+        emu->events |= CHIP8_EVENT_SOUND;
+    emu->sound_timer = emu->V[instr.x];
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX1E: ADD I, Vx.
+ */
+static void handle_add_i_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->I += emu->V[instr.x];
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX29: LD F, Vx (I = location of sprite for digit in Vx).
+ */
+static void handle_ld_f_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->I = (uint16_t)(emu->V[instr.x] * 5);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX30 (SUPER-CHIP): LD HF, Vx (I = 8x10 digit Vx).
+ */
+static void handle_ld_hf_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    emu->I = (uint16_t)(CHIP8_BIG_FONT_ADDR + (emu->V[instr.x] & 0xF) * 10);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX75 (SUPER-CHIP): LD R, Vx (flags = V0..Vx).
+ *
+ * There are only eight flag registers; X above 7 stores V0..V7.
+ */
+static void handle_ld_r_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    unsigned last = instr.x < CHIP8_RPL_FLAGS ? instr.x : CHIP8_RPL_FLAGS - 1;
+    memcpy(emu->rpl, emu->V, last + 1);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for 0xFX85 (SUPER-CHIP): LD Vx, R (V0..Vx = flags).
+ */
+static void handle_ld_vx_r(chip8_t *emu, chip8_instr_t instr)
+{
+    unsigned last = instr.x < CHIP8_RPL_FLAGS ? instr.x : CHIP8_RPL_FLAGS - 1;
+    memcpy(emu->V, emu->rpl, last + 1);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Returns whether the load-time analysis found an instruction at @p addr.
+ */
+static inline bool is_code(const chip8_t *emu, uint16_t addr)
+{
+    return (emu->code_map[(addr >> 3) & 0x1FF] >> (addr & 7)) & 1;
+}
+
+/**
+ * @brief Records a CPU store to @p addr.
+ *
+ * Drops the pre-decoded instruction covering the byte, which keeps the
+ * decode cache coherent for self-modifying programs, and marks its page
+ * for chip8_reset(). A store into an analyzed instruction (starting at
+ * the byte or the one before) also drops the code hints.
+ */
+static inline void note_memory_write(chip8_t *emu, uint16_t addr)
+{
+    emu->dirty_pages |= (uint16_t)(1u << (addr >> CHIP8_PAGE_SHIFT));
+    if (addr >= CHIP8_ROM_ENTRY_POINT)
+        emu->decode_cache[(addr - CHIP8_ROM_ENTRY_POINT) >> 1].op = CHIP8_OP_UNDECODED;
+    if (emu->code_hints && (is_code(emu, addr) || is_code(emu, (uint16_t)(addr - 1))))
+        emu->code_hints = false;
+}
+
+/**
+ * @brief Handler for 0xFX33: LD B, Vx (store BCD of Vx).
+ */
+static void handle_ld_b_vx(chip8_t *emu, chip8_instr_t instr)
+{
+    uint8_t value = emu->V[instr.x];
+    if (emu->I + 2 < CHIP8_MEMORY_SIZE)
+    {
+        emu->memory[emu->I + 0] = (uint8_t)(value / 100);
+        emu->memory[emu->I + 1] = (uint8_t)((value / 10) % 10);
+        emu->memory[emu->I + 2] = (uint8_t)(value % 10);
+        note_memory_write(emu, emu->I);
+        note_memory_write(emu, emu->I + 2);
+        watch_access(emu, emu->I, 3, true);
+    }
+    else
+    {
+        print_warning("BCD write out of memory bounds: I=0x%03X", emu->I);
+    }
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0xFX55: LD [I], V0..Vx (then I += x + 1 with the load_store_inc quirk).
+ */
+QUIRK_BODY ld_mem_vx(chip8_t *emu, chip8_instr_t instr, bool load_store_inc)
+{
+    watch_access(emu, emu->I, instr.x + 1u, true);
+    for (int i2 = 0; i2 <= instr.x; i2++)
+    {
+        if (emu->I + i2 < CHIP8_MEMORY_SIZE)
+        {
+            emu->memory[emu->I + i2] = emu->V[i2];
+            note_memory_write(emu, (uint16_t)(emu->I + i2));
+        }
+        else
+            print_warning("LD [I], Vx out of memory bounds: I+%d=0x%03X", i2, emu->I + i2);
+    }
+    if (load_store_inc)
+        emu->I = (uint16_t)(emu->I + instr.x + 1);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Body of 0xFX65: LD V0..Vx, [I] (then I += x + 1 with the load_store_inc quirk).
+ */
+QUIRK_BODY ld_vx_mem(chip8_t *emu, chip8_instr_t instr, bool load_store_inc)
+{
+    watch_access(emu, emu->I, instr.x + 1u, false);
+    for (int i2 = 0; i2 <= instr.x; i2++)
+    {
+        if (emu->I + i2 < CHIP8_MEMORY_SIZE)
+            emu->V[i2] = emu->memory[emu->I + i2];
+        else
+            print_warning("LD Vx, [I] out of memory bounds: I+%d=0x%03X", i2, emu->I + i2);
+    }
+    if (load_store_inc)
+        emu->I = (uint16_t)(emu->I + instr.x + 1);
+    emu->pc += 2;
+}
+
+/**
+ * @brief Handler for undefined 0xFX__ opcodes.
+ */
+static void handle_fxxx_unknown(chip8_t *emu, chip8_instr_t instr)
+{
+    print_warning("Unknown 0xF opcode: 0x%04X", instr.opcode);
+    emu->pc += 2;
+}
+
+/* --------------------------------------------------------------------------
+   QUIRK PROFILES - one specialized handler set per config_quirks_t
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Every quirk profile: config_quirks_t suffix, name, then the
+ *        shift_vy, load_store_inc, jump_vx and vf_reset quirks.
+ */
+#define CHIP8_QUIRK_PROFILES(X)                   \
+    X(MODERN, modern, false, false, false, false) \
+    X(VIP, vip, true, true, false, true)          \
+    X(SCHIP, schip, false, false, true, false)
+
+/**
+ * @brief Defines the quirk-dependent handlers of one profile, named
+ *        handle_<instruction>_<profile>.
+ */
+#define CHIP8_QUIRK_HANDLERS(id, name, shift_vy, load_store_inc, jump_vx, vf_reset) \
+    static void handle_or_vx_vy_##name(chip8_t *emu, chip8_instr_t instr)           \
+    {                                                                               \
+        or_vx_vy(emu, instr, vf_reset);                                             \
+    }                                                                               \
+    static void handle_and_vx_vy_##name(chip8_t *emu, chip8_instr_t instr)          \
+    {                                                                               \
+        and_vx_vy(emu, instr, vf_reset);                                            \
+    }                                                                               \
+    static void handle_xor_vx_vy_##name(chip8_t *emu, chip8_instr_t instr)          \
+    {                                                                               \
+        xor_vx_vy(emu, instr, vf_reset);                                            \
+    }                                                                               \
+    static void handle_shr_vx_##name(chip8_t *emu, chip8_instr_t instr)             \
+    {                                                                               \
+        shr_vx(emu, instr, shift_vy);                                               \
+    }                                                                               \
+    static void handle_shl_vx_##name(chip8_t *emu, chip8_instr_t instr)             \
+    {                                                                               \
+        shl_vx(emu, instr, shift_vy);                                               \
+    }                                                                               \
+    static void handle_jp_v0_nnn_##name(chip8_t *emu, chip8_instr_t instr)          \
+    {                                                                               \
+        jp_v0_nnn(emu, instr, jump_vx);                                             \
+    }                                                                               \
+    static void handle_ld_mem_vx_##name(chip8_t *emu, chip8_instr_t instr)          \
+    {                                                                               \
+        ld_mem_vx(emu, instr, load_store_inc);                                      \
+    }                                                                               \
+    static void handle_ld_vx_mem_##name(chip8_t *emu, chip8_instr_t instr)          \
+    {                                                                               \
+        ld_vx_mem(emu, instr, load_store_inc);                                      \
+    }
+
+CHIP8_QUIRK_PROFILES(CHIP8_QUIRK_HANDLERS)
+
+static const chip8_quirks_t quirk_profiles[CONFIG_QUIRKS_COUNT] = {
+#define CHIP8_QUIRK_INFO(id, name, shift_vy, load_store_inc, jump_vx, vf_reset)  \
+    [CONFIG_QUIRKS_##id] = {#name, shift_vy, load_store_inc, jump_vx, vf_reset},
+    CHIP8_QUIRK_PROFILES(CHIP8_QUIRK_INFO)
+#undef CHIP8_QUIRK_INFO
+};
+
+/* --------------------------------------------------------------------------
+   LEAF HANDLERS - one per chip8_op_t, one table per quirk profile
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief The op_handlers row of one profile: shared handlers plus the
+ *        profile's own instances of the quirk-dependent ones.
+ */
+#define CHIP8_OP_HANDLERS(id, name, shift_vy, load_store_inc, jump_vx, vf_reset) \
+    [CONFIG_QUIRKS_##id] = {                                                     \
+        [CHIP8_OP_CLS] = handle_cls,                                             \
+        [CHIP8_OP_RET] = handle_ret,                                             \
+        [CHIP8_OP_SYS] = handle_sys,                                             \
+        [CHIP8_OP_JP] = handle_jp,                                               \
+        [CHIP8_OP_CALL] = handle_call,                                           \
+        [CHIP8_OP_SE_VX_KK] = handle_se_vx_kk,                                   \
+        [CHIP8_OP_SNE_VX_KK] = handle_sne_vx_kk,                                 \
+        [CHIP8_OP_SE_VX_VY] = handle_se_vx_vy,                                   \
+        [CHIP8_OP_LD_VX_KK] = handle_ld_vx_kk,                                   \
+        [CHIP8_OP_ADD_VX_KK] = handle_add_vx_kk,                                 \
+        [CHIP8_OP_LD_VX_VY] = handle_ld_vx_vy,                                   \
+        [CHIP8_OP_OR_VX_VY] = handle_or_vx_vy_##name,                            \
+        [CHIP8_OP_AND_VX_VY] = handle_and_vx_vy_##name,                          \
+        [CHIP8_OP_XOR_VX_VY] = handle_xor_vx_vy_##name,                          \
+        [CHIP8_OP_ADD_VX_VY] = handle_add_vx_vy,                                 \
+        [CHIP8_OP_SUB_VX_VY] = handle_sub_vx_vy,                                 \
+        [CHIP8_OP_SHR_VX] = handle_shr_vx_##name,                                \
+        [CHIP8_OP_SUBN_VX_VY] = handle_subn_vx_vy,                               \
+        [CHIP8_OP_SHL_VX] = handle_shl_vx_##name,                                \
+        [CHIP8_OP_8XXX_UNKNOWN] = handle_8xxx_unknown,                           \
+        [CHIP8_OP_SNE_VX_VY] = handle_sne_vx_vy,                                 \
+        [CHIP8_OP_LD_I_NNN] = handle_ld_i_nnn,                                   \
+        [CHIP8_OP_JP_V0_NNN] = handle_jp_v0_nnn_##name,                          \
+        [CHIP8_OP_RND_VX_KK] = handle_rnd_vx_kk,                                 \
+        [CHIP8_OP_DRW] = handle_drw_vx_vy_n,                                     \
+        [CHIP8_OP_SKP_VX] = handle_skp_vx,                                       \
+        [CHIP8_OP_SKNP_VX] = handle_sknp_vx,                                     \
+        [CHIP8_OP_EXXX_UNKNOWN] = handle_exxx_unknown,                           \
+        [CHIP8_OP_LD_VX_DT] = handle_ld_vx_dt,                                   \
+        [CHIP8_OP_LD_VX_K] = handle_ld_vx_k,                                     \
+        [CHIP8_OP_LD_DT_VX] = handle_ld_dt_vx,                                   \
+        [CHIP8_OP_LD_ST_VX] = handle_ld_st_vx,                                   \
+        [CHIP8_OP_ADD_I_VX] = handle_add_i_vx,                                   \
+        [CHIP8_OP_LD_F_VX] = handle_ld_f_vx,                                     \
+        [CHIP8_OP_LD_B_VX] = handle_ld_b_vx,                                     \
+        [CHIP8_OP_LD_MEM_VX] = handle_ld_mem_vx_##name,                          \
+        [CHIP8_OP_LD_VX_MEM] = handle_ld_vx_mem_##name,                          \
+        [CHIP8_OP_FXXX_UNKNOWN] = handle_fxxx_unknown,                           \
+        [CHIP8_OP_SCD] = handle_scd,                                             \
+        [CHIP8_OP_SCR] = handle_scr,                                             \
+        [CHIP8_OP_SCL] = handle_scl,                                             \
+        [CHIP8_OP_EXIT] = handle_exit,                                           \
+        [CHIP8_OP_LOW] = handle_low,                                             \
+        [CHIP8_OP_HIGH] = handle_high,                                           \
+        [CHIP8_OP_DRW16] = handle_drw16,                                         \
+        [CHIP8_OP_LD_HF_VX] = handle_ld_hf_vx,                                   \
+        [CHIP8_OP_LD_R_VX] = handle_ld_r_vx,                                     \
+        [CHIP8_OP_LD_VX_R] = handle_ld_vx_r,                                     \
+    },
+
+static const chip8_opcode_handler_t op_handlers[CONFIG_QUIRKS_COUNT][CHIP8_OP_COUNT] = {
+    CHIP8_QUIRK_PROFILES(CHIP8_OP_HANDLERS)
+};
+
+const chip8_machine_t *chip8_machine_info(uint8_t machine)
+{
+    if (machine >= CONFIG_MACHINE_COUNT)
+        return &machines[CONFIG_MACHINE_CHIP8];
+    return &machines[machine];
+}
+
+const chip8_quirks_t *chip8_quirks_info(uint8_t quirks)
+{
+    if (quirks >= CONFIG_QUIRKS_COUNT)
+        return &quirk_profiles[CONFIG_QUIRKS_MODERN];
+    return &quirk_profiles[quirks];
+}
+
+chip8_op_t chip8_classify_opcode(uint16_t opcode, uint8_t machine)
+{
+    const bool extended = chip8_machine_info(machine)->extended;
+    static const uint8_t ops_8xxx[16] = {
+        [0x0] = CHIP8_OP_LD_VX_VY,
+        [0x1] = CHIP8_OP_OR_VX_VY,
+        [0x2] = CHIP8_OP_AND_VX_VY,
+        [0x3] = CHIP8_OP_XOR_VX_VY,
+        [0x4] = CHIP8_OP_ADD_VX_VY,
+        [0x5] = CHIP8_OP_SUB_VX_VY,
+        [0x6] = CHIP8_OP_SHR_VX,
+        [0x7] = CHIP8_OP_SUBN_VX_VY,
+        [0xE] = CHIP8_OP_SHL_VX,
+    };
+
+    switch (opcode >> 12)
+    {
+    case 0x0:
+        if (opcode == 0x00E0)
+            return CHIP8_OP_CLS;
+        if (opcode == 0x00EE)
+            return CHIP8_OP_RET;
+        if (extended)
+        {
+            if ((opcode & 0xFFF0) == 0x00C0)
+                return CHIP8_OP_SCD;
+            switch (opcode)
+            {
+            case 0x00FB:
+                return CHIP8_OP_SCR;
+            case 0x00FC:
+                return CHIP8_OP_SCL;
+            case 0x00FD:
+                return CHIP8_OP_EXIT;
+            case 0x00FE:
+                return CHIP8_OP_LOW;
+            case 0x00FF:
+                return CHIP8_OP_HIGH;
+            default:
+                break;
+            }
+        }
+        return CHIP8_OP_SYS;
+    case 0x1:
+        return CHIP8_OP_JP;
+    case 0x2:
+        return CHIP8_OP_CALL;
+    case 0x3:
+        return CHIP8_OP_SE_VX_KK;
+    case 0x4:
+        return CHIP8_OP_SNE_VX_KK;
+    case 0x5:
+        return CHIP8_OP_SE_VX_VY;
+    case 0x6:
+        return CHIP8_OP_LD_VX_KK;
+    case 0x7:
+        return CHIP8_OP_ADD_VX_KK;
+    case 0x8:
+    {
+        uint8_t op = ops_8xxx[opcode & 0x000F];
+        return op ? (chip8_op_t)op : CHIP8_OP_8XXX_UNKNOWN;
+    }
+    case 0x9:
+        return CHIP8_OP_SNE_VX_VY;
+    case 0xA:
+        return CHIP8_OP_LD_I_NNN;
+    case 0xB:
+        return CHIP8_OP_JP_V0_NNN;
+    case 0xC:
+        return CHIP8_OP_RND_VX_KK;
+    case 0xD:
+        return (extended && (opcode & 0x000F) == 0) ? CHIP8_OP_DRW16 : CHIP8_OP_DRW;
+    case 0xE:
+        switch (opcode & 0x00FF)
+        {
+        case 0x9E:
+            return CHIP8_OP_SKP_VX;
+        case 0xA1:
+            return CHIP8_OP_SKNP_VX;
+        default:
+            return CHIP8_OP_EXXX_UNKNOWN;
+        }
+    default: // 0xF
+        switch (opcode & 0x00FF)
+        {
+        case 0x07:
+            return CHIP8_OP_LD_VX_DT;
+        case 0x0A:
+            return CHIP8_OP_LD_VX_K;
+        case 0x15:
+            return CHIP8_OP_LD_DT_VX;
+        case 0x18:
+            return CHIP8_OP_LD_ST_VX;
+        case 0x1E:
+            return CHIP8_OP_ADD_I_VX;
+        case 0x29:
+            return CHIP8_OP_LD_F_VX;
+        case 0x30:
+            return extended ? CHIP8_OP_LD_HF_VX : CHIP8_OP_FXXX_UNKNOWN;
+        case 0x33:
+            return CHIP8_OP_LD_B_VX;
+        case 0x55:
+            return CHIP8_OP_LD_MEM_VX;
+        case 0x65:
+            return CHIP8_OP_LD_VX_MEM;
+        case 0x75:
+            return extended ? CHIP8_OP_LD_R_VX : CHIP8_OP_FXXX_UNKNOWN;
+        case 0x85:
+            return extended ? CHIP8_OP_LD_VX_R : CHIP8_OP_FXXX_UNKNOWN;
+        default:
+            return CHIP8_OP_FXXX_UNKNOWN;
+        }
+    }
+}
+
+const char *chip8_op_name(chip8_op_t op)
+{
+    static const char *const names[CHIP8_OP_COUNT] = {
+        [CHIP8_OP_UNDECODED] = "----",
+        [CHIP8_OP_CLS] = "00E0",
+        [CHIP8_OP_RET] = "00EE",
+        [CHIP8_OP_SYS] = "0NNN",
+        [CHIP8_OP_JP] = "1NNN",
+        [CHIP8_OP_CALL] = "2NNN",
+        [CHIP8_OP_SE_VX_KK] = "3XNN",
+        [CHIP8_OP_SNE_VX_KK] = "4XNN",
+        [CHIP8_OP_SE_VX_VY] = "5XY0",
+        [CHIP8_OP_LD_VX_KK] = "6XNN",
+        [CHIP8_OP_ADD_VX_KK] = "7XNN",
+        [CHIP8_OP_LD_VX_VY] = "8XY0",
+        [CHIP8_OP_OR_VX_VY] = "8XY1",
+        [CHIP8_OP_AND_VX_VY] = "8XY2",
+        [CHIP8_OP_XOR_VX_VY] = "8XY3",
+        [CHIP8_OP_ADD_VX_VY] = "8XY4",
+        [CHIP8_OP_SUB_VX_VY] = "8XY5",
+        [CHIP8_OP_SHR_VX] = "8XY6",
+        [CHIP8_OP_SUBN_VX_VY] = "8XY7",
+        [CHIP8_OP_SHL_VX] = "8XYE",
+        [CHIP8_OP_8XXX_UNKNOWN] = "8XY?",
+        [CHIP8_OP_SNE_VX_VY] = "9XY0",
+        [CHIP8_OP_LD_I_NNN] = "ANNN",
+        [CHIP8_OP_JP_V0_NNN] = "BNNN",
+        [CHIP8_OP_RND_VX_KK] = "CXNN",
+        [CHIP8_OP_DRW] = "DXYN",
+        [CHIP8_OP_SKP_VX] = "EX9E",
+        [CHIP8_OP_SKNP_VX] = "EXA1",
+        [CHIP8_OP_EXXX_UNKNOWN] = "EX??",
+        [CHIP8_OP_LD_VX_DT] = "FX07",
+        [CHIP8_OP_LD_VX_K] = "FX0A",
+        [CHIP8_OP_LD_DT_VX] = "FX15",
+        [CHIP8_OP_LD_ST_VX] = "FX18",
+        [CHIP8_OP_ADD_I_VX] = "FX1E",
+        [CHIP8_OP_LD_F_VX] = "FX29",
+        [CHIP8_OP_LD_B_VX] = "FX33",
+        [CHIP8_OP_LD_MEM_VX] = "FX55",
+        [CHIP8_OP_LD_VX_MEM] = "FX65",
+        [CHIP8_OP_FXXX_UNKNOWN] = "FX??",
+        [CHIP8_OP_SCD] = "00CN",
+        [CHIP8_OP_SCR] = "00FB",
+        [CHIP8_OP_SCL] = "00FC",
+        [CHIP8_OP_EXIT] = "00FD",
+        [CHIP8_OP_LOW] = "00FE",
+        [CHIP8_OP_HIGH] = "00FF",
+        [CHIP8_OP_DRW16] = "DXY0",
+        [CHIP8_OP_LD_HF_VX] = "FX30",
+        [CHIP8_OP_LD_R_VX] = "FX75",
+        [CHIP8_OP_LD_VX_R] = "FX85",
+    };
+
+    if ((unsigned)op >= CHIP8_OP_COUNT)
+        return "????";
+    return names[op];
+}
+
+/**
+ * @brief Sub-dispatch for 0x0___, 0x8XY_, 0xB___, 0xDXY_, 0xE___ and 0xF___ instructions.
+ *
+ * These are the groups whose meaning depends on the low bits, on the
+ * machine for the SUPER-CHIP additions, or on the quirk profile.
+ */
+static void handle_subgroup(chip8_t *emu, chip8_instr_t instr)
+{
+    op_handlers[emu->quirks][chip8_classify_opcode(instr.opcode, emu->machine)](emu, instr);
+}
+
+/* --------------------------------------------------------------------------
+   LOOKUP TABLE - DISPATCH by the high nibble
+   -------------------------------------------------------------------------- */
+
+static chip8_opcode_handler_t opcode_table[16] = {
+    [0x0] = handle_subgroup,    // 0xxx opcodes -> sub-dispatch
+    [0x1] = handle_jp,          // 0x1NNN
+    [0x2] = handle_call,        // 0x2NNN
+    [0x3] = handle_se_vx_kk,    // 0x3XNN
+    [0x4] = handle_sne_vx_kk,   // 0x4XNN
+    [0x5] = handle_se_vx_vy,    // 0x5XY0
+    [0x6] = handle_ld_vx_kk,    // 0x6XNN
+    [0x7] = handle_add_vx_kk,   // 0x7XNN
+    [0x8] = handle_subgroup,    // 0x8XY_ -> sub-dispatch
+    [0x9] = handle_sne_vx_vy,   // 0x9XY0
+    [0xA] = handle_ld_i_nnn,    // 0xANNN
+    [0xB] = handle_subgroup,    // 0xBNNN -> sub-dispatch (quirk profile)
+    [0xC] = handle_rnd_vx_kk,   // 0xCXNN
+    [0xD] = handle_subgroup,    // 0xDXYN / 0xDXY0 -> sub-dispatch
+    [0xE] = handle_subgroup,    // 0xEX__ -> sub-dispatch
+    [0xF] = handle_subgroup     // 0xFX__ -> sub-dispatch
+};
+
+/* --------------------------------------------------------------------------
+   Emulator Lifecycle
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Writes the fonts of the current machine into page 0.
+ */
+static void install_fonts(chip8_t *emu)
+{
+    memcpy(emu->memory, chip8_fontset, sizeof(chip8_fontset));
+    if (chip8_machine_info(emu->machine)->extended)
+        memcpy(&emu->memory[CHIP8_BIG_FONT_ADDR], chip8_big_fontset, sizeof(chip8_big_fontset));
+}
+
+bool chip8_init(chip8_t *emu)
+{
+    memset(emu, 0, sizeof(chip8_t));
+    emu->state = CHIP8_RUNNING;
+
+    // The first present must upload the whole (blank) screen
+    emu->dirty_rows = CHIP8_ALL_ROWS_DIRTY;
+
+    // No image is loaded yet, so the first chip8_reset() rebuilds everything
+    emu->dirty_pages = CHIP8_ALL_PAGES_DIRTY;
+
+    chip8_seed(emu, CHIP8_DEFAULT_SEED);
+
+    // Program counter starts at 0x200 (standard for most CHIP-8)
+    emu->pc = CHIP8_ROM_ENTRY_POINT;
+
+    // Load standard fontset into memory starting at 0x000
+    install_fonts(emu);
+
+    return true;
+}
+
+void chip8_set_machine(chip8_t *emu, uint8_t machine)
+{
+    emu->machine = machine < CONFIG_MACHINE_COUNT ? machine : CONFIG_MACHINE_CHIP8;
+
+    memset(emu->memory, 0, CHIP8_PAGE_SIZE);
+    install_fonts(emu);
+    set_resolution(emu, 0);
+    memset(emu->rpl, 0, sizeof(emu->rpl));
+
+    // Instructions are classified per machine
+    chip8_flush_decode_cache(emu);
+}
+
+bool chip8_load_program(chip8_t *emu, const char *filepath)
 {
     FILE *fp = fopen(filepath, "rb");
     if (!fp)
@@ -532,28 +1263,267 @@ bool chip8_load_program(chip8_t *emu, const char *filepath)
         return false;
     }
 
+    chip8_flush_decode_cache(emu);
+
     print_info("Loaded ROM: %s (%ld bytes)", filepath, file_size);
     return true;
 }
 
+bool chip8_load_buffer(chip8_t *emu, const uint8_t *data, size_t size)
+{
+    const size_t max_rom_size = CHIP8_MEMORY_SIZE - CHIP8_ROM_ENTRY_POINT;
+    if (size > max_rom_size)
+    {
+        print_warning("ROM too large: %zu bytes (max allowed: %zu bytes)", size, max_rom_size);
+        return false;
+    }
+
+    if (size)
+        memcpy(&emu->memory[CHIP8_ROM_ENTRY_POINT], data, size);
+    chip8_flush_decode_cache(emu);
+    return true;
+}
+
+/**
+ * @brief Rebuilds memory page @p page as chip8_init() plus a load of @p rom
+ *        would leave it: zeros, overlaid with the fontset and the image.
+ *
+ * Page 0 and 1 precede the program area and have no decode cache slots.
+ */
+static void reset_page(chip8_t *emu, unsigned page, const rom_image_t *rom)
+{
+    const size_t begin = (size_t)page << CHIP8_PAGE_SHIFT;
+    const size_t end = begin + CHIP8_PAGE_SIZE;
+    const size_t rom_end = CHIP8_ROM_ENTRY_POINT + rom->size;
+
+    memset(&emu->memory[begin], 0, CHIP8_PAGE_SIZE);
+
+    if (page == 0)
+        install_fonts(emu);
+
+    if (begin >= CHIP8_ROM_ENTRY_POINT)
+    {
+        if (begin < rom_end)
+            memcpy(&emu->memory[begin], &rom->data[begin - CHIP8_ROM_ENTRY_POINT],
+                   (rom_end < end ? rom_end : end) - begin);
+
+        memset(&emu->decode_cache[(begin - CHIP8_ROM_ENTRY_POINT) >> 1], 0,
+               (CHIP8_PAGE_SIZE / 2) * sizeof(chip8_decoded_t));
+    }
+}
+
+/**
+ * @brief Returns the pages an image of @p size bytes occupies from 0x200.
+ */
+static uint16_t rom_pages(size_t size)
+{
+    if (size == 0)
+        return 0;
+    unsigned first = CHIP8_ROM_ENTRY_POINT >> CHIP8_PAGE_SHIFT;
+    unsigned last = (unsigned)((CHIP8_ROM_ENTRY_POINT + size - 1) >> CHIP8_PAGE_SHIFT);
+    return (uint16_t)(((1u << (last + 1)) - 1) & ~((1u << first) - 1));
+}
+
+bool chip8_reset(chip8_t *emu, const rom_image_t *rom)
+{
+    const size_t max_rom_size = CHIP8_MEMORY_SIZE - CHIP8_ROM_ENTRY_POINT;
+    if (rom->size > max_rom_size)
+    {
+        print_warning("ROM too large: %zu bytes (max allowed: %zu bytes)", rom->size, max_rom_size);
+        return false;
+    }
+
+    // Switching images also rebuilds the pages either of them covers
+    uint32_t pages = emu->dirty_pages;
+    if (emu->rom_data != (uintptr_t)rom->data || emu->rom_size != rom->size)
+    {
+        pages |= rom_pages(emu->rom_size) | rom_pages(rom->size);
+        emu->code_hints = false;
+    }
+
+    for (unsigned page = 0; pages; page++, pages >>= 1)
+    {
+        if (pages & 1)
+            reset_page(emu, page, rom);
+    }
+
+    emu->rom_data = (uintptr_t)rom->data;
+    emu->rom_size = (uint16_t)rom->size;
+    emu->dirty_pages = 0;
+
+    // Registers and host state as chip8_init() leaves them
+    emu->timer_epoch = 0;
+    emu->timer_ticks = 0;
+    emu->idle_skipped = 0;
+    set_resolution(emu, 0);
+    emu->state = CHIP8_RUNNING;
+    memset(emu->stack, 0, sizeof(emu->stack));
+    emu->I = 0;
+    emu->pc = CHIP8_ROM_ENTRY_POINT;
+    emu->sp = 0;
+    emu->delay_timer = 0;
+    emu->sound_timer = 0;
+    emu->key_wait = 0;
+    emu->idle_wait = 0;
+    emu->idle_backoff = 0;
+    emu->events = 0;
+    memset(emu->V, 0, sizeof(emu->V));
+    memset(emu->rpl, 0, sizeof(emu->rpl));
+    emu->keys = 0;
+    memset(&emu->current_instr, 0, sizeof(emu->current_instr));
+
+    chip8_seed(emu, emu->seed);
+    return true;
+}
+
+void chip8_seed(chip8_t *emu, uint64_t seed)
+{
+    // splitmix64 spreads similar seeds apart and never yields a stuck state
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    emu->rng_state = z ? z : 0x9E3779B97F4A7C15ULL;
+    emu->seed = seed;
+}
+
+void chip8_snapshot(const chip8_t *emu, chip8_snapshot_t *snap)
+{
+    snap->rng_state = emu->rng_state;
+    snap->seed = emu->seed;
+    memcpy(snap->display, emu->display, sizeof(snap->display));
+    memcpy(snap->stack, emu->stack, sizeof(snap->stack));
+    snap->I = emu->I;
+    snap->pc = emu->pc;
+    snap->sp = emu->sp;
+    snap->delay_timer = emu->delay_timer;
+    snap->sound_timer = emu->sound_timer;
+    snap->key_wait = emu->key_wait;
+    memcpy(snap->V, emu->V, sizeof(snap->V));
+    memcpy(snap->rpl, emu->rpl, sizeof(snap->rpl));
+    snap->machine = emu->machine;
+    snap->hires = emu->hires;
+    memset(snap->reserved, 0, sizeof(snap->reserved));
+    memcpy(snap->memory, emu->memory, sizeof(snap->memory));
+}
+
+void chip8_restore(chip8_t *emu, const chip8_snapshot_t *snap)
+{
+    emu->rng_state = snap->rng_state;
+    emu->seed = snap->seed;
+    memcpy(emu->display, snap->display, sizeof(emu->display));
+    memcpy(emu->stack, snap->stack, sizeof(emu->stack));
+    emu->I = snap->I;
+    emu->pc = snap->pc;
+    emu->sp = snap->sp;
+    emu->delay_timer = snap->delay_timer;
+    emu->sound_timer = snap->sound_timer;
+    emu->key_wait = snap->key_wait;
+    memcpy(emu->V, snap->V, sizeof(emu->V));
+    memcpy(emu->rpl, snap->rpl, sizeof(emu->rpl));
+    emu->hires = snap->hires ? 1 : 0;
+
+    // The code hints survive if the snapshot holds the same instructions
+    bool hints = emu->code_hints;
+    for (unsigned addr = 0; hints && addr < CHIP8_MEMORY_SIZE; addr++)
+    {
+        if ((is_code(emu, (uint16_t)addr) || is_code(emu, (uint16_t)(addr - 1))) &&
+            snap->memory[addr] != emu->memory[addr])
+            hints = false;
+    }
+    memcpy(emu->memory, snap->memory, sizeof(emu->memory));
+
+    emu->dirty_rows = CHIP8_ALL_ROWS_DIRTY;
+    chip8_flush_decode_cache(emu);
+    emu->code_hints = hints;
+}
+
+void chip8_set_quirks(chip8_t *emu, uint8_t quirks)
+{
+    emu->quirks = quirks < CONFIG_QUIRKS_COUNT ? quirks : CONFIG_QUIRKS_MODERN;
+}
+
+const char *chip8_core_name(uint8_t core)
+{
+    return core_names[core < CONFIG_CORE_COUNT ? core : CONFIG_CORE_CACHED];
+}
+
+void chip8_set_core(chip8_t *emu, uint8_t core)
+{
+    emu->core = core < CONFIG_CORE_COUNT ? core : CONFIG_CORE_CACHED;
+}
+
+void chip8_flush_decode_cache(chip8_t *emu)
+{
+    memset(emu->decode_cache, 0, sizeof(emu->decode_cache));
+
+    // Whoever wrote memory behind the CPU's back may have touched any page
+    emu->dirty_pages = CHIP8_ALL_PAGES_DIRTY;
+    emu->code_hints = false;
+}
+
+void chip8_set_keys(chip8_t *emu, uint16_t held, uint16_t pressed)
+{
+    emu->keys = held;
+
+    if (emu->key_wait && pressed)
+    {
+        uint8_t key = 0;
+        while (!(pressed & (1u << key)))
+            key++;
+        emu->V[emu->key_wait & 0xF] = key;
+        emu->key_wait = 0;
+    }
+}
+
 void chip8_cycle(chip8_t *emu)
 {
+    // Halted in FX0A until chip8_set_keys() reports a press
+    if (emu->key_wait)
+        return;
+
     // Ensure PC is within memory bounds
     if (emu->pc + 1 >= CHIP8_MEMORY_SIZE)
     {
         print_error("Program Counter out of bounds: PC=0x%03X", emu->pc);
         emu->state = CHIP8_STOPPED;
+        emu->events |= CHIP8_EVENT_STOP;
         return;
     }
 
-    // Fetch 2 bytes from memory
+    // Fast path: program-area instructions are decoded once and cached
+    if (emu->core != CONFIG_CORE_TABLE && emu->pc >= CHIP8_ROM_ENTRY_POINT && !(emu->pc & 1))
+    {
+        chip8_decoded_t *entry = &emu->decode_cache[(emu->pc - CHIP8_ROM_ENTRY_POINT) >> 1];
+        if (entry->op == CHIP8_OP_UNDECODED)
+        {
+            uint16_t raw = (uint16_t)((emu->memory[emu->pc] << 8) | emu->memory[emu->pc + 1]);
+            entry->instr = chip8_decode_opcode(raw);
+            entry->op = (uint8_t)chip8_classify_opcode(raw, emu->machine);
+        }
+
+        emu->current_instr = entry->instr;
+
+#ifdef CHIP8_TRACE
+        if (emu->trace)
+            debug_log_instruction(emu);
+#endif
+
+        op_handlers[emu->quirks][entry->op](emu, entry->instr);
+        return;
+    }
+
+    // Slow path (odd or sub-0x200 PC, or the table core): fetch 2 bytes from memory
     uint16_t raw_opcode = (uint16_t)((emu->memory[emu->pc] << 8) | emu->memory[emu->pc + 1]);
 
     // Decode the opcode
-    emu->current_instr = decode_opcode(raw_opcode);
+    emu->current_instr = chip8_decode_opcode(raw_opcode);
 
+#ifdef CHIP8_TRACE
     // Log the decoded instruction for debugging
-    debug_log_instruction(emu);
+    if (emu->trace)
+        debug_log_instruction(emu);
+#endif
 
     // Dispatch to the appropriate handler based on the high nibble
     uint8_t high_nibble = (uint8_t)((emu->current_instr.opcode & 0xF000) >> 12);
@@ -568,52 +1538,864 @@ void chip8_cycle(chip8_t *emu)
     }
 }
 
+/* --------------------------------------------------------------------------
+   THREADED CORE - one function per batch, registers in locals
+   -------------------------------------------------------------------------- */
+
+/*
+ * GCC and Clang can jump through a table of label addresses, so every
+ * instruction body ends in its own indirect jump to the next one and no
+ * handler is called. Other compilers (or -DCHIP8_NO_COMPUTED_GOTO) get the
+ * same bodies as the cases of one switch, with the quirk-dependent
+ * instructions left to the shared handlers.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(CHIP8_NO_COMPUTED_GOTO)
+#define CHIP8_COMPUTED_GOTO
+#endif
+
+#ifdef CHIP8_COMPUTED_GOTO
+#define THREADED_OP(op) op_##op:
+#define THREADED_DEFAULT op_FALLBACK:
+#define THREADED_JUMP(next) goto *labels[(next)]
+#else
+#define THREADED_OP(op) case CHIP8_OP_##op:
+#define THREADED_DEFAULT default:
+#define THREADED_JUMP(next) \
+    do                      \
+    {                       \
+        op = (next);        \
+        goto dispatch;      \
+    } while (0)
+#endif
+
+/**
+ * @brief Ends an instruction body: leaves once the budget is spent,
+ *        otherwise fetches the instruction at pc and jumps to its body.
+ */
+#define THREADED_NEXT()                                                                        \
+    do                                                                                         \
+    {                                                                                          \
+        if (done == budget)                                                                    \
+            goto out;                                                                          \
+        done++;                                                                                \
+        if ((unsigned)(pc - CHIP8_ROM_ENTRY_POINT) >= 2 * CHIP8_DECODE_CACHE_SIZE || (pc & 1)) \
+            goto fetch_uncached;                                                               \
+        entry = &emu->decode_cache[(pc - CHIP8_ROM_ENTRY_POINT) >> 1];                         \
+        if (entry->op == CHIP8_OP_UNDECODED)                                                   \
+            goto fetch_fill;                                                                   \
+        in = entry->instr;                                                                     \
+        THREADED_JUMP(entry->op);                                                              \
+    } while (0)
+
+/**
+ * @brief The quirk-dependent instruction bodies of one profile, labelled
+ *        op_<class>_<profile>.
+ */
+#define THREADED_QUIRK_OPS(id, name, shift_vy, load_store_inc, jump_vx, vf_reset)        \
+    op_OR_VX_VY_##name:                                                                  \
+    V[in.x] |= V[in.y];                                                                  \
+    if (vf_reset)                                                                        \
+        V[0xF] = 0;                                                                      \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_AND_VX_VY_##name:                                                                 \
+    V[in.x] &= V[in.y];                                                                  \
+    if (vf_reset)                                                                        \
+        V[0xF] = 0;                                                                      \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_XOR_VX_VY_##name:                                                                 \
+    V[in.x] ^= V[in.y];                                                                  \
+    if (vf_reset)                                                                        \
+        V[0xF] = 0;                                                                      \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_SHR_VX_##name:                                                                    \
+    {                                                                                    \
+        uint8_t value = V[shift_vy ? in.y : in.x];                                       \
+        V[0xF] = value & 0x1;                                                            \
+        V[in.x] = (uint8_t)(value >> 1);                                                 \
+    }                                                                                    \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_SHL_VX_##name:                                                                    \
+    {                                                                                    \
+        uint8_t value = V[shift_vy ? in.y : in.x];                                       \
+        V[0xF] = (value & 0x80) >> 7;                                                    \
+        V[in.x] = (uint8_t)(value << 1);                                                 \
+    }                                                                                    \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_JP_V0_NNN_##name:                                                                 \
+    pc = (V[jump_vx ? in.x : 0] + in.nnn) & 0xFFF;                                       \
+    THREADED_NEXT();                                                                     \
+    op_LD_MEM_VX_##name:                                                                 \
+    for (int r = 0; r <= in.x; r++)                                                      \
+    {                                                                                    \
+        if (I + r < CHIP8_MEMORY_SIZE)                                                   \
+        {                                                                                \
+            emu->memory[I + r] = V[r];                                                   \
+            note_memory_write(emu, (uint16_t)(I + r));                                   \
+        }                                                                                \
+        else                                                                             \
+            print_warning("LD [I], Vx out of memory bounds: I+%d=0x%03X", r, I + r);     \
+    }                                                                                    \
+    if (load_store_inc)                                                                  \
+        I = (uint16_t)(I + in.x + 1);                                                    \
+    pc += 2;                                                                             \
+    THREADED_NEXT();                                                                     \
+    op_LD_VX_MEM_##name:                                                                 \
+    for (int r = 0; r <= in.x; r++)                                                      \
+    {                                                                                    \
+        if (I + r < CHIP8_MEMORY_SIZE)                                                   \
+            V[r] = emu->memory[I + r];                                                   \
+        else                                                                             \
+            print_warning("LD Vx, [I] out of memory bounds: I+%d=0x%03X", r, I + r);     \
+    }                                                                                    \
+    if (load_store_inc)                                                                  \
+        I = (uint16_t)(I + in.x + 1);                                                    \
+    pc += 2;                                                                             \
+    THREADED_NEXT();
+
+/**
+ * @brief The label table row of one profile: shared bodies, the
+ *        profile's quirk-dependent ones, and the shared handlers for the
+ *        display and seldom-used instructions.
+ */
+#define THREADED_LABELS(id, name, shift_vy, load_store_inc, jump_vx, vf_reset) \
+    [CONFIG_QUIRKS_##id] = {                                                   \
+        [CHIP8_OP_UNDECODED] = &&op_FALLBACK,                                  \
+        [CHIP8_OP_CLS] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_RET] = &&op_RET,                                             \
+        [CHIP8_OP_SYS] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_JP] = &&op_JP,                                               \
+        [CHIP8_OP_CALL] = &&op_CALL,                                           \
+        [CHIP8_OP_SE_VX_KK] = &&op_SE_VX_KK,                                   \
+        [CHIP8_OP_SNE_VX_KK] = &&op_SNE_VX_KK,                                 \
+        [CHIP8_OP_SE_VX_VY] = &&op_SE_VX_VY,                                   \
+        [CHIP8_OP_LD_VX_KK] = &&op_LD_VX_KK,                                   \
+        [CHIP8_OP_ADD_VX_KK] = &&op_ADD_VX_KK,                                 \
+        [CHIP8_OP_LD_VX_VY] = &&op_LD_VX_VY,                                   \
+        [CHIP8_OP_OR_VX_VY] = &&op_OR_VX_VY_##name,                            \
+        [CHIP8_OP_AND_VX_VY] = &&op_AND_VX_VY_##name,                          \
+        [CHIP8_OP_XOR_VX_VY] = &&op_XOR_VX_VY_##name,                          \
+        [CHIP8_OP_ADD_VX_VY] = &&op_ADD_VX_VY,                                 \
+        [CHIP8_OP_SUB_VX_VY] = &&op_SUB_VX_VY,                                 \
+        [CHIP8_OP_SHR_VX] = &&op_SHR_VX_##name,                                \
+        [CHIP8_OP_SUBN_VX_VY] = &&op_SUBN_VX_VY,                               \
+        [CHIP8_OP_SHL_VX] = &&op_SHL_VX_##name,                                \
+        [CHIP8_OP_8XXX_UNKNOWN] = &&op_FALLBACK,                               \
+        [CHIP8_OP_SNE_VX_VY] = &&op_SNE_VX_VY,                                 \
+        [CHIP8_OP_LD_I_NNN] = &&op_LD_I_NNN,                                   \
+        [CHIP8_OP_JP_V0_NNN] = &&op_JP_V0_NNN_##name,                          \
+        [CHIP8_OP_RND_VX_KK] = &&op_RND_VX_KK,                                 \
+        [CHIP8_OP_DRW] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_SKP_VX] = &&op_SKP_VX,                                       \
+        [CHIP8_OP_SKNP_VX] = &&op_SKNP_VX,                                     \
+        [CHIP8_OP_EXXX_UNKNOWN] = &&op_FALLBACK,                               \
+        [CHIP8_OP_LD_VX_DT] = &&op_LD_VX_DT,                                   \
+        [CHIP8_OP_LD_VX_K] = &&op_LD_VX_K,                                     \
+        [CHIP8_OP_LD_DT_VX] = &&op_LD_DT_VX,                                   \
+        [CHIP8_OP_LD_ST_VX] = &&op_LD_ST_VX,                                   \
+        [CHIP8_OP_ADD_I_VX] = &&op_ADD_I_VX,                                   \
+        [CHIP8_OP_LD_F_VX] = &&op_LD_F_VX,                                     \
+        [CHIP8_OP_LD_B_VX] = &&op_LD_B_VX,                                     \
+        [CHIP8_OP_LD_MEM_VX] = &&op_LD_MEM_VX_##name,                          \
+        [CHIP8_OP_LD_VX_MEM] = &&op_LD_VX_MEM_##name,                          \
+        [CHIP8_OP_FXXX_UNKNOWN] = &&op_FALLBACK,                               \
+        [CHIP8_OP_SCD] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_SCR] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_SCL] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_EXIT] = &&op_FALLBACK,                                       \
+        [CHIP8_OP_LOW] = &&op_FALLBACK,                                        \
+        [CHIP8_OP_HIGH] = &&op_FALLBACK,                                       \
+        [CHIP8_OP_DRW16] = &&op_FALLBACK,                                      \
+        [CHIP8_OP_LD_HF_VX] = &&op_LD_HF_VX,                                   \
+        [CHIP8_OP_LD_R_VX] = &&op_FALLBACK,                                    \
+        [CHIP8_OP_LD_VX_R] = &&op_FALLBACK,                                    \
+    },
+
+/**
+ * @brief Runs up to @p budget instructions in one function (CONFIG_CORE_THREADED).
+ *
+ * PC and I are kept in locals and only written back around the shared
+ * handlers and on exit. Instructions come from the decode cache as in
+ * chip8_cycle(), so stores stay coherent through note_memory_write().
+ * Stops after the first instruction that raises an event, like the
+ * stepping loop of chip8_run(); instruction counts, warnings and results
+ * match it exactly. The caller has checked that the CPU is running.
+ */
+static uint32_t run_threaded(chip8_t *emu, uint32_t budget)
+{
+#ifdef CHIP8_COMPUTED_GOTO
+    static const void *const profile_labels[CONFIG_QUIRKS_COUNT][CHIP8_OP_COUNT] = {
+        CHIP8_QUIRK_PROFILES(THREADED_LABELS)
+    };
+    const void *const *const labels = profile_labels[emu->quirks];
+#else
+    uint8_t op;
+#endif
+    uint8_t *const V = emu->V;
+    uint16_t pc = emu->pc;
+    uint16_t I = emu->I;
+    uint32_t done = 0;
+    chip8_decoded_t *entry;
+    chip8_decoded_t uncached;
+    chip8_instr_t in;
+
+    THREADED_NEXT();
+
+#ifndef CHIP8_COMPUTED_GOTO
+dispatch:
+    switch (op)
+    {
+#endif
+    THREADED_OP(RET)
+    if (emu->sp == 0)
+    {
+        print_warning("Stack underflow on RET");
+        emu->events |= CHIP8_EVENT_STACK;
+        pc += 2;
+        goto out;
+    }
+    pc = emu->stack[--emu->sp];
+    THREADED_NEXT();
+
+    THREADED_OP(JP)
+    pc = in.nnn;
+    THREADED_NEXT();
+
+    THREADED_OP(CALL)
+    if (emu->sp >= 16)
+    {
+        print_warning("Stack overflow on CALL 0x%03X", in.nnn);
+        emu->state = CHIP8_STOPPED;
+        emu->events |= CHIP8_EVENT_STACK | CHIP8_EVENT_STOP;
+        goto out;
+    }
+    emu->stack[emu->sp++] = pc + 2;
+    pc = in.nnn;
+    THREADED_NEXT();
+
+    THREADED_OP(SE_VX_KK)
+    pc += V[in.x] == in.kk ? 4 : 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SNE_VX_KK)
+    pc += V[in.x] != in.kk ? 4 : 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SE_VX_VY)
+    pc += V[in.x] == V[in.y] ? 4 : 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_VX_KK)
+    V[in.x] = in.kk;
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(ADD_VX_KK)
+    V[in.x] += in.kk;
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_VX_VY)
+    V[in.x] = V[in.y];
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(ADD_VX_VY)
+    {
+        uint16_t sum = V[in.x] + V[in.y];
+        V[0xF] = sum > 0xFF;
+        V[in.x] = (uint8_t)sum;
+    }
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SUB_VX_VY)
+    V[0xF] = V[in.x] >= V[in.y];
+    V[in.x] -= V[in.y];
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SUBN_VX_VY)
+    V[0xF] = V[in.y] >= V[in.x];
+    V[in.x] = V[in.y] - V[in.x];
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SNE_VX_VY)
+    pc += V[in.x] != V[in.y] ? 4 : 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_I_NNN)
+    I = in.nnn;
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(RND_VX_KK)
+    V[in.x] = next_random(emu) & in.kk;
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SKP_VX)
+    pc += (emu->keys & (1u << (V[in.x] & 0xF))) ? 4 : 2;
+    THREADED_NEXT();
+
+    THREADED_OP(SKNP_VX)
+    pc += (emu->keys & (1u << (V[in.x] & 0xF))) ? 2 : 4;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_VX_DT)
+    V[in.x] = emu->delay_timer;
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_VX_K)
+    emu->key_wait = (uint8_t)(CHIP8_KEY_WAIT | in.x);
+    emu->events |= CHIP8_EVENT_KEY_WAIT;
+    pc += 2;
+    goto out;
+
+    THREADED_OP(LD_DT_VX)
+    emu->delay_timer = V[in.x];
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_ST_VX)
+    pc += 2;
+    if ((emu->sound_timer != 0) != (V[in.x] != 0))
+    {
+        emu->sound_timer = V[in.x];
+        emu->events |= CHIP8_EVENT_SOUND;
+        goto out;
+    }
+    emu->sound_timer = V[in.x];
+    THREADED_NEXT();
+
+    THREADED_OP(ADD_I_VX)
+    I += V[in.x];
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_F_VX)
+    I = (uint16_t)(V[in.x] * 5);
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_HF_VX)
+    I = (uint16_t)(CHIP8_BIG_FONT_ADDR + (V[in.x] & 0xF) * 10);
+    pc += 2;
+    THREADED_NEXT();
+
+    THREADED_OP(LD_B_VX)
+    if (I + 2 < CHIP8_MEMORY_SIZE)
+    {
+        uint8_t value = V[in.x];
+        emu->memory[I + 0] = (uint8_t)(value / 100);
+        emu->memory[I + 1] = (uint8_t)((value / 10) % 10);
+        emu->memory[I + 2] = (uint8_t)(value % 10);
+        note_memory_write(emu, I);
+        note_memory_write(emu, (uint16_t)(I + 2));
+    }
+    else
+        print_warning("BCD write out of memory bounds: I=0x%03X", I);
+    pc += 2;
+    THREADED_NEXT();
+
+#ifdef CHIP8_COMPUTED_GOTO
+    CHIP8_QUIRK_PROFILES(THREADED_QUIRK_OPS)
+#endif
+
+    // Display, SUPER-CHIP control and undefined instructions
+    THREADED_DEFAULT
+    emu->pc = pc;
+    emu->I = I;
+    emu->current_instr = in;
+#ifdef CHIP8_COMPUTED_GOTO
+    op_handlers[emu->quirks][entry->op](emu, in);
+#else
+    op_handlers[emu->quirks][op](emu, in);
+#endif
+    pc = emu->pc;
+    I = emu->I;
+    if (emu->events)
+        goto out;
+    THREADED_NEXT();
+#ifndef CHIP8_COMPUTED_GOTO
+    }
+#endif
+
+fetch_fill:
+    entry->instr = chip8_decode_opcode((uint16_t)(emu->memory[pc] << 8 | emu->memory[pc + 1]));
+    entry->op = (uint8_t)chip8_classify_opcode(entry->instr.opcode, emu->machine);
+    in = entry->instr;
+    THREADED_JUMP(entry->op);
+
+fetch_uncached:
+    if (pc + 1 >= CHIP8_MEMORY_SIZE)
+    {
+        print_error("Program Counter out of bounds: PC=0x%03X", pc);
+        emu->state = CHIP8_STOPPED;
+        emu->events |= CHIP8_EVENT_STOP;
+        goto out;
+    }
+    entry = &uncached;
+    entry->instr = chip8_decode_opcode((uint16_t)(emu->memory[pc] << 8 | emu->memory[pc + 1]));
+    entry->op = (uint8_t)chip8_classify_opcode(entry->instr.opcode, emu->machine);
+    in = entry->instr;
+    THREADED_JUMP(entry->op);
+
+out:
+    emu->pc = pc;
+    emu->I = I;
+    return done;
+}
+
+/**
+ * @brief Maps the events of a finished batch to the reason it ended.
+ */
+static chip8_exit_t exit_reason_of(const chip8_t *emu)
+{
+    const uint8_t events = emu->events;
+
+    if (events & CHIP8_EVENT_STACK)
+        return CHIP8_EXIT_STACK_FAULT;
+    if ((events & CHIP8_EVENT_STOP) || emu->state != CHIP8_RUNNING)
+        return CHIP8_EXIT_STOPPED;
+    if (events & CHIP8_EVENT_KEY_WAIT)
+        return CHIP8_EXIT_KEY_WAIT;
+    if (events & CHIP8_EVENT_WATCH)
+        return CHIP8_EXIT_WATCHPOINT;
+    if (events & CHIP8_EVENT_SOUND)
+        return CHIP8_EXIT_SOUND;
+    if (events & CHIP8_EVENT_DRAW)
+        return CHIP8_EXIT_DRAW;
+    if (events & CHIP8_EVENT_BREAKPOINT)
+        return CHIP8_EXIT_BREAKPOINT;
+    return CHIP8_EXIT_BUDGET;
+}
+
+/**
+ * @brief Returns whether any breakpoint, watchpoint or condition is set.
+ */
+static inline bool debug_armed(const chip8_t *emu)
+{
+    return (emu->breakpoint_count | emu->watch_count | emu->condition_count) != 0;
+}
+
+/**
+ * @brief Evaluates one condition against the current registers.
+ */
+static bool condition_holds(const chip8_t *emu, const chip8_condition_t *cond)
+{
+    uint16_t lhs;
+    if (cond->reg < 16)
+        lhs = emu->V[cond->reg];
+    else if (cond->reg == CHIP8_COND_REG_I)
+        lhs = emu->I;
+    else if (cond->reg == CHIP8_COND_REG_DT)
+        lhs = emu->delay_timer;
+    else
+        lhs = emu->sound_timer;
+
+    switch ((chip8_cond_op_t)cond->op)
+    {
+    case CHIP8_COND_EQ:
+        return lhs == cond->value;
+    case CHIP8_COND_NE:
+        return lhs != cond->value;
+    case CHIP8_COND_LT:
+        return lhs < cond->value;
+    case CHIP8_COND_LE:
+        return lhs <= cond->value;
+    case CHIP8_COND_GT:
+        return lhs > cond->value;
+    case CHIP8_COND_GE:
+        return lhs >= cond->value;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns whether chip8_run() stops before the instruction at the PC.
+ *
+ * Conditions checked everywhere are re-armed while false, so they see
+ * every instruction even when a breakpoint stops first.
+ */
+static bool should_break(chip8_t *emu)
+{
+    bool hit = chip8_has_breakpoint(emu, emu->pc);
+
+    for (unsigned i = 0; i < emu->condition_count; i++)
+    {
+        chip8_condition_t *cond = &emu->conditions[i];
+        if (cond->addr == CHIP8_COND_ANY_ADDR)
+        {
+            bool holds = condition_holds(emu, cond);
+            hit |= holds && cond->armed;
+            cond->armed = !holds;
+        }
+        else if (cond->addr == emu->pc && !hit)
+        {
+            hit = condition_holds(emu, cond);
+        }
+    }
+    return hit;
+}
+
+uint32_t chip8_run(chip8_t *emu, uint32_t budget, chip8_exit_t *exit_reason)
+{
+    // A batch that stopped for the host left a bit set: resume past the PC
+    const bool resuming = emu->events & (CHIP8_EVENT_BREAKPOINT | CHIP8_EVENT_WATCH | CHIP8_EVENT_STEP);
+    uint32_t done = 0;
+    emu->events = 0;
+
+    if (emu->state != CHIP8_RUNNING)
+    {
+        *exit_reason = CHIP8_EXIT_STOPPED;
+        return 0;
+    }
+    if (emu->key_wait)
+    {
+        *exit_reason = CHIP8_EXIT_KEY_WAIT;
+        return 0;
+    }
+
+    if (debug_armed(emu))
+    {
+        for (; done < budget && !emu->events; done++)
+        {
+            if ((done || !resuming) && should_break(emu))
+            {
+                emu->events |= CHIP8_EVENT_BREAKPOINT;
+                break;
+            }
+            chip8_cycle(emu);
+        }
+    }
+    else
+    {
+        bool threaded = emu->core == CONFIG_CORE_THREADED;
+#ifdef CHIP8_TRACE
+        threaded = threaded && !emu->trace;
+#endif
+        if (threaded)
+            done = run_threaded(emu, budget);
+        else
+        {
+            for (; done < budget && !emu->events; done++)
+                chip8_cycle(emu);
+        }
+    }
+
+    *exit_reason = exit_reason_of(emu);
+    return done;
+}
+
+void chip8_set_breakpoint(chip8_t *emu, uint16_t addr, bool on)
+{
+    uint8_t *byte = &emu->breakpoints[(addr >> 3) & 0x1FF];
+    const uint8_t bit = (uint8_t)(1u << (addr & 7));
+
+    if (on && !(*byte & bit))
+        emu->breakpoint_count++;
+    else if (!on && (*byte & bit))
+        emu->breakpoint_count--;
+    *byte = on ? (uint8_t)(*byte | bit) : (uint8_t)(*byte & ~bit);
+}
+
+void chip8_clear_breakpoints(chip8_t *emu)
+{
+    memset(emu->breakpoints, 0, sizeof(emu->breakpoints));
+    emu->breakpoint_count = 0;
+}
+
+uint32_t chip8_step(chip8_t *emu, chip8_exit_t *exit_reason)
+{
+    emu->events = 0;
+    if (emu->state != CHIP8_RUNNING || emu->key_wait)
+    {
+        *exit_reason = emu->key_wait ? CHIP8_EXIT_KEY_WAIT : CHIP8_EXIT_STOPPED;
+        return 0;
+    }
+
+    chip8_cycle(emu);
+    *exit_reason = exit_reason_of(emu);
+    emu->events |= CHIP8_EVENT_STEP;
+    return 1;
+}
+
+void chip8_set_watchpoint(chip8_t *emu, uint16_t first, uint16_t last, bool on)
+{
+    for (unsigned addr = first; addr <= last && addr < CHIP8_MEMORY_SIZE; addr++)
+    {
+        uint8_t *byte = &emu->watchpoints[addr >> 3];
+        const uint8_t bit = (uint8_t)(1u << (addr & 7));
+
+        if (on && !(*byte & bit))
+            emu->watch_count++;
+        else if (!on && (*byte & bit))
+            emu->watch_count--;
+        *byte = on ? (uint8_t)(*byte | bit) : (uint8_t)(*byte & ~bit);
+    }
+}
+
+void chip8_clear_watchpoints(chip8_t *emu)
+{
+    memset(emu->watchpoints, 0, sizeof(emu->watchpoints));
+    emu->watch_count = 0;
+}
+
+bool chip8_add_condition(chip8_t *emu, uint16_t addr, uint8_t reg, chip8_cond_op_t op, uint16_t value)
+{
+    if (emu->condition_count == CHIP8_MAX_CONDITIONS || reg > CHIP8_COND_REG_ST || op > CHIP8_COND_GE)
+        return false;
+
+    emu->conditions[emu->condition_count++] = (chip8_condition_t){
+        .addr = addr == CHIP8_COND_ANY_ADDR ? addr : (uint16_t)(addr & 0xFFF),
+        .value = value,
+        .reg = reg,
+        .op = (uint8_t)op,
+        .armed = true,
+    };
+    return true;
+}
+
+void chip8_clear_conditions(chip8_t *emu)
+{
+    memset(emu->conditions, 0, sizeof(emu->conditions));
+    emu->condition_count = 0;
+}
+
+bool chip8_idle_safe(chip8_op_t op)
+{
+    // A loop of these changes nothing a later iteration can observe except
+    // through its registers
+    switch (op)
+    {
+    case CHIP8_OP_JP:
+    case CHIP8_OP_SE_VX_KK:
+    case CHIP8_OP_SNE_VX_KK:
+    case CHIP8_OP_SE_VX_VY:
+    case CHIP8_OP_LD_VX_KK:
+    case CHIP8_OP_ADD_VX_KK:
+    case CHIP8_OP_LD_VX_VY:
+    case CHIP8_OP_OR_VX_VY:
+    case CHIP8_OP_AND_VX_VY:
+    case CHIP8_OP_XOR_VX_VY:
+    case CHIP8_OP_ADD_VX_VY:
+    case CHIP8_OP_SUB_VX_VY:
+    case CHIP8_OP_SHR_VX:
+    case CHIP8_OP_SUBN_VX_VY:
+    case CHIP8_OP_SHL_VX:
+    case CHIP8_OP_SNE_VX_VY:
+    case CHIP8_OP_LD_I_NNN:
+    case CHIP8_OP_JP_V0_NNN:
+    case CHIP8_OP_SKP_VX:
+    case CHIP8_OP_SKNP_VX:
+    case CHIP8_OP_LD_VX_DT:
+    case CHIP8_OP_ADD_I_VX:
+    case CHIP8_OP_LD_F_VX:
+    case CHIP8_OP_LD_VX_MEM:
+    case CHIP8_OP_LD_HF_VX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Executes instructions looking for an idle loop at the current PC.
+ *
+ * @return Instructions executed plus, if a loop was found, the whole
+ *         iterations skipped; never more than @p budget.
+ */
+static uint32_t probe_idle(chip8_t *emu, uint32_t budget, chip8_idle_t *idle)
+{
+    const uint16_t start_pc = emu->pc;
+    const uint16_t start_i = emu->I;
+    const uint8_t start_sp = emu->sp;
+    uint8_t start_v[16];
+    memcpy(start_v, emu->V, sizeof(start_v));
+
+    bool reads_timer = false;
+    uint32_t executed = 0;
+    while (executed < budget && executed < CHIP8_IDLE_MAX_LOOP &&
+           emu->state == CHIP8_RUNNING && emu->pc + 1 < CHIP8_MEMORY_SIZE)
+    {
+        uint16_t opcode = (uint16_t)(emu->memory[emu->pc] << 8 | emu->memory[emu->pc + 1]);
+        chip8_op_t op = chip8_classify_opcode(opcode, emu->machine);
+        if (!chip8_idle_safe(op))
+            break;
+        reads_timer |= (op == CHIP8_OP_LD_VX_DT);
+
+        chip8_cycle(emu);
+        executed++;
+
+        if (emu->pc == start_pc && emu->I == start_i && emu->sp == start_sp &&
+            memcmp(emu->V, start_v, sizeof(start_v)) == 0)
+        {
+            // Every further iteration repeats this one exactly
+            uint32_t skipped = (budget - executed) / executed * executed;
+            emu->idle_skipped += skipped;
+            *idle = reads_timer ? CHIP8_IDLE_TIMER : CHIP8_IDLE_INPUT;
+            emu->idle_backoff = 0;
+            return executed + skipped;
+        }
+    }
+
+    // Busy code: probe less often the longer it stays busy
+    emu->idle_wait = emu->idle_backoff;
+    emu->idle_backoff = (uint8_t)(emu->idle_backoff ? emu->idle_backoff * 2 : 1);
+    if (emu->idle_backoff > CHIP8_IDLE_MAX_BACKOFF)
+        emu->idle_backoff = CHIP8_IDLE_MAX_BACKOFF;
+    return executed;
+}
+
+uint32_t chip8_run_until_tick(chip8_t *emu, uint32_t budget, chip8_idle_t *idle)
+{
+    uint32_t done = 0;
+    *idle = CHIP8_IDLE_NONE;
+
+    // The probe would step over breakpoints and watchpoints
+    if (emu->idle_wait > 0)
+        emu->idle_wait--;
+    else if (!emu->key_wait && !debug_armed(emu))
+    {
+        // Nothing left to resume past: forget a stop the host has since disarmed
+        emu->events = 0;
+
+        // No loop the probe accepts passes through analyzed code outside idle_map
+        if (!emu->code_hints || !is_code(emu, emu->pc) ||
+            ((emu->idle_map[(emu->pc >> 3) & 0x1FF] >> (emu->pc & 7)) & 1))
+            done = probe_idle(emu, budget, idle);
+    }
+
+    // Draws and sound switches do not end a slice
+    while (done < budget)
+    {
+        chip8_exit_t reason;
+        done += chip8_run(emu, budget - done, &reason);
+        if (emu->state != CHIP8_RUNNING || emu->key_wait || reason == CHIP8_EXIT_BREAKPOINT ||
+            reason == CHIP8_EXIT_WATCHPOINT)
+            break;
+    }
+    return done;
+}
+
+void chip8_set_code_hints(chip8_t *emu, const uint8_t *code_map, const uint8_t *idle_map)
+{
+    emu->code_hints = code_map && idle_map;
+    if (!emu->code_hints)
+        return;
+
+    memcpy(emu->code_map, code_map, sizeof(emu->code_map));
+    memcpy(emu->idle_map, idle_map, sizeof(emu->idle_map));
+
+    // Decode up front what the cache would otherwise fill in on first use
+    for (uint16_t addr = CHIP8_ROM_ENTRY_POINT; addr + 1 < CHIP8_MEMORY_SIZE; addr += 2)
+    {
+        if (!is_code(emu, addr))
+            continue;
+        chip8_decoded_t *entry = &emu->decode_cache[(addr - CHIP8_ROM_ENTRY_POINT) >> 1];
+        uint16_t raw = (uint16_t)((emu->memory[addr] << 8) | emu->memory[addr + 1]);
+        entry->instr = chip8_decode_opcode(raw);
+        entry->op = (uint8_t)chip8_classify_opcode(raw, emu->machine);
+    }
+}
+
 void chip8_timers_decrement(chip8_t *emu)
 {
     if (emu->delay_timer > 0)
         emu->delay_timer--;
 
     if (emu->sound_timer > 0)
-    {
-        // If not already playing a beep, start the beep sound
-        if (!audio_is_beep_playing())
-            audio_play_beep_loop();
-
         emu->sound_timer--;
-
-        // Stop the beep sound when the timer reaches zero
-        if (emu->sound_timer == 0)
-            audio_stop_beep();
-    }
 }
 
-void chip8_timers_tick_60hz(chip8_t *emu)
+unsigned chip8_timers_tick_60hz(chip8_t *emu)
 {
-    static uint64_t lastCount = 0;
     uint64_t now = SDL_GetPerformanceCounter();
     uint64_t freq = SDL_GetPerformanceFrequency();
 
-    if (lastCount == 0)
-        lastCount = now;
+    if (emu->timer_epoch == 0)
+        emu->timer_epoch = now;
 
-    double elapsed = (double)(now - lastCount) / (double)freq;
-    double interval = 1.0 / 60.0;
-
-    while (elapsed >= interval)
+    // Ticks due by now, from the start of the schedule rather than the last
+    // tick, so the truncated period is not added up tick after tick
+    uint64_t due = (now - emu->timer_epoch) * CONFIG_FRAME_RATE / freq;
+    unsigned delivered = 0;
+    while (emu->timer_ticks < due)
     {
         chip8_timers_decrement(emu);
-        elapsed -= interval;
-        lastCount += (uint64_t)(interval * freq);
+        emu->timer_ticks++;
+        delivered++;
+    }
+    return delivered;
+}
+
+uint64_t chip8_display_hash(const chip8_t *emu)
+{
+    const uint8_t *bytes = (const uint8_t *)emu->display;
+    const size_t size = display_words(emu) * sizeof(uint64_t);
+    uint64_t hash = 0xCBF29CE484222325ULL; // FNV-1a offset basis
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL; // FNV-1a prime
     }
+    return hash;
+}
+
+uint64_t chip8_memory_hash(const chip8_t *emu)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL; // FNV-1a offset basis
+    for (size_t i = 0; i < sizeof(emu->memory); i++)
+    {
+        hash ^= emu->memory[i];
+        hash *= 0x100000001B3ULL; // FNV-1a prime
+    }
+    return hash;
+}
+
+void chip8_trace_header(const chip8_t *emu, uint8_t out[CHIP8_TRACE_HEADER_SIZE])
+{
+    memset(out, 0, CHIP8_TRACE_HEADER_SIZE);
+    memcpy(out, CHIP8_TRACE_MAGIC, 8);
+    out[8] = CHIP8_TRACE_VERSION & 0xFF;
+    out[9] = CHIP8_TRACE_VERSION >> 8;
+    out[10] = CHIP8_TRACE_RECORD_SIZE & 0xFF;
+    out[11] = CHIP8_TRACE_RECORD_SIZE >> 8;
+    out[12] = emu->machine;
+    out[13] = emu->quirks;
+}
+
+void chip8_trace_record(const chip8_t *emu, uint8_t out[CHIP8_TRACE_RECORD_SIZE])
+{
+    const uint16_t words[3] = {emu->pc, emu->current_instr.opcode, emu->I};
+    for (int i = 0; i < 3; i++)
+    {
+        out[2 * i] = (uint8_t)(words[i] & 0xFF);
+        out[2 * i + 1] = (uint8_t)(words[i] >> 8);
+    }
+    out[6] = emu->sp;
+    out[7] = emu->delay_timer;
+    memcpy(&out[8], emu->V, sizeof(emu->V));
 }
 
 void debug_log_instruction(const chip8_t *emu)
 {
-    static bool debug_enabled = true;
-    if (!debug_enabled)
+    if (log_trace_active())
+    {
+        uint8_t record[CHIP8_TRACE_RECORD_SIZE];
+        chip8_trace_record(emu, record);
+        log_trace_write(record, sizeof(record));
         return;
+    }
 
     const chip8_instr_t *instr = &emu->current_instr;
-    print_debug("PC: 0x%03X | Opcode: 0x%04X | x: %X | y: %X | kk: 0x%02X | nnn: 0x%03X | n: %X | I: 0x%03X\n",
+    print_debug("PC: 0x%03X | Opcode: 0x%04X | x: %X | y: %X | kk: 0x%02X | nnn: 0x%03X | n: %X | I: 0x%03X",
                 emu->pc, instr->opcode, instr->x, instr->y, instr->kk, instr->nnn, instr->n, emu->I);
 }
@@ -4,45 +4,544 @@
  *
  * This file contains the definitions of functions used for logging
  * informational, warning, error, and timestamped messages to the CLI.
+ *
+ * Each logging thread owns a single-producer ring; the writer thread is
+ * the only consumer of all of them. Every message takes a number from one
+ * counter when its slot is reserved, and the writer writes the numbers in
+ * sequence, holding back while the next one is still being formatted, so
+ * messages come out in the order they were logged, across threads too.
  */
 
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // fileno()
+#endif
+
 #include "cli_logger.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <SDL2/SDL.h>
 
-void print_info(const char *format, ...)
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+/** @brief Ring slot kinds after the log levels. */
+enum
+{
+    LOG_KIND_TIMESTAMPED = LOG_LEVEL_ERROR + 1, /**< print_timestamped() */
+    LOG_KIND_TRACE,                             /**< log_trace_write() record */
+    LOG_KIND_NONE,                              /**< Formatting failed: nothing to write */
+};
+
+/**
+ * @struct log_slot_t
+ * @brief One queued message or trace record.
+ */
+typedef struct
+{
+    int seq;                 /**< Position in the global order, taken by ring_reserve() */
+    uint16_t len;            /**< Bytes in data */
+    uint8_t kind;            /**< log_level_t or LOG_KIND_* */
+    char data[LOG_LINE_MAX]; /**< Formatted text (not terminated) or record */
+} log_slot_t;
+
+/**
+ * @struct log_repeat_t
+ * @brief How often one warning was logged in the current second.
+ */
+typedef struct
+{
+    const char *format;  /**< Format string of the warning, or NULL */
+    time_t second;       /**< Second being counted */
+    uint32_t printed;    /**< Printed in that second */
+    uint32_t suppressed; /**< Not printed since the last report */
+} log_repeat_t;
+
+/**
+ * @struct log_ring_t
+ * @brief Per-thread logging state.
+ */
+typedef struct
+{
+    SDL_atomic_t head;                      /**< Next slot the writer reads */
+    SDL_atomic_t tail;                      /**< Next slot the owner fills */
+    log_repeat_t repeats[LOG_REPEAT_SLOTS]; /**< Owner only */
+    unsigned next_repeat;                   /**< Slot reused next, round robin */
+    log_slot_t slots[LOG_RING_SLOTS];       /**< Queued messages */
+} log_ring_t;
+
+static log_level_t g_log_level = LOG_LEVEL_DEBUG;
+
+static log_ring_t *g_rings[LOG_MAX_THREADS]; /**< Published with SDL_AtomicSetPtr() */
+static SDL_atomic_t g_ring_count;            /**< Rings handed out (may exceed LOG_MAX_THREADS) */
+static _Thread_local log_ring_t *t_ring;     /**< This thread's ring */
+static _Thread_local bool t_no_ring;         /**< No ring could be set up for this thread */
+
+static SDL_Thread *g_writer;   /**< Background writer, or NULL */
+static SDL_mutex *g_wake_lock; /**< Guards g_wake_pending */
+static SDL_cond *g_wake;       /**< Signalled when an empty ring gets a message */
+static bool g_wake_pending;    /**< The writer has been woken since it last looked */
+static SDL_atomic_t g_running; /**< 1 while messages are queued */
+static SDL_atomic_t g_queued;  /**< Messages and records queued so far */
+static SDL_atomic_t g_written; /**< Of those, written so far */
+
+static FILE *g_trace;      /**< Open trace file, or NULL */
+static bool g_trace_error; /**< A trace write failed */
+
+void set_log_level(log_level_t level)
+{
+    g_log_level = level;
+}
+
+/**
+ * @brief Wakes the writer thread, or makes its next wait return at once.
+ */
+static void wake_writer(void)
+{
+    SDL_LockMutex(g_wake_lock);
+    g_wake_pending = true;
+    SDL_CondSignal(g_wake);
+    SDL_UnlockMutex(g_wake_lock);
+}
+
+/**
+ * @brief Returns the calling thread's ring, creating it on first use.
+ */
+static log_ring_t *thread_ring(void)
+{
+    if (t_ring || t_no_ring)
+        return t_ring;
+
+    int index = SDL_AtomicAdd(&g_ring_count, 1);
+    log_ring_t *ring = index < LOG_MAX_THREADS ? calloc(1, sizeof(*ring)) : NULL;
+    if (!ring)
+    {
+        t_no_ring = true;
+        return NULL;
+    }
+    SDL_AtomicSetPtr((void **)&g_rings[index], ring);
+    t_ring = ring;
+    return ring;
+}
+
+/**
+ * @brief Returns whether ANSI colors should be used on @p stream.
+ */
+static bool use_color(FILE *stream)
+{
+    static int stdout_tty = -1;
+    static int stderr_tty = -1;
+
+    int *tty = stream == stderr ? &stderr_tty : &stdout_tty;
+    if (*tty < 0)
+        *tty = isatty(fileno(stream)) ? 1 : 0;
+    return *tty == 1;
+}
+
+/**
+ * @brief Writes one message with its level tag.
+ */
+static void write_line(uint8_t kind, const char *text, size_t len)
+{
+    static const struct
+    {
+        const char *tag;
+        const char *color;
+    } tags[] = {
+        [LOG_LEVEL_DEBUG] = {"[DEBUG] ", COLOR_DEBUG},
+        [LOG_LEVEL_INFO] = {"[INFO] ", COLOR_INFO},
+        [LOG_LEVEL_WARNING] = {"[WARNING] ", COLOR_WARNING},
+        [LOG_LEVEL_ERROR] = {"[ERROR] ", COLOR_ERROR},
+    };
+
+    if (kind == LOG_KIND_NONE)
+        return;
+    if (kind == LOG_KIND_TRACE)
+    {
+        if (g_trace && fwrite(text, 1, len, g_trace) != len)
+            g_trace_error = true;
+        return;
+    }
+    if (kind == LOG_KIND_TIMESTAMPED)
+    {
+        fprintf(stdout, "%.*s\n", (int)len, text);
+        return;
+    }
+
+    FILE *stream = kind >= LOG_LEVEL_WARNING ? stderr : stdout;
+    if (use_color(stream))
+        fprintf(stream, "%s%s" RESET_COLOR "%.*s\n", tags[kind].color, tags[kind].tag, (int)len, text);
+    else
+        fprintf(stream, "%s%.*s\n", tags[kind].tag, (int)len, text);
+}
+
+/**
+ * @brief Reserves the next slot of @p ring and numbers it, or returns NULL when it is full.
+ *
+ * Every reserved slot must be published: the writer waits for it before
+ * writing any later number.
+ */
+static log_slot_t *ring_reserve(log_ring_t *ring)
+{
+    unsigned tail = (unsigned)SDL_AtomicGet(&ring->tail);
+    if (tail - (unsigned)SDL_AtomicGet(&ring->head) >= LOG_RING_SLOTS)
+        return NULL;
+    log_slot_t *slot = &ring->slots[tail & (LOG_RING_SLOTS - 1)];
+    slot->seq = SDL_AtomicAdd(&g_queued, 1);
+    return slot;
+}
+
+/**
+ * @brief Reserves the next slot of @p ring, waiting for the writer while it is full.
+ *
+ * Nothing is dropped: a thread that logs faster than the output can take
+ * runs at the speed of the output, as it did when logging was synchronous.
+ */
+static log_slot_t *ring_wait(log_ring_t *ring)
+{
+    log_slot_t *slot;
+    while (!(slot = ring_reserve(ring)))
+    {
+        wake_writer();
+        SDL_Delay(0);
+    }
+    return slot;
+}
+
+/**
+ * @brief Hands the slot from ring_reserve() to the writer.
+ */
+static void ring_publish(log_ring_t *ring, log_slot_t *slot, uint8_t kind, size_t len)
+{
+    slot->kind = kind;
+    slot->len = (uint16_t)len;
+
+    // The writer sleeps once every ring is empty or the next number is
+    // missing; either way this ring was empty, so wake it for the first message
+    int tail = SDL_AtomicGet(&ring->tail);
+    SDL_AtomicSet(&ring->tail, (int)((unsigned)tail + 1));
+    if (tail == SDL_AtomicGet(&ring->head))
+        wake_writer();
+}
+
+/**
+ * @brief Queues or writes a message that passed the level and repeat checks.
+ */
+static void log_message(uint8_t kind, const char *format, va_list args)
+{
+    log_ring_t *ring = SDL_AtomicGet(&g_running) ? thread_ring() : NULL;
+    if (ring)
+    {
+        log_slot_t *slot = ring_wait(ring);
+        int len = vsnprintf(slot->data, sizeof(slot->data), format, args);
+        if (len < 0)
+        {
+            ring_publish(ring, slot, LOG_KIND_NONE, 0);
+            return;
+        }
+        ring_publish(ring, slot, kind, (size_t)len < sizeof(slot->data) ? (size_t)len : sizeof(slot->data) - 1);
+        return;
+    }
+
+    char text[LOG_LINE_MAX];
+    int len = vsnprintf(text, sizeof(text), format, args);
+    if (len >= 0)
+        write_line(kind, text, (size_t)len < sizeof(text) ? (size_t)len : sizeof(text) - 1);
+}
+
+/**
+ * @brief Formats and logs a message without further checks.
+ */
+static void log_format(uint8_t kind, const char *format, ...)
 {
     va_list args;
     va_start(args, format);
+    log_message(kind, format, args);
+    va_end(args);
+}
 
-    printf(COLOR_INFO "[INFO] " RESET_COLOR);
-    vprintf(format, args);
-    printf("\n");
+/**
+ * @brief Reports the warnings of @p repeat that were not printed.
+ */
+static void report_repeats(log_repeat_t *repeat)
+{
+    if (repeat->suppressed)
+        log_format(LOG_LEVEL_WARNING, "Suppressed %u more of: %s", repeat->suppressed, repeat->format);
+    repeat->suppressed = 0;
+}
 
-    va_end(args);
+/**
+ * @brief Returns whether a warning with @p format may be printed now.
+ *
+ * Keyed on the format string, so every call site is counted separately
+ * whatever its arguments.
+ */
+static bool allow_repeat(const char *format)
+{
+    log_ring_t *ring = thread_ring();
+    if (!ring)
+        return true;
+
+    time_t now = time(NULL);
+    log_repeat_t *repeat = NULL;
+    for (unsigned i = 0; i < LOG_REPEAT_SLOTS && !repeat; i++)
+    {
+        if (ring->repeats[i].format == format)
+            repeat = &ring->repeats[i];
+    }
+    if (!repeat)
+    {
+        repeat = &ring->repeats[ring->next_repeat];
+        ring->next_repeat = (ring->next_repeat + 1) % LOG_REPEAT_SLOTS;
+        if (repeat->format)
+            report_repeats(repeat);
+        *repeat = (log_repeat_t){format, now, 0, 0};
+    }
+
+    if (repeat->second != now)
+    {
+        report_repeats(repeat);
+        repeat->second = now;
+        repeat->printed = 0;
+    }
+    if (repeat->printed >= LOG_BURST)
+    {
+        repeat->suppressed++;
+        return false;
+    }
+    repeat->printed++;
+    return true;
 }
 
-void print_warning(const char *format, ...)
+/**
+ * @brief Writes the next message in the global order.
+ *
+ * @return false if every ring is empty, or the next message is reserved
+ *         but not yet published (its thread wakes the writer when it is).
+ */
+static bool write_next(void)
+{
+    int count = SDL_AtomicGet(&g_ring_count);
+    if (count > LOG_MAX_THREADS)
+        count = LOG_MAX_THREADS;
+
+    log_ring_t *oldest = NULL;
+    int oldest_seq = 0;
+    for (int i = 0; i < count; i++)
+    {
+        log_ring_t *ring = SDL_AtomicGetPtr((void **)&g_rings[i]);
+        if (!ring)
+            continue;
+        int head = SDL_AtomicGet(&ring->head);
+        if (head == SDL_AtomicGet(&ring->tail))
+            continue;
+        int seq = ring->slots[head & (LOG_RING_SLOTS - 1)].seq;
+        if (!oldest || (int)((unsigned)seq - (unsigned)oldest_seq) < 0)
+        {
+            oldest = ring;
+            oldest_seq = seq;
+        }
+    }
+    if (!oldest || oldest_seq != SDL_AtomicGet(&g_written))
+        return false;
+
+    int head = SDL_AtomicGet(&oldest->head);
+    const log_slot_t *slot = &oldest->slots[head & (LOG_RING_SLOTS - 1)];
+    write_line(slot->kind, slot->data, slot->len);
+    SDL_AtomicSet(&oldest->head, (int)((unsigned)head + 1));
+    SDL_AtomicAdd(&g_written, 1);
+    return true;
+}
+
+/**
+ * @brief Writer thread: drains the rings until log_stop().
+ */
+static int writer_main(void *unused)
 {
+    (void)unused;
+    for (;;)
+    {
+        while (write_next())
+            ;
+
+        // Idle: hand the output to the terminal before sleeping
+        fflush(stdout);
+        fflush(stderr);
+        if (!SDL_AtomicGet(&g_running))
+            break;
+
+        SDL_LockMutex(g_wake_lock);
+        if (!g_wake_pending)
+            SDL_CondWaitTimeout(g_wake, g_wake_lock, 100);
+        g_wake_pending = false;
+        SDL_UnlockMutex(g_wake_lock);
+    }
+    return 0;
+}
+
+/**
+ * @brief Frees the writer wakeup, either half of which may be missing.
+ */
+static void release_wake(void)
+{
+    SDL_DestroyCond(g_wake);
+    SDL_DestroyMutex(g_wake_lock);
+    g_wake = NULL;
+    g_wake_lock = NULL;
+}
+
+bool log_start(void)
+{
+    if (g_writer)
+        return true;
+
+    g_wake_lock = SDL_CreateMutex();
+    g_wake = SDL_CreateCond();
+    if (!g_wake_lock || !g_wake)
+    {
+        release_wake();
+        return false;
+    }
+
+    SDL_AtomicSet(&g_running, 1);
+    g_writer = SDL_CreateThread(writer_main, "chip8-log", NULL);
+    if (!g_writer)
+    {
+        SDL_AtomicSet(&g_running, 0);
+        release_wake();
+        return false;
+    }
+    return true;
+}
+
+void log_flush(void)
+{
+    if (g_writer)
+    {
+        int target = SDL_AtomicGet(&g_queued);
+        wake_writer();
+        while ((int)((unsigned)SDL_AtomicGet(&g_written) - (unsigned)target) < 0)
+            SDL_Delay(1);
+    }
+    fflush(stdout);
+    fflush(stderr);
+}
+
+void log_stop(void)
+{
+    int count = SDL_AtomicGet(&g_ring_count);
+    if (count > LOG_MAX_THREADS)
+        count = LOG_MAX_THREADS;
+
+    // The other threads are done: their counters can be read from here
+    for (int i = 0; i < count; i++)
+    {
+        log_ring_t *ring = SDL_AtomicGetPtr((void **)&g_rings[i]);
+        if (!ring)
+            continue;
+        for (unsigned r = 0; r < LOG_REPEAT_SLOTS; r++)
+        {
+            if (ring->repeats[r].format)
+                report_repeats(&ring->repeats[r]);
+        }
+    }
+
+    if (!log_trace_close())
+        print_error("Failed to write the trace file.");
+
+    if (g_writer)
+    {
+        SDL_AtomicSet(&g_running, 0);
+        wake_writer();
+        SDL_WaitThread(g_writer, NULL);
+        release_wake();
+        g_writer = NULL;
+    }
+    fflush(stdout);
+    fflush(stderr);
+}
+
+bool log_trace_open(const char *path, const void *header, size_t size)
+{
+    g_trace = fopen(path, "wb");
+    if (!g_trace)
+    {
+        print_error("Failed to open trace file: %s", path);
+        return false;
+    }
+    g_trace_error = fwrite(header, 1, size, g_trace) != size;
+    return !g_trace_error;
+}
+
+bool log_trace_active(void)
+{
+    return g_trace != NULL;
+}
+
+void log_trace_write(const void *record, size_t size)
+{
+    log_ring_t *ring = SDL_AtomicGet(&g_running) ? thread_ring() : NULL;
+    if (!ring)
+    {
+        if (g_trace && fwrite(record, 1, size, g_trace) != size)
+            g_trace_error = true;
+        return;
+    }
+
+    log_slot_t *slot = ring_wait(ring);
+    memcpy(slot->data, record, size);
+    ring_publish(ring, slot, LOG_KIND_TRACE, size);
+}
+
+bool log_trace_close(void)
+{
+    if (!g_trace)
+        return true;
+
+    log_flush();
+    bool ok = !g_trace_error;
+    ok = (fclose(g_trace) == 0) && ok;
+    g_trace = NULL;
+    return ok;
+}
+
+void print_info(const char *format, ...)
+{
+    if (g_log_level > LOG_LEVEL_INFO)
+        return;
+
     va_list args;
     va_start(args, format);
+    log_message(LOG_LEVEL_INFO, format, args);
+    va_end(args);
+}
 
-    printf(COLOR_WARNING "[WARNING] " RESET_COLOR);
-    vprintf(format, args);
-    printf("\n");
+void print_warning(const char *format, ...)
+{
+    if (g_log_level > LOG_LEVEL_WARNING || !allow_repeat(format))
+        return;
 
+    va_list args;
+    va_start(args, format);
+    log_message(LOG_LEVEL_WARNING, format, args);
     va_end(args);
 }
 
 void print_debug(const char *format, ...)
 {
+    if (g_log_level > LOG_LEVEL_DEBUG)
+        return;
+
     va_list args;
     va_start(args, format);
-
-    printf(COLOR_DEBUG "[DEBUG] " RESET_COLOR);
-    vprintf(format, args);
-    printf("\n");
-
+    log_message(LOG_LEVEL_DEBUG, format, args);
     va_end(args);
 }
 
@@ -50,11 +549,7 @@ void print_error(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-
-    printf(COLOR_ERROR "[ERROR] " RESET_COLOR);
-    vprintf(format, args);
-    printf("\n");
-
+    log_message(LOG_LEVEL_ERROR, format, args);
     va_end(args);
 }
 
@@ -68,9 +563,10 @@ void print_timestamped(const char *format, ...)
     char time_str[20];
     strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", t);
 
-    printf("[TIMESTAMP %s] ", time_str);
-    vprintf(format, args);
-    printf("\n");
+    char text[LOG_LINE_MAX];
+    int len = snprintf(text, sizeof(text), "[TIMESTAMP %s] ", time_str);
+    vsnprintf(text + len, sizeof(text) - (size_t)len, format, args);
+    log_format(LOG_KIND_TIMESTAMPED, "%s", text);
 
     va_end(args);
 }
@@ -31,16 +31,211 @@ void print_usage(const char *prog_name, bool to_stderr)
             "  -h, --height <height>      Window height (default: 320)\n"
             "  -s, --scale <scale>        Scale factor (default: 10)\n"
             "  -f, --fg <fg_color>        Foreground color (hex, default: 0xFFFFFFFF)\n"
-            "  -b, --bg <bg_color>        Background color (hex, default: 0x00000000)\n\n"
+            "  -b, --bg <bg_color>        Background color (hex, default: 0x00000000)\n"
+            "      --renderer <sdl|gl>    Presentation backend (default: sdl)\n"
+            "      --crt                  GL renderer: scanlines and vignette\n"
+            "      --ghost                GL renderer: let switched-off pixels fade out\n\n"
             "Options (Audio):\n"
             "  -A, --audio <on|off>       Enable or disable audio (default: on)\n"
-            "  -W, --wav <path>           Path to beep sound file (default: assets/beep.wav)\n"
-            "  -V, --vol <volume>         Set audio volume (0-128, default: 128)\n\n"
+            "  -V, --vol <volume>         Set audio volume (0-128, default: 128)\n"
+            "      --tone <hz>            Beep frequency (default: 440)\n"
+            "      --audio-buffer <n>     Audio buffer in samples, 64-4096 (default: 256)\n\n"
+            "Options (Input):\n"
+            "      --keymap <file>        Load key bindings (lines of '<chip8 key> <scancode name>')\n\n"
+            "Options (Emulation):\n"
+            "  -i, --ips <rate>           Instructions per second (default: 720)\n"
+            "  -c, --cycles-per-frame <n> Instructions per 60 Hz frame (default: 12)\n"
+            "      --machine <chip8|schip> Machine to emulate (default: chip8)\n"
+            "      --quirks <profile>     auto, vip, schip or modern (default: auto, see --quirks-db)\n"
+            "      --quirks-db <file>     Quirk database for auto (default: quirks.db next to the ROM)\n"
+            "      --core <engine>        CPU engine: cached, table or threaded (default: cached)\n"
+            "      --headless             Run without window or audio, unthrottled\n"
+            "      --max-cycles <n>       Headless instruction budget (default: 10000000)\n"
+            "      --dump-display         Headless: print the final display as ASCII\n"
+            "      --trace                Log every instruction (needs a TRACE=1 build)\n"
+            "      --trace-file <file>    Write the instruction trace to file in binary (implies --trace)\n"
+            "      --seed <n>             Random seed for CXNN (default: 1 headless, random otherwise)\n"
+            "      --profile              Report hot PCs, loops and instruction mix on exit\n"
+            "      --profile-out <file>   Also write the profile to file (.csv, else JSON)\n"
+            "      --stats <seconds>      Log IPS, frame rate and latency every few seconds (default: 0 = off)\n"
+            "      --metrics-out <file>   Write run metrics to file as JSON on exit\n"
+            "      --rewind <seconds>     Rewind history, hold Backspace to rewind (default: 10, 0 = off)\n"
+            "      --save-state <file>    Save the machine state to file on exit\n"
+            "      --load-state <file>    Resume from a saved state after loading the ROM\n"
+            "      --record <file>        Record every frame to file (convert with chip8-video)\n"
+            "      --record-input <file>  Log key input to file on exit, for --replay\n"
+            "      --replay <file>        Replay an input log headless and check its final hashes\n"
+            "      --expect-hash <hex>    Headless: fail unless the final display_hash matches\n\n"
+            "Options (Debugging):\n"
+            "      --break <addr,...>     Stop before the instructions at these (hex) addresses\n"
+            "      --watch <lo[-hi],...>  Stop after an instruction touches these addresses\n"
+            "      --break-if <cond,...>  Stop when a condition holds, e.g. V3==5 or 2A4:I>=0xF00\n"
+            "      --debug-port <port>    Serve debugger commands on 127.0.0.1:port (see README)\n\n"
             "Other Options:\n"
             "  -?, --help                 Show this help message and exit\n",
             prog_name);
 }
 
+/**
+ * @brief Converts an instructions-per-second rate into a per-frame batch size.
+ *
+ * The rate is rounded to the nearest whole number of instructions per frame
+ * and never drops below one.
+ */
+static uint32_t ips_to_cycles_per_frame(long ips)
+{
+    if (ips < CONFIG_FRAME_RATE)
+        return 1;
+    return (uint32_t)((ips + CONFIG_FRAME_RATE / 2) / CONFIG_FRAME_RATE);
+}
+
+/**
+ * @brief Parses a strictly positive cycle count, falling back to the default.
+ */
+static uint32_t parse_cycles_per_frame(const char *value)
+{
+    int cycles = atoi(value);
+    if (cycles <= 0)
+    {
+        print_warning("Invalid cycles per frame '%s', using %d.", value, CONFIG_DEFAULT_CYCLES_PER_FRAME);
+        return CONFIG_DEFAULT_CYCLES_PER_FRAME;
+    }
+    return (uint32_t)cycles;
+}
+
+/**
+ * @brief Parses a --renderer name, falling back to the SDL renderer.
+ */
+static uint8_t parse_renderer(const char *value)
+{
+    if (strcmp(value, "gl") == 0)
+        return CONFIG_RENDERER_GL;
+    if (strcmp(value, "sdl") != 0)
+        print_warning("Unknown renderer '%s', using sdl.", value);
+    return CONFIG_RENDERER_SDL;
+}
+
+/**
+ * @brief Parses a --machine name, falling back to the original CHIP-8.
+ */
+static uint8_t parse_machine(const char *value)
+{
+    if (strcmp(value, "schip") == 0)
+        return CONFIG_MACHINE_SCHIP;
+    if (strcmp(value, "chip8") != 0)
+        print_warning("Unknown machine '%s', using chip8.", value);
+    return CONFIG_MACHINE_CHIP8;
+}
+
+/**
+ * @brief Parses a --quirks profile name, falling back to auto.
+ */
+static uint8_t parse_quirks(const char *value)
+{
+    if (strcmp(value, "vip") == 0)
+        return CONFIG_QUIRKS_VIP;
+    if (strcmp(value, "schip") == 0)
+        return CONFIG_QUIRKS_SCHIP;
+    if (strcmp(value, "modern") == 0)
+        return CONFIG_QUIRKS_MODERN;
+    if (strcmp(value, "auto") != 0)
+        print_warning("Unknown quirk profile '%s', using auto.", value);
+    return CONFIG_QUIRKS_AUTO;
+}
+
+/**
+ * @brief Parses a --core engine name, falling back to the decode cache.
+ */
+static uint8_t parse_core(const char *value)
+{
+    if (strcmp(value, "table") == 0)
+        return CONFIG_CORE_TABLE;
+    if (strcmp(value, "threaded") == 0)
+        return CONFIG_CORE_THREADED;
+    if (strcmp(value, "cached") != 0)
+        print_warning("Unknown core '%s', using cached.", value);
+    return CONFIG_CORE_CACHED;
+}
+
+/**
+ * @brief Parses a beep frequency, falling back to the default outside 20 Hz - 20 kHz.
+ */
+static int parse_tone(const char *value)
+{
+    int hz = atoi(value);
+    if (hz < 20 || hz > 20000)
+    {
+        print_warning("Invalid tone '%s' Hz, using %d.", value, CONFIG_DEFAULT_TONE_HZ);
+        return CONFIG_DEFAULT_TONE_HZ;
+    }
+    return hz;
+}
+
+/**
+ * @brief Parses an audio buffer size, rounded up to the power of two SDL expects.
+ */
+static int parse_audio_buffer(const char *value)
+{
+    int samples = atoi(value);
+    if (samples < 64 || samples > 4096)
+    {
+        print_warning("Invalid audio buffer '%s', using %d samples.", value, CONFIG_DEFAULT_AUDIO_BUFFER);
+        return CONFIG_DEFAULT_AUDIO_BUFFER;
+    }
+
+    int pow2 = 64;
+    while (pow2 < samples)
+        pow2 <<= 1;
+    return pow2;
+}
+
+/**
+ * @brief Appends @p value to the comma-separated list @p list, so a
+ *        repeated option adds to the earlier ones.
+ */
+static void append_list(char *list, size_t size, const char *value)
+{
+    size_t used = strlen(list);
+    if (used + (used ? 1 : 0) + strlen(value) >= size)
+    {
+        print_warning("Too many debugger entries, ignoring '%s'.", value);
+        return;
+    }
+    if (used)
+        list[used++] = ',';
+    strcpy(list + used, value);
+}
+
+/**
+ * @brief Parses a --debug-port number, 0 (off) when out of range.
+ */
+static uint16_t parse_debug_port(const char *value)
+{
+    long port = strtol(value, NULL, 10);
+    if (port <= 0 || port > 65535)
+    {
+        print_warning("Invalid debug port '%s', debugger port disabled.", value);
+        return 0;
+    }
+    return (uint16_t)port;
+}
+
+/**
+ * @brief Parses a --rewind length, 0 (off) when it is not a number of seconds in range.
+ */
+static uint32_t parse_rewind_seconds(const char *value)
+{
+    char *end;
+    unsigned long seconds = strtoul(value, &end, 10); // Negative and too large both end up above the limit
+    if (end == value || *end != '\0' || seconds > CONFIG_MAX_REWIND_SECONDS)
+    {
+        print_warning("Invalid rewind length '%s' (0 to %u seconds), rewind disabled.", value,
+                      CONFIG_MAX_REWIND_SECONDS);
+        return 0;
+    }
+    return (uint32_t)seconds;
+}
+
 /* Forward declarations of OS-specific parse logic */
 #ifdef _WIN32
 static bool parse_config_windows(app_config_t *config, int argc, char *argv[]);
@@ -56,13 +251,46 @@ bool parse_config(app_config_t *config, int argc, char *argv[])
     config->display_cfg.fg_color = CONFIG_DEFAULT_FG_COLOR;
     config->display_cfg.bg_color = CONFIG_DEFAULT_BG_COLOR;
     config->display_cfg.scale_factor = CONFIG_DEFAULT_SCALE_FACTOR;
+    config->display_cfg.renderer = CONFIG_RENDERER_SDL;
+    config->display_cfg.crt = false;
+    config->display_cfg.ghost = false;
 
     // Initialize default audio
     config->audio_cfg.enabled = true;
-    strncpy(config->audio_cfg.wav_path, CONFIG_DEFAULT_WAV_PATH,
-            sizeof(config->audio_cfg.wav_path) - 1);
-    config->audio_cfg.wav_path[sizeof(config->audio_cfg.wav_path) - 1] = '\0';
     config->audio_cfg.volume = CONFIG_DEFAULT_VOLUME;
+    config->audio_cfg.tone_hz = CONFIG_DEFAULT_TONE_HZ;
+    config->audio_cfg.buffer_samples = CONFIG_DEFAULT_AUDIO_BUFFER;
+
+    // Initialize default emulation
+    config->emu_cfg.cycles_per_frame = CONFIG_DEFAULT_CYCLES_PER_FRAME;
+    config->emu_cfg.machine = CONFIG_MACHINE_CHIP8;
+    config->emu_cfg.quirks = CONFIG_QUIRKS_AUTO;
+    config->emu_cfg.quirks_db[0] = '\0';
+    config->emu_cfg.core = CONFIG_CORE_CACHED;
+    config->emu_cfg.headless = false;
+    config->emu_cfg.dump_display = false;
+    config->emu_cfg.trace = false;
+    config->emu_cfg.trace_file[0] = '\0';
+    config->emu_cfg.seed = 0;
+    config->emu_cfg.seed_set = false;
+    config->emu_cfg.profile = false;
+    config->emu_cfg.profile_out[0] = '\0';
+    config->emu_cfg.stats_seconds = 0;
+    config->emu_cfg.metrics_out[0] = '\0';
+    config->emu_cfg.rewind_seconds = CONFIG_DEFAULT_REWIND_SECONDS;
+    config->emu_cfg.save_state[0] = '\0';
+    config->emu_cfg.load_state[0] = '\0';
+    config->emu_cfg.record_path[0] = '\0';
+    config->emu_cfg.record_input[0] = '\0';
+    config->emu_cfg.replay_path[0] = '\0';
+    config->emu_cfg.expect_hash = 0;
+    config->emu_cfg.expect_hash_set = false;
+    config->emu_cfg.breakpoints[0] = '\0';
+    config->emu_cfg.watchpoints[0] = '\0';
+    config->emu_cfg.conditions[0] = '\0';
+    config->emu_cfg.debug_port = 0;
+    config->input_cfg.keymap_path[0] = '\0';
+    config->emu_cfg.max_cycles = CONFIG_DEFAULT_MAX_CYCLES;
 
     // ROM path default
     config->rom_path[0] = '\0';
@@ -135,6 +363,18 @@ static bool parse_config_windows(app_config_t *config, int argc, char *argv[])
         {
             config->display_cfg.bg_color = strtoul(argv[++g_win_optind], NULL, 16);
         }
+        else if (strcmp(arg, "--renderer") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->display_cfg.renderer = parse_renderer(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--crt") == 0)
+        {
+            config->display_cfg.crt = true;
+        }
+        else if (strcmp(arg, "--ghost") == 0)
+        {
+            config->display_cfg.ghost = true;
+        }
         // Audio flags
         else if ((strcmp(arg, "-A") == 0 || strcmp(arg, "--audio") == 0) && (g_win_optind + 1 < argc))
         {
@@ -146,9 +386,16 @@ static bool parse_config_windows(app_config_t *config, int argc, char *argv[])
         }
         else if ((strcmp(arg, "-W") == 0 || strcmp(arg, "--wav") == 0) && (g_win_optind + 1 < argc))
         {
-            strncpy(config->audio_cfg.wav_path, argv[++g_win_optind],
-                    sizeof(config->audio_cfg.wav_path) - 1);
-            config->audio_cfg.wav_path[sizeof(config->audio_cfg.wav_path) - 1] = '\0';
+            g_win_optind++;
+            print_warning("-W/--wav is ignored: the beep is synthesized (see --tone).");
+        }
+        else if (strcmp(arg, "--tone") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->audio_cfg.tone_hz = parse_tone(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--audio-buffer") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->audio_cfg.buffer_samples = parse_audio_buffer(argv[++g_win_optind]);
         }
         else if ((strcmp(arg, "-V") == 0 || strcmp(arg, "--vol") == 0) && (g_win_optind + 1 < argc))
         {
@@ -159,6 +406,144 @@ static bool parse_config_windows(app_config_t *config, int argc, char *argv[])
                 vol = 128;
             config->audio_cfg.volume = vol;
         }
+        // Emulation flags
+        else if ((strcmp(arg, "-i") == 0 || strcmp(arg, "--ips") == 0) && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.cycles_per_frame = ips_to_cycles_per_frame(atol(argv[++g_win_optind]));
+        }
+        else if ((strcmp(arg, "-c") == 0 || strcmp(arg, "--cycles-per-frame") == 0) && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.cycles_per_frame = parse_cycles_per_frame(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--machine") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.machine = parse_machine(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--quirks") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.quirks = parse_quirks(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--quirks-db") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.quirks_db, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.quirks_db) - 1);
+            config->emu_cfg.quirks_db[sizeof(config->emu_cfg.quirks_db) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--core") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.core = parse_core(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--headless") == 0)
+        {
+            config->emu_cfg.headless = true;
+        }
+        else if (strcmp(arg, "--max-cycles") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.max_cycles = strtoull(argv[++g_win_optind], NULL, 10);
+        }
+        else if (strcmp(arg, "--dump-display") == 0)
+        {
+            config->emu_cfg.dump_display = true;
+        }
+        else if (strcmp(arg, "--trace") == 0)
+        {
+            config->emu_cfg.trace = true;
+        }
+        else if (strcmp(arg, "--trace-file") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.trace_file, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.trace_file) - 1);
+            config->emu_cfg.trace_file[sizeof(config->emu_cfg.trace_file) - 1] = '\0';
+            config->emu_cfg.trace = true;
+        }
+        else if (strcmp(arg, "--seed") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.seed = strtoull(argv[++g_win_optind], NULL, 0);
+            config->emu_cfg.seed_set = true;
+        }
+        else if (strcmp(arg, "--profile") == 0)
+        {
+            config->emu_cfg.profile = true;
+        }
+        else if (strcmp(arg, "--profile-out") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.profile_out, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.profile_out) - 1);
+            config->emu_cfg.profile_out[sizeof(config->emu_cfg.profile_out) - 1] = '\0';
+            config->emu_cfg.profile = true;
+        }
+        else if (strcmp(arg, "--stats") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.stats_seconds = (uint32_t)atoi(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--metrics-out") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.metrics_out, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.metrics_out) - 1);
+            config->emu_cfg.metrics_out[sizeof(config->emu_cfg.metrics_out) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--rewind") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.rewind_seconds = parse_rewind_seconds(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--save-state") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.save_state, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.save_state) - 1);
+            config->emu_cfg.save_state[sizeof(config->emu_cfg.save_state) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--load-state") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.load_state, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.load_state) - 1);
+            config->emu_cfg.load_state[sizeof(config->emu_cfg.load_state) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--record") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.record_path, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.record_path) - 1);
+            config->emu_cfg.record_path[sizeof(config->emu_cfg.record_path) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--record-input") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.record_input, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.record_input) - 1);
+            config->emu_cfg.record_input[sizeof(config->emu_cfg.record_input) - 1] = '\0';
+        }
+        else if (strcmp(arg, "--replay") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->emu_cfg.replay_path, argv[++g_win_optind],
+                    sizeof(config->emu_cfg.replay_path) - 1);
+            config->emu_cfg.replay_path[sizeof(config->emu_cfg.replay_path) - 1] = '\0';
+            config->emu_cfg.headless = true;
+        }
+        else if (strcmp(arg, "--expect-hash") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.expect_hash = strtoull(argv[++g_win_optind], NULL, 16);
+            config->emu_cfg.expect_hash_set = true;
+        }
+        else if (strcmp(arg, "--break") == 0 && (g_win_optind + 1 < argc))
+        {
+            append_list(config->emu_cfg.breakpoints, sizeof(config->emu_cfg.breakpoints), argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--watch") == 0 && (g_win_optind + 1 < argc))
+        {
+            append_list(config->emu_cfg.watchpoints, sizeof(config->emu_cfg.watchpoints), argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--break-if") == 0 && (g_win_optind + 1 < argc))
+        {
+            append_list(config->emu_cfg.conditions, sizeof(config->emu_cfg.conditions), argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--debug-port") == 0 && (g_win_optind + 1 < argc))
+        {
+            config->emu_cfg.debug_port = parse_debug_port(argv[++g_win_optind]);
+        }
+        else if (strcmp(arg, "--keymap") == 0 && (g_win_optind + 1 < argc))
+        {
+            strncpy(config->input_cfg.keymap_path, argv[++g_win_optind],
+                    sizeof(config->input_cfg.keymap_path) - 1);
+            config->input_cfg.keymap_path[sizeof(config->input_cfg.keymap_path) - 1] = '\0';
+        }
         // Unknown or leftover
         else if (arg[0] == '-')
         {
@@ -204,6 +589,43 @@ static bool parse_config_windows(app_config_t *config, int argc, char *argv[])
 /*-----------------------------------------------------------
  *   UNIX-SPECIFIC PARSER (getopt_long)
  *----------------------------------------------------------*/
+
+/* Values for long options that have no single-character equivalent */
+enum
+{
+    OPT_HEADLESS = 256,
+    OPT_MAX_CYCLES,
+    OPT_DUMP_DISPLAY,
+    OPT_TRACE,
+    OPT_TRACE_FILE,
+    OPT_SEED,
+    OPT_PROFILE,
+    OPT_PROFILE_OUT,
+    OPT_STATS,
+    OPT_METRICS_OUT,
+    OPT_REWIND,
+    OPT_SAVE_STATE,
+    OPT_LOAD_STATE,
+    OPT_RECORD,
+    OPT_KEYMAP,
+    OPT_RENDERER,
+    OPT_CRT,
+    OPT_GHOST,
+    OPT_RECORD_INPUT,
+    OPT_REPLAY,
+    OPT_EXPECT_HASH,
+    OPT_TONE,
+    OPT_AUDIO_BUFFER,
+    OPT_MACHINE,
+    OPT_QUIRKS,
+    OPT_QUIRKS_DB,
+    OPT_CORE,
+    OPT_BREAK,
+    OPT_WATCH,
+    OPT_BREAK_IF,
+    OPT_DEBUG_PORT,
+};
+
 static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
 {
     static struct option long_opts[] = {
@@ -213,11 +635,50 @@ static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
         {"scale", required_argument, NULL, 's'},
         {"fg", required_argument, NULL, 'f'},
         {"bg", required_argument, NULL, 'b'},
+        {"renderer", required_argument, NULL, OPT_RENDERER},
+        {"crt", no_argument, NULL, OPT_CRT},
+        {"ghost", no_argument, NULL, OPT_GHOST},
 
         // Audio
         {"audio", required_argument, NULL, 'A'},
         {"wav", required_argument, NULL, 'W'},
         {"vol", required_argument, NULL, 'V'},
+        {"tone", required_argument, NULL, OPT_TONE},
+        {"audio-buffer", required_argument, NULL, OPT_AUDIO_BUFFER},
+
+        // Input
+        {"keymap", required_argument, NULL, OPT_KEYMAP},
+
+        // Emulation
+        {"ips", required_argument, NULL, 'i'},
+        {"cycles-per-frame", required_argument, NULL, 'c'},
+        {"machine", required_argument, NULL, OPT_MACHINE},
+        {"quirks", required_argument, NULL, OPT_QUIRKS},
+        {"quirks-db", required_argument, NULL, OPT_QUIRKS_DB},
+        {"core", required_argument, NULL, OPT_CORE},
+        {"headless", no_argument, NULL, OPT_HEADLESS},
+        {"max-cycles", required_argument, NULL, OPT_MAX_CYCLES},
+        {"dump-display", no_argument, NULL, OPT_DUMP_DISPLAY},
+        {"trace", no_argument, NULL, OPT_TRACE},
+        {"trace-file", required_argument, NULL, OPT_TRACE_FILE},
+        {"seed", required_argument, NULL, OPT_SEED},
+        {"profile", no_argument, NULL, OPT_PROFILE},
+        {"profile-out", required_argument, NULL, OPT_PROFILE_OUT},
+        {"stats", required_argument, NULL, OPT_STATS},
+        {"metrics-out", required_argument, NULL, OPT_METRICS_OUT},
+        {"rewind", required_argument, NULL, OPT_REWIND},
+        {"save-state", required_argument, NULL, OPT_SAVE_STATE},
+        {"load-state", required_argument, NULL, OPT_LOAD_STATE},
+        {"record", required_argument, NULL, OPT_RECORD},
+        {"record-input", required_argument, NULL, OPT_RECORD_INPUT},
+        {"replay", required_argument, NULL, OPT_REPLAY},
+        {"expect-hash", required_argument, NULL, OPT_EXPECT_HASH},
+
+        // Debugging
+        {"break", required_argument, NULL, OPT_BREAK},
+        {"watch", required_argument, NULL, OPT_WATCH},
+        {"break-if", required_argument, NULL, OPT_BREAK_IF},
+        {"debug-port", required_argument, NULL, OPT_DEBUG_PORT},
 
         // Help
         {"help", no_argument, NULL, 0},
@@ -233,7 +694,7 @@ static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
     bool width_set = false;
     bool height_set = false;
 
-    while ((opt = getopt_long(argc, argv, "w:h:s:f:b:A:W:V:?",
+    while ((opt = getopt_long(argc, argv, "w:h:s:f:b:A:W:V:i:c:?",
                               long_opts, &option_index)) != -1)
     {
         switch (opt)
@@ -269,6 +730,15 @@ static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
         case 'b':
             config->display_cfg.bg_color = strtoul(optarg, NULL, 16);
             break;
+        case OPT_RENDERER:
+            config->display_cfg.renderer = parse_renderer(optarg);
+            break;
+        case OPT_CRT:
+            config->display_cfg.crt = true;
+            break;
+        case OPT_GHOST:
+            config->display_cfg.ghost = true;
+            break;
 
         // Audio
         case 'A':
@@ -280,12 +750,14 @@ static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
             break;
         }
         case 'W':
-        {
-            strncpy(config->audio_cfg.wav_path, optarg,
-                    sizeof(config->audio_cfg.wav_path) - 1);
-            config->audio_cfg.wav_path[sizeof(config->audio_cfg.wav_path) - 1] = '\0';
+            print_warning("-W/--wav is ignored: the beep is synthesized (see --tone).");
+            break;
+        case OPT_TONE:
+            config->audio_cfg.tone_hz = parse_tone(optarg);
+            break;
+        case OPT_AUDIO_BUFFER:
+            config->audio_cfg.buffer_samples = parse_audio_buffer(optarg);
             break;
-        }
         case 'V':
         {
             int vol = atoi(optarg);
@@ -297,6 +769,117 @@ static bool parse_config_unix(app_config_t *config, int argc, char *argv[])
             break;
         }
 
+        // Emulation
+        case 'i':
+            config->emu_cfg.cycles_per_frame = ips_to_cycles_per_frame(atol(optarg));
+            break;
+        case 'c':
+            config->emu_cfg.cycles_per_frame = parse_cycles_per_frame(optarg);
+            break;
+        case OPT_MACHINE:
+            config->emu_cfg.machine = parse_machine(optarg);
+            break;
+        case OPT_QUIRKS:
+            config->emu_cfg.quirks = parse_quirks(optarg);
+            break;
+        case OPT_QUIRKS_DB:
+            strncpy(config->emu_cfg.quirks_db, optarg,
+                    sizeof(config->emu_cfg.quirks_db) - 1);
+            config->emu_cfg.quirks_db[sizeof(config->emu_cfg.quirks_db) - 1] = '\0';
+            break;
+        case OPT_CORE:
+            config->emu_cfg.core = parse_core(optarg);
+            break;
+        case OPT_HEADLESS:
+            config->emu_cfg.headless = true;
+            break;
+        case OPT_MAX_CYCLES:
+            config->emu_cfg.max_cycles = strtoull(optarg, NULL, 10);
+            break;
+        case OPT_DUMP_DISPLAY:
+            config->emu_cfg.dump_display = true;
+            break;
+        case OPT_TRACE:
+            config->emu_cfg.trace = true;
+            break;
+        case OPT_TRACE_FILE:
+            strncpy(config->emu_cfg.trace_file, optarg,
+                    sizeof(config->emu_cfg.trace_file) - 1);
+            config->emu_cfg.trace_file[sizeof(config->emu_cfg.trace_file) - 1] = '\0';
+            config->emu_cfg.trace = true;
+            break;
+        case OPT_SEED:
+            config->emu_cfg.seed = strtoull(optarg, NULL, 0);
+            config->emu_cfg.seed_set = true;
+            break;
+        case OPT_PROFILE:
+            config->emu_cfg.profile = true;
+            break;
+        case OPT_PROFILE_OUT:
+            strncpy(config->emu_cfg.profile_out, optarg,
+                    sizeof(config->emu_cfg.profile_out) - 1);
+            config->emu_cfg.profile_out[sizeof(config->emu_cfg.profile_out) - 1] = '\0';
+            config->emu_cfg.profile = true;
+            break;
+        case OPT_STATS:
+            config->emu_cfg.stats_seconds = (uint32_t)atoi(optarg);
+            break;
+        case OPT_METRICS_OUT:
+            strncpy(config->emu_cfg.metrics_out, optarg,
+                    sizeof(config->emu_cfg.metrics_out) - 1);
+            config->emu_cfg.metrics_out[sizeof(config->emu_cfg.metrics_out) - 1] = '\0';
+            break;
+        case OPT_REWIND:
+            config->emu_cfg.rewind_seconds = parse_rewind_seconds(optarg);
+            break;
+        case OPT_SAVE_STATE:
+            strncpy(config->emu_cfg.save_state, optarg,
+                    sizeof(config->emu_cfg.save_state) - 1);
+            config->emu_cfg.save_state[sizeof(config->emu_cfg.save_state) - 1] = '\0';
+            break;
+        case OPT_LOAD_STATE:
+            strncpy(config->emu_cfg.load_state, optarg,
+                    sizeof(config->emu_cfg.load_state) - 1);
+            config->emu_cfg.load_state[sizeof(config->emu_cfg.load_state) - 1] = '\0';
+            break;
+        case OPT_RECORD:
+            strncpy(config->emu_cfg.record_path, optarg,
+                    sizeof(config->emu_cfg.record_path) - 1);
+            config->emu_cfg.record_path[sizeof(config->emu_cfg.record_path) - 1] = '\0';
+            break;
+        case OPT_RECORD_INPUT:
+            strncpy(config->emu_cfg.record_input, optarg,
+                    sizeof(config->emu_cfg.record_input) - 1);
+            config->emu_cfg.record_input[sizeof(config->emu_cfg.record_input) - 1] = '\0';
+            break;
+        case OPT_REPLAY:
+            strncpy(config->emu_cfg.replay_path, optarg,
+                    sizeof(config->emu_cfg.replay_path) - 1);
+            config->emu_cfg.replay_path[sizeof(config->emu_cfg.replay_path) - 1] = '\0';
+            config->emu_cfg.headless = true; // Replays never need a window
+            break;
+        case OPT_EXPECT_HASH:
+            config->emu_cfg.expect_hash = strtoull(optarg, NULL, 16);
+            config->emu_cfg.expect_hash_set = true;
+            break;
+        case OPT_BREAK:
+            append_list(config->emu_cfg.breakpoints, sizeof(config->emu_cfg.breakpoints), optarg);
+            break;
+        case OPT_WATCH:
+            append_list(config->emu_cfg.watchpoints, sizeof(config->emu_cfg.watchpoints), optarg);
+            break;
+        case OPT_BREAK_IF:
+            append_list(config->emu_cfg.conditions, sizeof(config->emu_cfg.conditions), optarg);
+            break;
+        case OPT_DEBUG_PORT:
+            config->emu_cfg.debug_port = parse_debug_port(optarg);
+            break;
+        case OPT_KEYMAP:
+            strncpy(config->input_cfg.keymap_path, optarg,
+                    sizeof(config->input_cfg.keymap_path) - 1);
+            config->input_cfg.keymap_path[sizeof(config->input_cfg.keymap_path) - 1] = '\0';
+            break;
+
         // Help
         case 0:
             if (strcmp(long_opts[option_index].name, "help") == 0)
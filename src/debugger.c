@@ -0,0 +1,558 @@
+/**
+ * @file debugger.c
+ * @brief Implementation of the debugger command line and its TCP port.
+ */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "debugger.h"
+#include "disasm.h"
+#include "cli_logger.h"
+
+/** @brief Most bytes one "x" command dumps. */
+#define DEBUGGER_DUMP_MAX 256
+
+/** @brief Comparison spellings, longest first so "<=" is not read as "<". */
+static const struct
+{
+    const char *text;
+    chip8_cond_op_t op;
+} cond_ops[] = {
+    {"==", CHIP8_COND_EQ}, {"!=", CHIP8_COND_NE}, {"<=", CHIP8_COND_LE},
+    {">=", CHIP8_COND_GE}, {"<", CHIP8_COND_LT},  {">", CHIP8_COND_GT},
+};
+
+/**
+ * @brief Sends formatted text to the connected client, if any.
+ */
+static void reply(debugger_t *dbg, const char *format, ...)
+{
+    if (dbg->client_fd < 0)
+        return;
+
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (len < 0)
+        return;
+    if ((size_t)len >= sizeof(text))
+        len = (int)sizeof(text) - 1;
+
+#ifndef _WIN32
+    // A client that hung up is noticed by the next recv()
+    if (send(dbg->client_fd, text, (size_t)len, MSG_NOSIGNAL) < 0 && errno != EAGAIN)
+        print_warning("Debugger client write failed.");
+#endif
+}
+
+static const char *skip_spaces(const char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+    return s;
+}
+
+/**
+ * @brief Parses a hexadecimal address (0x optional) and advances @p s past it.
+ */
+static bool parse_addr(const char **s, uint16_t *addr)
+{
+    const char *start = skip_spaces(*s);
+    char *end;
+    unsigned long value = strtoul(start, &end, 16);
+    if (end == start || value > 0xFFF)
+        return false;
+    *addr = (uint16_t)value;
+    *s = end;
+    return true;
+}
+
+/**
+ * @brief Parses "lo" or "lo-hi" into an address range.
+ */
+static bool parse_range(const char *s, uint16_t *first, uint16_t *last)
+{
+    if (!parse_addr(&s, first))
+        return false;
+    *last = *first;
+    s = skip_spaces(s);
+    if (*s == '-')
+    {
+        s++;
+        if (!parse_addr(&s, last) || *last < *first)
+            return false;
+    }
+    return *skip_spaces(s) == '\0';
+}
+
+/**
+ * @brief Parses "REG OP VALUE", spaces optional, e.g. "V3==5" or "I >= 0xF00".
+ */
+static bool parse_condition(const char *s, uint8_t *reg, chip8_cond_op_t *op, uint16_t *value)
+{
+    s = skip_spaces(s);
+    if (toupper((unsigned char)s[0]) == 'V' && isxdigit((unsigned char)s[1]))
+    {
+        *reg = (uint8_t)(isdigit((unsigned char)s[1]) ? s[1] - '0' : toupper((unsigned char)s[1]) - 'A' + 10);
+        s += 2;
+    }
+    else if (toupper((unsigned char)s[0]) == 'D' && toupper((unsigned char)s[1]) == 'T')
+    {
+        *reg = CHIP8_COND_REG_DT;
+        s += 2;
+    }
+    else if (toupper((unsigned char)s[0]) == 'S' && toupper((unsigned char)s[1]) == 'T')
+    {
+        *reg = CHIP8_COND_REG_ST;
+        s += 2;
+    }
+    else if (toupper((unsigned char)s[0]) == 'I')
+    {
+        *reg = CHIP8_COND_REG_I;
+        s += 1;
+    }
+    else
+    {
+        return false;
+    }
+
+    s = skip_spaces(s);
+    size_t i = 0;
+    while (i < sizeof(cond_ops) / sizeof(cond_ops[0]) && strncmp(s, cond_ops[i].text, strlen(cond_ops[i].text)) != 0)
+        i++;
+    if (i == sizeof(cond_ops) / sizeof(cond_ops[0]))
+        return false;
+    *op = cond_ops[i].op;
+    s = skip_spaces(s + strlen(cond_ops[i].text));
+
+    char *end;
+    unsigned long v = strtoul(s, &end, 0);
+    if (end == s || v > 0xFFFF || *skip_spaces(end) != '\0')
+        return false;
+    *value = (uint16_t)v;
+    return true;
+}
+
+/**
+ * @brief Adds a condition, "COND" checked everywhere or "ADDR:COND" at one address.
+ */
+static bool add_condition(chip8_t *emu, const char *spec)
+{
+    uint16_t addr = CHIP8_COND_ANY_ADDR;
+    const char *colon = strchr(spec, ':');
+    if (colon)
+    {
+        const char *s = spec;
+        if (!parse_addr(&s, &addr) || skip_spaces(s) != colon)
+            return false;
+        spec = colon + 1;
+    }
+
+    uint8_t reg;
+    chip8_cond_op_t op;
+    uint16_t value;
+    return parse_condition(spec, &reg, &op, &value) && chip8_add_condition(emu, addr, reg, op, value);
+}
+
+/**
+ * @brief Applies @p arm to every entry of a comma-separated option list.
+ */
+static bool arm_list(chip8_t *emu, const char *list, const char *option, bool (*arm)(chip8_t *, const char *))
+{
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", list);
+
+    bool ok = true;
+    for (char *entry = strtok(copy, ","); entry; entry = strtok(NULL, ","))
+    {
+        if (!arm(emu, entry))
+        {
+            print_error("Invalid %s entry: '%s'", option, entry);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool arm_breakpoint(chip8_t *emu, const char *spec)
+{
+    uint16_t addr;
+    if (!parse_addr(&spec, &addr) || *skip_spaces(spec) != '\0')
+        return false;
+    chip8_set_breakpoint(emu, addr, true);
+    return true;
+}
+
+static bool arm_watchpoint(chip8_t *emu, const char *spec)
+{
+    uint16_t first, last;
+    if (!parse_range(spec, &first, &last))
+        return false;
+    chip8_set_watchpoint(emu, first, last, true);
+    return true;
+}
+
+/**
+ * @brief Opens the listening socket on 127.0.0.1:@p port, non-blocking.
+ */
+static void open_port(debugger_t *dbg, uint16_t port)
+{
+#ifdef _WIN32
+    (void)dbg;
+    print_warning("--debug-port %u ignored: the debugger port needs POSIX sockets.", port);
+#else
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        print_warning("Debugger port disabled: socket() failed.");
+        return;
+    }
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    // Loopback only: the port is unauthenticated and lets anyone who connects pause, step and read the state
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+    {
+        print_warning("Debugger port disabled: cannot listen on 127.0.0.1:%u.", port);
+        close(fd);
+        return;
+    }
+
+    dbg->listen_fd = fd;
+    print_info("Debugger listening on 127.0.0.1:%u", port);
+#endif
+}
+
+bool debugger_init(debugger_t *dbg, chip8_t *emu, const emulation_config_t *cfg)
+{
+    memset(dbg, 0, sizeof(*dbg));
+    dbg->listen_fd = -1;
+    dbg->client_fd = -1;
+
+    bool ok = arm_list(emu, cfg->breakpoints, "--break", arm_breakpoint);
+    ok = arm_list(emu, cfg->watchpoints, "--watch", arm_watchpoint) && ok;
+    ok = arm_list(emu, cfg->conditions, "--break-if", add_condition) && ok;
+    if (!ok)
+        return false;
+
+    if (cfg->debug_port)
+        open_port(dbg, cfg->debug_port);
+    return true;
+}
+
+/**
+ * @brief Sends the registers and the next instruction to the log and the client.
+ */
+static void show_registers(debugger_t *dbg, const chip8_t *emu)
+{
+    char line[160];
+    int len = snprintf(line, sizeof(line), "PC=%03X I=%03X SP=%u DT=%u ST=%u", emu->pc, emu->I, emu->sp,
+                       emu->delay_timer, emu->sound_timer);
+    for (unsigned i = 0; i < 16 && len > 0 && (size_t)len < sizeof(line); i++)
+        len += snprintf(line + len, sizeof(line) - (size_t)len, " V%X=%02X", i, emu->V[i]);
+
+    uint16_t opcode = (uint16_t)(emu->memory[emu->pc & 0xFFF] << 8 | emu->memory[(emu->pc + 1) & 0xFFF]);
+    char text[DISASM_TEXT_MAX];
+    disasm_format(text, sizeof(text), opcode, emu->machine);
+    print_info("%s", line);
+    print_info("next: %04X  %s", opcode, text);
+    reply(dbg, "%s\nnext: %04X  %s\n", line, opcode, text);
+}
+
+void debugger_report(debugger_t *dbg, const chip8_t *emu)
+{
+    if (emu->events & CHIP8_EVENT_WATCH)
+    {
+        // Every watched instruction advances the PC by two
+        print_info("Watchpoint: 0x%03X %s by the instruction at 0x%03X", emu->watch_addr,
+                   emu->watch_store ? "written" : "read", (emu->pc - 2) & 0xFFF);
+        reply(dbg, "stopped: watchpoint 0x%03X %s at 0x%03X\n", emu->watch_addr,
+              emu->watch_store ? "written" : "read", (emu->pc - 2) & 0xFFF);
+    }
+    else if (emu->events & CHIP8_EVENT_BREAKPOINT)
+    {
+        print_info("Break at 0x%03X", emu->pc);
+        reply(dbg, "stopped: break 0x%03X\n", emu->pc);
+    }
+    else if (emu->events & CHIP8_EVENT_STEP)
+    {
+        reply(dbg, "stopped: step\n");
+    }
+    else
+    {
+        return;
+    }
+    show_registers(dbg, emu);
+}
+
+uint32_t debugger_step(chip8_t *emu, uint32_t count)
+{
+    if (emu->state != CHIP8_PAUSED)
+        return 0;
+
+    // chip8_step() runs RUNNING CPUs only; the host pause is ours to lift
+    emu->state = CHIP8_RUNNING;
+    uint32_t done = 0;
+    chip8_exit_t reason = CHIP8_EXIT_BUDGET;
+    while (done < count && reason != CHIP8_EXIT_WATCHPOINT && reason != CHIP8_EXIT_KEY_WAIT &&
+           reason != CHIP8_EXIT_STOPPED && reason != CHIP8_EXIT_STACK_FAULT)
+        done += chip8_step(emu, &reason);
+    if (emu->state == CHIP8_RUNNING)
+        emu->state = CHIP8_PAUSED;
+
+    return done;
+}
+
+/**
+ * @brief Dumps memory as lines of 16 hex bytes.
+ */
+static void dump_memory(debugger_t *dbg, const chip8_t *emu, uint16_t addr, unsigned len)
+{
+    for (unsigned row = 0; row < len; row += 16)
+    {
+        char line[80];
+        int used = snprintf(line, sizeof(line), "%03X:", (addr + row) & 0xFFF);
+        for (unsigned i = row; i < len && i < row + 16; i++)
+            used += snprintf(line + used, sizeof(line) - (size_t)used, " %02X", emu->memory[(addr + i) & 0xFFF]);
+        reply(dbg, "%s\n", line);
+    }
+}
+
+/**
+ * @brief Executes one command line from the client.
+ */
+static debugger_action_t run_command(debugger_t *dbg, chip8_t *emu, char *line)
+{
+    char *args = line + strcspn(line, " \t");
+    if (*args)
+        *args++ = '\0';
+    args = (char *)skip_spaces(args);
+    const char *cmd = line;
+
+    if (strcmp(cmd, "b") == 0 || strcmp(cmd, "break") == 0)
+    {
+        // "break ADDR", "break ADDR if COND" or "break if COND"
+        const char *cond = strstr(args, "if");
+        if (cond == args)
+        {
+            if (!add_condition(emu, cond + 2))
+                reply(dbg, "error: bad or too many conditions (%u max)\n", CHIP8_MAX_CONDITIONS);
+            else
+                reply(dbg, "ok\n");
+            return DEBUGGER_NONE;
+        }
+
+        const char *s = args;
+        uint16_t addr;
+        if (!parse_addr(&s, &addr))
+        {
+            reply(dbg, "error: usage: break ADDR [if COND] | break if COND\n");
+            return DEBUGGER_NONE;
+        }
+        s = skip_spaces(s);
+        if (*s == '\0')
+            chip8_set_breakpoint(emu, addr, true);
+        else
+        {
+            char spec[DEBUGGER_LINE_MAX];
+            uint8_t reg;
+            chip8_cond_op_t op;
+            uint16_t value;
+            snprintf(spec, sizeof(spec), "%s", s);
+            if (strncmp(spec, "if", 2) != 0 || !parse_condition(spec + 2, &reg, &op, &value) ||
+                !chip8_add_condition(emu, addr, reg, op, value))
+            {
+                reply(dbg, "error: bad or too many conditions (%u max)\n", CHIP8_MAX_CONDITIONS);
+                return DEBUGGER_NONE;
+            }
+        }
+        reply(dbg, "ok\n");
+    }
+    else if (strcmp(cmd, "d") == 0 || strcmp(cmd, "delete") == 0)
+    {
+        const char *s = args;
+        uint16_t addr;
+        if (*s == '\0')
+        {
+            chip8_clear_breakpoints(emu);
+            chip8_clear_conditions(emu);
+            chip8_clear_watchpoints(emu);
+        }
+        else if (parse_addr(&s, &addr))
+            chip8_set_breakpoint(emu, addr, false);
+        else
+        {
+            reply(dbg, "error: usage: delete [ADDR]\n");
+            return DEBUGGER_NONE;
+        }
+        reply(dbg, "ok\n");
+    }
+    else if (strcmp(cmd, "w") == 0 || strcmp(cmd, "watch") == 0 || strcmp(cmd, "unwatch") == 0)
+    {
+        bool on = cmd[0] == 'w';
+        uint16_t first, last;
+        if (!on && *args == '\0')
+            chip8_clear_watchpoints(emu);
+        else if (parse_range(args, &first, &last))
+            chip8_set_watchpoint(emu, first, last, on);
+        else
+        {
+            reply(dbg, "error: usage: %s LO[-HI]\n", cmd);
+            return DEBUGGER_NONE;
+        }
+        reply(dbg, "ok\n");
+    }
+    else if (strcmp(cmd, "s") == 0 || strcmp(cmd, "step") == 0)
+    {
+        long count = *args ? strtol(args, NULL, 0) : 1;
+        if (emu->state != CHIP8_PAUSED)
+            reply(dbg, "error: pause first\n");
+        else if (count <= 0)
+            reply(dbg, "error: usage: step [N]\n");
+        else
+        {
+            dbg->step_count = (uint32_t)count;
+            return DEBUGGER_STEP;
+        }
+    }
+    else if (strcmp(cmd, "r") == 0 || strcmp(cmd, "regs") == 0)
+    {
+        show_registers(dbg, emu);
+    }
+    else if (strcmp(cmd, "x") == 0)
+    {
+        const char *s = args;
+        uint16_t addr;
+        if (!parse_addr(&s, &addr))
+        {
+            reply(dbg, "error: usage: x ADDR [LEN]\n");
+            return DEBUGGER_NONE;
+        }
+        long len = *skip_spaces(s) ? strtol(s, NULL, 0) : 16;
+        dump_memory(dbg, emu, addr, len <= 0 ? 16 : len > DEBUGGER_DUMP_MAX ? DEBUGGER_DUMP_MAX : (unsigned)len);
+    }
+    else if (strcmp(cmd, "p") == 0 || strcmp(cmd, "pause") == 0)
+    {
+        reply(dbg, "ok\n");
+        return DEBUGGER_PAUSE;
+    }
+    else if (strcmp(cmd, "c") == 0 || strcmp(cmd, "continue") == 0)
+    {
+        reply(dbg, "ok\n");
+        return DEBUGGER_CONTINUE;
+    }
+    else if (strcmp(cmd, "h") == 0 || strcmp(cmd, "help") == 0)
+    {
+        reply(dbg, "break ADDR [if COND] | break if COND | delete [ADDR] | watch LO[-HI] | unwatch [LO[-HI]]\n"
+                   "pause | continue | step [N] | regs | x ADDR [LEN]   (COND: V0..VF, I, DT or ST, "
+                   "then == != < <= > >=, then a value)\n");
+    }
+    else if (*cmd != '\0')
+    {
+        reply(dbg, "error: unknown command '%s' (try help)\n", cmd);
+    }
+    return DEBUGGER_NONE;
+}
+
+debugger_action_t debugger_poll(debugger_t *dbg, chip8_t *emu)
+{
+    debugger_action_t action = DEBUGGER_NONE;
+#ifndef _WIN32
+    if (dbg->listen_fd < 0)
+        return action;
+
+    if (dbg->client_fd < 0)
+    {
+        int fd = accept(dbg->listen_fd, NULL, NULL);
+        if (fd < 0)
+            return action;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        dbg->client_fd = fd;
+        dbg->input_len = 0;
+        print_info("Debugger client connected.");
+        reply(dbg, "chip8 debugger; try help\n");
+    }
+
+    // Take in what arrived, as much as the buffer holds
+    while (dbg->input_len < sizeof(dbg->input))
+    {
+        ssize_t got = recv(dbg->client_fd, dbg->input + dbg->input_len, sizeof(dbg->input) - dbg->input_len, 0);
+        if (got > 0)
+        {
+            dbg->input_len += (size_t)got;
+            continue;
+        }
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            print_info("Debugger client disconnected.");
+            close(dbg->client_fd);
+            dbg->client_fd = -1;
+            dbg->input_len = 0;
+            return action;
+        }
+        break;
+    }
+
+    // Run whole lines until one hands the run state to the caller; the
+    // rest waits for the next poll, when that change has happened
+    char *newline;
+    while (action == DEBUGGER_NONE && (newline = memchr(dbg->input, '\n', dbg->input_len)))
+    {
+        char line[DEBUGGER_LINE_MAX];
+        size_t len = (size_t)(newline - dbg->input);
+        size_t used = len < sizeof(line) - 1 ? len : sizeof(line) - 1;
+        memcpy(line, dbg->input, used);
+        line[used] = '\0';
+        if (used && line[used - 1] == '\r')
+            line[used - 1] = '\0';
+
+        dbg->input_len -= len + 1;
+        memmove(dbg->input, newline + 1, dbg->input_len);
+        action = run_command(dbg, emu, line);
+    }
+
+    if (dbg->input_len == sizeof(dbg->input))
+    {
+        reply(dbg, "error: line too long\n");
+        dbg->input_len = 0;
+    }
+#else
+    (void)dbg;
+    (void)emu;
+#endif
+    return action;
+}
+
+void debugger_cleanup(debugger_t *dbg)
+{
+#ifndef _WIN32
+    if (dbg->client_fd >= 0)
+        close(dbg->client_fd);
+    if (dbg->listen_fd >= 0)
+        close(dbg->listen_fd);
+#endif
+    dbg->client_fd = -1;
+    dbg->listen_fd = -1;
+}
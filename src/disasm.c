@@ -0,0 +1,403 @@
+/**
+ * @file disasm.c
+ * @brief Implementation of the control flow analysis and disassembler.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "disasm.h"
+
+/**
+ * @brief Successors of one instruction.
+ */
+typedef struct
+{
+    uint16_t addr[2]; /**< Next PCs, first count valid */
+    uint8_t count;    /**< 0..2 */
+    uint8_t exit;     /**< disasm_end_t if the instruction ends a block, else DISASM_END_FALLTHROUGH */
+} successors_t;
+
+static inline uint16_t opcode_at(const chip8_t *emu, uint16_t addr)
+{
+    return (uint16_t)(emu->memory[addr] << 8 | emu->memory[addr + 1]);
+}
+
+/**
+ * @brief Returns whether an instruction can start at @p addr inside the program area.
+ */
+static inline bool in_program(unsigned addr)
+{
+    return addr >= CHIP8_ROM_ENTRY_POINT && addr + 1 < CHIP8_MEMORY_SIZE;
+}
+
+/**
+ * @brief Lists where the CPU can go after the instruction at @p addr.
+ */
+static successors_t successors_of(uint16_t addr, chip8_op_t op, chip8_instr_t instr)
+{
+    const uint16_t next = (uint16_t)(addr + 2);
+    switch (op)
+    {
+    case CHIP8_OP_JP:
+        return (successors_t){{instr.nnn, 0}, 1, DISASM_END_JUMP};
+    case CHIP8_OP_CALL:
+        return (successors_t){{instr.nnn, next}, 2, DISASM_END_CALL};
+    case CHIP8_OP_SE_VX_KK:
+    case CHIP8_OP_SNE_VX_KK:
+    case CHIP8_OP_SE_VX_VY:
+    case CHIP8_OP_SNE_VX_VY:
+    case CHIP8_OP_SKP_VX:
+    case CHIP8_OP_SKNP_VX:
+        return (successors_t){{next, (uint16_t)(addr + 4)}, 2, DISASM_END_SKIP};
+    case CHIP8_OP_RET:
+        return (successors_t){{0, 0}, 0, DISASM_END_RETURN};
+    case CHIP8_OP_JP_V0_NNN:
+        return (successors_t){{0, 0}, 0, DISASM_END_INDIRECT};
+    case CHIP8_OP_EXIT:
+    case CHIP8_OP_SYS:
+    case CHIP8_OP_8XXX_UNKNOWN:
+    case CHIP8_OP_EXXX_UNKNOWN:
+    case CHIP8_OP_FXXX_UNKNOWN:
+        return (successors_t){{0, 0}, 0, DISASM_END_HALT};
+    default:
+        return (successors_t){{next, 0}, 1, DISASM_END_FALLTHROUGH};
+    }
+}
+
+static inline void set_bit(uint8_t *map, uint16_t addr)
+{
+    map[addr >> 3] |= (uint8_t)(1u << (addr & 7));
+}
+
+/**
+ * @brief Marks everything reachable from the entry point as code.
+ */
+static void walk(disasm_t *dis, const chip8_t *emu)
+{
+    // Each address is pushed once, so the stack cannot overflow
+    uint16_t stack[DISASM_ADDRESSES];
+    bool queued[DISASM_ADDRESSES] = {false};
+    unsigned depth = 0;
+
+    stack[depth++] = CHIP8_ROM_ENTRY_POINT;
+    queued[CHIP8_ROM_ENTRY_POINT] = true;
+    dis->flags[CHIP8_ROM_ENTRY_POINT] |= DISASM_LEADER;
+
+    while (depth)
+    {
+        uint16_t addr = stack[--depth];
+        uint16_t opcode = opcode_at(emu, addr);
+        chip8_op_t op = chip8_classify_opcode(opcode, emu->machine);
+        chip8_instr_t instr = chip8_decode_opcode(opcode);
+        successors_t next = successors_of(addr, op, instr);
+
+        dis->flags[addr] |= DISASM_CODE;
+        dis->flags[addr + 1] |= DISASM_OPERAND;
+        set_bit(dis->code_map, addr);
+        dis->instructions++;
+
+        if (op == CHIP8_OP_JP)
+            dis->flags[instr.nnn] |= DISASM_JUMP_TARGET;
+        else if (op == CHIP8_OP_CALL)
+            dis->flags[instr.nnn] |= DISASM_CALL_TARGET;
+        else if (op == CHIP8_OP_LD_I_NNN)
+            dis->flags[instr.nnn] |= DISASM_DATA_REF;
+        else if (op == CHIP8_OP_JP_V0_NNN)
+            dis->indirect_jumps++;
+
+        for (unsigned i = 0; i < next.count; i++)
+        {
+            uint16_t target = next.addr[i];
+            if (!in_program(target))
+                continue;
+            // Branches and the instructions after them start blocks
+            if (next.exit != DISASM_END_FALLTHROUGH)
+                dis->flags[target] |= DISASM_LEADER;
+            if (!queued[target])
+            {
+                queued[target] = true;
+                stack[depth++] = target;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Splits the code into basic blocks.
+ */
+static void build_blocks(disasm_t *dis, const chip8_t *emu)
+{
+    for (unsigned start = CHIP8_ROM_ENTRY_POINT; in_program(start); start++)
+    {
+        if ((dis->flags[start] & (DISASM_CODE | DISASM_LEADER)) != (DISASM_CODE | DISASM_LEADER))
+            continue;
+
+        disasm_block_t *block = &dis->blocks[dis->block_count++];
+        block->start = (uint16_t)start;
+
+        uint16_t addr = (uint16_t)start;
+        for (;;)
+        {
+            uint16_t opcode = opcode_at(emu, addr);
+            successors_t next = successors_of(addr, chip8_classify_opcode(opcode, emu->machine),
+                                              chip8_decode_opcode(opcode));
+            uint16_t after = (uint16_t)(addr + 2);
+
+            if (next.exit == DISASM_END_FALLTHROUGH &&
+                (!in_program(after) || (dis->flags[after] & (DISASM_CODE | DISASM_LEADER)) != DISASM_CODE))
+            {
+                // Falls into another block, or off the end of memory
+                block->end = after;
+                block->exit = in_program(after) ? DISASM_END_FALLTHROUGH : DISASM_END_HALT;
+                block->succ_count = in_program(after) ? 1 : 0;
+                block->succ[0] = after;
+                break;
+            }
+            if (next.exit != DISASM_END_FALLTHROUGH)
+            {
+                block->end = after;
+                block->exit = next.exit;
+                block->succ_count = next.count;
+                memcpy(block->succ, next.addr, sizeof(block->succ));
+                break;
+            }
+            addr = after;
+        }
+    }
+}
+
+/**
+ * @brief Returns whether the idle probe could succeed when started at @p start.
+ *
+ * Breadth-first over idle-safe instructions, so the first return to
+ * @p start is along the shortest cycle. @p seen holds per-address stamps;
+ * @p stamp is unique to this call.
+ */
+static bool may_idle(const disasm_t *dis, const chip8_t *emu, uint16_t start, uint16_t *seen, uint16_t stamp)
+{
+    uint16_t queue[DISASM_ADDRESSES];
+    uint8_t depth[DISASM_ADDRESSES];
+    unsigned head = 0;
+    unsigned tail = 0;
+
+    queue[tail] = start;
+    depth[tail++] = 0;
+
+    while (head < tail)
+    {
+        uint16_t addr = queue[head];
+        uint8_t executed = depth[head++];
+
+        if (executed == CHIP8_IDLE_MAX_LOOP)
+            continue;
+
+        // Nothing is known about code the walk did not reach
+        if (!in_program(addr) || !(dis->flags[addr] & DISASM_CODE))
+            return true;
+
+        uint16_t opcode = opcode_at(emu, addr);
+        chip8_op_t op = chip8_classify_opcode(opcode, emu->machine);
+        if (!chip8_idle_safe(op))
+            continue;
+        if (op == CHIP8_OP_JP_V0_NNN)
+            return true;
+
+        successors_t next = successors_of(addr, op, chip8_decode_opcode(opcode));
+        for (unsigned i = 0; i < next.count; i++)
+        {
+            uint16_t target = next.addr[i] & 0xFFF;
+            if (target == start)
+                return true;
+            if (seen[target] != stamp)
+            {
+                seen[target] = stamp;
+                queue[tail] = target;
+                depth[tail++] = (uint8_t)(executed + 1);
+            }
+        }
+    }
+    return false;
+}
+
+void disasm_analyze(disasm_t *dis, const chip8_t *emu)
+{
+    memset(dis, 0, sizeof(*dis));
+
+    walk(dis, emu);
+    build_blocks(dis, emu);
+
+    uint16_t seen[DISASM_ADDRESSES] = {0};
+    for (unsigned addr = CHIP8_ROM_ENTRY_POINT; in_program(addr); addr++)
+    {
+        if ((dis->flags[addr] & DISASM_CODE) && may_idle(dis, emu, (uint16_t)addr, seen, (uint16_t)addr))
+        {
+            dis->flags[addr] |= DISASM_IDLE;
+            set_bit(dis->idle_map, (uint16_t)addr);
+            dis->idle_starts++;
+        }
+    }
+}
+
+void disasm_format(char *buf, size_t size, uint16_t opcode, uint8_t machine)
+{
+    const chip8_instr_t in = chip8_decode_opcode(opcode);
+    const unsigned x = in.x;
+    const unsigned y = in.y;
+
+    switch (chip8_classify_opcode(opcode, machine))
+    {
+    case CHIP8_OP_CLS:
+        snprintf(buf, size, "CLS");
+        break;
+    case CHIP8_OP_RET:
+        snprintf(buf, size, "RET");
+        break;
+    case CHIP8_OP_SYS:
+        snprintf(buf, size, "SYS 0x%03X", in.nnn);
+        break;
+    case CHIP8_OP_JP:
+        snprintf(buf, size, "JP 0x%03X", in.nnn);
+        break;
+    case CHIP8_OP_CALL:
+        snprintf(buf, size, "CALL 0x%03X", in.nnn);
+        break;
+    case CHIP8_OP_SE_VX_KK:
+        snprintf(buf, size, "SE V%X, 0x%02X", x, in.kk);
+        break;
+    case CHIP8_OP_SNE_VX_KK:
+        snprintf(buf, size, "SNE V%X, 0x%02X", x, in.kk);
+        break;
+    case CHIP8_OP_SE_VX_VY:
+        snprintf(buf, size, "SE V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_LD_VX_KK:
+        snprintf(buf, size, "LD V%X, 0x%02X", x, in.kk);
+        break;
+    case CHIP8_OP_ADD_VX_KK:
+        snprintf(buf, size, "ADD V%X, 0x%02X", x, in.kk);
+        break;
+    case CHIP8_OP_LD_VX_VY:
+        snprintf(buf, size, "LD V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_OR_VX_VY:
+        snprintf(buf, size, "OR V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_AND_VX_VY:
+        snprintf(buf, size, "AND V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_XOR_VX_VY:
+        snprintf(buf, size, "XOR V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_ADD_VX_VY:
+        snprintf(buf, size, "ADD V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_SUB_VX_VY:
+        snprintf(buf, size, "SUB V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_SHR_VX:
+        snprintf(buf, size, "SHR V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_SUBN_VX_VY:
+        snprintf(buf, size, "SUBN V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_SHL_VX:
+        snprintf(buf, size, "SHL V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_SNE_VX_VY:
+        snprintf(buf, size, "SNE V%X, V%X", x, y);
+        break;
+    case CHIP8_OP_LD_I_NNN:
+        snprintf(buf, size, "LD I, 0x%03X", in.nnn);
+        break;
+    case CHIP8_OP_JP_V0_NNN:
+        snprintf(buf, size, "JP V0, 0x%03X", in.nnn);
+        break;
+    case CHIP8_OP_RND_VX_KK:
+        snprintf(buf, size, "RND V%X, 0x%02X", x, in.kk);
+        break;
+    case CHIP8_OP_DRW:
+    case CHIP8_OP_DRW16:
+        snprintf(buf, size, "DRW V%X, V%X, %u", x, y, in.n);
+        break;
+    case CHIP8_OP_SKP_VX:
+        snprintf(buf, size, "SKP V%X", x);
+        break;
+    case CHIP8_OP_SKNP_VX:
+        snprintf(buf, size, "SKNP V%X", x);
+        break;
+    case CHIP8_OP_LD_VX_DT:
+        snprintf(buf, size, "LD V%X, DT", x);
+        break;
+    case CHIP8_OP_LD_VX_K:
+        snprintf(buf, size, "LD V%X, K", x);
+        break;
+    case CHIP8_OP_LD_DT_VX:
+        snprintf(buf, size, "LD DT, V%X", x);
+        break;
+    case CHIP8_OP_LD_ST_VX:
+        snprintf(buf, size, "LD ST, V%X", x);
+        break;
+    case CHIP8_OP_ADD_I_VX:
+        snprintf(buf, size, "ADD I, V%X", x);
+        break;
+    case CHIP8_OP_LD_F_VX:
+        snprintf(buf, size, "LD F, V%X", x);
+        break;
+    case CHIP8_OP_LD_B_VX:
+        snprintf(buf, size, "LD B, V%X", x);
+        break;
+    case CHIP8_OP_LD_MEM_VX:
+        snprintf(buf, size, "LD [I], V%X", x);
+        break;
+    case CHIP8_OP_LD_VX_MEM:
+        snprintf(buf, size, "LD V%X, [I]", x);
+        break;
+    case CHIP8_OP_SCD:
+        snprintf(buf, size, "SCD %u", in.n);
+        break;
+    case CHIP8_OP_SCR:
+        snprintf(buf, size, "SCR");
+        break;
+    case CHIP8_OP_SCL:
+        snprintf(buf, size, "SCL");
+        break;
+    case CHIP8_OP_EXIT:
+        snprintf(buf, size, "EXIT");
+        break;
+    case CHIP8_OP_LOW:
+        snprintf(buf, size, "LOW");
+        break;
+    case CHIP8_OP_HIGH:
+        snprintf(buf, size, "HIGH");
+        break;
+    case CHIP8_OP_LD_HF_VX:
+        snprintf(buf, size, "LD HF, V%X", x);
+        break;
+    case CHIP8_OP_LD_R_VX:
+        snprintf(buf, size, "LD R, V%X", x);
+        break;
+    case CHIP8_OP_LD_VX_R:
+        snprintf(buf, size, "LD V%X, R", x);
+        break;
+    default:
+        snprintf(buf, size, "DW 0x%04X", opcode);
+        break;
+    }
+}
+
+const disasm_block_t *disasm_block_at(const disasm_t *dis, uint16_t addr)
+{
+    // Blocks are in address order
+    unsigned lo = 0;
+    unsigned hi = dis->block_count;
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (dis->blocks[mid].start < addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < dis->block_count && dis->blocks[lo].start == addr ? &dis->blocks[lo] : NULL;
+}
@@ -0,0 +1,384 @@
+/**
+ * @file emu_thread.c
+ * @brief Emulation thread, frame pacing and the frame triple buffer.
+ */
+
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "emu_thread.h"
+#include "audio.h"
+#include "cli_logger.h"
+
+/**
+ * @brief Frames the scheduler may fall behind before it stops catching up.
+ *
+ * Short stalls are absorbed by running the missed frames back to back. After
+ * a long stall (debugger, suspended laptop) the schedule is re-anchored
+ * instead, so the emulator never fast-forwards through seconds of gameplay.
+ */
+#define SCHED_MAX_LAG_FRAMES 5
+
+/**
+ * @brief Returns the performance-counter value at which a frame is due.
+ *
+ * Deadlines are computed from the absolute frame index rather than by adding
+ * a rounded period each frame, so integer truncation never accumulates into
+ * drift.
+ */
+static uint64_t frame_deadline(uint64_t epoch, uint64_t frame_index, uint64_t freq)
+{
+    return epoch + frame_index * freq / CONFIG_FRAME_RATE;
+}
+
+/**
+ * @brief Sleeps until the performance counter reaches @p deadline.
+ *
+ * Uses SDL_Delay while more than two milliseconds remain, leaving the OS
+ * scheduler slack to wake us up early, then spins for the final stretch.
+ */
+static void wait_until(uint64_t deadline, uint64_t freq)
+{
+    uint64_t now;
+    while ((now = SDL_GetPerformanceCounter()) < deadline)
+    {
+        uint64_t remaining_ms = (deadline - now) * 1000 / freq;
+        if (remaining_ms >= 2)
+            SDL_Delay((Uint32)(remaining_ms - 1));
+    }
+}
+
+/**
+ * @brief Copies the presenter's view of @p emu into the back slot and swaps it in.
+ */
+static void publish_frame(emu_thread_t *et, uint64_t frame)
+{
+    const chip8_t *emu = et->emu;
+    emu_frame_t *out = &et->frames[et->back];
+
+    memcpy(out->display, emu->display, sizeof(out->display));
+    out->hires = emu->hires;
+    out->frame = frame;
+    out->state = emu->state;
+    out->metrics = et->metrics;
+    out->published = SDL_GetPerformanceCounter();
+
+    // Make the slot contents visible before the index that hands it over
+    SDL_MemoryBarrierRelease();
+    et->back = SDL_AtomicSet(&et->middle, et->back | EMU_FRAME_FRESH) & ~EMU_FRAME_FRESH;
+}
+
+/**
+ * @brief Starts a frame: applies the input collected for it and logs it.
+ */
+static void begin_frame(emu_thread_t *et, uint16_t pressed)
+{
+    uint16_t keys = (uint16_t)SDL_AtomicGet(&et->keys);
+    if (et->input)
+        replay_frame(et->input, keys, pressed);
+    chip8_set_keys(et->emu, keys, pressed);
+    et->frame_left = et->cfg->cycles_per_frame;
+}
+
+/**
+ * @brief Ends a frame: one timer tick and one rewind record.
+ */
+static void end_frame(emu_thread_t *et)
+{
+    chip8_timers_decrement(et->emu); // Timers tick once per frame
+    et->metrics.timer_ticks++;
+
+    if (et->rewind)
+        rewind_push(et->rewind, et->emu);
+    et->frame_left = 0;
+}
+
+/**
+ * @brief Switches the run state for the debugger and tells the presenter.
+ */
+static void force_state(emu_thread_t *et, chip8_state_t state)
+{
+    et->emu->state = state;
+    SDL_AtomicSet(&et->debug_state, (int)state + 1);
+}
+
+/**
+ * @brief Runs one 60 Hz frame, or what an interrupted one still owes, or
+ *        one step back in rewind history.
+ */
+static void run_frame(emu_thread_t *et, uint16_t pressed)
+{
+    chip8_t *emu = et->emu;
+
+    if (emu->state == CHIP8_RUNNING)
+    {
+        // Input only reaches new frames, which keeps the log exact
+        if (!et->frame_left)
+            begin_frame(et, pressed);
+
+        // A ROM halted in FX0A costs nothing until a key goes down, and
+        // one spinning on the delay timer only costs a probe per frame
+        if (et->prof)
+        {
+            uint32_t i;
+            for (i = 0; i < et->frame_left && emu->state == CHIP8_RUNNING && !chip8_waiting_for_key(emu); i++)
+                profiler_cycle(et->prof, emu);
+            et->metrics.instructions += i;
+        }
+        else
+        {
+            chip8_idle_t idle;
+            uint64_t skipped = emu->idle_skipped;
+            uint32_t ran = chip8_run_until_tick(emu, et->frame_left, &idle); // Execute instructions
+            skipped = emu->idle_skipped - skipped;
+            et->frame_left -= ran;
+            et->metrics.instructions += ran - skipped;
+            et->metrics.idle_skipped += skipped;
+
+            if (et->dbg && debugger_stopped(emu) && emu->state == CHIP8_RUNNING)
+            {
+                debugger_report(et->dbg, emu);
+                force_state(et, CHIP8_PAUSED);
+                if (et->frame_left)
+                    return; // The rest of the frame runs on resume
+            }
+        }
+
+        end_frame(et);
+    }
+    else if (emu->state == CHIP8_REWINDING)
+    {
+        // Step back one frame per frame; stay on the oldest one when exhausted.
+        // The input log forgets the frames undone, so it still replays
+        // to the state the session ends in
+        if (et->rewind && rewind_step_back(et->rewind, emu) && et->input)
+            replay_rewind(et->input);
+        et->frame_left = 0;
+    }
+}
+
+/**
+ * @brief Single-steps a paused emulator inside the frame structure.
+ *
+ * Steps count against the current frame like any other instruction: one
+ * that starts a frame applies its input and one that completes it ticks
+ * the timers, so a stepped session runs exactly as an unstepped one.
+ */
+static void step_paused(emu_thread_t *et, uint32_t count)
+{
+    chip8_t *emu = et->emu;
+    uint32_t done = 0;
+
+    while (done < count && emu->state == CHIP8_PAUSED)
+    {
+        // Presses made while paused are discarded, as without stepping
+        if (!et->frame_left)
+            begin_frame(et, 0);
+
+        uint32_t chunk = count - done < et->frame_left ? count - done : et->frame_left;
+        uint32_t stepped = debugger_step(emu, chunk);
+        done += stepped;
+        et->metrics.instructions += stepped;
+        et->frame_left -= stepped;
+        if (!et->frame_left)
+            end_frame(et);
+        if (stepped < chunk || (emu->events & CHIP8_EVENT_WATCH))
+            break;
+    }
+
+    if (done)
+        debugger_report(et->dbg, emu);
+    else if (emu->key_wait)
+        print_info("Waiting for a key in FX0A at 0x%03X; resume to press one.", emu->pc);
+}
+
+/**
+ * @brief Polls the debugger port and carries out what it asks for.
+ */
+static void run_debugger(emu_thread_t *et)
+{
+    chip8_t *emu = et->emu;
+    uint32_t steps = (uint32_t)SDL_AtomicSet(&et->steps, 0);
+
+    switch (debugger_poll(et->dbg, emu))
+    {
+    case DEBUGGER_PAUSE:
+        if (emu->state == CHIP8_RUNNING)
+            force_state(et, CHIP8_PAUSED);
+        break;
+    case DEBUGGER_CONTINUE:
+        if (emu->state == CHIP8_PAUSED)
+            force_state(et, CHIP8_RUNNING);
+        break;
+    case DEBUGGER_STEP:
+        steps += et->dbg->step_count;
+        break;
+    case DEBUGGER_NONE:
+        break;
+    }
+
+    if (steps && emu->state == CHIP8_PAUSED)
+        step_paused(et, steps);
+}
+
+/**
+ * @brief Thread body: applies input, runs and publishes frames on schedule.
+ */
+static int emu_thread_main(void *data)
+{
+    emu_thread_t *et = data;
+    chip8_t *emu = et->emu;
+
+    // Presentation may lag; emulation timing may not
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    const uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t epoch = SDL_GetPerformanceCounter();
+    uint64_t frame_index = 0;
+    uint64_t frames = 0;
+
+    for (;;)
+    {
+        chip8_state_t requested = (chip8_state_t)SDL_AtomicGet(&et->requested);
+        if (requested == CHIP8_STOPPED)
+            break;
+
+        // A state the debugger chose holds until the presenter adopts it
+        int forced = SDL_AtomicGet(&et->debug_state);
+        if (forced && (int)requested + 1 == forced)
+            SDL_AtomicSet(&et->debug_state, 0);
+        else if (forced)
+            requested = (chip8_state_t)(forced - 1);
+
+        // The user controls running, paused and rewinding; a ROM that
+        // stopped or failed stays that way
+        if (emu->state == CHIP8_RUNNING || emu->state == CHIP8_PAUSED || emu->state == CHIP8_REWINDING)
+            emu->state = requested;
+        uint16_t pressed = (uint16_t)SDL_AtomicSet(&et->presses, 0);
+
+        if (et->dbg)
+            run_debugger(et);
+
+        run_frame(et, pressed);
+        et->metrics.frames++;
+        publish_frame(et, ++frames);
+
+        // The tone follows the sound timer frame by frame; paused or
+        // rewinding, there is nothing to hear
+        audio_set_beep(emu->state == CHIP8_RUNNING && chip8_sound_active(emu));
+
+        // Every emulated frame is recorded, including ones the presenter skips
+        if (et->rec)
+            recorder_push(et->rec, emu->display, emu->hires, 1);
+
+        // Sleep until the next frame is due, or catch up if we are late
+        frame_index++;
+        uint64_t deadline = frame_deadline(epoch, frame_index, freq);
+        uint64_t now = SDL_GetPerformanceCounter();
+        metrics_hist_add(&et->metrics.late, now > deadline ? now - deadline : 0);
+        if (now > frame_deadline(epoch, frame_index + SCHED_MAX_LAG_FRAMES, freq))
+        {
+            // Too far behind: re-anchor the schedule instead of bursting.
+            // The time in between is never emulated, which is the drift
+            et->metrics.resyncs++;
+            et->metrics.drift_ticks += now - deadline;
+            epoch = now;
+            frame_index = 0;
+        }
+        else
+        {
+            wait_until(deadline, freq);
+        }
+    }
+
+    return 0;
+}
+
+bool emu_thread_start(emu_thread_t *et, chip8_t *emu, const emulation_config_t *cfg,
+                      profiler_t *prof, rewind_t *rewind, recorder_t *rec, replay_t *input,
+                      debugger_t *dbg)
+{
+    memset(et, 0, sizeof(*et));
+    et->emu = emu;
+    et->cfg = cfg;
+    et->prof = prof;
+    et->rewind = rewind;
+    et->rec = rec;
+    et->input = input;
+    et->dbg = dbg;
+
+    // Slot 0 is presented, slot 1 in flight, slot 2 written first
+    et->front = 0;
+    et->back = 2;
+    SDL_AtomicSet(&et->middle, 1);
+    SDL_AtomicSet(&et->keys, emu->keys);
+    SDL_AtomicSet(&et->requested, emu->state);
+
+    // Show the loaded state straight away
+    publish_frame(et, 0);
+
+    et->thread = SDL_CreateThread(emu_thread_main, "chip8-emu", et);
+    if (!et->thread)
+    {
+        print_error("Failed to create emulation thread: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void emu_thread_set_input(emu_thread_t *et, uint16_t keys, uint16_t pressed, chip8_state_t state)
+{
+    SDL_AtomicSet(&et->keys, keys);
+
+    // Accumulate presses until the emulation thread collects them
+    if (pressed)
+    {
+        int old;
+        do
+            old = SDL_AtomicGet(&et->presses);
+        while (!SDL_AtomicCAS(&et->presses, old, old | pressed));
+    }
+
+    SDL_AtomicSet(&et->requested, state);
+}
+
+void emu_thread_step(emu_thread_t *et, uint32_t count)
+{
+    if (et->dbg)
+        SDL_AtomicAdd(&et->steps, (int)count);
+}
+
+bool emu_thread_debug_state(emu_thread_t *et, chip8_state_t *state)
+{
+    int forced = SDL_AtomicGet(&et->debug_state);
+    if (!forced)
+        return false;
+    *state = (chip8_state_t)(forced - 1);
+    return true;
+}
+
+const emu_frame_t *emu_thread_acquire(emu_thread_t *et)
+{
+    if (!(SDL_AtomicGet(&et->middle) & EMU_FRAME_FRESH))
+        return NULL;
+
+    // Only the presenter clears the flag, so the slot cannot go stale here
+    et->front = SDL_AtomicSet(&et->middle, et->front) & ~EMU_FRAME_FRESH;
+    SDL_MemoryBarrierAcquire();
+    return &et->frames[et->front];
+}
+
+const emu_frame_t *emu_thread_current(const emu_thread_t *et)
+{
+    return &et->frames[et->front];
+}
+
+void emu_thread_stop(emu_thread_t *et)
+{
+    if (!et->thread)
+        return;
+
+    SDL_AtomicSet(&et->requested, CHIP8_STOPPED);
+    SDL_WaitThread(et->thread, NULL);
+    et->thread = NULL;
+}
@@ -0,0 +1,378 @@
+/**
+ * @file gl_renderer.c
+ * @brief OpenGL backend: packed-bit texture upload and a palette shader.
+ */
+
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "gl_renderer.h"
+#include "chip8.h"
+#include "cli_logger.h"
+
+#define GL_BYTES_PER_ROW (CHIP8_HIRES_WIDTH / 8)                          /**< Texels per texture row */
+#define GL_TEXTURE_ROWS (CHIP8_HIRES_HEIGHT * GL_RENDERER_HISTORY)        /**< Texture height */
+
+/**
+ * @brief GL entry points used by the backend: return type, name without
+ *        the gl prefix, parameter list.
+ */
+#define GL_FUNCTIONS(X)                                                                          \
+    X(const GLubyte *, GetString, (GLenum))                                                      \
+    X(void, Viewport, (GLint, GLint, GLsizei, GLsizei))                                          \
+    X(void, ClearColor, (GLclampf, GLclampf, GLclampf, GLclampf))                                \
+    X(void, Clear, (GLbitfield))                                                                 \
+    X(void, PixelStorei, (GLenum, GLint))                                                        \
+    X(void, GenTextures, (GLsizei, GLuint *))                                                    \
+    X(void, DeleteTextures, (GLsizei, const GLuint *))                                           \
+    X(void, BindTexture, (GLenum, GLuint))                                                       \
+    X(void, ActiveTexture, (GLenum))                                                             \
+    X(void, TexParameteri, (GLenum, GLenum, GLint))                                              \
+    X(void, TexImage2D, (GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *)) \
+    X(void, TexSubImage2D, (GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *)) \
+    X(void, GenBuffers, (GLsizei, GLuint *))                                                     \
+    X(void, DeleteBuffers, (GLsizei, const GLuint *))                                            \
+    X(void, BindBuffer, (GLenum, GLuint))                                                        \
+    X(void, BufferData, (GLenum, GLsizeiptr, const void *, GLenum))                              \
+    X(void, EnableVertexAttribArray, (GLuint))                                                   \
+    X(void, VertexAttribPointer, (GLuint, GLint, GLenum, GLboolean, GLsizei, const void *))      \
+    X(void, DrawArrays, (GLenum, GLint, GLsizei))                                                \
+    X(GLuint, CreateShader, (GLenum))                                                            \
+    X(void, DeleteShader, (GLuint))                                                              \
+    X(void, ShaderSource, (GLuint, GLsizei, const GLchar *const *, const GLint *))               \
+    X(void, CompileShader, (GLuint))                                                             \
+    X(void, GetShaderiv, (GLuint, GLenum, GLint *))                                              \
+    X(void, GetShaderInfoLog, (GLuint, GLsizei, GLsizei *, GLchar *))                            \
+    X(GLuint, CreateProgram, (void))                                                             \
+    X(void, DeleteProgram, (GLuint))                                                             \
+    X(void, AttachShader, (GLuint, GLuint))                                                      \
+    X(void, BindAttribLocation, (GLuint, GLuint, const GLchar *))                                \
+    X(void, LinkProgram, (GLuint))                                                               \
+    X(void, GetProgramiv, (GLuint, GLenum, GLint *))                                             \
+    X(void, GetProgramInfoLog, (GLuint, GLsizei, GLsizei *, GLchar *))                           \
+    X(void, UseProgram, (GLuint))                                                                \
+    X(GLint, GetUniformLocation, (GLuint, const GLchar *))                                       \
+    X(void, Uniform1i, (GLint, GLint))                                                           \
+    X(void, Uniform1f, (GLint, GLfloat))                                                         \
+    X(void, Uniform1fv, (GLint, GLsizei, const GLfloat *))                                       \
+    X(void, Uniform2f, (GLint, GLfloat, GLfloat))                                                \
+    X(void, Uniform4f, (GLint, GLfloat, GLfloat, GLfloat, GLfloat))
+
+/**
+ * @brief Entry points resolved at runtime; shared by every context, since
+ *        the backend only ever creates one.
+ */
+static struct
+{
+#define DECLARE_FUNCTION(ret, name, args) ret(APIENTRY *name) args;
+    GL_FUNCTIONS(DECLARE_FUNCTION)
+#undef DECLARE_FUNCTION
+} gl_api;
+
+/**
+ * @brief Vertex shader: a full-viewport quad with y pointing down the display.
+ */
+static const char *const vertex_source =
+    "#version 120\n"
+    "attribute vec2 a_pos;\n"
+    "varying vec2 v_uv;\n"
+    "void main()\n"
+    "{\n"
+    "    v_uv = vec2(a_pos.x * 0.5 + 0.5, 0.5 - a_pos.y * 0.5);\n"
+    "    gl_Position = vec4(a_pos, 0.0, 1.0);\n"
+    "}\n";
+
+/**
+ * @brief Fragment shader: unpacks one display bit per pixel.
+ *
+ * Each texel holds eight horizontally adjacent pixels, leftmost in the
+ * most significant bit; a frame of u_size pixels uses the top left of its
+ * 16x64 slot. GLSL 1.20 has no integer operations, so the bit is
+ * isolated with floor/mod on the byte value. Older frames of the history
+ * contribute halving intensities when ghosting is on; the CRT effect
+ * darkens the edges of every display row and the corners of the screen.
+ */
+static const char *const fragment_source =
+    "#version 120\n"
+    "uniform sampler2D u_bits;\n"
+    "uniform float u_rows[4];\n"
+    "uniform float u_ghost;\n"
+    "uniform float u_crt;\n"
+    "uniform vec4 u_fg;\n"
+    "uniform vec4 u_bg;\n"
+    "uniform vec2 u_size;\n"
+    "varying vec2 v_uv;\n"
+    "float lit(vec2 cell, float first_row)\n"
+    "{\n"
+    "    vec2 texel = vec2((floor(cell.x / 8.0) + 0.5) / 16.0, (first_row + cell.y + 0.5) / 256.0);\n"
+    "    float byte = floor(texture2D(u_bits, texel).r * 255.0 + 0.5);\n"
+    "    return mod(floor(byte / exp2(7.0 - mod(cell.x, 8.0))), 2.0);\n"
+    "}\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 p = v_uv * u_size;\n"
+    "    vec2 cell = min(floor(p), u_size - 1.0);\n"
+    "    float i = lit(cell, u_rows[0]);\n"
+    "    if (u_ghost > 0.0)\n"
+    "    {\n"
+    "        i = max(i, u_ghost * 0.5 * lit(cell, u_rows[1]));\n"
+    "        i = max(i, u_ghost * 0.25 * lit(cell, u_rows[2]));\n"
+    "        i = max(i, u_ghost * 0.125 * lit(cell, u_rows[3]));\n"
+    "    }\n"
+    "    vec3 c = mix(u_bg.rgb, u_fg.rgb, i);\n"
+    "    if (u_crt > 0.0)\n"
+    "    {\n"
+    "        float scan = 1.0 - u_crt * 0.35 * pow(abs(fract(p.y) - 0.5) * 2.0, 2.0);\n"
+    "        vec2 d = v_uv - 0.5;\n"
+    "        c *= scan * (1.0 - u_crt * dot(d, d) * 0.5);\n"
+    "    }\n"
+    "    gl_FragColor = vec4(c, 1.0);\n"
+    "}\n";
+
+_Static_assert(GL_RENDERER_HISTORY == 4, "fragment_source samples exactly four history frames");
+_Static_assert(GL_BYTES_PER_ROW == 16 && GL_TEXTURE_ROWS == 256, "fragment_source assumes a 16x256 texture");
+
+/**
+ * @brief Resolves every entry point in GL_FUNCTIONS.
+ *
+ * @return false, naming the first missing function, if any is unavailable.
+ */
+static bool load_functions(void)
+{
+#define LOAD_FUNCTION(ret, name, args)                                                    \
+    gl_api.name = (ret(APIENTRY *) args)SDL_GL_GetProcAddress("gl" #name);          \
+    if (!gl_api.name)                                                               \
+    {                                                                               \
+        print_warning("OpenGL function gl%s is unavailable.", #name);               \
+        return false;                                                               \
+    }
+    GL_FUNCTIONS(LOAD_FUNCTION)
+#undef LOAD_FUNCTION
+    return true;
+}
+
+/**
+ * @brief Compiles one shader stage.
+ *
+ * @return The shader, or 0 after logging the compiler output.
+ */
+static GLuint compile_shader(GLenum type, const char *source)
+{
+    GLuint shader = gl_api.CreateShader(type);
+    if (!shader)
+        return 0;
+
+    gl_api.ShaderSource(shader, 1, &source, NULL);
+    gl_api.CompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    gl_api.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char log[512] = "";
+        gl_api.GetShaderInfoLog(shader, sizeof(log), NULL, log);
+        print_warning("OpenGL shader failed to compile: %s", log);
+        gl_api.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+/**
+ * @brief Compiles and links the display program with a_pos at location 0.
+ *
+ * @return The program, or 0 after logging why it failed.
+ */
+static GLuint build_program(void)
+{
+    GLuint vs = compile_shader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fs = vs ? compile_shader(GL_FRAGMENT_SHADER, fragment_source) : 0;
+    GLuint program = fs ? gl_api.CreateProgram() : 0;
+
+    if (program)
+    {
+        gl_api.AttachShader(program, vs);
+        gl_api.AttachShader(program, fs);
+        gl_api.BindAttribLocation(program, 0, "a_pos");
+        gl_api.LinkProgram(program);
+
+        GLint ok = GL_FALSE;
+        gl_api.GetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok)
+        {
+            char log[512] = "";
+            gl_api.GetProgramInfoLog(program, sizeof(log), NULL, log);
+            print_warning("OpenGL shader failed to link: %s", log);
+            gl_api.DeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    // The program keeps what it needs; the stages can go either way
+    if (vs)
+        gl_api.DeleteShader(vs);
+    if (fs)
+        gl_api.DeleteShader(fs);
+    return program;
+}
+
+/**
+ * @brief Sets a vec4 uniform from a configuration colour.
+ *
+ * Colours are read as ARGB, like the ARGB8888 texture of the SDL renderer,
+ * so both backends show the same palette. Alpha is ignored there too.
+ */
+static void set_color(GLint location, uint32_t color)
+{
+    gl_api.Uniform4f(location,
+                     ((color >> 16) & 0xFF) / 255.0f,
+                     ((color >> 8) & 0xFF) / 255.0f,
+                     (color & 0xFF) / 255.0f,
+                     1.0f);
+}
+
+bool gl_renderer_init(gl_renderer_t *gl, SDL_Window *window, const display_config_t *config,
+                      const chip8_machine_t *machine)
+{
+    memset(gl, 0, sizeof(*gl));
+    gl->window = window;
+    gl->width = machine->width;
+    gl->height = machine->height;
+    gl->bg_color = config->bg_color;
+    gl->ghost = config->ghost;
+
+    gl->context = SDL_GL_CreateContext(window);
+    if (!gl->context)
+    {
+        print_warning("OpenGL context could not be created: %s", SDL_GetError());
+        return false;
+    }
+
+    if (!load_functions() || !(gl->program = build_program()))
+    {
+        gl_renderer_cleanup(gl);
+        return false;
+    }
+
+    // Presenting is paced by the emulation thread; vsync only avoids tearing
+    SDL_GL_SetSwapInterval(1);
+
+    // Two triangles covering the viewport
+    static const GLfloat quad[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    gl_api.GenBuffers(1, &gl->vertices);
+    gl_api.BindBuffer(GL_ARRAY_BUFFER, gl->vertices);
+    gl_api.BufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    gl_api.EnableVertexAttribArray(0);
+    gl_api.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+
+    // One byte per texel, history frames stacked vertically, all cleared
+    static const uint8_t blank[GL_TEXTURE_ROWS * GL_BYTES_PER_ROW];
+    gl_api.GenTextures(1, &gl->texture);
+    gl_api.ActiveTexture(GL_TEXTURE0);
+    gl_api.BindTexture(GL_TEXTURE_2D, gl->texture);
+    gl_api.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl_api.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl_api.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl_api.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl_api.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gl_api.TexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, GL_BYTES_PER_ROW, GL_TEXTURE_ROWS, 0,
+                      GL_LUMINANCE, GL_UNSIGNED_BYTE, blank);
+
+    gl_api.UseProgram(gl->program);
+    gl_api.Uniform1i(gl_api.GetUniformLocation(gl->program, "u_bits"), 0);
+    gl->u_rows = gl_api.GetUniformLocation(gl->program, "u_rows");
+    gl->u_ghost = gl_api.GetUniformLocation(gl->program, "u_ghost");
+    gl->u_crt = gl_api.GetUniformLocation(gl->program, "u_crt");
+    gl->u_fg = gl_api.GetUniformLocation(gl->program, "u_fg");
+    gl->u_bg = gl_api.GetUniformLocation(gl->program, "u_bg");
+    gl->u_size = gl_api.GetUniformLocation(gl->program, "u_size");
+
+    set_color(gl->u_fg, config->fg_color);
+    set_color(gl->u_bg, config->bg_color);
+    gl_api.Uniform1f(gl->u_ghost, config->ghost ? 1.0f : 0.0f);
+    gl_api.Uniform1f(gl->u_crt, config->crt ? 1.0f : 0.0f);
+    gl_api.Uniform2f(gl->u_size, CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT);
+
+    // Nothing in the history yet; treat the trail as already faded
+    gl->unchanged = GL_RENDERER_HISTORY;
+    print_info("Using the OpenGL renderer (%s).", (const char *)gl_api.GetString(GL_RENDERER));
+    return true;
+}
+
+void gl_renderer_present(gl_renderer_t *gl, const uint64_t *display, bool hires, uint64_t dirty)
+{
+    // An unchanged display only needs drawing while a ghost trail fades
+    if (dirty)
+        gl->unchanged = 0;
+    else if (!gl->ghost || gl->unchanged >= GL_RENDERER_HISTORY - 1)
+        return;
+    else
+        gl->unchanged++;
+
+    // The trail is in the old layout; switching clears the screen anyway
+    if (hires != gl->hires)
+    {
+        static const uint8_t blank[GL_TEXTURE_ROWS * GL_BYTES_PER_ROW];
+        gl_api.TexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GL_BYTES_PER_ROW, GL_TEXTURE_ROWS,
+                             GL_LUMINANCE, GL_UNSIGNED_BYTE, blank);
+        gl_api.Uniform2f(gl->u_size, CHIP8_DISPLAY_WIDTH << hires, CHIP8_DISPLAY_HEIGHT << hires);
+        gl->hires = hires;
+    }
+
+    // Repack the rows big-endian so texel x/8 holds pixels x..x+7, MSB first
+    const int words = hires ? 2 : 1;
+    const int lines = CHIP8_DISPLAY_HEIGHT << hires;
+    uint8_t bits[CHIP8_HIRES_HEIGHT * GL_BYTES_PER_ROW];
+    for (int y = 0; y < lines; y++)
+        for (int b = 0; b < 8 * words; b++)
+            bits[y * 8 * words + b] = (uint8_t)(display[y * words + b / 8] >> (56 - 8 * (b % 8)));
+
+    // Without ghosting only slot 0 is ever sampled
+    if (gl->ghost)
+        gl->head = (gl->head + 1) % GL_RENDERER_HISTORY;
+    gl_api.TexSubImage2D(GL_TEXTURE_2D, 0, 0, gl->head * CHIP8_HIRES_HEIGHT,
+                         8 * words, lines, GL_LUMINANCE, GL_UNSIGNED_BYTE, bits);
+
+    GLfloat rows[GL_RENDERER_HISTORY];
+    for (int k = 0; k < GL_RENDERER_HISTORY; k++)
+        rows[k] = (GLfloat)(((gl->head - k + GL_RENDERER_HISTORY) % GL_RENDERER_HISTORY) * CHIP8_HIRES_HEIGHT);
+    gl_api.Uniform1fv(gl->u_rows, GL_RENDERER_HISTORY, rows);
+
+    // Letterbox in the background colour, then the largest whole multiple
+    // of the largest screen that fits (or a plain fit in smaller windows)
+    int width, height;
+    SDL_GL_GetDrawableSize(gl->window, &width, &height);
+    gl_api.Viewport(0, 0, width, height);
+    gl_api.ClearColor(((gl->bg_color >> 16) & 0xFF) / 255.0f,
+                      ((gl->bg_color >> 8) & 0xFF) / 255.0f,
+                      (gl->bg_color & 0xFF) / 255.0f, 1.0f);
+    gl_api.Clear(GL_COLOR_BUFFER_BIT);
+
+    int scale_x = width / gl->width;
+    int scale_y = height / gl->height;
+    int scale = scale_x < scale_y ? scale_x : scale_y;
+    int view_w = scale ? scale * gl->width : width;
+    int view_h = scale ? scale * gl->height : height;
+    gl_api.Viewport((width - view_w) / 2, (height - view_h) / 2, view_w, view_h);
+    gl_api.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    SDL_GL_SwapWindow(gl->window);
+}
+
+void gl_renderer_cleanup(gl_renderer_t *gl)
+{
+    if (!gl->context)
+        return;
+
+    // Functions are only missing if loading failed before anything was made
+    if (gl->texture)
+        gl_api.DeleteTextures(1, &gl->texture);
+    if (gl->vertices)
+        gl_api.DeleteBuffers(1, &gl->vertices);
+    if (gl->program)
+        gl_api.DeleteProgram(gl->program);
+
+    SDL_GL_DeleteContext(gl->context);
+    memset(gl, 0, sizeof(*gl));
+}
@@ -0,0 +1,177 @@
+/**
+ * @file headless.c
+ * @brief Implementation of windowless, unthrottled execution.
+ */
+
+#include <SDL2/SDL_timer.h>
+#include <stdio.h>
+
+#include "headless.h"
+
+/**
+ * @brief Applies @p ticks 60 Hz timer ticks at once.
+ */
+static void advance_timers(chip8_t *emu, uint64_t ticks)
+{
+    // Both timers stop at zero, so 255 ticks clear them
+    if (ticks > 255)
+        ticks = 255;
+    while (ticks--)
+        chip8_timers_decrement(emu);
+}
+
+bool headless_run(chip8_t *emu, const emulation_config_t *cfg, profiler_t *prof,
+                  recorder_t *rec, debugger_t *dbg, headless_result_t *result)
+{
+    const uint32_t cycles_per_frame = cfg->cycles_per_frame ? cfg->cycles_per_frame : 1;
+    uint64_t start = SDL_GetPerformanceCounter();
+    const uint64_t skipped_before = emu->idle_skipped;
+    uint64_t cycles = 0;
+    uint64_t frames = 0;
+    uint32_t frame_cycles = 0;
+    chip8_idle_t idle = CHIP8_IDLE_NONE;
+
+    // Without input, a ROM waiting in FX0A can never continue
+    while (cycles < cfg->max_cycles && emu->state == CHIP8_RUNNING && !chip8_waiting_for_key(emu))
+    {
+        uint64_t left = cfg->max_cycles - cycles;
+
+        if (idle == CHIP8_IDLE_INPUT)
+        {
+            // No key ever changes here, so the loop runs to the end of the
+            // budget and never reads the timers: skip it in one slice and
+            // catch the timers up afterwards
+            uint32_t done = chip8_run_until_tick(emu, left > UINT32_MAX ? UINT32_MAX : (uint32_t)left, &idle);
+            uint64_t elapsed = (uint64_t)frame_cycles + done;
+            advance_timers(emu, elapsed / cycles_per_frame);
+            frames += elapsed / cycles_per_frame;
+
+            // The idle loop never draws, so every skipped frame shows the same screen
+            if (rec && elapsed >= cycles_per_frame)
+                recorder_push(rec, emu->display, emu->hires, (uint32_t)(elapsed / cycles_per_frame));
+            frame_cycles = (uint32_t)(elapsed % cycles_per_frame);
+            cycles += done;
+            continue;
+        }
+
+        // Virtual clock: one timer tick per frame's worth of instructions
+        uint32_t slice = cycles_per_frame - frame_cycles;
+        if (slice > left)
+            slice = (uint32_t)left;
+
+        uint32_t done = 0;
+        if (prof)
+        {
+            for (; done < slice && emu->state == CHIP8_RUNNING && !chip8_waiting_for_key(emu); done++)
+                profiler_cycle(prof, emu);
+        }
+        else
+        {
+            // A stop ends the slice early; the next one carries on from it
+            done = chip8_run_until_tick(emu, slice, &idle);
+            if (dbg && debugger_stopped(emu))
+                debugger_report(dbg, emu);
+        }
+        cycles += done;
+        frame_cycles += done;
+
+        if (frame_cycles == cycles_per_frame)
+        {
+            chip8_timers_decrement(emu);
+            frame_cycles = 0;
+            frames++;
+            if (rec)
+                recorder_push(rec, emu->display, emu->hires, 1);
+        }
+    }
+
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+
+    result->cycles = cycles;
+    result->executed = cycles - (emu->idle_skipped - skipped_before);
+    result->frames = frames;
+    result->display_hash = chip8_display_hash(emu);
+    result->memory_hash = chip8_memory_hash(emu);
+    result->elapsed_seconds = (double)elapsed / (double)SDL_GetPerformanceFrequency();
+
+    return emu->state != CHIP8_ERROR;
+}
+
+bool headless_replay(chip8_t *emu, const emulation_config_t *cfg, const replay_t *replay,
+                     profiler_t *prof, recorder_t *rec, debugger_t *dbg, headless_result_t *result)
+{
+    const uint32_t cycles_per_frame = replay->cycles_per_frame;
+    uint64_t start = SDL_GetPerformanceCounter();
+    const uint64_t skipped_before = emu->idle_skipped;
+    uint64_t cycles = 0;
+    uint64_t frames = 0;
+    uint32_t next = 0;
+
+    chip8_set_keys(emu, replay->start_keys, 0);
+
+    while (frames < replay->frames && emu->state == CHIP8_RUNNING)
+    {
+        // Keys change only between frames, as on the emulation thread
+        if (next < replay->count && replay->events[next].frame == frames)
+        {
+            chip8_set_keys(emu, replay->events[next].held, replay->events[next].pressed);
+            next++;
+        }
+
+        uint64_t left = cfg->max_cycles - cycles;
+        uint32_t slice = left < cycles_per_frame ? (uint32_t)left : cycles_per_frame;
+
+        uint32_t done = 0;
+        if (prof)
+        {
+            for (; done < slice && emu->state == CHIP8_RUNNING && !chip8_waiting_for_key(emu); done++)
+                profiler_cycle(prof, emu);
+        }
+        else
+        {
+            // Stops must not cut the frame short, or the log stops matching
+            chip8_idle_t idle;
+            done = chip8_run_until_tick(emu, slice, &idle);
+            while (dbg && debugger_stopped(emu) && emu->state == CHIP8_RUNNING)
+            {
+                debugger_report(dbg, emu);
+                if (done == slice)
+                    break;
+                done += chip8_run_until_tick(emu, slice - done, &idle);
+            }
+        }
+        cycles += done;
+
+        // Out of budget part way through: the frame never completed
+        if (slice < cycles_per_frame)
+            break;
+
+        chip8_timers_decrement(emu);
+        frames++;
+        if (rec)
+            recorder_push(rec, emu->display, emu->hires, 1);
+    }
+
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+
+    result->cycles = cycles;
+    result->executed = cycles - (emu->idle_skipped - skipped_before);
+    result->frames = frames;
+    result->display_hash = chip8_display_hash(emu);
+    result->memory_hash = chip8_memory_hash(emu);
+    result->elapsed_seconds = (double)elapsed / (double)SDL_GetPerformanceFrequency();
+
+    return emu->state != CHIP8_ERROR;
+}
+
+void headless_print_display(const chip8_t *emu, FILE *out)
+{
+    const unsigned width = chip8_display_width(emu);
+    const unsigned height = chip8_display_height(emu);
+    for (unsigned y = 0; y < height; y++)
+    {
+        for (unsigned x = 0; x < width; x++)
+            fputc(chip8_get_pixel(emu, x, y) ? '#' : '.', out);
+        fputc('\n', out);
+    }
+}
@@ -8,20 +8,84 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_mixer.h>
 
 #include "chip8.h"
 #include "cli_logger.h"
 #include "sdl_interface.h"
 #include "config.h"
 #include "audio.h"
+#include "headless.h"
+#include "profiler.h"
+#include "savestate.h"
+#include "emu_thread.h"
+#include "recorder.h"
+#include "replay.h"
+#include "quirks_db.h"
+#include "debugger.h"
+#include "disasm.h"
+#include "metrics.h"
 #ifdef _WIN32
 #include "win_parser.h"
 #endif
 
+/**
+ * @brief Returns a dirty-row mask of the rows that differ between two displays.
+ *
+ * Displays of different resolutions differ in every row.
+ */
+static uint64_t changed_rows(const uint64_t *shown, bool shown_hires, const uint64_t *display, bool hires)
+{
+    if (shown_hires != hires)
+        return CHIP8_ALL_ROWS_DIRTY;
+
+    const int words = hires ? 2 : 1;
+    uint64_t dirty = 0;
+    for (int y = 0; y < (CHIP8_DISPLAY_HEIGHT << hires); y++)
+    {
+        if (memcmp(&shown[y * words], &display[y * words], (size_t)words * sizeof(*display)) != 0)
+            dirty |= (uint64_t)1 << y;
+    }
+    return dirty;
+}
+
+/**
+ * @brief Stops the profiler, prints its report and writes --profile-out.
+ */
+static void finish_profile(profiler_t *prof, const chip8_t *emu, const emulation_config_t *cfg)
+{
+    profiler_stop(prof);
+    log_flush();
+    profiler_print_report(prof, emu, stdout);
+
+    if (cfg->profile_out[0] != '\0')
+    {
+        if (profiler_write_file(prof, emu, cfg->profile_out))
+            print_info("Profile written to %s", cfg->profile_out);
+        else
+            print_error("Failed to write profile: %s", cfg->profile_out);
+    }
+}
+
+/**
+ * @brief Writes --metrics-out and says so.
+ */
+static void write_metrics(const metrics_t *metrics, const char *path)
+{
+    if (metrics_write_file(metrics, path))
+        print_info("Metrics written to %s", path);
+    else
+        print_error("Failed to write metrics: %s", path);
+}
+
 int main(int argc, char *argv[])
 {
+    // Startup is timed unconditionally; --profile decides whether it is shown
+    profiler_startup_t startup;
+    profiler_startup_begin(&startup);
+
     // 1) Create a single config structure for display, audio, and ROM
     app_config_t app_cfg;
     memset(&app_cfg, 0, sizeof(app_cfg));
@@ -39,6 +103,11 @@ int main(int argc, char *argv[])
         print_usage(argv[0], true);
         return EXIT_FAILURE;
     }
+    profiler_startup_mark(&startup, "config");
+
+    // From here on messages are written by a background thread
+    log_start();
+    atexit(log_stop);
 
     // 3) Initialize CHIP-8 emulator state
     chip8_t emu;
@@ -51,71 +120,440 @@ int main(int argc, char *argv[])
     // Copy display config into emulator
     emu.config = app_cfg.display_cfg;
 
+#ifndef CHIP8_TRACE
+    if (app_cfg.emu_cfg.trace)
+        print_warning("--trace ignored: rebuild with 'make TRACE=1' to enable instruction tracing.");
+#endif
+
+    // A replay brings its own seed and frame size: the session is only
+    // reproduced if both match
+    replay_t replay;
+    memset(&replay, 0, sizeof(replay));
+    bool replaying = app_cfg.emu_cfg.replay_path[0] != '\0';
+    if (replaying)
+    {
+        if (!replay_read(&replay, app_cfg.emu_cfg.replay_path))
+            return EXIT_FAILURE;
+        app_cfg.emu_cfg.seed = replay.seed;
+        app_cfg.emu_cfg.seed_set = true;
+        app_cfg.emu_cfg.cycles_per_frame = replay.cycles_per_frame;
+        app_cfg.emu_cfg.machine = replay.machine;
+        app_cfg.emu_cfg.quirks = replay.quirks;
+    }
+    chip8_set_machine(&emu, app_cfg.emu_cfg.machine);
+
+    // Seed CXNN: fixed when headless so runs are reproducible, otherwise
+    // varied per session but logged so any session can be replayed
+    uint64_t seed = app_cfg.emu_cfg.seed;
+    if (!app_cfg.emu_cfg.seed_set)
+    {
+        seed = app_cfg.emu_cfg.headless ? CHIP8_DEFAULT_SEED
+                                        : (uint64_t)time(NULL) ^ SDL_GetPerformanceCounter();
+        if (!app_cfg.emu_cfg.headless)
+            print_info("Random seed: %llu (pass --seed to reproduce)", (unsigned long long)seed);
+    }
+    chip8_seed(&emu, seed);
+    profiler_startup_mark(&startup, "core");
+
     // 4) Load the ROM
     if (!chip8_load_program(&emu, app_cfg.rom_path))
     {
         print_error("Failed to load ROM: %s\n", app_cfg.rom_path);
+        replay_free(&replay);
+        return EXIT_FAILURE;
+    }
+
+    // Quirks from --quirks, else from the database; unknown ROMs get the machine's usual ones
+    uint8_t quirks = app_cfg.emu_cfg.quirks;
+    if (quirks == CONFIG_QUIRKS_AUTO)
+    {
+        uint8_t fallback = emu.machine == CONFIG_MACHINE_SCHIP ? CONFIG_QUIRKS_SCHIP : CONFIG_QUIRKS_MODERN;
+        quirks = quirks_db_select(app_cfg.emu_cfg.quirks_db, app_cfg.rom_path, fallback);
+    }
+    chip8_set_quirks(&emu, quirks);
+    chip8_set_core(&emu, app_cfg.emu_cfg.core);
+
+#ifdef CHIP8_TRACE
+    // The header records the machine and quirks, so this waits until both are known
+    emu.trace = app_cfg.emu_cfg.trace;
+    if (app_cfg.emu_cfg.trace_file[0] != '\0')
+    {
+        uint8_t header[CHIP8_TRACE_HEADER_SIZE];
+        chip8_trace_header(&emu, header);
+        if (!log_trace_open(app_cfg.emu_cfg.trace_file, header, sizeof(header)))
+        {
+            replay_free(&replay);
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    // Map the program once, so the core does not have to probe for idle loops everywhere
+    {
+        disasm_t analysis;
+        disasm_analyze(&analysis, &emu);
+        chip8_set_code_hints(&emu, analysis.code_map, analysis.idle_map);
+        // Only with --trace: the summary line of other runs is parsed by scripts
+        if (app_cfg.emu_cfg.trace)
+            print_debug("ROM analysis: %u instructions in %u blocks, %u idle loop starts, %u indirect jumps",
+                        analysis.instructions, analysis.block_count, analysis.idle_starts, analysis.indirect_jumps);
+    }
+
+    // Resume from a save state, if requested
+    if (app_cfg.emu_cfg.load_state[0] != '\0' && !savestate_read(&emu, app_cfg.emu_cfg.load_state))
+    {
+        replay_free(&replay);
+        return EXIT_FAILURE;
+    }
+
+    if (replaying && chip8_memory_hash(&emu) != replay.start_hash)
+    {
+        print_error("Input log was recorded with a different ROM or save state: %s", app_cfg.emu_cfg.replay_path);
+        replay_free(&replay);
         return EXIT_FAILURE;
     }
+    profiler_startup_mark(&startup, "ROM");
+
+    // Optional profiler; NULL keeps the plain chip8_cycle() path
+    profiler_t *prof = NULL;
+    if (app_cfg.emu_cfg.profile)
+    {
+        prof = profiler_create();
+        if (!prof)
+        {
+            print_error("Failed to allocate profiler.");
+            replay_free(&replay);
+            return EXIT_FAILURE;
+        }
+        profiler_start(prof);
+    }
+    profiler_startup_mark(&startup, "profiler");
+
+    // Breakpoints, watchpoints and conditions from the command line; the
+    // port only makes sense with a window to pause
+    if (app_cfg.emu_cfg.headless && app_cfg.emu_cfg.debug_port)
+    {
+        print_warning("--debug-port ignored: headless runs log their stops and carry on.");
+        app_cfg.emu_cfg.debug_port = 0;
+    }
+    debugger_t dbg;
+    if (!debugger_init(&dbg, &emu, &app_cfg.emu_cfg))
+    {
+        profiler_destroy(prof);
+        replay_free(&replay);
+        return EXIT_FAILURE;
+    }
+    if (prof && (emu.breakpoint_count || emu.watch_count || emu.condition_count))
+        print_warning("Breakpoints and watchpoints are ignored while profiling.");
+
+    // Headless: no window, no audio, no frame pacing
+    if (app_cfg.emu_cfg.headless)
+    {
+        if (app_cfg.emu_cfg.record_input[0] != '\0')
+            print_warning("--record-input ignored: headless runs take no input.");
+
+        // Nothing runs in real time here, so the recorder may make us wait
+        recorder_t *rec = NULL;
+        if (app_cfg.emu_cfg.record_path[0] != '\0' &&
+            !(rec = recorder_open(app_cfg.emu_cfg.record_path, true, chip8_machine_info(emu.machine))))
+        {
+            profiler_destroy(prof);
+            replay_free(&replay);
+            return EXIT_FAILURE;
+        }
+
+        profiler_startup_mark(&startup, "setup");
+        if (prof)
+        {
+            log_flush();
+            profiler_startup_print(&startup, stdout);
+        }
+
+        headless_result_t result;
+        bool ok = replaying ? headless_replay(&emu, &app_cfg.emu_cfg, &replay, prof, rec, &dbg, &result)
+                            : headless_run(&emu, &app_cfg.emu_cfg, prof, rec, &dbg, &result);
+        if (!recorder_close(rec))
+            ok = false;
+
+        // Logged messages first, so they stay ahead of the results
+        log_flush();
+        if (app_cfg.emu_cfg.dump_display)
+            headless_print_display(&emu, stdout);
+
+        double ips = result.elapsed_seconds > 0.0 ? (double)result.executed / result.elapsed_seconds : 0.0;
+        printf("display_hash=%016llx memory_hash=%016llx seed=%llu cycles=%llu frames=%llu seconds=%.6f ips=%.0f\n",
+               (unsigned long long)result.display_hash,
+               (unsigned long long)result.memory_hash,
+               (unsigned long long)emu.seed,
+               (unsigned long long)result.cycles,
+               (unsigned long long)result.frames,
+               result.elapsed_seconds, ips);
+
+        // Regression checks: the recorded session's end, or a given hash
+        if (replaying)
+        {
+            if (result.frames < replay.frames)
+            {
+                print_error("Replay ended after %llu of %llu frames%s.",
+                            (unsigned long long)result.frames, (unsigned long long)replay.frames,
+                            emu.state == CHIP8_RUNNING ? " (raise --max-cycles)" : "");
+                ok = false;
+            }
+            else if (result.display_hash != replay.display_hash || result.memory_hash != replay.memory_hash)
+            {
+                print_error("Replay diverged: display_hash=%016llx memory_hash=%016llx, recorded %016llx %016llx.",
+                            (unsigned long long)result.display_hash, (unsigned long long)result.memory_hash,
+                            (unsigned long long)replay.display_hash, (unsigned long long)replay.memory_hash);
+                ok = false;
+            }
+            else
+            {
+                print_info("Replay matches the recorded session (%llu frames).", (unsigned long long)replay.frames);
+            }
+            replay_free(&replay);
+        }
+        if (app_cfg.emu_cfg.expect_hash_set && result.display_hash != app_cfg.emu_cfg.expect_hash)
+        {
+            print_error("display_hash=%016llx, expected %016llx.",
+                        (unsigned long long)result.display_hash, (unsigned long long)app_cfg.emu_cfg.expect_hash);
+            ok = false;
+        }
+
+        if (prof)
+        {
+            finish_profile(prof, &emu, &app_cfg.emu_cfg);
+            profiler_destroy(prof);
+        }
+        if (app_cfg.emu_cfg.metrics_out[0] != '\0')
+        {
+            // Nothing is presented or paced headless: only the counters and the run time apply
+            metrics_t metrics;
+            metrics_init(&metrics, app_cfg.emu_cfg.cycles_per_frame);
+            metrics.start_ticks -= (uint64_t)(result.elapsed_seconds * (double)SDL_GetPerformanceFrequency());
+            metrics.emu.instructions = result.executed;
+            metrics.emu.idle_skipped = result.cycles - result.executed;
+            metrics.emu.frames = result.frames;
+            metrics.emu.timer_ticks = result.frames;
+            write_metrics(&metrics, app_cfg.emu_cfg.metrics_out);
+        }
+        if (app_cfg.emu_cfg.save_state[0] != '\0' && !savestate_write(&emu, app_cfg.emu_cfg.save_state))
+            ok = false;
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
     // 5) Initialize SDL (window, renderer, texture)
     sdl_t sdl;
-    if (!sdl_init(&sdl, &app_cfg.display_cfg))
+    if (!sdl_init(&sdl, &app_cfg.display_cfg, chip8_machine_info(emu.machine)))
     {
         print_error("SDL initialization failed.\n");
+        debugger_cleanup(&dbg);
+        profiler_destroy(prof);
         return EXIT_FAILURE;
     }
+    profiler_startup_mark(&startup, "video");
 
-    // 6) Initialize audio (if enabled)
+    // 6) Enable audio (if enabled); the device opens on the first beep
     if (app_cfg.audio_cfg.enabled)
     {
-        if (!audio_init(app_cfg.audio_cfg.wav_path))
+        if (!audio_init(&app_cfg.audio_cfg))
         {
             print_error("Audio initialization failed.\n");
+            debugger_cleanup(&dbg);
             sdl_cleanup(&sdl);
+            profiler_destroy(prof);
             return EXIT_FAILURE;
         }
-        // Set global volume for SDL_mixer
-        Mix_Volume(-1, app_cfg.audio_cfg.volume);
     }
 
-    // 7) Main loop
+    // Rewind history: one delta-compressed frame per 60 Hz tick
+    rewind_t rewind;
+    bool rewind_enabled = false;
+    if (app_cfg.emu_cfg.rewind_seconds > 0)
+    {
+        rewind_enabled = rewind_init(&rewind, app_cfg.emu_cfg.rewind_seconds);
+        if (!rewind_enabled)
+            print_warning("Failed to allocate %u s of rewind history; rewind disabled.",
+                          app_cfg.emu_cfg.rewind_seconds);
+    }
+
+    // Recording must never hold up emulation: a full queue drops frames
+    recorder_t *rec = NULL;
+    if (app_cfg.emu_cfg.record_path[0] != '\0' &&
+        !(rec = recorder_open(app_cfg.emu_cfg.record_path, false, chip8_machine_info(emu.machine))))
+        print_warning("Recording disabled.");
+
+    if (app_cfg.emu_cfg.expect_hash_set)
+        print_warning("--expect-hash ignored: it checks headless runs.");
+
+    // Input log: the keys of every emulated frame, written on exit
+    replay_t input_log;
+    bool record_input = app_cfg.emu_cfg.record_input[0] != '\0';
+    if (record_input)
+        replay_begin(&input_log, &emu, app_cfg.emu_cfg.cycles_per_frame);
+    profiler_startup_mark(&startup, "buffers");
+
+    // 7) Emulate on a thread of its own; this one only polls input and
+    //    presents finished frames, so a slow present or the quit dialog
+    //    never stalls emulation
+    emu_thread_t emu_thread;
+    if (!emu_thread_start(&emu_thread, &emu, &app_cfg.emu_cfg, prof, rewind_enabled ? &rewind : NULL, rec,
+                          record_input ? &input_log : NULL, &dbg))
+    {
+        debugger_cleanup(&dbg);
+        if (record_input)
+            replay_free(&input_log);
+        recorder_close(rec);
+        if (rewind_enabled)
+            rewind_cleanup(&rewind);
+        sdl_cleanup(&sdl);
+        if (app_cfg.audio_cfg.enabled)
+            audio_cleanup();
+        profiler_destroy(prof);
+        return EXIT_FAILURE;
+    }
+
+    profiler_startup_mark(&startup, "emu thread");
+
+    sdl_keymap_t keymap;
+    sdl_keymap_default(&keymap);
+    if (app_cfg.input_cfg.keymap_path[0] != '\0' && !sdl_keymap_load(&keymap, app_cfg.input_cfg.keymap_path))
+        print_warning("Using the default key bindings.");
+
+    sdl_input_t input = {.keymap = &keymap, .keys = 0, .pressed = 0, .state = CHIP8_RUNNING, .steps = 0, .redraw = true,
+                         .overlay = false};
+    uint64_t shown[CHIP8_DISPLAY_WORDS]; // What the texture currently holds
+    memset(shown, 0, sizeof(shown));
+    bool shown_hires = false;
     bool running = true;
-    uint8_t previous_frame[64 * 32];
-    memset(previous_frame, 0, sizeof(previous_frame));
+    bool first_present = true;
+    profiler_startup_mark(&startup, "keymap");
+
+    // Health counters: the F3 overlay refreshes every second, --stats logs every few
+    const uint64_t freq = SDL_GetPerformanceFrequency();
+    metrics_t metrics;
+    metrics_init(&metrics, app_cfg.emu_cfg.cycles_per_frame);
+    metrics_mark_t overlay_mark, stats_mark;
+    metrics_mark(&metrics, &overlay_mark);
+    metrics_mark(&metrics, &stats_mark);
+    bool overlay_shown = false;
 
     while (running)
     {
+        // A breakpoint pauses on its own, the debugger port may resume
+        chip8_state_t debug_state;
+        if (emu_thread_debug_state(&emu_thread, &debug_state) && input.state != CHIP8_STOPPED)
+            input.state = debug_state;
+
         // Poll events
         SDL_Event event;
         while (SDL_PollEvent(&event))
-        {
-            sdl_handle_event(&emu, &event);
+            sdl_handle_event(&input, &event);
 
-            // If the emulator's state changes to STOPPED, exit
-            if (emu.state == CHIP8_STOPPED)
-            {
-                running = false;
-            }
+        emu_thread_set_input(&emu_thread, input.keys, input.pressed, input.state);
+        input.pressed = 0;
+        if (input.steps)
+            emu_thread_step(&emu_thread, input.steps);
+        input.steps = 0;
+        if (input.state == CHIP8_STOPPED)
+            break;
+
+        audio_update();
+
+        // The title bar and the log are updated whether or not a frame is due
+        uint64_t now = SDL_GetPerformanceCounter();
+        if (input.overlay && now - overlay_mark.ticks >= freq)
+        {
+            char line[METRICS_LINE_MAX];
+            metrics_sample(&metrics, &overlay_mark, line, sizeof(line));
+            sdl_show_status(&sdl, line);
+            overlay_shown = true;
+        }
+        else if (!input.overlay && overlay_shown)
+        {
+            sdl_show_status(&sdl, NULL);
+            overlay_shown = false;
+        }
+        if (app_cfg.emu_cfg.stats_seconds && now - stats_mark.ticks >= app_cfg.emu_cfg.stats_seconds * freq)
+        {
+            char line[METRICS_LINE_MAX];
+            metrics_sample(&metrics, &stats_mark, line, sizeof(line));
+            print_info("Stats: %s", line);
+        }
 
-            // If the emulator is paused, skip emulation cycle
-            if (emu.state == CHIP8_PAUSED)
-                break;
+        // Frames arrive at 60 Hz; wait briefly when there is nothing new
+        const emu_frame_t *frame = emu_thread_acquire(&emu_thread);
+        if (!frame && !input.redraw)
+        {
+            SDL_Delay(1);
+            continue;
         }
+        const bool fresh = frame != NULL;
+        if (!frame)
+            frame = emu_thread_current(&emu_thread);
+        else
+            metrics_frame(&metrics, &frame->metrics, frame->frame);
+
+        // Present the rows that changed since the last present, if any
+        uint64_t dirty = input.redraw ? CHIP8_ALL_ROWS_DIRTY
+                                      : changed_rows(shown, shown_hires, frame->display, frame->hires);
+        memcpy(shown, frame->display, sizeof(shown));
+        shown_hires = frame->hires;
+        input.redraw = false;
+
+        uint64_t render_start = SDL_GetPerformanceCounter();
+        sdl_present(&sdl, frame->display, frame->hires, &app_cfg.display_cfg, dirty);
+        uint64_t render_end = SDL_GetPerformanceCounter();
+        if (prof)
+            profiler_add_render(prof, render_end - render_start);
+
+        // Without changed rows only the OpenGL backend draws at all
+        metrics_present(&metrics, dirty != 0 || sdl.gl, render_end - render_start,
+                        fresh ? render_end - frame->published : 0);
 
-        // If still running, do one CPU cycle
-        if (emu.state == CHIP8_RUNNING)
+        if (first_present)
         {
-            chip8_cycle(&emu);                             // Execute instructions
-            chip8_timers_tick_60hz(&emu);                  // Update timers at ~60 Hz
-            sdl_update_screen(&sdl, &emu, previous_frame); // Render if needed
+            first_present = false;
+            profiler_startup_mark(&startup, "first frame");
+            if (prof)
+            {
+                log_flush();
+                profiler_startup_print(&startup, stdout);
+            }
         }
 
-        // Small delay to control emulation speed and prevent high CPU usage
-        SDL_Delay(1);
+        // The ROM itself can stop the emulator (stack overflow, PC out of range)
+        if (frame->state == CHIP8_STOPPED)
+            running = false;
+    }
+
+    emu_thread_stop(&emu_thread);
+    debugger_cleanup(&dbg);
+    recorder_close(rec);
+
+    // The thread has stopped, so its final counters can be read directly
+    metrics.emu = emu_thread.metrics;
+    if (app_cfg.emu_cfg.metrics_out[0] != '\0')
+        write_metrics(&metrics, app_cfg.emu_cfg.metrics_out);
+
+    if (record_input)
+    {
+        replay_write(&input_log, &emu, app_cfg.emu_cfg.record_input);
+        replay_free(&input_log);
     }
 
     // 8) Cleanup
+    if (app_cfg.emu_cfg.save_state[0] != '\0')
+        savestate_write(&emu, app_cfg.emu_cfg.save_state);
+
+    if (rewind_enabled)
+        rewind_cleanup(&rewind);
+
+    if (prof)
+    {
+        finish_profile(prof, &emu, &app_cfg.emu_cfg);
+        profiler_destroy(prof);
+    }
+
     sdl_cleanup(&sdl);
 
     if (app_cfg.audio_cfg.enabled)
@@ -0,0 +1,137 @@
+/**
+ * @file metrics.c
+ * @brief Runtime health counters, the periodic stats line and the JSON dump.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "metrics.h"
+
+static double ticks_to_seconds(uint64_t ticks)
+{
+    return (double)ticks / (double)SDL_GetPerformanceFrequency();
+}
+
+static double ticks_to_ms(uint64_t ticks)
+{
+    return ticks_to_seconds(ticks) * 1000.0;
+}
+
+void metrics_init(metrics_t *m, uint32_t cycles_per_frame)
+{
+    memset(m, 0, sizeof(*m));
+    m->cycles_per_frame = cycles_per_frame;
+    m->start_ticks = SDL_GetPerformanceCounter();
+}
+
+void metrics_hist_add(metrics_hist_t *hist, uint64_t ticks)
+{
+    uint64_t us = ticks * 1000000 / SDL_GetPerformanceFrequency();
+    unsigned bucket = 0;
+    while (bucket + 1 < METRICS_BUCKETS && us >= (uint64_t)METRICS_FIRST_BUCKET_US << bucket)
+        bucket++;
+
+    hist->counts[bucket]++;
+    hist->samples++;
+    hist->total_ticks += ticks;
+    if (ticks > hist->max_ticks)
+        hist->max_ticks = ticks;
+}
+
+void metrics_frame(metrics_t *m, const metrics_emu_t *emu, uint64_t frame)
+{
+    m->emu = *emu;
+    if (frame > m->last_frame + 1)
+        m->skipped += frame - m->last_frame - 1;
+    if (frame > m->last_frame)
+        m->last_frame = frame;
+}
+
+void metrics_present(metrics_t *m, bool drawn, uint64_t render_ticks, uint64_t latency_ticks)
+{
+    if (!drawn)
+    {
+        m->unchanged++;
+        return;
+    }
+    m->presented++;
+    metrics_hist_add(&m->render, render_ticks);
+    if (latency_ticks)
+        metrics_hist_add(&m->latency, latency_ticks);
+}
+
+/**
+ * @brief Mean of @p hist in milliseconds, 0 when it is empty.
+ */
+static double hist_mean_ms(const metrics_hist_t *hist)
+{
+    return hist->samples ? ticks_to_ms(hist->total_ticks) / (double)hist->samples : 0.0;
+}
+
+void metrics_mark(const metrics_t *m, metrics_mark_t *mark)
+{
+    mark->ticks = SDL_GetPerformanceCounter();
+    mark->instructions = m->emu.instructions;
+    mark->frames = m->presented + m->unchanged;
+}
+
+void metrics_sample(const metrics_t *m, metrics_mark_t *mark, char *buf, size_t size)
+{
+    metrics_mark_t now;
+    metrics_mark(m, &now);
+    double seconds = ticks_to_seconds(now.ticks - mark->ticks);
+
+    double ips = seconds > 0.0 ? (double)(now.instructions - mark->instructions) / seconds : 0.0;
+    double fps = seconds > 0.0 ? (double)(now.frames - mark->frames) / seconds : 0.0;
+    snprintf(buf, size, "ips=%.0f fps=%.1f render=%.2fms latency=%.2fms skipped=%llu drift=%.3fs",
+             ips, fps, hist_mean_ms(&m->render), hist_mean_ms(&m->latency), (unsigned long long)m->skipped,
+             ticks_to_seconds(m->emu.drift_ticks));
+    *mark = now;
+}
+
+static void write_hist(FILE *fp, const char *name, const metrics_hist_t *hist, bool last)
+{
+    fprintf(fp, "  \"%s\": { \"samples\": %llu, \"mean_ms\": %.3f, \"max_ms\": %.3f, \"buckets\": [",
+            name, (unsigned long long)hist->samples, hist_mean_ms(hist), ticks_to_ms(hist->max_ticks));
+    for (unsigned i = 0; i < METRICS_BUCKETS; i++)
+    {
+        if (i + 1 < METRICS_BUCKETS)
+            fprintf(fp, "%s{ \"below_us\": %u, \"count\": %llu }", i ? ", " : "", METRICS_FIRST_BUCKET_US << i,
+                    (unsigned long long)hist->counts[i]);
+        else
+            fprintf(fp, ", { \"below_us\": null, \"count\": %llu }", (unsigned long long)hist->counts[i]);
+    }
+    fprintf(fp, "] }%s\n", last ? "" : ",");
+}
+
+bool metrics_write_file(const metrics_t *m, const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return false;
+
+    double seconds = ticks_to_seconds(SDL_GetPerformanceCounter() - m->start_ticks);
+    const metrics_emu_t *emu = &m->emu;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"seconds\": %.6f,\n", seconds);
+    fprintf(fp, "  \"instructions\": %llu,\n", (unsigned long long)emu->instructions);
+    fprintf(fp, "  \"idle_skipped\": %llu,\n", (unsigned long long)emu->idle_skipped);
+    fprintf(fp, "  \"ips\": %.0f,\n", seconds > 0.0 ? (double)emu->instructions / seconds : 0.0);
+    fprintf(fp, "  \"cycles_per_frame\": { \"configured\": %u, \"achieved\": %.2f },\n", m->cycles_per_frame,
+            emu->timer_ticks ? (double)(emu->instructions + emu->idle_skipped) / (double)emu->timer_ticks : 0.0);
+    fprintf(fp, "  \"frames\": { \"emulated\": %llu, \"presented\": %llu, \"unchanged\": %llu, \"skipped\": %llu },\n",
+            (unsigned long long)emu->frames, (unsigned long long)m->presented, (unsigned long long)m->unchanged,
+            (unsigned long long)m->skipped);
+    fprintf(fp, "  \"timer_ticks\": %llu,\n", (unsigned long long)emu->timer_ticks);
+    fprintf(fp, "  \"resyncs\": %llu,\n", (unsigned long long)emu->resyncs);
+    fprintf(fp, "  \"drift_seconds\": %.6f,\n", ticks_to_seconds(emu->drift_ticks));
+    write_hist(fp, "frame_late", &emu->late, false);
+    write_hist(fp, "render", &m->render, false);
+    write_hist(fp, "latency", &m->latency, true);
+    fprintf(fp, "}\n");
+
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,374 @@
+/**
+ * @file profiler.c
+ * @brief Implementation of the instruction-level profiler.
+ */
+
+#include <SDL2/SDL_timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profiler.h"
+
+/** @brief Rows shown in each section of the text report. */
+#define PROFILER_REPORT_TOP_PCS 16
+#define PROFILER_REPORT_TOP_LOOPS 8
+
+/**
+ * @struct profile_entry_t
+ * @brief One (key, count) pair used when sorting counters for output.
+ */
+typedef struct
+{
+    uint32_t key;
+    uint64_t count;
+} profile_entry_t;
+
+profiler_t *profiler_create(void)
+{
+    return calloc(1, sizeof(profiler_t));
+}
+
+void profiler_destroy(profiler_t *prof)
+{
+    free(prof);
+}
+
+void profiler_start(profiler_t *prof)
+{
+    prof->start_ticks = SDL_GetPerformanceCounter();
+}
+
+void profiler_stop(profiler_t *prof)
+{
+    prof->elapsed_ticks = SDL_GetPerformanceCounter() - prof->start_ticks;
+}
+
+void profiler_cycle(profiler_t *prof, chip8_t *emu)
+{
+    uint16_t pc = emu->pc;
+
+    // Out-of-range PCs are left for chip8_cycle() to report; nothing
+    // executes while FX0A waits for a key
+    if (pc + 1 >= CHIP8_MEMORY_SIZE || chip8_waiting_for_key(emu))
+    {
+        chip8_cycle(emu);
+        return;
+    }
+
+    uint16_t opcode = (uint16_t)(emu->memory[pc] << 8 | emu->memory[pc + 1]);
+    chip8_op_t op = chip8_classify_opcode(opcode, emu->machine);
+
+    prof->cycles++;
+    prof->pc_counts[pc]++;
+    prof->op_counts[op]++;
+    prof->group_counts[opcode >> 12]++;
+
+    if (op == CHIP8_OP_JP && (opcode & 0x0FFF) <= pc)
+        prof->loop_counts[opcode & 0x0FFF]++;
+
+    if (op == CHIP8_OP_DRW)
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        chip8_cycle(emu);
+        prof->draw_ticks += SDL_GetPerformanceCounter() - start;
+        prof->draw_calls++;
+        return;
+    }
+
+    chip8_cycle(emu);
+}
+
+void profiler_add_render(profiler_t *prof, uint64_t ticks)
+{
+    prof->render_ticks += ticks;
+    prof->render_calls++;
+}
+
+/**
+ * @brief Orders entries by descending count, then ascending key.
+ */
+static int compare_entries(const void *a, const void *b)
+{
+    const profile_entry_t *ea = a;
+    const profile_entry_t *eb = b;
+
+    if (ea->count != eb->count)
+        return ea->count < eb->count ? 1 : -1;
+    return (ea->key > eb->key) - (ea->key < eb->key);
+}
+
+/**
+ * @brief Collects the non-zero counters of an array, sorted hottest first.
+ *
+ * @param counts Counter array.
+ * @param n      Number of counters.
+ * @param out    Receives a malloc'd entry array (NULL when empty); caller frees.
+ * @return Number of entries in @p out.
+ */
+static size_t sorted_entries(const uint64_t *counts, size_t n, profile_entry_t **out)
+{
+    size_t used = 0;
+    for (size_t i = 0; i < n; i++)
+        used += counts[i] != 0;
+
+    *out = NULL;
+    if (used == 0)
+        return 0;
+
+    profile_entry_t *entries = malloc(used * sizeof(profile_entry_t));
+    if (!entries)
+        return 0;
+
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (counts[i])
+        {
+            entries[j].key = (uint32_t)i;
+            entries[j].count = counts[i];
+            j++;
+        }
+    }
+
+    qsort(entries, used, sizeof(profile_entry_t), compare_entries);
+    *out = entries;
+    return used;
+}
+
+static double ticks_to_seconds(uint64_t ticks)
+{
+    return (double)ticks / (double)SDL_GetPerformanceFrequency();
+}
+
+static double profiler_seconds(const profiler_t *prof)
+{
+    return ticks_to_seconds(prof->elapsed_ticks);
+}
+
+static double profiler_ips(const profiler_t *prof)
+{
+    double seconds = profiler_seconds(prof);
+    return seconds > 0.0 ? (double)prof->cycles / seconds : 0.0;
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+/**
+ * @brief Reads the opcode stored at @p addr (as it is at report time).
+ */
+static uint16_t opcode_at(const chip8_t *emu, uint32_t addr)
+{
+    if (addr + 1 >= CHIP8_MEMORY_SIZE)
+        return 0;
+    return (uint16_t)(emu->memory[addr] << 8 | emu->memory[addr + 1]);
+}
+
+void profiler_startup_begin(profiler_startup_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->origin = SDL_GetPerformanceCounter();
+    st->last = st->origin;
+}
+
+void profiler_startup_mark(profiler_startup_t *st, const char *phase)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (st->count < PROFILER_MAX_PHASES)
+    {
+        st->names[st->count] = phase;
+        st->ticks[st->count] = now - st->last;
+        st->count++;
+    }
+    st->last = now;
+}
+
+void profiler_startup_print(const profiler_startup_t *st, FILE *out)
+{
+    double total = ticks_to_seconds(st->last - st->origin);
+
+    fprintf(out, "\n=== Startup ===\n");
+    for (int i = 0; i < st->count; i++)
+    {
+        double seconds = ticks_to_seconds(st->ticks[i]);
+        fprintf(out, "%-14s %8.2f ms  %5.1f%%\n", st->names[i], seconds * 1000.0,
+                total > 0.0 ? 100.0 * seconds / total : 0.0);
+    }
+    fprintf(out, "%-14s %8.2f ms\n", "total", total * 1000.0);
+}
+
+void profiler_print_report(const profiler_t *prof, const chip8_t *emu, FILE *out)
+{
+    double seconds = profiler_seconds(prof);
+    double draw_seconds = ticks_to_seconds(prof->draw_ticks);
+    double render_seconds = ticks_to_seconds(prof->render_ticks);
+    profile_entry_t *entries;
+    size_t count;
+
+    fprintf(out, "\n=== Profile ===\n");
+    fprintf(out, "Instructions: %llu in %.3f s (%.0f instructions/s)\n",
+            (unsigned long long)prof->cycles, seconds, profiler_ips(prof));
+    fprintf(out, "DXYN:         %llu calls, %.3f ms (%.1f%% of run)\n",
+            (unsigned long long)prof->draw_calls, draw_seconds * 1000.0,
+            seconds > 0.0 ? 100.0 * draw_seconds / seconds : 0.0);
+    if (prof->render_calls)
+        fprintf(out, "Rendering:    %llu frames, %.3f ms (%.1f%% of run)\n",
+                (unsigned long long)prof->render_calls, render_seconds * 1000.0,
+                seconds > 0.0 ? 100.0 * render_seconds / seconds : 0.0);
+
+    // Hottest instruction addresses
+    count = sorted_entries(prof->pc_counts, CHIP8_MEMORY_SIZE, &entries);
+    fprintf(out, "\nTop PCs:\n    PC  opcode  class         count      %%\n");
+    for (size_t i = 0; i < count && i < PROFILER_REPORT_TOP_PCS; i++)
+    {
+        uint16_t opcode = opcode_at(emu, entries[i].key);
+        fprintf(out, "  %04X    %04X   %s  %12llu  %5.1f\n",
+                (unsigned)entries[i].key, opcode, chip8_op_name(chip8_classify_opcode(opcode, emu->machine)),
+                (unsigned long long)entries[i].count, percent(entries[i].count, prof->cycles));
+    }
+    free(entries);
+
+    // Loop heads: targets of backward jumps
+    count = sorted_entries(prof->loop_counts, CHIP8_MEMORY_SIZE, &entries);
+    fprintf(out, "\nHot loops (backward 1NNN targets):\n  target         count\n");
+    if (count == 0)
+        fprintf(out, "  (none)\n");
+    for (size_t i = 0; i < count && i < PROFILER_REPORT_TOP_LOOPS; i++)
+        fprintf(out, "    %04X  %12llu\n", (unsigned)entries[i].key, (unsigned long long)entries[i].count);
+    free(entries);
+
+    // Instruction mix
+    count = sorted_entries(prof->op_counts, CHIP8_OP_COUNT, &entries);
+    fprintf(out, "\nInstruction classes:\n  class        count      %%\n");
+    for (size_t i = 0; i < count; i++)
+        fprintf(out, "  %s  %12llu  %5.1f\n", chip8_op_name((chip8_op_t)entries[i].key),
+                (unsigned long long)entries[i].count, percent(entries[i].count, prof->cycles));
+    free(entries);
+
+    count = sorted_entries(prof->group_counts, 16, &entries);
+    fprintf(out, "\nOpcode groups:\n  group        count      %%\n");
+    for (size_t i = 0; i < count; i++)
+        fprintf(out, "  %Xxxx  %12llu  %5.1f\n", (unsigned)entries[i].key,
+                (unsigned long long)entries[i].count, percent(entries[i].count, prof->cycles));
+    free(entries);
+}
+
+/**
+ * @brief Returns true if @p path ends in ".csv" (case-insensitive).
+ */
+static bool has_csv_extension(const char *path)
+{
+    size_t len = strlen(path);
+    if (len < 4)
+        return false;
+
+    const char *ext = path + len - 4;
+    return ext[0] == '.' &&
+           (ext[1] == 'c' || ext[1] == 'C') &&
+           (ext[2] == 's' || ext[2] == 'S') &&
+           (ext[3] == 'v' || ext[3] == 'V');
+}
+
+static void write_csv(const profiler_t *prof, const chip8_t *emu, FILE *fp)
+{
+    profile_entry_t *entries;
+    size_t count;
+
+    fprintf(fp, "section,key,name,count\n");
+    fprintf(fp, "summary,cycles,,%llu\n", (unsigned long long)prof->cycles);
+    fprintf(fp, "summary,seconds,,%.6f\n", profiler_seconds(prof));
+    fprintf(fp, "summary,ips,,%.0f\n", profiler_ips(prof));
+    fprintf(fp, "summary,draw_calls,,%llu\n", (unsigned long long)prof->draw_calls);
+    fprintf(fp, "summary,draw_seconds,,%.6f\n", ticks_to_seconds(prof->draw_ticks));
+    fprintf(fp, "summary,render_calls,,%llu\n", (unsigned long long)prof->render_calls);
+    fprintf(fp, "summary,render_seconds,,%.6f\n", ticks_to_seconds(prof->render_ticks));
+
+    count = sorted_entries(prof->pc_counts, CHIP8_MEMORY_SIZE, &entries);
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "pc,0x%03X,%04X,%llu\n", (unsigned)entries[i].key, opcode_at(emu, entries[i].key),
+                (unsigned long long)entries[i].count);
+    free(entries);
+
+    count = sorted_entries(prof->loop_counts, CHIP8_MEMORY_SIZE, &entries);
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "loop,0x%03X,,%llu\n", (unsigned)entries[i].key, (unsigned long long)entries[i].count);
+    free(entries);
+
+    count = sorted_entries(prof->op_counts, CHIP8_OP_COUNT, &entries);
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "class,%u,%s,%llu\n", (unsigned)entries[i].key, chip8_op_name((chip8_op_t)entries[i].key),
+                (unsigned long long)entries[i].count);
+    free(entries);
+
+    count = sorted_entries(prof->group_counts, 16, &entries);
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "group,%X,,%llu\n", (unsigned)entries[i].key, (unsigned long long)entries[i].count);
+    free(entries);
+}
+
+static void write_json(const profiler_t *prof, const chip8_t *emu, FILE *fp)
+{
+    profile_entry_t *entries;
+    size_t count;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"cycles\": %llu,\n", (unsigned long long)prof->cycles);
+    fprintf(fp, "  \"seconds\": %.6f,\n", profiler_seconds(prof));
+    fprintf(fp, "  \"ips\": %.0f,\n", profiler_ips(prof));
+    fprintf(fp, "  \"draw\": { \"calls\": %llu, \"seconds\": %.6f },\n",
+            (unsigned long long)prof->draw_calls, ticks_to_seconds(prof->draw_ticks));
+    fprintf(fp, "  \"render\": { \"calls\": %llu, \"seconds\": %.6f },\n",
+            (unsigned long long)prof->render_calls, ticks_to_seconds(prof->render_ticks));
+
+    count = sorted_entries(prof->pc_counts, CHIP8_MEMORY_SIZE, &entries);
+    fprintf(fp, "  \"pcs\": [");
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t opcode = opcode_at(emu, entries[i].key);
+        fprintf(fp, "%s\n    { \"pc\": %u, \"opcode\": \"%04X\", \"class\": \"%s\", \"count\": %llu }",
+                i ? "," : "", (unsigned)entries[i].key, opcode, chip8_op_name(chip8_classify_opcode(opcode, emu->machine)),
+                (unsigned long long)entries[i].count);
+    }
+    fprintf(fp, "\n  ],\n");
+    free(entries);
+
+    count = sorted_entries(prof->loop_counts, CHIP8_MEMORY_SIZE, &entries);
+    fprintf(fp, "  \"loops\": [");
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "%s\n    { \"target\": %u, \"count\": %llu }",
+                i ? "," : "", (unsigned)entries[i].key, (unsigned long long)entries[i].count);
+    fprintf(fp, "\n  ],\n");
+    free(entries);
+
+    count = sorted_entries(prof->op_counts, CHIP8_OP_COUNT, &entries);
+    fprintf(fp, "  \"classes\": [");
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "%s\n    { \"class\": \"%s\", \"count\": %llu }",
+                i ? "," : "", chip8_op_name((chip8_op_t)entries[i].key), (unsigned long long)entries[i].count);
+    fprintf(fp, "\n  ],\n");
+    free(entries);
+
+    count = sorted_entries(prof->group_counts, 16, &entries);
+    fprintf(fp, "  \"groups\": [");
+    for (size_t i = 0; i < count; i++)
+        fprintf(fp, "%s\n    { \"group\": \"%X\", \"count\": %llu }",
+                i ? "," : "", (unsigned)entries[i].key, (unsigned long long)entries[i].count);
+    fprintf(fp, "\n  ]\n}\n");
+    free(entries);
+}
+
+bool profiler_write_file(const profiler_t *prof, const chip8_t *emu, const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return false;
+
+    if (has_csv_extension(path))
+        write_csv(prof, emu, fp);
+    else
+        write_json(prof, emu, fp);
+
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file quirks_db.c
+ * @brief Implementation of the per-ROM quirk database.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "quirks_db.h"
+#include "chip8.h"
+#include "cli_logger.h"
+#include "rom.h"
+
+uint64_t quirks_db_rom_hash(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL; // FNV-1a offset basis
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL; // FNV-1a prime
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the config_quirks_t called @p name, or CONFIG_QUIRKS_COUNT.
+ */
+static uint8_t profile_from_name(const char *name)
+{
+    for (uint8_t q = 0; q < CONFIG_QUIRKS_COUNT; q++)
+    {
+        if (strcmp(chip8_quirks_info(q)->name, name) == 0)
+            return q;
+    }
+    return CONFIG_QUIRKS_COUNT;
+}
+
+/**
+ * @brief Looks @p hash up in the database at @p path.
+ *
+ * @return The profile listed for the ROM, or CONFIG_QUIRKS_COUNT if the
+ *         file has no entry for it; CONFIG_QUIRKS_AUTO if it cannot be read.
+ */
+static uint8_t find_profile(const char *path, uint64_t hash)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return CONFIG_QUIRKS_AUTO;
+
+    char line[256];
+    int line_no = 0;
+    uint8_t found = CONFIG_QUIRKS_COUNT;
+    while (found == CONFIG_QUIRKS_COUNT && fgets(line, sizeof(line), fp))
+    {
+        line_no++;
+
+        // Strip the comment; what is left is blank or "<hash> <profile>"
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+
+        char key[32];
+        char name[32];
+        int fields = sscanf(line, " %31s %31s", key, name);
+        if (fields <= 0)
+            continue;
+
+        char *end;
+        uint64_t entry = strtoull(key, &end, 16);
+        uint8_t profile = fields == 2 ? profile_from_name(name) : CONFIG_QUIRKS_COUNT;
+        if (*end != '\0' || profile == CONFIG_QUIRKS_COUNT)
+        {
+            print_warning("%s:%d: expected '<rom hash> <vip|schip|modern>'", path, line_no);
+            continue;
+        }
+        if (entry == hash)
+            found = profile;
+    }
+    fclose(fp);
+    return found;
+}
+
+uint8_t quirks_db_select(const char *db_path, const char *rom_path, uint8_t fallback)
+{
+    // Default to the database kept with the ROM collection
+    char path[512];
+    const bool explicit_db = db_path && db_path[0] != '\0';
+    if (explicit_db)
+    {
+        snprintf(path, sizeof(path), "%s", db_path);
+    }
+    else
+    {
+        const char *slash = strrchr(rom_path, '/');
+#ifdef _WIN32
+        const char *backslash = strrchr(rom_path, '\\');
+        if (backslash && (!slash || backslash > slash))
+            slash = backslash;
+#endif
+        int dir_len = slash ? (int)(slash - rom_path + 1) : 0;
+        snprintf(path, sizeof(path), "%.*s%s", dir_len, rom_path, QUIRKS_DB_FILE);
+    }
+
+    rom_image_t rom;
+    if (!rom_image_map(&rom, rom_path))
+        return fallback; // Loading the ROM reports the error
+    uint64_t hash = quirks_db_rom_hash(rom.data, rom.size);
+    rom_image_release(&rom);
+
+    uint8_t profile = find_profile(path, hash);
+    if (profile < CONFIG_QUIRKS_COUNT)
+    {
+        print_info("Quirks: %s (from %s)", chip8_quirks_info(profile)->name, path);
+        return profile;
+    }
+
+    if (profile == CONFIG_QUIRKS_AUTO && explicit_db)
+        print_warning("Failed to open quirk database: %s", path);
+    print_info("Quirks: %s (ROM %016llx is not in %s)", chip8_quirks_info(fallback)->name,
+               (unsigned long long)hash, path);
+    return fallback;
+}
@@ -0,0 +1,476 @@
+/**
+ * @file recorder.c
+ * @brief Display recording: bounded queue, background XOR/RLE encoder and decoder.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "recorder.h"
+#include "cli_logger.h"
+
+/**
+ * @brief Returns the bytes of chip8_t::display a screen uses: 256 or 1024.
+ */
+static size_t display_bytes(bool hires)
+{
+    return (hires ? CHIP8_DISPLAY_WORDS : CHIP8_DISPLAY_HEIGHT) * sizeof(uint64_t);
+}
+
+/**
+ * @brief Doubles every pixel of a 32-pixel half row into a 64-pixel word.
+ */
+static uint64_t double_pixels(uint32_t half)
+{
+    uint64_t x = half;
+    x = (x | x << 16) & 0x0000FFFF0000FFFFULL;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFULL;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | x << 2) & 0x3333333333333333ULL;
+    x = (x | x << 1) & 0x5555555555555555ULL;
+    return x | x << 1;
+}
+
+/**
+ * @brief Writes one display word as 8 screen bytes, big-endian.
+ */
+static uint8_t *put_word(uint8_t *screen, uint64_t word)
+{
+    for (int b = 0; b < 8; b++)
+        *screen++ = (uint8_t)(word >> (56 - 8 * b));
+    return screen;
+}
+
+/**
+ * @brief Packs display rows into the on-disk screen layout of @p rec.
+ *
+ * A low-resolution frame in a 128x64 recording is scaled up 2x2.
+ */
+static void pack_screen(const recorder_t *rec, const recorder_frame_t *frame, uint8_t *screen)
+{
+    if (frame->hires || rec->width == CHIP8_DISPLAY_WIDTH)
+    {
+        const size_t words = rec->screen_bytes / 8;
+        for (size_t i = 0; i < words; i++)
+            screen = put_word(screen, frame->display[i]);
+        return;
+    }
+
+    for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++)
+    {
+        uint64_t row = frame->display[y];
+        for (int copy = 0; copy < 2; copy++)
+        {
+            screen = put_word(screen, double_pixels((uint32_t)(row >> 32)));
+            screen = put_word(screen, double_pixels((uint32_t)row));
+        }
+    }
+}
+
+/*-----------------------------------------------------------
+ *   ENCODER (background thread)
+ *----------------------------------------------------------*/
+
+/**
+ * @brief Writes bytes, remembering the first failure.
+ */
+static void put_bytes(recorder_t *rec, const void *data, size_t size)
+{
+    if (rec->io_error)
+        return;
+    if (fwrite(data, 1, size, rec->file) != size)
+    {
+        rec->io_error = true;
+        return;
+    }
+    rec->bytes += size;
+}
+
+/**
+ * @brief Writes a record tag followed by an unsigned LEB128 value.
+ */
+static void put_varint_record(recorder_t *rec, uint8_t tag, uint64_t value)
+{
+    uint8_t buf[11];
+    size_t n = 0;
+    buf[n++] = tag;
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[n++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    put_bytes(rec, buf, n);
+}
+
+/**
+ * @brief Writes the frames held on the current screen, if any.
+ *
+ * Holds are split so that a reader never sees more than UINT32_MAX frames
+ * in one record.
+ */
+static void flush_hold(recorder_t *rec)
+{
+    while (rec->hold)
+    {
+        uint64_t n = rec->hold > UINT32_MAX ? UINT32_MAX : rec->hold;
+        put_varint_record(rec, RECORDER_HOLD, n);
+        rec->hold -= n;
+    }
+}
+
+/**
+ * @brief Writes a DELTA record taking the last screen to @p screen.
+ */
+static void put_delta(recorder_t *rec, const uint8_t *screen)
+{
+    const int size = (int)rec->screen_bytes;
+    uint8_t out[1 + 2 * RECORDER_MAX_SCREEN_BYTES];
+    size_t n = 0;
+    out[n++] = RECORDER_DELTA;
+
+    int i = 0;
+    while (i < size)
+    {
+        // Zero run: bytes that did not change
+        int run = 0;
+        while (i + run < size && run < 128 && screen[i + run] == rec->screen[i + run])
+            run++;
+        if (run)
+        {
+            out[n++] = (uint8_t)(run - 1);
+            i += run;
+            continue;
+        }
+
+        // Literal run: stop at the first pair of unchanged bytes, as a
+        // lone one is cheaper inline than as its own control byte
+        int lit = 0;
+        while (i + lit < size && lit < 128 &&
+               !(screen[i + lit] == rec->screen[i + lit] &&
+                 (i + lit + 1 == size || screen[i + lit + 1] == rec->screen[i + lit + 1])))
+            lit++;
+        out[n++] = (uint8_t)(0x7F + lit);
+        for (int k = 0; k < lit; k++)
+            out[n++] = screen[i + k] ^ rec->screen[i + k];
+        i += lit;
+    }
+
+    put_bytes(rec, out, n);
+    memcpy(rec->screen, screen, rec->screen_bytes);
+}
+
+/**
+ * @brief Adds one queued screen to the stream.
+ */
+static void encode_frame(recorder_t *rec, const recorder_frame_t *frame)
+{
+    uint8_t screen[RECORDER_MAX_SCREEN_BYTES];
+    pack_screen(rec, frame, screen);
+
+    // Unchanged screens only extend the hold
+    if (memcmp(screen, rec->screen, rec->screen_bytes) == 0)
+    {
+        rec->hold += frame->frames;
+        return;
+    }
+
+    flush_hold(rec);
+    put_delta(rec, screen);
+    rec->hold = frame->frames - 1;
+}
+
+/**
+ * @brief Encoder thread: encodes queued frames in batches until told to finish.
+ */
+static int encoder_main(void *data)
+{
+    recorder_t *rec = data;
+    uint64_t total = 0;
+    bool done = false;
+
+    while (!done)
+    {
+        // Wait for frames, then take everything queued so far
+        SDL_LockMutex(rec->lock);
+        while (rec->head == rec->tail)
+        {
+            rec->encoder_waiting = true;
+            SDL_CondWait(rec->cond, rec->lock);
+        }
+        rec->encoder_waiting = false;
+        uint32_t tail = rec->tail;
+        uint32_t head = rec->head;
+        SDL_UnlockMutex(rec->lock);
+
+        // The producer never touches slots between tail and head
+        for (; tail != head && !done; tail++)
+        {
+            const recorder_frame_t *frame = &rec->queue[tail % RECORDER_QUEUE_FRAMES];
+            if (frame->frames == 0)
+            {
+                done = true;
+                break;
+            }
+            encode_frame(rec, frame);
+            total += frame->frames;
+        }
+
+        SDL_LockMutex(rec->lock);
+        rec->tail = tail;
+        if (rec->producer_waiting)
+            SDL_CondSignal(rec->cond);
+        SDL_UnlockMutex(rec->lock);
+    }
+
+    flush_hold(rec);
+    put_varint_record(rec, RECORDER_END, total);
+    return 0;
+}
+
+/*-----------------------------------------------------------
+ *   PRODUCER API
+ *----------------------------------------------------------*/
+
+recorder_t *recorder_open(const char *path, bool lossless, const chip8_machine_t *machine)
+{
+    recorder_t *rec = calloc(1, sizeof(*rec));
+    if (!rec)
+    {
+        print_error("Out of memory for the recorder.");
+        return NULL;
+    }
+
+    strncpy(rec->path, path, sizeof(rec->path) - 1);
+    rec->lossless = lossless;
+    rec->width = (uint8_t)machine->width;
+    rec->height = (uint8_t)machine->height;
+    rec->screen_bytes = (uint32_t)machine->width / 8 * machine->height;
+    rec->file = fopen(path, "wb");
+    if (!rec->file)
+    {
+        print_error("Failed to create recording: %s", path);
+        free(rec);
+        return NULL;
+    }
+
+    const uint8_t header[RECORDER_HEADER_SIZE] = {
+        'C', 'H', '8', 'V', 'I', 'D', 'E', 'O',
+        RECORDER_VERSION, rec->width, rec->height, CONFIG_FRAME_RATE,
+        0, 0, 0, 0};
+    put_bytes(rec, header, sizeof(header));
+
+    rec->lock = SDL_CreateMutex();
+    rec->cond = SDL_CreateCond();
+    rec->thread = rec->lock && rec->cond ? SDL_CreateThread(encoder_main, "chip8-record", rec) : NULL;
+    if (!rec->thread)
+    {
+        print_error("Failed to start the recording thread: %s", SDL_GetError());
+        if (rec->cond)
+            SDL_DestroyCond(rec->cond);
+        if (rec->lock)
+            SDL_DestroyMutex(rec->lock);
+        fclose(rec->file);
+        free(rec);
+        return NULL;
+    }
+    return rec;
+}
+
+/**
+ * @brief Puts one slot into the queue, waiting or dropping when it is full.
+ *
+ * @return false if the frame was dropped.
+ */
+static bool enqueue(recorder_t *rec, const uint64_t *display, bool hires, uint32_t frames, bool wait)
+{
+    SDL_LockMutex(rec->lock);
+    while (rec->head - rec->tail == RECORDER_QUEUE_FRAMES)
+    {
+        if (!wait)
+        {
+            SDL_UnlockMutex(rec->lock);
+            return false;
+        }
+        rec->producer_waiting = true;
+        SDL_CondWait(rec->cond, rec->lock);
+    }
+    rec->producer_waiting = false;
+
+    recorder_frame_t *slot = &rec->queue[rec->head % RECORDER_QUEUE_FRAMES];
+    if (display)
+        memcpy(slot->display, display, display_bytes(hires));
+    slot->frames = frames;
+    slot->hires = hires;
+    rec->head++;
+
+    // Wake the encoder for a batch, not for every frame
+    if (rec->encoder_waiting && (rec->head - rec->tail >= RECORDER_WAKE_FRAMES || frames == 0))
+        SDL_CondSignal(rec->cond);
+    SDL_UnlockMutex(rec->lock);
+    return true;
+}
+
+void recorder_push(recorder_t *rec, const uint64_t *display, bool hires, uint32_t frames)
+{
+    const size_t size = display_bytes(hires);
+    rec->frames += frames;
+
+    // Static screens are common; count them here instead of queueing copies
+    if (rec->held && rec->held <= UINT32_MAX - frames && hires == rec->last_hires &&
+        memcmp(display, rec->last, size) == 0)
+    {
+        rec->held += frames;
+        return;
+    }
+
+    if (rec->held && !enqueue(rec, rec->last, rec->last_hires, rec->held, rec->lossless))
+    {
+        // Queue full: drop the held screen and give its frames to this one,
+        // so the timeline stays exact
+        rec->dropped += rec->held;
+        frames = rec->held <= UINT32_MAX - frames ? rec->held + frames : UINT32_MAX;
+    }
+
+    memcpy(rec->last, display, size);
+    rec->last_hires = hires;
+    rec->held = frames;
+}
+
+bool recorder_close(recorder_t *rec)
+{
+    if (!rec)
+        return true;
+
+    if (rec->held)
+        enqueue(rec, rec->last, rec->last_hires, rec->held, true);
+    enqueue(rec, NULL, false, 0, true);
+    SDL_WaitThread(rec->thread, NULL);
+
+    bool ok = !rec->io_error;
+    if (fclose(rec->file) != 0)
+        ok = false;
+
+    if (!ok)
+        print_error("Failed to write recording: %s", rec->path);
+    else
+        print_info("Recorded %llu frames to %s (%llu bytes, raw ARGB would be %llu).",
+                   (unsigned long long)rec->frames, rec->path, (unsigned long long)rec->bytes,
+                   (unsigned long long)rec->frames * rec->width * rec->height * 4);
+    if (rec->dropped)
+        print_warning("Recording fell behind: %llu frames show a later screen.",
+                      (unsigned long long)rec->dropped);
+
+    SDL_DestroyCond(rec->cond);
+    SDL_DestroyMutex(rec->lock);
+    free(rec);
+    return ok;
+}
+
+/*-----------------------------------------------------------
+ *   DECODER
+ *----------------------------------------------------------*/
+
+bool recording_open(recording_reader_t *reader, const char *path)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (!reader->file)
+    {
+        print_error("Failed to open recording: %s", path);
+        return false;
+    }
+
+    uint8_t header[RECORDER_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), reader->file) != sizeof(header) ||
+        memcmp(header, RECORDER_MAGIC, 8) != 0 || header[8] != RECORDER_VERSION || header[11] == 0 ||
+        !((header[9] == CHIP8_DISPLAY_WIDTH && header[10] == CHIP8_DISPLAY_HEIGHT) ||
+          (header[9] == CHIP8_HIRES_WIDTH && header[10] == CHIP8_HIRES_HEIGHT)))
+    {
+        print_error("Not a supported recording: %s", path);
+        fclose(reader->file);
+        reader->file = NULL;
+        return false;
+    }
+    reader->width = header[9];
+    reader->height = header[10];
+    reader->screen_bytes = (uint32_t)reader->width / 8 * reader->height;
+    reader->fps = header[11];
+    return true;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 value; false on EOF or overflow.
+ */
+static bool read_varint(FILE *file, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = fgetc(file);
+        if (c == EOF)
+            return false;
+        *value |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+int recording_next(recording_reader_t *reader, uint32_t *frames)
+{
+    uint64_t value;
+    int tag = fgetc(reader->file);
+
+    switch (tag)
+    {
+    case RECORDER_DELTA:
+        for (int i = 0; i < (int)reader->screen_bytes;)
+        {
+            int c = fgetc(reader->file);
+            if (c == EOF)
+                return -1;
+            int run = c < 0x80 ? c + 1 : c - 0x7F;
+            if (i + run > (int)reader->screen_bytes)
+                return -1;
+            if (c >= 0x80)
+            {
+                for (int k = 0; k < run; k++)
+                {
+                    int x = fgetc(reader->file);
+                    if (x == EOF)
+                        return -1;
+                    reader->screen[i + k] ^= (uint8_t)x;
+                }
+            }
+            i += run;
+        }
+        *frames = 1;
+        reader->frames++;
+        return 1;
+
+    case RECORDER_HOLD:
+        if (!read_varint(reader->file, &value) || value == 0 || value > UINT32_MAX)
+            return -1;
+        *frames = (uint32_t)value;
+        reader->frames += value;
+        return 1;
+
+    case RECORDER_END:
+        // The trailer doubles as a check that nothing was lost
+        if (!read_varint(reader->file, &value) || value != reader->frames)
+            return -1;
+        return 0;
+
+    default:
+        return -1;
+    }
+}
+
+void recording_close(recording_reader_t *reader)
+{
+    if (reader->file)
+        fclose(reader->file);
+    reader->file = NULL;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file replay.c
+ * @brief Implementation of input logs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "cli_logger.h"
+
+/** @brief Events allocated by the first logged key change. */
+#define REPLAY_INITIAL_EVENTS 1024
+
+static const char REPLAY_MAGIC[8] = {'C', 'H', '8', 'I', 'N', 'P', 'U', 'T'};
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+void replay_begin(replay_t *rp, const chip8_t *emu, uint32_t cycles_per_frame)
+{
+    memset(rp, 0, sizeof(*rp));
+    rp->cycles_per_frame = cycles_per_frame;
+    rp->machine = emu->machine;
+    rp->quirks = emu->quirks;
+    rp->seed = emu->seed;
+    rp->start_hash = chip8_memory_hash(emu);
+    rp->start_keys = emu->keys;
+    rp->held = emu->keys;
+}
+
+void replay_frame(replay_t *rp, uint16_t held, uint16_t pressed)
+{
+    if (rp->overflow)
+        return;
+
+    if (held != rp->held || pressed)
+    {
+        // Frame numbers are 32-bit: over two years of play
+        if (rp->frames > UINT32_MAX || rp->count == UINT32_MAX)
+        {
+            rp->overflow = true;
+            return;
+        }
+        if (rp->count == rp->capacity)
+        {
+            // Runs on the emulation thread: grow geometrically, rarely
+            uint32_t capacity = rp->capacity ? rp->capacity * 2 : REPLAY_INITIAL_EVENTS;
+            replay_event_t *events = realloc(rp->events, (size_t)capacity * sizeof(*events));
+            if (!events)
+            {
+                rp->overflow = true;
+                return;
+            }
+            rp->events = events;
+            rp->capacity = capacity;
+        }
+
+        rp->events[rp->count++] = (replay_event_t){(uint32_t)rp->frames, held, pressed};
+        rp->held = held;
+    }
+
+    rp->frames++;
+}
+
+void replay_rewind(replay_t *rp)
+{
+    if (rp->overflow || rp->frames == 0)
+        return;
+
+    rp->frames--;
+    while (rp->count && rp->events[rp->count - 1].frame >= rp->frames)
+        rp->count--;
+    rp->held = rp->count ? rp->events[rp->count - 1].held : rp->start_keys;
+}
+
+bool replay_write(const replay_t *rp, const chip8_t *emu, const char *path)
+{
+    if (rp->overflow)
+    {
+        print_error("Input log ran out of memory and is incomplete; not writing %s", path);
+        return false;
+    }
+
+    uint8_t header[REPLAY_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    put_u16(header + 8, REPLAY_VERSION);
+    put_u16(header + 10, rp->start_keys);
+    put_u32(header + 12, rp->cycles_per_frame);
+    put_u64(header + 16, rp->seed);
+    put_u64(header + 24, rp->start_hash);
+    put_u64(header + 32, rp->frames);
+    put_u64(header + 40, chip8_display_hash(emu));
+    put_u64(header + 48, chip8_memory_hash(emu));
+    put_u32(header + 56, rp->count);
+    header[60] = rp->machine;
+    header[61] = rp->quirks;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        print_error("Failed to open input log for writing: %s", path);
+        return false;
+    }
+
+    bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+    for (uint32_t i = 0; ok && i < rp->count; i++)
+    {
+        uint8_t event[REPLAY_EVENT_SIZE];
+        put_u32(event, rp->events[i].frame);
+        put_u16(event + 4, rp->events[i].held);
+        put_u16(event + 6, rp->events[i].pressed);
+        ok = fwrite(event, 1, sizeof(event), fp) == sizeof(event);
+    }
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+    {
+        print_error("Failed to write input log: %s", path);
+        return false;
+    }
+
+    print_info("Input log written to %s (%llu frames, %u events); replay with --replay %s",
+               path, (unsigned long long)rp->frames, rp->count, path);
+    return true;
+}
+
+bool replay_read(replay_t *rp, const char *path)
+{
+    memset(rp, 0, sizeof(*rp));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+    {
+        print_error("Failed to open input log: %s", path);
+        return false;
+    }
+
+    uint8_t header[REPLAY_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header) ||
+        memcmp(header, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0)
+    {
+        print_error("Not a CHIP-8 input log: %s", path);
+        fclose(fp);
+        return false;
+    }
+
+    uint16_t version = get_u16(header + 8);
+    if (version != REPLAY_VERSION)
+    {
+        print_error("Unsupported input log version %u: %s", version, path);
+        fclose(fp);
+        return false;
+    }
+
+    rp->start_keys = get_u16(header + 10);
+    rp->held = rp->start_keys;
+    rp->cycles_per_frame = get_u32(header + 12);
+    rp->seed = get_u64(header + 16);
+    rp->start_hash = get_u64(header + 24);
+    rp->frames = get_u64(header + 32);
+    rp->display_hash = get_u64(header + 40);
+    rp->memory_hash = get_u64(header + 48);
+    uint32_t count = get_u32(header + 56);
+    rp->machine = header[60];
+    rp->quirks = header[61];
+
+    rp->events = count ? malloc((size_t)count * sizeof(*rp->events)) : NULL;
+    if (count && !rp->events)
+    {
+        print_error("Failed to allocate %u input events: %s", count, path);
+        fclose(fp);
+        return false;
+    }
+    rp->capacity = count;
+
+    // Events must be in strictly increasing frame order inside the session
+    bool ok = rp->cycles_per_frame != 0 && rp->machine < CONFIG_MACHINE_COUNT &&
+              rp->quirks < CONFIG_QUIRKS_COUNT;
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        uint8_t event[REPLAY_EVENT_SIZE];
+        if (fread(event, 1, sizeof(event), fp) != sizeof(event))
+        {
+            ok = false;
+            break;
+        }
+        replay_event_t *e = &rp->events[i];
+        e->frame = get_u32(event);
+        e->held = get_u16(event + 4);
+        e->pressed = get_u16(event + 6);
+        ok = e->frame < rp->frames && (i == 0 || e->frame > rp->events[i - 1].frame);
+    }
+    rp->count = count;
+    fclose(fp);
+
+    if (!ok)
+    {
+        print_error("Corrupt input log: %s", path);
+        replay_free(rp);
+        return false;
+    }
+    return true;
+}
+
+void replay_free(replay_t *rp)
+{
+    free(rp->events);
+    rp->events = NULL;
+    rp->count = 0;
+    rp->capacity = 0;
+}
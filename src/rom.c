@@ -0,0 +1,523 @@
+/**
+ * @file rom.c
+ * @brief Implementation of ROM images, corpora and pack archives.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rom.h"
+#include "cli_logger.h"
+
+/** @brief Largest ROM that fits between 0x200 and the end of memory. */
+#define ROM_MAX_SIZE (4096 - 0x200)
+
+/** @brief Pack header: magic, u32 version, u32 entry count. */
+#define ROM_PACK_HEADER_SIZE 16
+
+/** @brief Pack index entry: u32 offset, u32 size, name. */
+#define ROM_PACK_ENTRY_SIZE (8 + ROM_PACK_NAME_MAX)
+
+static const char ROM_PACK_MAGIC[8] = {'C', 'H', '8', 'P', 'A', 'C', 'K', '\0'};
+
+static void copy_name(char *dst, size_t dst_size, const char *src)
+{
+    snprintf(dst, dst_size, "%s", src ? src : "");
+}
+
+static const char *base_name(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char *backslash = strrchr(path, '\\');
+    if (backslash && (!slash || backslash > slash))
+        slash = backslash;
+#endif
+    return slash ? slash + 1 : path;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* --------------------------------------------------------------------------
+   File access
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Maps a whole file read-only, or reads it where mmap is unavailable.
+ *
+ * @param path    File to open.
+ * @param data    Receives the file contents (NULL for an empty file).
+ * @param size    Receives the file size.
+ * @param mapping Receives the mapping to pass to unmap_file(), or NULL.
+ * @param owned   Receives the heap copy to free(), or NULL.
+ * @return false if the file cannot be opened or read.
+ */
+static bool map_file(const char *path, const uint8_t **data, size_t *size, void **mapping, uint8_t **owned)
+{
+    *data = NULL;
+    *size = 0;
+    *mapping = NULL;
+    *owned = NULL;
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_size > 0)
+    {
+        void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        *mapping = base;
+        *data = base;
+        *size = (size_t)st.st_size;
+    }
+
+    close(fd);
+    return true;
+#else
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long file_size = ftell(fp);
+    rewind(fp);
+    if (file_size < 0)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    if (file_size > 0)
+    {
+        uint8_t *buffer = malloc((size_t)file_size);
+        if (!buffer || fread(buffer, 1, (size_t)file_size, fp) != (size_t)file_size)
+        {
+            free(buffer);
+            fclose(fp);
+            return false;
+        }
+        *owned = buffer;
+        *data = buffer;
+        *size = (size_t)file_size;
+    }
+
+    fclose(fp);
+    return true;
+#endif
+}
+
+static void unmap_file(void *mapping, size_t size)
+{
+#ifndef _WIN32
+    if (mapping)
+        munmap(mapping, size);
+#else
+    (void)mapping;
+    (void)size;
+#endif
+}
+
+/* --------------------------------------------------------------------------
+   Images
+   -------------------------------------------------------------------------- */
+
+bool rom_image_from_buffer(rom_image_t *rom, const void *data, size_t size, const char *name)
+{
+    memset(rom, 0, sizeof(*rom));
+    if (size > ROM_MAX_SIZE)
+    {
+        print_warning("ROM too large: %s (%zu bytes, max allowed: %d bytes)", name ? name : "buffer", size,
+                      ROM_MAX_SIZE);
+        return false;
+    }
+
+    rom->data = size ? data : NULL;
+    rom->size = size;
+    copy_name(rom->name, sizeof(rom->name), name);
+    return true;
+}
+
+bool rom_image_map(rom_image_t *rom, const char *path)
+{
+    memset(rom, 0, sizeof(*rom));
+
+    const uint8_t *data;
+    size_t size;
+    void *mapping;
+    uint8_t *owned;
+    if (!map_file(path, &data, &size, &mapping, &owned))
+    {
+        print_error("Failed to open ROM file: %s", path);
+        return false;
+    }
+
+    if (!rom_image_from_buffer(rom, data, size, path))
+    {
+        unmap_file(mapping, size);
+        free(owned);
+        return false;
+    }
+
+    rom->mapping = mapping;
+    rom->mapping_size = size;
+    rom->owned = owned;
+    return true;
+}
+
+void rom_image_release(rom_image_t *rom)
+{
+    unmap_file(rom->mapping, rom->mapping_size);
+    free(rom->owned);
+    memset(rom, 0, sizeof(*rom));
+}
+
+/* --------------------------------------------------------------------------
+   Corpora
+   -------------------------------------------------------------------------- */
+
+static bool has_rom_extension(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 4 && strcmp(name + len - 4, ".ch8") == 0;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/**
+ * @brief Appends a copy of @p name to a growable array of names.
+ */
+static bool append_name(char ***names, size_t *used, size_t *capacity, const char *name)
+{
+    if (*used == *capacity)
+    {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        char **grown = realloc(*names, new_capacity * sizeof(char *));
+        if (!grown)
+            return false;
+        *names = grown;
+        *capacity = new_capacity;
+    }
+
+    char *copy = malloc(strlen(name) + 1);
+    if (!copy)
+        return false;
+    strcpy(copy, name);
+    (*names)[(*used)++] = copy;
+    return true;
+}
+
+/**
+ * @brief Lists the *.ch8 entries of a directory, sorted by name.
+ *
+ * @return Malloc'd array of malloc'd names (caller frees), or NULL on error.
+ */
+static char **list_rom_files(const char *dir, size_t *count)
+{
+    char **names = NULL;
+    size_t used = 0;
+    size_t capacity = 0;
+    bool ok = true;
+
+#ifndef _WIN32
+    DIR *d = opendir(dir);
+    if (!d)
+        return NULL;
+
+    struct dirent *entry;
+    while (ok && (entry = readdir(d)) != NULL)
+    {
+        if (has_rom_extension(entry->d_name))
+            ok = append_name(&names, &used, &capacity, entry->d_name);
+    }
+    closedir(d);
+#else
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*.ch8", dir);
+
+    WIN32_FIND_DATAA find;
+    HANDLE h = FindFirstFileA(pattern, &find);
+    if (h != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (has_rom_extension(find.cFileName))
+                ok = append_name(&names, &used, &capacity, find.cFileName);
+        } while (ok && FindNextFileA(h, &find));
+        FindClose(h);
+    }
+#endif
+
+    if (ok && !names)
+        ok = (names = calloc(1, sizeof(char *))) != NULL;
+
+    if (!ok)
+    {
+        for (size_t i = 0; i < used; i++)
+            free(names[i]);
+        free(names);
+        return NULL;
+    }
+
+    qsort(names, used, sizeof(char *), compare_names);
+    *count = used;
+    return names;
+}
+
+bool rom_corpus_load_dir(rom_corpus_t *corpus, const char *dir)
+{
+    memset(corpus, 0, sizeof(*corpus));
+
+    size_t file_count = 0;
+    char **names = list_rom_files(dir, &file_count);
+    if (!names)
+    {
+        print_error("Failed to read ROM directory: %s", dir);
+        return false;
+    }
+
+    // Every file fits in ROM_MAX_SIZE, so one block holds the whole corpus
+    corpus->roms = calloc(file_count ? file_count : 1, sizeof(rom_image_t));
+    corpus->blob = malloc(file_count ? file_count * ROM_MAX_SIZE : 1);
+    bool ok = corpus->roms && corpus->blob;
+
+    size_t blob_used = 0;
+    for (size_t i = 0; ok && i < file_count; i++)
+    {
+        char path[ROM_NAME_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+
+        FILE *fp = fopen(path, "rb");
+        if (!fp)
+        {
+            print_warning("Skipping unreadable ROM: %s", path);
+            continue;
+        }
+
+        // Read one byte past the limit to detect oversized files
+        uint8_t *dst = corpus->blob + blob_used;
+        size_t size = fread(dst, 1, ROM_MAX_SIZE, fp);
+        int extra = fgetc(fp);
+        fclose(fp);
+        if (extra != EOF)
+        {
+            print_warning("Skipping oversized ROM: %s", path);
+            continue;
+        }
+
+        rom_image_t *rom = &corpus->roms[corpus->count++];
+        rom->data = size ? dst : NULL;
+        rom->size = size;
+        copy_name(rom->name, sizeof(rom->name), path);
+        blob_used += size;
+    }
+
+    for (size_t i = 0; i < file_count; i++)
+        free(names[i]);
+    free(names);
+
+    if (!ok)
+    {
+        print_error("Out of memory while loading ROM directory: %s", dir);
+        rom_corpus_free(corpus);
+        return false;
+    }
+
+    // Give back the unused tail of the worst-case block and re-point the images
+    uint8_t *shrunk = realloc(corpus->blob, blob_used ? blob_used : 1);
+    if (shrunk)
+    {
+        size_t offset = 0;
+        corpus->blob = shrunk;
+        for (size_t i = 0; i < corpus->count; i++)
+        {
+            corpus->roms[i].data = corpus->roms[i].size ? shrunk + offset : NULL;
+            offset += corpus->roms[i].size;
+        }
+    }
+
+    print_info("Loaded %zu ROMs from %s (%zu bytes)", corpus->count, dir, blob_used);
+    return true;
+}
+
+bool rom_corpus_load_pack(rom_corpus_t *corpus, const char *path)
+{
+    memset(corpus, 0, sizeof(*corpus));
+
+    const uint8_t *data;
+    size_t size;
+    void *mapping;
+    uint8_t *owned;
+    if (!map_file(path, &data, &size, &mapping, &owned))
+    {
+        print_error("Failed to open ROM pack: %s", path);
+        return false;
+    }
+    corpus->mapping = mapping;
+    corpus->mapping_size = size;
+    corpus->blob = owned;
+
+    if (size < ROM_PACK_HEADER_SIZE || memcmp(data, ROM_PACK_MAGIC, sizeof(ROM_PACK_MAGIC)) != 0 ||
+        get_u32(data + 8) != ROM_PACK_VERSION)
+    {
+        print_error("Not a CHIP-8 ROM pack (or unsupported version): %s", path);
+        rom_corpus_free(corpus);
+        return false;
+    }
+
+    uint32_t count = get_u32(data + 12);
+    if (count > (size - ROM_PACK_HEADER_SIZE) / ROM_PACK_ENTRY_SIZE)
+    {
+        print_error("Corrupt ROM pack index: %s", path);
+        rom_corpus_free(corpus);
+        return false;
+    }
+
+    corpus->roms = calloc(count ? count : 1, sizeof(rom_image_t));
+    if (!corpus->roms)
+    {
+        rom_corpus_free(corpus);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t *entry = data + ROM_PACK_HEADER_SIZE + (size_t)i * ROM_PACK_ENTRY_SIZE;
+        uint32_t offset = get_u32(entry);
+        uint32_t rom_size = get_u32(entry + 4);
+
+        if (rom_size > ROM_MAX_SIZE || offset > size || rom_size > size - offset)
+        {
+            print_error("Corrupt ROM pack entry %u: %s", i, path);
+            rom_corpus_free(corpus);
+            return false;
+        }
+
+        rom_image_t *rom = &corpus->roms[corpus->count++];
+        rom->data = rom_size ? data + offset : NULL;
+        rom->size = rom_size;
+        memcpy(rom->name, entry + 8, ROM_PACK_NAME_MAX);
+        rom->name[ROM_PACK_NAME_MAX - 1] = '\0';
+    }
+
+    print_info("Mapped %zu ROMs from %s", corpus->count, path);
+    return true;
+}
+
+bool rom_path_is_directory(const char *path)
+{
+#ifndef _WIN32
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#else
+    DWORD attributes = GetFileAttributesA(path);
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#endif
+}
+
+bool rom_corpus_load(rom_corpus_t *corpus, const char *path)
+{
+    if (rom_path_is_directory(path))
+        return rom_corpus_load_dir(corpus, path);
+    return rom_corpus_load_pack(corpus, path);
+}
+
+const rom_image_t *rom_corpus_find(const rom_corpus_t *corpus, const char *name)
+{
+    for (size_t i = 0; i < corpus->count; i++)
+    {
+        if (strcmp(corpus->roms[i].name, name) == 0)
+            return &corpus->roms[i];
+    }
+    return NULL;
+}
+
+void rom_corpus_free(rom_corpus_t *corpus)
+{
+    unmap_file(corpus->mapping, corpus->mapping_size);
+    free(corpus->blob);
+    free(corpus->roms);
+    memset(corpus, 0, sizeof(*corpus));
+}
+
+/* --------------------------------------------------------------------------
+   Pack archives
+   -------------------------------------------------------------------------- */
+
+bool rom_pack_write(const char *path, const rom_image_t *roms, size_t count)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        print_error("Failed to open ROM pack for writing: %s", path);
+        return false;
+    }
+
+    uint8_t header[ROM_PACK_HEADER_SIZE];
+    memcpy(header, ROM_PACK_MAGIC, sizeof(ROM_PACK_MAGIC));
+    put_u32(header + 8, ROM_PACK_VERSION);
+    put_u32(header + 12, (uint32_t)count);
+    bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+
+    // Index first, then the ROM bytes in the same order
+    uint32_t offset = (uint32_t)(ROM_PACK_HEADER_SIZE + count * ROM_PACK_ENTRY_SIZE);
+    for (size_t i = 0; ok && i < count; i++)
+    {
+        uint8_t entry[ROM_PACK_ENTRY_SIZE];
+        memset(entry, 0, sizeof(entry));
+        put_u32(entry, offset);
+        put_u32(entry + 4, (uint32_t)roms[i].size);
+        strncpy((char *)entry + 8, base_name(roms[i].name), ROM_PACK_NAME_MAX - 1);
+
+        ok = fwrite(entry, 1, sizeof(entry), fp) == sizeof(entry);
+        offset += (uint32_t)roms[i].size;
+    }
+
+    for (size_t i = 0; ok && i < count; i++)
+    {
+        if (roms[i].size)
+            ok = fwrite(roms[i].data, 1, roms[i].size, fp) == roms[i].size;
+    }
+
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+        print_error("Failed to write ROM pack: %s", path);
+    return ok;
+}
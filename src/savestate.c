@@ -0,0 +1,404 @@
+/**
+ * @file savestate.c
+ * @brief Implementation of save-state files and the rewind buffer.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "savestate.h"
+#include "cli_logger.h"
+
+/** @brief Bytes in a serialized snapshot (also sizeof(chip8_snapshot_t)). */
+#define SNAPSHOT_SIZE 5208
+
+/** @brief Worst-case encoded size of a SNAPSHOT_SIZE delta. */
+#define DELTA_MAX_SIZE (2 * SNAPSHOT_SIZE + 16)
+
+/** @brief Zero runs shorter than this stay inside a literal run. */
+#define DELTA_MIN_SKIP 4
+
+/** @brief File header: magic, u16 version, u16 reserved, u32 raw size, u32 payload size. */
+#define SAVESTATE_HEADER_SIZE 20
+
+static const char SAVESTATE_MAGIC[8] = {'C', 'H', '8', 'S', 'T', 'A', 'T', 'E'};
+
+_Static_assert(sizeof(chip8_snapshot_t) == SNAPSHOT_SIZE, "chip8_snapshot_t must not contain padding");
+
+/* --------------------------------------------------------------------------
+   Delta codec
+   -------------------------------------------------------------------------- */
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+/**
+ * @brief Encodes cur XOR ref as [u16 skip][u16 literal][literal bytes] runs.
+ *
+ * Trailing zeros are not encoded, so identical inputs produce zero bytes.
+ *
+ * @param cur Current bytes.
+ * @param ref Reference bytes, or NULL for all zeros.
+ * @param n   Length of both inputs.
+ * @param out Output buffer of at least 2 * n + 16 bytes.
+ * @return Encoded length.
+ */
+static size_t delta_encode(const uint8_t *cur, const uint8_t *ref, size_t n, uint8_t *out)
+{
+#define DELTA_AT(k) ((uint8_t)(cur[k] ^ (ref ? ref[k] : 0)))
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < n)
+    {
+        size_t skip_start = i;
+        while (i < n && i - skip_start < 0xFFFF && DELTA_AT(i) == 0)
+            i++;
+        if (i == n)
+            break;
+
+        // Extend the literal over short zero runs that would cost more to skip
+        size_t lit_start = i;
+        while (i < n && i - lit_start < 0xFFFF)
+        {
+            if (DELTA_AT(i) == 0)
+            {
+                size_t z = i;
+                while (z < n && z - i < DELTA_MIN_SKIP && DELTA_AT(z) == 0)
+                    z++;
+                if (z == n || z - i == DELTA_MIN_SKIP)
+                    break;
+            }
+            i++;
+        }
+
+        put_u16(&out[o], (uint16_t)(lit_start - skip_start));
+        put_u16(&out[o + 2], (uint16_t)(i - lit_start));
+        o += 4;
+        for (size_t k = lit_start; k < i; k++)
+            out[o++] = DELTA_AT(k);
+    }
+
+    return o;
+#undef DELTA_AT
+}
+
+/**
+ * @brief XORs an encoded delta into @p dst.
+ *
+ * @return false if the encoding is malformed or overruns @p n bytes.
+ */
+static bool delta_apply(uint8_t *dst, size_t n, const uint8_t *in, size_t in_len)
+{
+    size_t pos = 0;
+    size_t i = 0;
+
+    while (i < in_len)
+    {
+        if (in_len - i < 4)
+            return false;
+
+        size_t skip = get_u16(&in[i]);
+        size_t lit = get_u16(&in[i + 2]);
+        i += 4;
+
+        if (lit > in_len - i || skip + lit > n - pos)
+            return false;
+
+        pos += skip;
+        for (size_t k = 0; k < lit; k++)
+            dst[pos++] ^= in[i++];
+    }
+
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+   Save-state files
+   -------------------------------------------------------------------------- */
+
+/**
+ * @brief Serializes a snapshot field by field in little-endian order.
+ */
+static void serialize_snapshot(const chip8_snapshot_t *snap, uint8_t *out)
+{
+    put_u64(out, snap->rng_state);
+    put_u64(out + 8, snap->seed);
+    for (int i = 0; i < CHIP8_DISPLAY_WORDS; i++)
+        put_u64(out + 16 + 8 * i, snap->display[i]);
+    for (int i = 0; i < 16; i++)
+        put_u16(out + 1040 + 2 * i, snap->stack[i]);
+    put_u16(out + 1072, snap->I);
+    put_u16(out + 1074, snap->pc);
+    out[1076] = snap->sp;
+    out[1077] = snap->delay_timer;
+    out[1078] = snap->sound_timer;
+    out[1079] = snap->key_wait;
+    memcpy(out + 1080, snap->V, sizeof(snap->V));
+    memcpy(out + 1096, snap->rpl, sizeof(snap->rpl));
+    out[1104] = snap->machine;
+    out[1105] = snap->hires;
+    memset(out + 1106, 0, sizeof(snap->reserved));
+    memcpy(out + 1112, snap->memory, sizeof(snap->memory));
+}
+
+static void deserialize_snapshot(const uint8_t *in, chip8_snapshot_t *snap)
+{
+    snap->rng_state = get_u64(in);
+    snap->seed = get_u64(in + 8);
+    for (int i = 0; i < CHIP8_DISPLAY_WORDS; i++)
+        snap->display[i] = get_u64(in + 16 + 8 * i);
+    for (int i = 0; i < 16; i++)
+        snap->stack[i] = get_u16(in + 1040 + 2 * i);
+    snap->I = get_u16(in + 1072);
+    snap->pc = get_u16(in + 1074);
+    snap->sp = in[1076];
+    snap->delay_timer = in[1077];
+    snap->sound_timer = in[1078];
+    snap->key_wait = in[1079];
+    memcpy(snap->V, in + 1080, sizeof(snap->V));
+    memcpy(snap->rpl, in + 1096, sizeof(snap->rpl));
+    snap->machine = in[1104];
+    snap->hires = in[1105];
+    memset(snap->reserved, 0, sizeof(snap->reserved));
+    memcpy(snap->memory, in + 1112, sizeof(snap->memory));
+}
+
+bool savestate_write(const chip8_t *emu, const char *path)
+{
+    chip8_snapshot_t snap;
+    uint8_t raw[SNAPSHOT_SIZE];
+    uint8_t file[SAVESTATE_HEADER_SIZE + DELTA_MAX_SIZE];
+
+    chip8_snapshot(emu, &snap);
+    serialize_snapshot(&snap, raw);
+    size_t payload = delta_encode(raw, NULL, sizeof(raw), file + SAVESTATE_HEADER_SIZE);
+
+    memcpy(file, SAVESTATE_MAGIC, sizeof(SAVESTATE_MAGIC));
+    put_u16(file + 8, SAVESTATE_VERSION);
+    put_u16(file + 10, 0);
+    put_u32(file + 12, SNAPSHOT_SIZE);
+    put_u32(file + 16, (uint32_t)payload);
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        print_error("Failed to open save state for writing: %s", path);
+        return false;
+    }
+
+    size_t total = SAVESTATE_HEADER_SIZE + payload;
+    bool ok = fwrite(file, 1, total, fp) == total;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+    {
+        print_error("Failed to write save state: %s", path);
+        return false;
+    }
+
+    print_info("Saved state to %s (%zu bytes)", path, total);
+    return true;
+}
+
+bool savestate_read(chip8_t *emu, const char *path)
+{
+    uint8_t file[SAVESTATE_HEADER_SIZE + DELTA_MAX_SIZE];
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+    {
+        print_error("Failed to open save state: %s", path);
+        return false;
+    }
+    size_t size = fread(file, 1, sizeof(file), fp);
+    fclose(fp);
+
+    if (size < SAVESTATE_HEADER_SIZE || memcmp(file, SAVESTATE_MAGIC, sizeof(SAVESTATE_MAGIC)) != 0)
+    {
+        print_error("Not a CHIP-8 save state: %s", path);
+        return false;
+    }
+
+    uint16_t version = get_u16(file + 8);
+    uint32_t raw_size = get_u32(file + 12);
+    uint32_t payload = get_u32(file + 16);
+    if (version != SAVESTATE_VERSION || raw_size != SNAPSHOT_SIZE)
+    {
+        print_error("Unsupported save state version %u: %s", version, path);
+        return false;
+    }
+
+    uint8_t raw[SNAPSHOT_SIZE];
+    memset(raw, 0, sizeof(raw));
+    if (payload != size - SAVESTATE_HEADER_SIZE ||
+        !delta_apply(raw, sizeof(raw), file + SAVESTATE_HEADER_SIZE, payload))
+    {
+        print_error("Corrupt save state: %s", path);
+        return false;
+    }
+
+    chip8_snapshot_t snap;
+    deserialize_snapshot(raw, &snap);
+    if (snap.sp > 16 || snap.pc >= CHIP8_MEMORY_SIZE || (snap.key_wait & ~(CHIP8_KEY_WAIT | 0xFu)))
+    {
+        print_error("Corrupt save state (SP=%u, PC=0x%04X): %s", snap.sp, snap.pc, path);
+        return false;
+    }
+    if (snap.machine != emu->machine)
+    {
+        print_error("Save state is for the %s machine (pass --machine %s): %s",
+                    chip8_machine_info(snap.machine)->name, chip8_machine_info(snap.machine)->name, path);
+        return false;
+    }
+    // A 64x32 machine has no high-resolution screen to restore into
+    if (snap.hires > 1 || (snap.hires && !chip8_machine_info(snap.machine)->extended))
+    {
+        print_error("Corrupt save state (high resolution on the %s machine): %s",
+                    chip8_machine_info(snap.machine)->name, path);
+        return false;
+    }
+
+    chip8_restore(emu, &snap);
+    print_info("Loaded state from %s", path);
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+   Rewind buffer
+   -------------------------------------------------------------------------- */
+
+bool rewind_init(rewind_t *rw, uint32_t seconds)
+{
+    memset(rw, 0, sizeof(*rw));
+
+    // The arena is indexed with 32-bit offsets
+    size_t capacity = (size_t)seconds * 60;
+    if (capacity == 0 || capacity > UINT32_MAX / SAVESTATE_REWIND_BYTES_PER_FRAME ||
+        capacity > SIZE_MAX / sizeof(rewind_frame_t))
+        return false;
+    size_t arena_size = capacity * SAVESTATE_REWIND_BYTES_PER_FRAME;
+    if (arena_size < DELTA_MAX_SIZE)
+        arena_size = DELTA_MAX_SIZE;
+
+    rw->capacity = (uint32_t)capacity;
+    rw->arena_size = (uint32_t)arena_size;
+    rw->arena = malloc(arena_size);
+    rw->frames = malloc(capacity * sizeof(rewind_frame_t));
+    rw->scratch = malloc(DELTA_MAX_SIZE);
+    if (!rw->arena || !rw->frames || !rw->scratch)
+    {
+        rewind_cleanup(rw);
+        return false;
+    }
+    return true;
+}
+
+void rewind_cleanup(rewind_t *rw)
+{
+    free(rw->arena);
+    free(rw->frames);
+    free(rw->scratch);
+    memset(rw, 0, sizeof(*rw));
+}
+
+/**
+ * @brief Drops the oldest frame.
+ */
+static void rewind_drop_oldest(rewind_t *rw)
+{
+    rw->arena_used -= rw->frames[rw->first].length;
+    rw->first = (rw->first + 1) % rw->capacity;
+    rw->count--;
+}
+
+void rewind_push(rewind_t *rw, const chip8_t *emu)
+{
+    if (!rw->arena)
+        return;
+
+    if (!rw->has_current)
+    {
+        chip8_snapshot(emu, &rw->current);
+        rw->has_current = true;
+        return;
+    }
+
+    // The delta stored for the new frame restores the frame before it
+    chip8_snapshot(emu, &rw->next);
+    size_t length = delta_encode((const uint8_t *)&rw->next, (const uint8_t *)&rw->current,
+                                 sizeof(chip8_snapshot_t), rw->scratch);
+
+    while (rw->count == rw->capacity || rw->arena_size - rw->arena_used < length)
+        rewind_drop_oldest(rw);
+
+    rewind_frame_t *frame = &rw->frames[(rw->first + rw->count) % rw->capacity];
+    frame->offset = rw->arena_head;
+    frame->length = (uint32_t)length;
+
+    // Copy into the byte ring, wrapping at the end
+    size_t tail = rw->arena_size - rw->arena_head;
+    size_t first_part = length < tail ? length : tail;
+    memcpy(rw->arena + rw->arena_head, rw->scratch, first_part);
+    memcpy(rw->arena, rw->scratch + first_part, length - first_part);
+
+    rw->arena_head = (uint32_t)((rw->arena_head + length) % rw->arena_size);
+    rw->arena_used += (uint32_t)length;
+    rw->count++;
+
+    rw->current = rw->next;
+}
+
+bool rewind_step_back(rewind_t *rw, chip8_t *emu)
+{
+    if (!rw->arena || rw->count == 0)
+        return false;
+
+    const rewind_frame_t *frame = &rw->frames[(rw->first + rw->count - 1) % rw->capacity];
+
+    size_t tail = rw->arena_size - frame->offset;
+    size_t first_part = frame->length < tail ? frame->length : tail;
+    memcpy(rw->scratch, rw->arena + frame->offset, first_part);
+    memcpy(rw->scratch + first_part, rw->arena, frame->length - first_part);
+
+    // Our own encodings never fail to decode
+    delta_apply((uint8_t *)&rw->current, sizeof(chip8_snapshot_t), rw->scratch, frame->length);
+
+    rw->arena_head = frame->offset;
+    rw->arena_used -= frame->length;
+    rw->count--;
+
+    chip8_restore(emu, &rw->current);
+    return true;
+}
@@ -8,9 +8,17 @@
 #include <string.h>
 #include <stdbool.h>
 #include <SDL2/SDL.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include "sdl_interface.h"
 #include "cli_logger.h"
 
+/** @brief Window title; sdl_show_status() appends to it. */
+#define WINDOW_TITLE "CHIP-8 Emulator"
+
 /**
  * @brief Extracts RGBA components from a 32-bit color value.
  *
@@ -64,21 +72,38 @@ static bool confirm_quit()
     }
 }
 
-bool sdl_init(sdl_t *sdl, const display_config_t *config)
+bool sdl_init(sdl_t *sdl, const display_config_t *config, const chip8_machine_t *machine)
 {
-    // Initialize SDL with everything enabled (audio, video, etc.)
-    if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+    // Video (and with it events) only: audio opens on the first beep, and
+    // joystick, haptic and controller support cost startup time for nothing
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         SDL_Log("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
         return false;
     }
 
+    sdl->renderer = NULL;
+    sdl->texture = NULL;
+    sdl->gl = NULL;
+    sdl->scale = 1;
+    sdl->width = machine->width;
+    sdl->height = machine->height;
+
+    // The GL backend needs a GL-capable window and a 2.1 context
+    bool want_gl = config->renderer == CONFIG_RENDERER_GL;
+    if (want_gl)
+    {
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+        SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    }
+
     // Create a window
-    sdl->window = SDL_CreateWindow("CHIP-8 Emulator",
+    sdl->window = SDL_CreateWindow(WINDOW_TITLE,
                                    SDL_WINDOWPOS_CENTERED,
                                    SDL_WINDOWPOS_CENTERED,
                                    config->window_width, config->window_height,
-                                   SDL_WINDOW_SHOWN);
+                                   SDL_WINDOW_SHOWN | (want_gl ? SDL_WINDOW_OPENGL : 0));
 
     if (!sdl->window)
     {
@@ -87,9 +112,34 @@ bool sdl_init(sdl_t *sdl, const display_config_t *config)
         return false;
     }
 
-    // Create a renderer for the window
+    if (want_gl)
+    {
+        sdl->gl = malloc(sizeof(*sdl->gl));
+        if (sdl->gl && gl_renderer_init(sdl->gl, sdl->window, config, machine))
+        {
+            static const uint64_t blank[CHIP8_DISPLAY_WORDS];
+            gl_renderer_present(sdl->gl, blank, false, CHIP8_ALL_ROWS_DIRTY);
+            return true;
+        }
+        free(sdl->gl);
+        sdl->gl = NULL;
+        print_warning("Falling back to the SDL renderer.");
+    }
+
+    // Create a renderer for the window; without a GPU, draw in software
     sdl->renderer = SDL_CreateRenderer(sdl->window, -1, SDL_RENDERER_ACCELERATED);
     if (!sdl->renderer)
+    {
+        print_warning("No accelerated renderer (%s), using the software renderer.", SDL_GetError());
+        sdl->renderer = SDL_CreateRenderer(sdl->window, -1, SDL_RENDERER_SOFTWARE);
+
+        // Scaling while converting is cheaper than a software RenderCopy
+        // stretch; the scale factor counts low-resolution pixels
+        int scale = (int)config->scale_factor * CHIP8_DISPLAY_WIDTH / sdl->width;
+        if (scale > 1)
+            sdl->scale = scale;
+    }
+    if (!sdl->renderer)
     {
         SDL_Log("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
         SDL_DestroyWindow(sdl->window);
@@ -101,7 +151,8 @@ bool sdl_init(sdl_t *sdl, const display_config_t *config)
     sdl->texture = SDL_CreateTexture(sdl->renderer,
                                      SDL_PIXELFORMAT_ARGB8888,
                                      SDL_TEXTUREACCESS_STREAMING,
-                                     64, 32); // CHIP-8 resolution
+                                     sdl->width * sdl->scale,
+                                     sdl->height * sdl->scale); // Largest resolution, times scale
     if (!sdl->texture)
     {
         SDL_Log("Texture could not be created! SDL_Error: %s\n", SDL_GetError());
@@ -123,123 +174,357 @@ bool sdl_init(sdl_t *sdl, const display_config_t *config)
     return true;
 }
 
-void sdl_render(const sdl_t *sdl, const chip8_t *emu)
+/*-----------------------------------------------------------
+ *   PIXEL CONVERSION KERNELS
+ *
+ * Each row kernel expands one 64-pixel display word (pixel 0 in the MSB)
+ * into 64 ARGB8888 pixels; high-resolution rows are two words. The vector
+ * versions compare every lane against a one-hot selector to get an
+ * all-ones mask for lit pixels and use it to pick fg or bg; the selectors
+ * walk down the row by shifting. Scaled rows are filled one run of equal
+ * pixels at a time.
+ *----------------------------------------------------------*/
+
+#if defined(__AVX2__)
+
+static const char convert_kernel_name[] = "avx2";
+
+static void convert_row(uint64_t row, uint32_t fg, uint32_t bg, uint32_t *dst)
 {
-    // The chip8_t's display is 64x32. We'll convert it into ARGB8888 pixels.
-    uint32_t pixels[64 * 32];
-    for (int i = 0; i < 64 * 32; i++)
+    const __m256i fgv = _mm256_set1_epi32((int)fg);
+    const __m256i bgv = _mm256_set1_epi32((int)bg);
+    const __m256i first = _mm256_set_epi32(1 << 24, 1 << 25, 1 << 26, 1 << 27,
+                                           1 << 28, 1 << 29, 1 << 30, (int)(1u << 31));
+
+    for (int half = 0; half < 2; half++)
     {
-        // If display[i] is non-zero, pixel is fg_color; otherwise bg_color
-        uint8_t pixel_on = emu->display[i];
-        pixels[i] = pixel_on ? emu->config.fg_color : emu->config.bg_color;
+        // Lane i of group g tests pixel 8g + i of this 32-pixel half
+        const __m256i bits = _mm256_set1_epi32((int)(uint32_t)(row >> (32 - 32 * half)));
+        __m256i sel = first;
+        for (int g = 0; g < 4; g++, dst += 8)
+        {
+            __m256i lit = _mm256_cmpeq_epi32(_mm256_and_si256(bits, sel), sel);
+            _mm256_storeu_si256((__m256i *)dst, _mm256_blendv_epi8(bgv, fgv, lit));
+            sel = _mm256_srli_epi32(sel, 8);
+        }
     }
+}
 
-    // Update the texture with our pixel buffer
-    if (SDL_UpdateTexture(sdl->texture, NULL, pixels, 64 * sizeof(uint32_t)) != 0)
+static void fill_span(uint32_t *dst, uint32_t color, int n)
+{
+    const __m256i v = _mm256_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+    for (; i < n; i++)
+        dst[i] = color;
+}
+
+#elif defined(__SSE2__)
+
+static const char convert_kernel_name[] = "sse2";
+
+static void convert_row(uint64_t row, uint32_t fg, uint32_t bg, uint32_t *dst)
+{
+    const __m128i fgv = _mm_set1_epi32((int)fg);
+    const __m128i bgv = _mm_set1_epi32((int)bg);
+    const __m128i first = _mm_set_epi32(1 << 28, 1 << 29, 1 << 30, (int)(1u << 31));
+
+    for (int half = 0; half < 2; half++)
     {
-        SDL_Log("SDL_UpdateTexture failed: %s\n", SDL_GetError());
-        return;
+        // Lane i of group g tests pixel 4g + i of this 32-pixel half
+        const __m128i bits = _mm_set1_epi32((int)(uint32_t)(row >> (32 - 32 * half)));
+        __m128i sel = first;
+        for (int g = 0; g < 8; g++, dst += 4)
+        {
+            // SSE2 has no blend: (lit & fg) | (~lit & bg)
+            __m128i lit = _mm_cmpeq_epi32(_mm_and_si128(bits, sel), sel);
+            _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(lit, fgv), _mm_andnot_si128(lit, bgv)));
+            sel = _mm_srli_epi32(sel, 4);
+        }
     }
+}
 
-    // Render
-    if (SDL_RenderClear(sdl->renderer) != 0)
+static void fill_span(uint32_t *dst, uint32_t color, int n)
+{
+    const __m128i v = _mm_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    for (; i < n; i++)
+        dst[i] = color;
+}
+
+#elif defined(__ARM_NEON)
+
+static const char convert_kernel_name[] = "neon";
+
+static void convert_row(uint64_t row, uint32_t fg, uint32_t bg, uint32_t *dst)
+{
+    static const uint32_t first_lanes[4] = {1u << 31, 1u << 30, 1u << 29, 1u << 28};
+    const uint32x4_t fgv = vdupq_n_u32(fg);
+    const uint32x4_t bgv = vdupq_n_u32(bg);
+    const uint32x4_t first = vld1q_u32(first_lanes);
+
+    for (int half = 0; half < 2; half++)
     {
-        SDL_Log("SDL_RenderClear failed: %s\n", SDL_GetError());
-        return;
+        // Lane i of group g tests pixel 4g + i of this 32-pixel half
+        const uint32x4_t bits = vdupq_n_u32((uint32_t)(row >> (32 - 32 * half)));
+        uint32x4_t sel = first;
+        for (int g = 0; g < 8; g++, dst += 4)
+        {
+            vst1q_u32(dst, vbslq_u32(vtstq_u32(bits, sel), fgv, bgv));
+            sel = vshrq_n_u32(sel, 4);
+        }
     }
+}
 
-    if (SDL_RenderCopy(sdl->renderer, sdl->texture, NULL, NULL) != 0)
+static void fill_span(uint32_t *dst, uint32_t color, int n)
+{
+    const uint32x4_t v = vdupq_n_u32(color);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1q_u32(dst + i, v);
+    for (; i < n; i++)
+        dst[i] = color;
+}
+
+#else
+
+static const char convert_kernel_name[] = "scalar";
+
+static void convert_row(uint64_t row, uint32_t fg, uint32_t bg, uint32_t *dst)
+{
+    // Branchless select: the mask is all ones for a lit pixel
+    const uint32_t diff = fg ^ bg;
+    for (int x = 0; x < CHIP8_DISPLAY_WIDTH; x++)
     {
-        SDL_Log("SDL_RenderCopy failed: %s\n", SDL_GetError());
-        return;
+        uint32_t lit = (uint32_t)0 - (uint32_t)((row >> (CHIP8_DISPLAY_WIDTH - 1 - x)) & 1);
+        dst[x] = bg ^ (diff & lit);
     }
+}
 
-    SDL_RenderPresent(sdl->renderer);
+static void fill_span(uint32_t *dst, uint32_t color, int n)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = color;
+}
+
+#endif
+
+/**
+ * @brief Expands one word to 64 * @p scale pixels, one run of equal pixels at a time.
+ */
+static void convert_row_scaled(uint64_t row, uint32_t fg, uint32_t bg, uint32_t *dst, int scale)
+{
+    int x = 0;
+    while (x < CHIP8_DISPLAY_WIDTH)
+    {
+        // row holds the pixels from x on, left-aligned; a run ends at the
+        // first bit that differs from the leading one, and a lit run at the
+        // latest where the zeros shifted in below the row begin
+        bool lit = row >> 63;
+        uint64_t rest = lit ? ~row : row;
+        int run = rest ? __builtin_clzll(rest) : CHIP8_DISPLAY_WIDTH - x;
+
+        fill_span(dst, lit ? fg : bg, run * scale);
+        dst += run * scale;
+        x += run;
+        row = run < 64 ? row << run : 0;
+    }
+}
+
+const char *sdl_convert_kernel(void)
+{
+    return convert_kernel_name;
+}
+
+void sdl_convert_rows(const uint64_t *display, bool hires, const display_config_t *config,
+                      void *pixels, int pitch, int first, int last, int scale)
+{
+    const int words = hires ? 2 : 1;
+    uint8_t *out = pixels;
+    for (int y = first; y <= last; y++)
+    {
+        const uint64_t *row = &display[y * words];
+        uint32_t *dst = (uint32_t *)out;
+        if (scale == 1)
+        {
+            for (int w = 0; w < words; w++)
+                convert_row(row[w], config->fg_color, config->bg_color, dst + 64 * w);
+            out += pitch;
+            continue;
+        }
+
+        // Build the first copy of the row, then duplicate it downwards
+        for (int w = 0; w < words; w++)
+            convert_row_scaled(row[w], config->fg_color, config->bg_color, dst + 64 * scale * w, scale);
+        out += pitch;
+        for (int r = 1; r < scale; r++, out += pitch)
+            memcpy(out, dst, (size_t)64 * words * scale * sizeof(uint32_t));
+    }
+}
+
+void sdl_render(const sdl_t *sdl, const chip8_t *emu)
+{
+    // Convert the whole display straight into the texture and present it
+    sdl_present(sdl, emu->display, emu->hires, &emu->config, CHIP8_ALL_ROWS_DIRTY);
+}
+
+void sdl_keymap_default(sdl_keymap_t *keymap)
+{
+    /*
+     * CHIP-8 Keypad Mapping (by key position, so it holds on any layout):
+     *
+     *   1 2 3 C        1 2 3 4
+     *   4 5 6 D   <-   Q W E R
+     *   7 8 9 E        A S D F
+     *   A 0 B F        Z X C V
+     */
+    static const SDL_Scancode layout[16] = {
+        SDL_SCANCODE_X, SDL_SCANCODE_1, SDL_SCANCODE_2, SDL_SCANCODE_3, // 0 1 2 3
+        SDL_SCANCODE_Q, SDL_SCANCODE_W, SDL_SCANCODE_E, SDL_SCANCODE_A, // 4 5 6 7
+        SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_Z, SDL_SCANCODE_C, // 8 9 A B
+        SDL_SCANCODE_4, SDL_SCANCODE_R, SDL_SCANCODE_F, SDL_SCANCODE_V, // C D E F
+    };
+
+    memset(keymap->keys, SDL_KEYMAP_UNMAPPED, sizeof(keymap->keys));
+    for (uint8_t key = 0; key < 16; key++)
+        keymap->keys[layout[key]] = key;
+}
+
+bool sdl_keymap_load(sdl_keymap_t *keymap, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        print_error("Failed to open keymap: %s", path);
+        return false;
+    }
+
+    sdl_keymap_t loaded;
+    memset(loaded.keys, SDL_KEYMAP_UNMAPPED, sizeof(loaded.keys));
+
+    char line[256];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp))
+    {
+        line_no++;
+
+        // Strip the comment and trailing whitespace
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r' ||
+                           line[len - 1] == ' ' || line[len - 1] == '\t'))
+            line[--len] = '\0';
+
+        unsigned key;
+        int name_start;
+        if (sscanf(line, " %n", &name_start) == 0 && line[name_start] == '\0')
+            continue; // Blank line
+
+        if (sscanf(line, " %x %n", &key, &name_start) != 1 || key > 0xF || line[name_start] == '\0')
+        {
+            print_error("%s:%d: expected '<chip8 key 0-F> <scancode name>'", path, line_no);
+            ok = false;
+            break;
+        }
+
+        SDL_Scancode scancode = SDL_GetScancodeFromName(&line[name_start]);
+        if (scancode == SDL_SCANCODE_UNKNOWN || scancode >= SDL_NUM_SCANCODES)
+        {
+            print_error("%s:%d: unknown key name '%s'", path, line_no, &line[name_start]);
+            ok = false;
+            break;
+        }
+        loaded.keys[scancode] = (uint8_t)key;
+    }
+    fclose(fp);
+
+    if (ok)
+    {
+        *keymap = loaded;
+        print_info("Loaded keymap: %s", path);
+    }
+    return ok;
 }
 
-void sdl_handle_event(chip8_t *emu, const SDL_Event *event)
+/**
+ * @brief Returns the CHIP-8 key bound to a keyboard event, or SDL_KEYMAP_UNMAPPED.
+ */
+static uint8_t lookup_key(const sdl_input_t *input, const SDL_Event *event)
 {
+    SDL_Scancode scancode = event->key.keysym.scancode;
+    if ((unsigned)scancode >= SDL_NUM_SCANCODES)
+        return SDL_KEYMAP_UNMAPPED;
+    return input->keymap->keys[scancode];
+}
+
+void sdl_handle_event(sdl_input_t *input, const SDL_Event *event)
+{
+    uint8_t key;
+
     switch (event->type)
     {
     case SDL_QUIT:
-        emu->state = CHIP8_STOPPED;
+        input->state = CHIP8_STOPPED;
         break;
 
     case SDL_KEYDOWN:
-        switch (event->key.keysym.sym)
+        key = lookup_key(input, event);
+        if (key != SDL_KEYMAP_UNMAPPED)
         {
-        // CHIP-8 Keypad Mapping
-        case SDLK_1:
-            emu->keys[0x1] = true;
-            break;
-        case SDLK_2:
-            emu->keys[0x2] = true;
-            break;
-        case SDLK_3:
-            emu->keys[0x3] = true;
-            break;
-        case SDLK_4:
-            emu->keys[0xC] = true;
-            break;
-        case SDLK_q:
-            emu->keys[0x4] = true;
-            break;
-        case SDLK_w:
-            emu->keys[0x5] = true;
-            break;
-        case SDLK_e:
-            emu->keys[0x6] = true;
-            break;
-        case SDLK_r:
-            emu->keys[0xD] = true;
-            break;
-        case SDLK_a:
-            emu->keys[0x7] = true;
-            break;
-        case SDLK_s:
-            emu->keys[0x8] = true;
-            break;
-        case SDLK_d:
-            emu->keys[0x9] = true;
-            break;
-        case SDLK_f:
-            emu->keys[0xE] = true;
-            break;
-        case SDLK_z:
-            emu->keys[0xA] = true;
-            break;
-        case SDLK_x:
-            emu->keys[0x0] = true;
-            break;
-        case SDLK_c:
-            emu->keys[0xB] = true;
-            break;
-        case SDLK_v:
-            emu->keys[0xF] = true;
+            // Auto-repeat is not a new press
+            if (!event->key.repeat)
+                input->pressed |= (uint16_t)(1u << key);
+            input->keys |= (uint16_t)(1u << key);
             break;
+        }
 
+        switch (event->key.keysym.sym)
+        {
         // Handle Quit
         case SDLK_ESCAPE:
             if (confirm_quit())
             {
-                emu->state = CHIP8_STOPPED;
+                input->state = CHIP8_STOPPED;
             }
             break;
 
         // Handle Pause/Resume
         case SDLK_SPACE:
-            if (emu->state == CHIP8_RUNNING)
+            if (input->state == CHIP8_RUNNING)
             {
-                emu->state = CHIP8_PAUSED;
-                print_info("CHIP-8 Emulator State: %s", "PAUSED");
+                input->state = CHIP8_PAUSED;
+                print_info("CHIP-8 Emulator State: %s (F10 steps one instruction)", "PAUSED");
             }
-            else if (emu->state == CHIP8_PAUSED)
+            else if (input->state == CHIP8_PAUSED)
             {
-                emu->state = CHIP8_RUNNING;
+                input->state = CHIP8_RUNNING;
                 print_info("CHIP-8 Emulator State: %s", "RUNNING");
             }
             break;
 
+        // Single-step while paused
+        case SDLK_F10:
+            if (input->state == CHIP8_PAUSED)
+                input->steps++;
+            break;
+
+        // Metrics in the title bar
+        case SDLK_F3:
+            input->overlay = !input->overlay;
+            break;
+
+        // Rewind while held
+        case SDLK_BACKSPACE:
+            if (input->state == CHIP8_RUNNING)
+                input->state = CHIP8_REWINDING;
+            break;
+
         default:
             // Handle other keys if necessary
             break;
@@ -247,59 +532,19 @@ void sdl_handle_event(chip8_t *emu, const SDL_Event *event)
         break;
 
     case SDL_KEYUP:
-        switch (event->key.keysym.sym)
+        key = lookup_key(input, event);
+        if (key != SDL_KEYMAP_UNMAPPED)
+            input->keys &= (uint16_t)~(1u << key);
+        else if (event->key.keysym.sym == SDLK_BACKSPACE && input->state == CHIP8_REWINDING)
+            input->state = CHIP8_RUNNING;
+        break;
+
+    case SDL_WINDOWEVENT:
+        // The window contents were lost or resized: redraw on the next present
+        if (event->window.event == SDL_WINDOWEVENT_EXPOSED ||
+            event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
         {
-        case SDLK_1:
-            emu->keys[0x1] = false;
-            break;
-        case SDLK_2:
-            emu->keys[0x2] = false;
-            break;
-        case SDLK_3:
-            emu->keys[0x3] = false;
-            break;
-        case SDLK_4:
-            emu->keys[0xC] = false;
-            break;
-        case SDLK_q:
-            emu->keys[0x4] = false;
-            break;
-        case SDLK_w:
-            emu->keys[0x5] = false;
-            break;
-        case SDLK_e:
-            emu->keys[0x6] = false;
-            break;
-        case SDLK_r:
-            emu->keys[0xD] = false;
-            break;
-        case SDLK_a:
-            emu->keys[0x7] = false;
-            break;
-        case SDLK_s:
-            emu->keys[0x8] = false;
-            break;
-        case SDLK_d:
-            emu->keys[0x9] = false;
-            break;
-        case SDLK_f:
-            emu->keys[0xE] = false;
-            break;
-        case SDLK_z:
-            emu->keys[0xA] = false;
-            break;
-        case SDLK_x:
-            emu->keys[0x0] = false;
-            break;
-        case SDLK_c:
-            emu->keys[0xB] = false;
-            break;
-        case SDLK_v:
-            emu->keys[0xF] = false;
-            break;
-        default:
-            // Handle other keys if necessary
-            break;
+            input->redraw = true;
         }
         break;
 
@@ -309,41 +554,47 @@ void sdl_handle_event(chip8_t *emu, const SDL_Event *event)
     }
 }
 
-void sdl_update_screen(const sdl_t *sdl, const chip8_t *emu, uint8_t *previous_frame)
+void sdl_present(const sdl_t *sdl, const uint64_t *display, bool hires, const display_config_t *config,
+                 uint64_t dirty)
 {
-    bool changed = false;
-
-    // Check if the display has changed since the last frame
-    for (int i = 0; i < 64 * 32; i++)
+    if (sdl->gl)
     {
-        if (emu->display[i] != previous_frame[i])
-        {
-            changed = true;
-            break;
-        }
+        // The shader does conversion and scaling; it may redraw unchanged frames
+        gl_renderer_present(sdl->gl, display, hires, dirty);
+        return;
     }
 
-    if (!changed)
+    if (dirty == 0)
     {
-        // No difference, skip rendering
+        // Nothing drawn since the last present, skip rendering
         return;
     }
 
-    // If changed, build new pixel buffer
-    uint32_t pixels[64 * 32];
-    for (int i = 0; i < 64 * 32; i++)
-    {
-        previous_frame[i] = emu->display[i]; // Update previous_frame
-        pixels[i] = emu->display[i] ? emu->config.fg_color : emu->config.bg_color;
-    }
+    // A low-resolution frame on a SUPER-CHIP texture is scaled up 2x
+    const int height = hires ? CHIP8_HIRES_HEIGHT : CHIP8_DISPLAY_HEIGHT;
+    const int scale = sdl->scale * sdl->height / height;
 
-    // Update the texture with the new pixel data
-    if (SDL_UpdateTexture(sdl->texture, NULL, pixels, 64 * sizeof(uint32_t)) != 0)
+    // Find the range of rows that changed since the last present
+    dirty &= height == 64 ? CHIP8_ALL_ROWS_DIRTY : ((uint64_t)1 << height) - 1;
+    if (dirty == 0)
+        return;
+    int first = __builtin_ctzll(dirty);
+    int last = 63 - __builtin_clzll(dirty);
+
+    // Lock only that band of the texture and convert it in place
+    SDL_Rect band = {0, first * scale, sdl->width * sdl->scale, (last - first + 1) * scale};
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(sdl->texture, &band, &pixels, &pitch) != 0)
     {
-        SDL_Log("SDL_UpdateTexture failed: %s\n", SDL_GetError());
+        SDL_Log("SDL_LockTexture failed: %s\n", SDL_GetError());
         return;
     }
 
+    sdl_convert_rows(display, hires, config, pixels, pitch, first, last, scale);
+
+    SDL_UnlockTexture(sdl->texture);
+
     // Clear the renderer
     if (SDL_RenderClear(sdl->renderer) != 0)
     {
@@ -362,6 +613,25 @@ void sdl_update_screen(const sdl_t *sdl, const chip8_t *emu, uint8_t *previous_f
     SDL_RenderPresent(sdl->renderer);
 }
 
+void sdl_update_screen(const sdl_t *sdl, chip8_t *emu)
+{
+    sdl_present(sdl, emu->display, emu->hires, &emu->config, emu->dirty_rows);
+    emu->dirty_rows = 0;
+}
+
+void sdl_show_status(const sdl_t *sdl, const char *status)
+{
+    if (!status)
+    {
+        SDL_SetWindowTitle(sdl->window, WINDOW_TITLE);
+        return;
+    }
+
+    char title[256];
+    snprintf(title, sizeof(title), "%s - %s", WINDOW_TITLE, status);
+    SDL_SetWindowTitle(sdl->window, title);
+}
+
 /**
  * @brief Cleans up and releases all SDL resources.
  *
@@ -371,6 +641,13 @@ void sdl_update_screen(const sdl_t *sdl, const chip8_t *emu, uint8_t *previous_f
  */
 void sdl_cleanup(sdl_t *sdl)
 {
+    if (sdl->gl)
+    {
+        gl_renderer_cleanup(sdl->gl);
+        free(sdl->gl);
+        sdl->gl = NULL;
+    }
+
     if (sdl->texture)
     {
         SDL_DestroyTexture(sdl->texture);
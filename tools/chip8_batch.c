@@ -0,0 +1,483 @@
+/**
+ * @file chip8_batch.c
+ * @brief Runs many headless CHIP-8 instances in parallel across cores.
+ *
+ * chip8-batch takes a list of ROMs (and optional seeds), shards them across
+ * a pool of worker threads and runs each one headless up to a cycle budget.
+ * One CSV line per instance is written in input order once every job has
+ * finished. Workers claim jobs from a shared atomic index, so a slow ROM
+ * never leaves the other cores idle.
+ *
+ * Usage:
+ *   chip8-batch [options] <rom | @listfile>...
+ *
+ * A list file holds one "<rom_path> [seed]" entry per line; blank lines and
+ * lines starting with '#' are ignored. --corpus adds every ROM of a
+ * directory or pack archive.
+ *
+ * Every ROM is read (or mapped) once up front; each run then loads it with a
+ * single memcpy, so large corpora cost no filesystem round-trips per run.
+ */
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "config.h"
+#include "headless.h"
+#include "cli_logger.h"
+#include "rom.h"
+
+/**
+ * @struct batch_job_t
+ * @brief One emulator instance to run and, afterwards, its result.
+ */
+typedef struct
+{
+    int image;                /**< Index into batch_t.images */
+    uint64_t seed;            /**< PRNG seed for CXNN */
+    bool ok;                  /**< ROM loaded and run ended without error */
+    chip8_state_t state;      /**< Final emulator state */
+    bool key_wait;            /**< The run ended halted in FX0A */
+    headless_result_t result; /**< Run summary */
+} batch_job_t;
+
+/**
+ * @struct batch_image_t
+ * @brief A ROM shared by one or more jobs.
+ */
+typedef struct
+{
+    rom_image_t rom; /**< ROM bytes; empty if loading failed */
+    bool ok;         /**< false if the ROM could not be read */
+} batch_image_t;
+
+/**
+ * @struct batch_t
+ * @brief Work shared by all worker threads.
+ */
+typedef struct
+{
+    batch_job_t *jobs;          /**< Job array, written disjointly by workers */
+    int job_count;              /**< Number of jobs */
+    int job_capacity;           /**< Allocated job slots */
+    batch_image_t *images;      /**< ROMs, loaded once and shared read-only */
+    int image_count;            /**< Number of images */
+    int image_capacity;         /**< Allocated image slots */
+    rom_corpus_t *corpora;      /**< Corpora backing some of the images */
+    int corpus_count;           /**< Number of corpora */
+    SDL_atomic_t next_job;      /**< Index of the next unclaimed job */
+    emulation_config_t emu_cfg; /**< Shared run settings */
+} batch_t;
+
+static void print_batch_usage(const char *prog_name, FILE *out)
+{
+    fprintf(out,
+            "Usage: %s [options] <rom | @listfile>...\n\n"
+            "Options:\n"
+            "  -j, --jobs <n>             Worker threads (default: CPU count)\n"
+            "  -n, --max-cycles <n>       Instruction budget per instance (default: 10000000)\n"
+            "  -c, --cycles-per-frame <n> Instructions per virtual frame (default: 12)\n"
+            "  -m, --machine <chip8|schip> Machine to emulate (default: chip8)\n"
+            "  -q, --quirks <profile>     vip, schip or modern (default: the machine's)\n"
+            "  -s, --seed <n>             Seed for entries without one (default: 1)\n"
+            "  -r, --repeat <n>           Run each entry with n consecutive seeds (default: 1)\n"
+            "  -C, --corpus <dir|pack>    Run every ROM of a directory or pack archive\n"
+            "  -o, --output <file>        Write CSV results to file (default: stdout)\n"
+            "  -v, --verbose              Print informational messages\n"
+            "  -?, --help                 Show this help message and exit\n",
+            prog_name);
+}
+
+/**
+ * @brief Appends an image to the batch, taking ownership of what it owns.
+ *
+ * @return The index of the image, or -1 on allocation failure.
+ */
+static int add_image(batch_t *batch, const rom_image_t *image, bool ok)
+{
+    if (batch->image_count == batch->image_capacity)
+    {
+        int new_capacity = batch->image_capacity ? batch->image_capacity * 2 : 64;
+        batch_image_t *images = realloc(batch->images, (size_t)new_capacity * sizeof(batch_image_t));
+        if (!images)
+        {
+            print_error("Out of memory while loading ROMs.");
+            return -1;
+        }
+        batch->images = images;
+        batch->image_capacity = new_capacity;
+    }
+
+    batch->images[batch->image_count].rom = *image;
+    batch->images[batch->image_count].ok = ok;
+    return batch->image_count++;
+}
+
+/**
+ * @brief Returns the image for @p rom_path, mapping the file on first use.
+ *
+ * Consecutive entries for the same path (list files, --repeat) share one
+ * image. A ROM that cannot be read still gets an (empty) image so that its
+ * jobs are reported as failed.
+ */
+static int find_or_map_image(batch_t *batch, const char *rom_path)
+{
+    if (batch->image_count > 0 && strcmp(batch->images[batch->image_count - 1].rom.name, rom_path) == 0)
+        return batch->image_count - 1;
+
+    rom_image_t image;
+    bool ok = rom_image_map(&image, rom_path);
+    if (!ok)
+        rom_image_from_buffer(&image, NULL, 0, rom_path);
+
+    int index = add_image(batch, &image, ok);
+    if (index < 0)
+        rom_image_release(&image);
+    return index;
+}
+
+/**
+ * @brief Grows the job array and appends @p repeat jobs for one ROM image.
+ */
+static bool add_jobs(batch_t *batch, int image, uint64_t seed, int repeat)
+{
+    for (int i = 0; i < repeat; i++)
+    {
+        if (batch->job_count == batch->job_capacity)
+        {
+            int new_capacity = batch->job_capacity ? batch->job_capacity * 2 : 64;
+            batch_job_t *jobs = realloc(batch->jobs, (size_t)new_capacity * sizeof(batch_job_t));
+            if (!jobs)
+            {
+                print_error("Out of memory while queuing jobs.");
+                return false;
+            }
+            batch->jobs = jobs;
+            batch->job_capacity = new_capacity;
+        }
+
+        batch_job_t *job = &batch->jobs[batch->job_count++];
+        memset(job, 0, sizeof(*job));
+        job->image = image;
+        job->seed = seed + (uint64_t)i;
+    }
+    return true;
+}
+
+/**
+ * @brief Queues one ROM file.
+ */
+static bool add_rom(batch_t *batch, const char *rom_path, uint64_t seed, int repeat)
+{
+    int image = find_or_map_image(batch, rom_path);
+    return image >= 0 && add_jobs(batch, image, seed, repeat);
+}
+
+/**
+ * @brief Queues every entry of a "<rom_path> [seed]" list file.
+ */
+static bool add_jobs_from_list(batch_t *batch, const char *list_path, uint64_t default_seed, int repeat)
+{
+    FILE *fp = fopen(list_path, "r");
+    if (!fp)
+    {
+        print_error("Failed to open ROM list: %s", list_path);
+        return false;
+    }
+
+    char line[512];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp))
+    {
+        char path[256];
+        unsigned long long seed = default_seed;
+
+        if (line[0] == '#' || sscanf(line, "%255s %llu", path, &seed) < 1)
+            continue;
+        ok = add_rom(batch, path, (uint64_t)seed, repeat);
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief Queues every ROM of a directory or pack archive.
+ */
+static bool add_jobs_from_corpus(batch_t *batch, const char *path, uint64_t seed, int repeat)
+{
+    rom_corpus_t *corpora = realloc(batch->corpora, (size_t)(batch->corpus_count + 1) * sizeof(rom_corpus_t));
+    if (!corpora)
+    {
+        print_error("Out of memory while loading corpus: %s", path);
+        return false;
+    }
+    batch->corpora = corpora;
+
+    rom_corpus_t *corpus = &batch->corpora[batch->corpus_count];
+    if (!rom_corpus_load(corpus, path))
+        return false;
+    batch->corpus_count++;
+
+    // Corpus images borrow the corpus storage, so they own nothing themselves
+    for (size_t i = 0; i < corpus->count; i++)
+    {
+        int image = add_image(batch, &corpus->roms[i], true);
+        if (image < 0 || !add_jobs(batch, image, seed, repeat))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Releases every image and corpus held by the batch.
+ */
+static void free_images(batch_t *batch)
+{
+    for (int i = 0; i < batch->image_count; i++)
+        rom_image_release(&batch->images[i].rom);
+    for (int i = 0; i < batch->corpus_count; i++)
+        rom_corpus_free(&batch->corpora[i]);
+    free(batch->images);
+    free(batch->corpora);
+}
+
+/**
+ * @brief Worker thread: claims jobs until none are left.
+ */
+static int batch_worker(void *data)
+{
+    batch_t *batch = data;
+
+    // One private emulator per worker, reset in place for every job it claims
+    chip8_t *emu = malloc(sizeof(chip8_t));
+    if (!emu)
+        return -1;
+    chip8_init(emu);
+    chip8_set_machine(emu, batch->emu_cfg.machine);
+    chip8_set_quirks(emu, batch->emu_cfg.quirks);
+
+    int index;
+    while ((index = SDL_AtomicAdd(&batch->next_job, 1)) < batch->job_count)
+    {
+        batch_job_t *job = &batch->jobs[index];
+        const batch_image_t *image = &batch->images[job->image];
+
+        if (!image->ok || !chip8_reset(emu, &image->rom))
+        {
+            job->ok = false;
+            job->state = CHIP8_ERROR;
+            continue;
+        }
+        chip8_seed(emu, job->seed);
+
+        job->ok = headless_run(emu, &batch->emu_cfg, NULL, NULL, NULL, &job->result);
+        job->state = emu->state;
+        job->key_wait = chip8_waiting_for_key(emu);
+    }
+
+    free(emu);
+    return 0;
+}
+
+/**
+ * @brief CSV name of how @p job ended; "keywait" for one halted in FX0A.
+ */
+static const char *state_name(const batch_job_t *job)
+{
+    switch (job->state)
+    {
+    case CHIP8_RUNNING:
+        return job->key_wait ? "keywait" : "running";
+    case CHIP8_PAUSED:
+        return "paused";
+    case CHIP8_REWINDING:
+        return "rewinding";
+    case CHIP8_STOPPED:
+        return "stopped";
+    default:
+        return "error";
+    }
+}
+
+/**
+ * @brief Writes @p text as one CSV field, quoted when it holds a comma,
+ *        quote or line break (RFC 4180).
+ */
+static void write_csv_field(FILE *out, const char *text)
+{
+    if (!strpbrk(text, ",\"\r\n"))
+    {
+        fputs(text, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"')
+            fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+int main(int argc, char *argv[])
+{
+    batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.emu_cfg.cycles_per_frame = CONFIG_DEFAULT_CYCLES_PER_FRAME;
+    batch.emu_cfg.max_cycles = CONFIG_DEFAULT_MAX_CYCLES;
+    batch.emu_cfg.quirks = CONFIG_QUIRKS_AUTO;
+
+    int threads = SDL_GetCPUCount();
+    int repeat = 1;
+    uint64_t seed = CHIP8_DEFAULT_SEED;
+    const char *output_path = NULL;
+
+    set_log_level(LOG_LEVEL_WARNING);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "-?") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_batch_usage(argv[0], stdout);
+            return EXIT_SUCCESS;
+        }
+        else if ((strcmp(arg, "-j") == 0 || strcmp(arg, "--jobs") == 0) && has_value)
+            threads = atoi(argv[++i]);
+        else if ((strcmp(arg, "-n") == 0 || strcmp(arg, "--max-cycles") == 0) && has_value)
+            batch.emu_cfg.max_cycles = strtoull(argv[++i], NULL, 10);
+        else if ((strcmp(arg, "-c") == 0 || strcmp(arg, "--cycles-per-frame") == 0) && has_value)
+            batch.emu_cfg.cycles_per_frame = (uint32_t)atoi(argv[++i]);
+        else if ((strcmp(arg, "-m") == 0 || strcmp(arg, "--machine") == 0) && has_value)
+            batch.emu_cfg.machine = strcmp(argv[++i], "schip") == 0 ? CONFIG_MACHINE_SCHIP : CONFIG_MACHINE_CHIP8;
+        else if ((strcmp(arg, "-q") == 0 || strcmp(arg, "--quirks") == 0) && has_value)
+        {
+            const char *name = argv[++i];
+            batch.emu_cfg.quirks = CONFIG_QUIRKS_COUNT;
+            for (uint8_t q = 0; q < CONFIG_QUIRKS_COUNT; q++)
+                if (strcmp(chip8_quirks_info(q)->name, name) == 0)
+                    batch.emu_cfg.quirks = q;
+            if (batch.emu_cfg.quirks == CONFIG_QUIRKS_COUNT)
+            {
+                print_error("Unknown quirk profile: %s", name);
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((strcmp(arg, "-s") == 0 || strcmp(arg, "--seed") == 0) && has_value)
+            seed = strtoull(argv[++i], NULL, 0);
+        else if ((strcmp(arg, "-r") == 0 || strcmp(arg, "--repeat") == 0) && has_value)
+            repeat = atoi(argv[++i]);
+        else if ((strcmp(arg, "-o") == 0 || strcmp(arg, "--output") == 0) && has_value)
+            output_path = argv[++i];
+        else if (strcmp(arg, "-v") == 0 || strcmp(arg, "--verbose") == 0)
+            set_log_level(LOG_LEVEL_INFO);
+        else if ((strcmp(arg, "-C") == 0 || strcmp(arg, "--corpus") == 0) && has_value)
+        {
+            if (!add_jobs_from_corpus(&batch, argv[++i], seed, repeat > 0 ? repeat : 1))
+                return EXIT_FAILURE;
+        }
+        else if (arg[0] == '-')
+        {
+            print_error("Invalid option: %s", arg);
+            print_batch_usage(argv[0], stderr);
+            return EXIT_FAILURE;
+        }
+        else if (arg[0] == '@')
+        {
+            if (!add_jobs_from_list(&batch, arg + 1, seed, repeat > 0 ? repeat : 1))
+                return EXIT_FAILURE;
+        }
+        else if (!add_rom(&batch, arg, seed, repeat > 0 ? repeat : 1))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (batch.job_count == 0)
+    {
+        print_error("No ROMs specified.");
+        print_batch_usage(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+    if (batch.emu_cfg.cycles_per_frame == 0)
+        batch.emu_cfg.cycles_per_frame = CONFIG_DEFAULT_CYCLES_PER_FRAME;
+    if (batch.emu_cfg.quirks == CONFIG_QUIRKS_AUTO)
+        batch.emu_cfg.quirks = batch.emu_cfg.machine == CONFIG_MACHINE_SCHIP ? CONFIG_QUIRKS_SCHIP : CONFIG_QUIRKS_MODERN;
+    if (threads < 1)
+        threads = 1;
+    if (threads > batch.job_count)
+        threads = batch.job_count;
+
+    // Run the pool
+    SDL_Thread **workers = calloc((size_t)threads, sizeof(SDL_Thread *));
+    if (!workers)
+    {
+        print_error("Out of memory while starting workers.");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t] = SDL_CreateThread(batch_worker, "chip8-batch", &batch);
+        if (!workers[t])
+            print_warning("Failed to start worker %d: %s", t, SDL_GetError());
+    }
+
+    int started = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        if (workers[t])
+        {
+            SDL_WaitThread(workers[t], NULL);
+            started++;
+        }
+    }
+    if (started == 0)
+        batch_worker(&batch); // No threads available: run everything here
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    free(workers);
+
+    // Emit results in input order
+    FILE *out = output_path ? fopen(output_path, "w") : stdout;
+    if (!out)
+    {
+        print_error("Failed to open output file: %s", output_path);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    uint64_t total_executed = 0; // Idle loops fast-forwarded by headless_run() do not count
+    fprintf(out, "rom,seed,state,cycles,frames,display_hash,seconds\n");
+    for (int i = 0; i < batch.job_count; i++)
+    {
+        const batch_job_t *job = &batch.jobs[i];
+        write_csv_field(out, batch.images[job->image].rom.name);
+        fprintf(out, ",%llu,%s,%llu,%llu,%016llx,%.6f\n",
+                (unsigned long long)job->seed,
+                state_name(job),
+                (unsigned long long)job->result.cycles,
+                (unsigned long long)job->result.frames,
+                (unsigned long long)job->result.display_hash,
+                job->result.elapsed_seconds);
+        total_executed += job->result.executed;
+        if (!job->ok)
+            failures++;
+    }
+    if (out != stdout)
+        fclose(out);
+
+    fprintf(stderr, "%d instances on %d threads in %.3f s (%.0f instructions/s aggregate), %d failed\n",
+            batch.job_count, threads, seconds, seconds > 0.0 ? (double)total_executed / seconds : 0.0, failures);
+
+    free(batch.jobs);
+    free_images(&batch);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
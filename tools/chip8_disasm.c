@@ -0,0 +1,315 @@
+/**
+ * @file chip8_disasm.c
+ * @brief Disassembles a ROM along its control flow.
+ *
+ * Runs disasm_analyze(), the analysis the emulator does at load time, and
+ * prints what it found: the reachable code split into basic blocks, with
+ * labels for jump and call targets and the successors of every block, and
+ * the unreachable bytes of the image as data. Instructions where an idle
+ * loop may start are marked. With --graph the control flow graph is
+ * printed in Graphviz dot format instead.
+ *
+ * With --trace it decodes a binary instruction trace written by
+ * chip8 --trace-file instead, one executed instruction per line.
+ *
+ * Usage:
+ *   chip8-disasm [options] <rom>
+ *   chip8-disasm --trace <file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "disasm.h"
+#include "rom.h"
+#include "cli_logger.h"
+
+/** @brief Data bytes per "db" line. */
+#define DATA_PER_LINE 8
+
+static const char *const exit_names[] = {
+    [DISASM_END_FALLTHROUGH] = "falls through",
+    [DISASM_END_JUMP] = "jumps",
+    [DISASM_END_CALL] = "calls",
+    [DISASM_END_SKIP] = "skips",
+    [DISASM_END_RETURN] = "returns",
+    [DISASM_END_INDIRECT] = "jumps indirectly",
+    [DISASM_END_HALT] = "halts",
+};
+
+static void print_disasm_usage(const char *prog_name, FILE *out)
+{
+    fprintf(out,
+            "Usage: %s [options] <rom>\n"
+            "       %s --trace <file>\n\n"
+            "Options:\n"
+            "  -m, --machine <chip8|schip> Instruction set to decode (default: chip8)\n"
+            "  -g, --graph                Print the control flow graph in Graphviz dot format\n"
+            "  -t, --trace <file>         Print a binary trace from chip8 --trace-file\n"
+            "  -?, --help                 Show this help message and exit\n",
+            prog_name, prog_name);
+}
+
+static uint16_t opcode_at(const chip8_t *emu, uint16_t addr)
+{
+    return (uint16_t)(emu->memory[addr] << 8 | emu->memory[addr + 1]);
+}
+
+/**
+ * @brief Prints the label line for @p addr, if anything refers to it.
+ */
+static void print_label(const disasm_t *dis, uint16_t addr)
+{
+    uint8_t flags = dis->flags[addr];
+    if (addr == CHIP8_ROM_ENTRY_POINT)
+        printf("main:\n");
+    else if (flags & DISASM_CALL_TARGET)
+        printf("sub_%03X:\n", addr);
+    else if (flags & DISASM_JUMP_TARGET)
+        printf("L%03X:\n", addr);
+    else if ((flags & DISASM_DATA_REF) && !(flags & DISASM_CODE))
+        printf("data_%03X:\n", addr);
+}
+
+/**
+ * @brief Prints one basic block: a summary comment, then its instructions.
+ */
+static void print_block(const disasm_t *dis, const chip8_t *emu, const disasm_block_t *block)
+{
+    printf("\n; block %03X-%03X %s", block->start, block->end - 1, exit_names[block->exit]);
+    for (unsigned i = 0; i < block->succ_count; i++)
+        printf("%s%03X", i ? ", " : " -> ", block->succ[i]);
+    printf("\n");
+    print_label(dis, block->start);
+
+    for (uint16_t addr = block->start; addr < block->end; addr += 2)
+    {
+        uint16_t opcode = opcode_at(emu, addr);
+        char text[DISASM_TEXT_MAX];
+        disasm_format(text, sizeof(text), opcode, emu->machine);
+
+        const bool idle = dis->flags[addr] & DISASM_IDLE;
+        const bool data = dis->flags[addr] & DISASM_DATA_REF;
+        if (idle || data)
+            printf("    %03X  %04X  %-18s  ; %s%s%s\n", addr, opcode, text, idle ? "idle loop" : "",
+                   idle && data ? ", " : "", data ? "also loaded into I" : "");
+        else
+            printf("    %03X  %04X  %s\n", addr, opcode, text);
+    }
+}
+
+/**
+ * @brief Prints the unreached bytes of @p first..@p end - 1 as data.
+ */
+static void print_data(const disasm_t *dis, const chip8_t *emu, uint16_t first, uint16_t end)
+{
+    printf("\n; data %03X-%03X (%u bytes)\n", first, end - 1, (unsigned)(end - first));
+
+    uint16_t addr = first;
+    while (addr < end)
+    {
+        print_label(dis, addr);
+        printf("    %03X  db", addr);
+
+        // A referenced byte starts a new line, so its label lines up
+        unsigned count = 0;
+        do
+        {
+            printf(" %02X", emu->memory[addr]);
+            addr++;
+            count++;
+        } while (addr < end && count < DATA_PER_LINE && !(dis->flags[addr] & DISASM_DATA_REF));
+        printf("\n");
+    }
+}
+
+static void print_listing(const disasm_t *dis, const chip8_t *emu, const char *name, size_t size)
+{
+    const uint16_t rom_end = (uint16_t)(CHIP8_ROM_ENTRY_POINT + size);
+    unsigned data_bytes = 0;
+    for (uint16_t addr = CHIP8_ROM_ENTRY_POINT; addr < rom_end; addr++)
+        data_bytes += !(dis->flags[addr] & (DISASM_CODE | DISASM_OPERAND));
+
+    printf("; %s: %zu bytes, %s\n", name, size, chip8_machine_info(emu->machine)->name);
+    printf("; %u instructions in %u blocks, %u data bytes, %u idle loop starts, %u indirect jumps\n",
+           dis->instructions, dis->block_count, data_bytes, dis->idle_starts, dis->indirect_jumps);
+
+    // Blocks in address order, with the unreached bytes between them
+    uint16_t addr = CHIP8_ROM_ENTRY_POINT;
+    for (unsigned b = 0; b <= dis->block_count; b++)
+    {
+        uint16_t gap_end = b < dis->block_count && dis->blocks[b].start < rom_end ? dis->blocks[b].start : rom_end;
+        while (addr < gap_end)
+        {
+            uint16_t first = addr;
+            while (addr < gap_end && !(dis->flags[addr] & (DISASM_CODE | DISASM_OPERAND)))
+                addr++;
+            if (addr > first)
+                print_data(dis, emu, first, addr);
+            while (addr < gap_end && (dis->flags[addr] & (DISASM_CODE | DISASM_OPERAND)))
+                addr++;
+        }
+
+        if (b < dis->block_count)
+        {
+            print_block(dis, emu, &dis->blocks[b]);
+            if (dis->blocks[b].end > addr)
+                addr = dis->blocks[b].end;
+        }
+    }
+}
+
+static void print_graph(const disasm_t *dis, const chip8_t *emu, const char *name)
+{
+    printf("digraph \"%s\" {\n", name);
+    printf("    node [shape=box, fontname=\"monospace\"];\n");
+
+    for (unsigned b = 0; b < dis->block_count; b++)
+    {
+        const disasm_block_t *block = &dis->blocks[b];
+        printf("    b%03X [label=\"", block->start);
+        for (uint16_t addr = block->start; addr < block->end; addr += 2)
+        {
+            char text[DISASM_TEXT_MAX];
+            disasm_format(text, sizeof(text), opcode_at(emu, addr), emu->machine);
+            printf("%03X  %s\\l", addr, text);
+        }
+        printf("\"%s];\n", (dis->flags[block->start] & DISASM_IDLE) ? ", style=bold" : "");
+
+        for (unsigned i = 0; i < block->succ_count; i++)
+        {
+            uint16_t succ = block->succ[i];
+            if (!disasm_block_at(dis, succ))
+                printf("    x%03X [label=\"%03X\", shape=plaintext];\n", succ, succ);
+            printf("    b%03X -> %c%03X%s;\n", block->start, disasm_block_at(dis, succ) ? 'b' : 'x', succ,
+                   block->exit == DISASM_END_CALL && i == 0 ? " [style=dashed]" : "");
+        }
+    }
+    printf("}\n");
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+/**
+ * @brief Prints the records of a --trace-file trace, one instruction per line.
+ */
+static bool print_trace(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        print_error("Failed to open trace file: %s", path);
+        return false;
+    }
+
+    uint8_t header[CHIP8_TRACE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, CHIP8_TRACE_MAGIC, 8) != 0 || get_u16(&header[8]) != CHIP8_TRACE_VERSION ||
+        get_u16(&header[10]) != CHIP8_TRACE_RECORD_SIZE)
+    {
+        print_error("Not a version %d trace file: %s", CHIP8_TRACE_VERSION, path);
+        fclose(file);
+        return false;
+    }
+    const uint8_t machine = header[12];
+    printf("; %s: %s, quirks %u\n", path, chip8_machine_info(machine)->name, header[13]);
+
+    uint8_t record[CHIP8_TRACE_RECORD_SIZE];
+    unsigned long long count = 0;
+    while (fread(record, 1, sizeof(record), file) == sizeof(record))
+    {
+        uint16_t opcode = get_u16(&record[2]);
+        char text[DISASM_TEXT_MAX];
+        disasm_format(text, sizeof(text), opcode, machine);
+
+        printf("%03X  %04X  %-18s  I=%03X SP=%u DT=%02X V=", get_u16(&record[0]), opcode, text,
+               get_u16(&record[4]), record[6], record[7]);
+        for (int i = 0; i < 16; i++)
+            printf("%02X", record[8 + i]);
+        printf("\n");
+        count++;
+    }
+    printf("; %llu instructions\n", count);
+
+    bool ok = !ferror(file);
+    if (!ok)
+        print_error("Failed to read trace file: %s", path);
+    fclose(file);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    uint8_t machine = CONFIG_MACHINE_CHIP8;
+    bool graph = false;
+    const char *rom_path = NULL;
+
+    set_log_level(LOG_LEVEL_WARNING);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "-?") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_disasm_usage(argv[0], stdout);
+            return EXIT_SUCCESS;
+        }
+        else if ((strcmp(arg, "-m") == 0 || strcmp(arg, "--machine") == 0) && has_value)
+            machine = strcmp(argv[++i], "schip") == 0 ? CONFIG_MACHINE_SCHIP : CONFIG_MACHINE_CHIP8;
+        else if (strcmp(arg, "-g") == 0 || strcmp(arg, "--graph") == 0)
+            graph = true;
+        else if ((strcmp(arg, "-t") == 0 || strcmp(arg, "--trace") == 0) && has_value)
+            return print_trace(argv[++i]) ? EXIT_SUCCESS : EXIT_FAILURE;
+        else if (arg[0] == '-' || rom_path)
+        {
+            print_error("Invalid option: %s", arg);
+            print_disasm_usage(argv[0], stderr);
+            return EXIT_FAILURE;
+        }
+        else
+            rom_path = arg;
+    }
+
+    if (!rom_path)
+    {
+        print_disasm_usage(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+
+    rom_image_t rom;
+    if (!rom_image_map(&rom, rom_path))
+        return EXIT_FAILURE;
+
+    // Both are too large for the stack of every platform
+    chip8_t *emu = malloc(sizeof(*emu));
+    disasm_t *dis = malloc(sizeof(*dis));
+    bool ok = emu && dis && chip8_init(emu);
+    if (ok)
+    {
+        chip8_set_machine(emu, machine);
+        ok = chip8_load_buffer(emu, rom.data, rom.size);
+    }
+
+    if (ok)
+    {
+        disasm_analyze(dis, emu);
+        if (graph)
+            print_graph(dis, emu, rom_path);
+        else
+            print_listing(dis, emu, rom_path, rom.size);
+    }
+    else
+        print_error("Failed to load ROM: %s", rom_path);
+
+    free(dis);
+    free(emu);
+    rom_image_release(&rom);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file chip8_pack.c
+ * @brief Builds and lists ROM pack archives.
+ *
+ * A pack stores many ROMs in one file behind a fixed-size index, so a
+ * corpus can be mapped with a single mmap() and indexed without copying
+ * (see rom_corpus_load_pack()).
+ *
+ * Usage:
+ *   chip8-pack -o <pack> <rom | dir>...
+ *   chip8-pack -l <pack>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rom.h"
+#include "cli_logger.h"
+
+static void print_pack_usage(const char *prog_name, FILE *out)
+{
+    fprintf(out,
+            "Usage: %s -o <pack> <rom | dir>...\n"
+            "       %s -l <pack>\n\n"
+            "Options:\n"
+            "  -o, --output <pack>        Write the given ROMs and directories to a pack\n"
+            "  -l, --list <pack>          List the entries of a pack\n"
+            "  -?, --help                 Show this help message and exit\n",
+            prog_name, prog_name);
+}
+
+static int list_pack(const char *path)
+{
+    rom_corpus_t corpus;
+    if (!rom_corpus_load_pack(&corpus, path))
+        return EXIT_FAILURE;
+
+    for (size_t i = 0; i < corpus.count; i++)
+        printf("%6zu  %s\n", corpus.roms[i].size, corpus.roms[i].name);
+
+    rom_corpus_free(&corpus);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output_path = NULL;
+    const char *list_path = NULL;
+    int first_input = argc;
+
+    set_log_level(LOG_LEVEL_WARNING);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "-?") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_pack_usage(argv[0], stdout);
+            return EXIT_SUCCESS;
+        }
+        else if ((strcmp(arg, "-o") == 0 || strcmp(arg, "--output") == 0) && has_value)
+            output_path = argv[++i];
+        else if ((strcmp(arg, "-l") == 0 || strcmp(arg, "--list") == 0) && has_value)
+            list_path = argv[++i];
+        else if (arg[0] == '-')
+        {
+            print_error("Invalid option: %s", arg);
+            print_pack_usage(argv[0], stderr);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            first_input = i;
+            break;
+        }
+    }
+
+    if (list_path)
+        return list_pack(list_path);
+
+    if (!output_path || first_input == argc)
+    {
+        print_pack_usage(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+
+    // Inputs are either ROM files or directories; both are read once
+    int input_count = argc - first_input;
+    rom_corpus_t *dirs = calloc((size_t)input_count, sizeof(rom_corpus_t));
+    rom_image_t *files = calloc((size_t)input_count, sizeof(rom_image_t));
+    rom_image_t *entries = NULL;
+    size_t entry_count = 0;
+    bool ok = dirs && files;
+
+    for (int i = 0; ok && i < input_count; i++)
+    {
+        const char *path = argv[first_input + i];
+        if (rom_path_is_directory(path))
+        {
+            ok = rom_corpus_load_dir(&dirs[i], path);
+            entry_count += dirs[i].count;
+        }
+        else
+        {
+            ok = rom_image_map(&files[i], path);
+            entry_count++;
+        }
+    }
+
+    if (ok)
+    {
+        entries = calloc(entry_count ? entry_count : 1, sizeof(rom_image_t));
+        ok = entries != NULL;
+    }
+
+    if (ok)
+    {
+        size_t n = 0;
+        for (int i = 0; i < input_count; i++)
+        {
+            for (size_t j = 0; j < dirs[i].count; j++)
+                entries[n++] = dirs[i].roms[j];
+            if (files[i].name[0] != '\0')
+                entries[n++] = files[i];
+        }
+        ok = rom_pack_write(output_path, entries, entry_count);
+        if (ok)
+            printf("Wrote %zu ROMs to %s\n", entry_count, output_path);
+    }
+
+    for (int i = 0; dirs && files && i < input_count; i++)
+    {
+        rom_corpus_free(&dirs[i]);
+        rom_image_release(&files[i]);
+    }
+    free(entries);
+    free(files);
+    free(dirs);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
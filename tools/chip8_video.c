@@ -0,0 +1,667 @@
+/**
+ * @file chip8_video.c
+ * @brief Converts --record recordings to GIF, Y4M or PNG.
+ *
+ * GIF keeps the recording's size advantage: two colours, each distinct
+ * screen stored once with its display time. Y4M is raw video for piping
+ * into an encoder (e.g. `ffmpeg -i out.y4m out.mp4`). PNG exports a single
+ * frame, or every frame when the output name holds a printf pattern.
+ *
+ * Usage:
+ *   chip8-video [options] -o <out.gif | out.y4m | out.png> <recording>
+ *   chip8-video -i <recording>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "recorder.h"
+#include "cli_logger.h"
+
+#define VIDEO_DEFAULT_SCALE 8    /**< Output pixels per CHIP-8 pixel */
+#define GIF_MIN_DELAY_CS 2       /**< Shortest GIF frame most viewers honour, in 1/100 s */
+#define GIF_MAX_CODES 4096       /**< LZW dictionary size */
+#define PNG_STORED_BLOCK 65535   /**< Largest stored deflate block */
+
+/**
+ * @struct video_opts_t
+ * @brief Conversion settings.
+ */
+typedef struct
+{
+    const char *input;  /**< Recording */
+    const char *output; /**< Output file or PNG pattern */
+    int scale;          /**< Output pixels per CHIP-8 pixel */
+    uint32_t fg;        /**< Lit colour, ARGB as on screen */
+    uint32_t bg;        /**< Unlit colour, ARGB */
+    long long frame;    /**< PNG: frame to export; -1 for the last */
+} video_opts_t;
+
+static void print_video_usage(const char *prog_name, FILE *out)
+{
+    fprintf(out,
+            "Usage: %s [options] -o <out.gif | out.y4m | out.png> <recording>\n"
+            "       %s -i <recording>\n\n"
+            "Options:\n"
+            "  -o, --output <file>        Output file; the format follows the extension\n"
+            "  -s, --scale <n>            Pixels per CHIP-8 pixel (default: %d)\n"
+            "  -f, --fg <color>           Foreground color (hex ARGB, default: 0xFFFFFFFF)\n"
+            "  -b, --bg <color>           Background color (hex ARGB, default: 0x00000000)\n"
+            "      --frame <n>            PNG: frame to export (default: the last); a name\n"
+            "                             with a %%d pattern exports every frame instead\n"
+            "  -i, --info                 Print frame and screen counts and exit\n"
+            "  -?, --help                 Show this help message and exit\n\n"
+            "GIF frames shorter than %d/100 s are merged into the next screen, as most\n"
+            "viewers would slow them down instead.\n",
+            prog_name, prog_name, VIDEO_DEFAULT_SCALE, GIF_MIN_DELAY_CS);
+}
+
+/**
+ * @brief Returns pixel (x, y) of a packed screen @p cols pixels wide: 1 lit, 0 unlit.
+ */
+static int screen_pixel(const uint8_t *screen, int cols, int x, int y)
+{
+    return (screen[y * (cols / 8) + x / 8] >> (7 - x % 8)) & 1;
+}
+
+static void put_u16le(FILE *out, unsigned value)
+{
+    fputc(value & 0xFF, out);
+    fputc((value >> 8) & 0xFF, out);
+}
+
+/*-----------------------------------------------------------
+ *   GIF
+ *----------------------------------------------------------*/
+
+/**
+ * @struct gif_writer_t
+ * @brief LZW bit packer and the screen waiting for its display time.
+ */
+typedef struct
+{
+    FILE *out;
+    int width;
+    int height;
+    int scale;
+    int cols;                        /**< Screen width in CHIP-8 pixels */
+    uint8_t block[255];              /**< Current data sub-block */
+    int block_len;
+    uint32_t bits;                   /**< Pending output bits, LSB first */
+    int bit_count;
+    uint16_t child[GIF_MAX_CODES][2]; /**< LZW trie: code extended by pixel 0 or 1; 0 = none */
+
+    uint8_t pending[RECORDER_MAX_SCREEN_BYTES]; /**< Screen not written yet */
+    bool has_pending;
+    uint64_t pending_start;          /**< Frame index at which it appeared */
+    uint32_t fps;
+} gif_writer_t;
+
+static void gif_put_code(gif_writer_t *gif, unsigned code, int size)
+{
+    gif->bits |= (uint32_t)code << gif->bit_count;
+    gif->bit_count += size;
+    while (gif->bit_count >= 8)
+    {
+        gif->block[gif->block_len++] = gif->bits & 0xFF;
+        gif->bits >>= 8;
+        gif->bit_count -= 8;
+        if (gif->block_len == 255)
+        {
+            fputc(255, gif->out);
+            fwrite(gif->block, 1, 255, gif->out);
+            gif->block_len = 0;
+        }
+    }
+}
+
+/**
+ * @brief Writes one image: graphic control extension, descriptor and LZW data.
+ */
+static void gif_put_image(gif_writer_t *gif, const uint8_t *screen, unsigned delay_cs)
+{
+    static const uint8_t gce[] = {0x21, 0xF9, 0x04, 0x00};
+    fwrite(gce, 1, sizeof(gce), gif->out);
+    put_u16le(gif->out, delay_cs);
+    fputc(0x00, gif->out); // Transparent colour index (unused)
+    fputc(0x00, gif->out); // Block terminator
+
+    fputc(0x2C, gif->out);
+    put_u16le(gif->out, 0);
+    put_u16le(gif->out, 0);
+    put_u16le(gif->out, (unsigned)gif->width);
+    put_u16le(gif->out, (unsigned)gif->height);
+    fputc(0x00, gif->out); // No local colour table
+
+    // Two colours, but GIF needs a minimum code size of 2: clear is 4, end 5
+    const int min_code_size = 2;
+    const unsigned clear = 1u << min_code_size;
+    fputc(min_code_size, gif->out);
+
+    memset(gif->child, 0, sizeof(gif->child));
+    gif->block_len = 0;
+    gif->bits = 0;
+    gif->bit_count = 0;
+    int code_size = min_code_size + 1;
+    unsigned next = clear + 2;
+    gif_put_code(gif, clear, code_size);
+
+    unsigned prefix = (unsigned)screen_pixel(screen, gif->cols, 0, 0);
+    for (int i = 1; i < gif->width * gif->height; i++)
+    {
+        int x = i % gif->width;
+        int y = i / gif->width;
+        int p = screen_pixel(screen, gif->cols, x / gif->scale, y / gif->scale);
+
+        if (gif->child[prefix][p])
+        {
+            prefix = gif->child[prefix][p];
+            continue;
+        }
+
+        gif_put_code(gif, prefix, code_size);
+        if (next < GIF_MAX_CODES)
+        {
+            if (next == (1u << code_size))
+                code_size++;
+            gif->child[prefix][p] = (uint16_t)next++;
+        }
+        else
+        {
+            // Dictionary full: start over
+            gif_put_code(gif, clear, code_size);
+            memset(gif->child, 0, sizeof(gif->child));
+            code_size = min_code_size + 1;
+            next = clear + 2;
+        }
+        prefix = (unsigned)p;
+    }
+    gif_put_code(gif, prefix, code_size);
+    gif_put_code(gif, clear + 1, code_size);
+    if (gif->bit_count)
+        gif_put_code(gif, 0, 8 - gif->bit_count);
+    if (gif->block_len)
+    {
+        fputc(gif->block_len, gif->out);
+        fwrite(gif->block, 1, (size_t)gif->block_len, gif->out);
+    }
+    fputc(0x00, gif->out); // End of image data
+}
+
+/**
+ * @brief Converts a frame index to GIF time, rounding so delays sum exactly.
+ */
+static uint64_t gif_time_cs(const gif_writer_t *gif, uint64_t frame)
+{
+    return (frame * 100 + gif->fps / 2) / gif->fps;
+}
+
+static bool write_gif(recording_reader_t *reader, const video_opts_t *opts, FILE *out)
+{
+    gif_writer_t *gif = calloc(1, sizeof(*gif));
+    if (!gif)
+        return false;
+    gif->out = out;
+    gif->scale = opts->scale;
+    gif->cols = reader->width;
+    gif->width = reader->width * opts->scale;
+    gif->height = reader->height * opts->scale;
+    gif->fps = reader->fps;
+
+    // Header, screen descriptor with a two-entry global colour table
+    fwrite("GIF89a", 1, 6, out);
+    put_u16le(out, (unsigned)gif->width);
+    put_u16le(out, (unsigned)gif->height);
+    fputc(0x80, out); // Global colour table of 2 entries
+    fputc(0x00, out); // Background colour index
+    fputc(0x00, out); // Square pixels
+    const uint32_t palette[2] = {opts->bg, opts->fg};
+    for (int i = 0; i < 2; i++)
+    {
+        fputc((palette[i] >> 16) & 0xFF, out);
+        fputc((palette[i] >> 8) & 0xFF, out);
+        fputc(palette[i] & 0xFF, out);
+    }
+
+    // Loop forever
+    static const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E',
+                                   '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+    fwrite(loop, 1, sizeof(loop), out);
+
+    // A screen is written once the next one shows how long it lasted
+    uint64_t now = 0;
+    uint32_t frames;
+    int status;
+    while ((status = recording_next(reader, &frames)) == 1)
+    {
+        bool changed = !gif->has_pending || memcmp(gif->pending, reader->screen, reader->screen_bytes) != 0;
+        if (changed)
+        {
+            if (gif->has_pending)
+            {
+                uint64_t delay = gif_time_cs(gif, now) - gif_time_cs(gif, gif->pending_start);
+                if (delay >= GIF_MIN_DELAY_CS)
+                {
+                    gif_put_image(gif, gif->pending, (unsigned)(delay > 0xFFFF ? 0xFFFF : delay));
+                    gif->pending_start = now;
+                }
+                // Too short to show: the new screen takes over its time
+            }
+            memcpy(gif->pending, reader->screen, reader->screen_bytes);
+            gif->has_pending = true;
+        }
+        now += frames;
+    }
+
+    if (status == 0 && gif->has_pending)
+    {
+        uint64_t delay = gif_time_cs(gif, now) - gif_time_cs(gif, gif->pending_start);
+        gif_put_image(gif, gif->pending, (unsigned)(delay > 0xFFFF ? 0xFFFF : delay));
+    }
+    fputc(0x3B, out); // Trailer
+
+    free(gif);
+    return status == 0;
+}
+
+/*-----------------------------------------------------------
+ *   Y4M
+ *----------------------------------------------------------*/
+
+/**
+ * @brief Converts an ARGB colour to BT.601 limited-range Y'CbCr.
+ */
+static void argb_to_yuv(uint32_t color, uint8_t yuv[3])
+{
+    int r = (color >> 16) & 0xFF;
+    int g = (color >> 8) & 0xFF;
+    int b = color & 0xFF;
+    yuv[0] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    yuv[1] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    yuv[2] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+static bool write_y4m(recording_reader_t *reader, const video_opts_t *opts, FILE *out)
+{
+    const int width = reader->width * opts->scale;
+    const int height = reader->height * opts->scale;
+    const size_t plane = (size_t)width * height;
+    uint8_t *planes = malloc(plane * 3);
+    if (!planes)
+        return false;
+
+    uint8_t colors[2][3];
+    argb_to_yuv(opts->bg, colors[0]);
+    argb_to_yuv(opts->fg, colors[1]);
+
+    // Full-resolution chroma keeps single pixels sharp
+    fprintf(out, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", width, height, reader->fps);
+
+    uint32_t frames;
+    int status;
+    while ((status = recording_next(reader, &frames)) == 1)
+    {
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+            {
+                const uint8_t *c = colors[screen_pixel(reader->screen, reader->width, x / opts->scale, y / opts->scale)];
+                size_t i = (size_t)y * width + x;
+                planes[i] = c[0];
+                planes[plane + i] = c[1];
+                planes[2 * plane + i] = c[2];
+            }
+
+        // Y4M has no frame durations: repeat held screens
+        for (uint32_t f = 0; f < frames; f++)
+        {
+            fputs("FRAME\n", out);
+            fwrite(planes, 1, plane * 3, out);
+        }
+    }
+
+    free(planes);
+    return status == 0;
+}
+
+/*-----------------------------------------------------------
+ *   PNG
+ *----------------------------------------------------------*/
+
+static uint32_t crc_table[256];
+
+static void crc_init(void)
+{
+    for (uint32_t n = 0; n < 256; n++)
+    {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void put_u32be(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void png_put_chunk(FILE *out, const char *type, const uint8_t *data, size_t size)
+{
+    uint8_t word[4];
+    put_u32be(word, (uint32_t)size);
+    fwrite(word, 1, 4, out);
+
+    uint32_t crc = crc_update(0xFFFFFFFFu, (const uint8_t *)type, 4);
+    crc = crc_update(crc, data, size);
+    fwrite(type, 1, 4, out);
+    fwrite(data, 1, size, out);
+    put_u32be(word, crc ^ 0xFFFFFFFFu);
+    fwrite(word, 1, 4, out);
+}
+
+/**
+ * @brief Writes a screen as a 1-bit palette PNG, zlib data in stored blocks.
+ *
+ * Stored blocks avoid a zlib dependency; a 2-colour image is small anyway.
+ */
+static bool write_png_file(const char *path, const recording_reader_t *reader, const uint8_t *screen,
+                           const video_opts_t *opts)
+{
+    const int width = reader->width * opts->scale;
+    const int height = reader->height * opts->scale;
+    const size_t row_bytes = 1 + ((size_t)width + 7) / 8;
+    const size_t raw_size = row_bytes * height;
+    const size_t blocks = (raw_size + PNG_STORED_BLOCK - 1) / PNG_STORED_BLOCK;
+
+    uint8_t *raw = calloc(1, raw_size);
+    uint8_t *zdata = malloc(2 + raw_size + blocks * 5 + 4);
+    FILE *out = raw && zdata ? fopen(path, "wb") : NULL;
+    if (!out)
+    {
+        print_error("Failed to create %s", path);
+        free(raw);
+        free(zdata);
+        return false;
+    }
+
+    // Filter type 0 per row, then pixels MSB first, palette index 1 = lit
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if (screen_pixel(screen, reader->width, x / opts->scale, y / opts->scale))
+                raw[y * row_bytes + 1 + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+
+    size_t n = 0;
+    zdata[n++] = 0x78;
+    zdata[n++] = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t done = 0; done < raw_size;)
+    {
+        size_t len = raw_size - done > PNG_STORED_BLOCK ? PNG_STORED_BLOCK : raw_size - done;
+        zdata[n++] = done + len == raw_size ? 1 : 0;
+        zdata[n++] = (uint8_t)(len & 0xFF);
+        zdata[n++] = (uint8_t)(len >> 8);
+        zdata[n++] = (uint8_t)(~len & 0xFF);
+        zdata[n++] = (uint8_t)((~len >> 8) & 0xFF);
+        memcpy(zdata + n, raw + done, len);
+        for (size_t i = 0; i < len; i++)
+        {
+            a = (a + raw[done + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        n += len;
+        done += len;
+    }
+    put_u32be(zdata + n, (b << 16) | a);
+    n += 4;
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), out);
+
+    uint8_t ihdr[13];
+    put_u32be(ihdr, (uint32_t)width);
+    put_u32be(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 1;  // Bit depth
+    ihdr[9] = 3;  // Palette
+    ihdr[10] = 0; // Deflate
+    ihdr[11] = 0; // Adaptive filtering
+    ihdr[12] = 0; // No interlace
+    png_put_chunk(out, "IHDR", ihdr, sizeof(ihdr));
+
+    uint8_t plte[6];
+    const uint32_t palette[2] = {opts->bg, opts->fg};
+    for (int i = 0; i < 2; i++)
+    {
+        plte[3 * i] = (palette[i] >> 16) & 0xFF;
+        plte[3 * i + 1] = (palette[i] >> 8) & 0xFF;
+        plte[3 * i + 2] = palette[i] & 0xFF;
+    }
+    png_put_chunk(out, "PLTE", plte, sizeof(plte));
+    png_put_chunk(out, "IDAT", zdata, n);
+    png_put_chunk(out, "IEND", NULL, 0);
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0)
+        ok = false;
+    free(raw);
+    free(zdata);
+    if (!ok)
+        print_error("Failed to write %s", path);
+    return ok;
+}
+
+/**
+ * @brief Returns true if @p name holds exactly one %d-style conversion and no other.
+ */
+static bool is_frame_pattern(const char *name)
+{
+    int conversions = 0;
+    for (const char *p = strchr(name, '%'); p; p = strchr(p, '%'))
+    {
+        p++;
+        while (*p >= '0' && *p <= '9')
+            p++;
+        if (*p != 'd')
+            return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+static bool write_png(recording_reader_t *reader, const video_opts_t *opts)
+{
+    crc_init();
+    const bool every = strchr(opts->output, '%') != NULL;
+    if (every && !is_frame_pattern(opts->output))
+    {
+        print_error("PNG pattern must contain a single %%d: %s", opts->output);
+        return false;
+    }
+
+    uint8_t chosen[RECORDER_MAX_SCREEN_BYTES];
+    bool found = false;
+    uint64_t now = 0;
+    uint32_t frames;
+    int status;
+    while ((status = recording_next(reader, &frames)) == 1)
+    {
+        if (every)
+        {
+            for (uint32_t f = 0; f < frames; f++)
+            {
+                char path[512];
+                snprintf(path, sizeof(path), opts->output, (int)(now + f));
+                if (!write_png_file(path, reader, reader->screen, opts))
+                    return false;
+            }
+        }
+        else if (opts->frame < 0 || (uint64_t)opts->frame < now + frames)
+        {
+            // Keep the last screen, or the one covering the requested frame
+            memcpy(chosen, reader->screen, reader->screen_bytes);
+            found = true;
+            if (opts->frame >= 0)
+                break;
+        }
+        now += frames;
+    }
+
+    if (status < 0)
+        return false;
+    if (every)
+        return true;
+    if (!found)
+    {
+        print_error("Recording has no frame %lld.", opts->frame);
+        return false;
+    }
+    return write_png_file(opts->output, reader, chosen, opts);
+}
+
+/*-----------------------------------------------------------
+ *   MAIN
+ *----------------------------------------------------------*/
+
+static int print_info_summary(recording_reader_t *reader, const char *path)
+{
+    uint8_t shown[RECORDER_MAX_SCREEN_BYTES] = {0};
+    uint64_t screens = 0;
+    uint32_t frames;
+    int status;
+    while ((status = recording_next(reader, &frames)) == 1)
+    {
+        if (memcmp(shown, reader->screen, reader->screen_bytes) != 0)
+            screens++;
+        memcpy(shown, reader->screen, reader->screen_bytes);
+    }
+
+    if (status < 0)
+    {
+        print_error("Recording is truncated or corrupt: %s", path);
+        return EXIT_FAILURE;
+    }
+    printf("%s: %ux%u, %llu frames at %u fps (%.2f s), %llu screen updates\n", path,
+           reader->width, reader->height, (unsigned long long)reader->frames, reader->fps, (double)reader->frames / reader->fps,
+           (unsigned long long)screens);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Returns the extension of @p path, including the dot, or "".
+ */
+static const char *extension(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    const char *slash = strrchr(path, '/');
+    return dot && (!slash || dot > slash) ? dot : "";
+}
+
+int main(int argc, char *argv[])
+{
+    video_opts_t opts = {
+        .scale = VIDEO_DEFAULT_SCALE,
+        .fg = CONFIG_DEFAULT_FG_COLOR,
+        .bg = CONFIG_DEFAULT_BG_COLOR,
+        .frame = -1,
+    };
+    bool info = false;
+
+    set_log_level(LOG_LEVEL_WARNING);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "-?") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_video_usage(argv[0], stdout);
+            return EXIT_SUCCESS;
+        }
+        else if ((strcmp(arg, "-o") == 0 || strcmp(arg, "--output") == 0) && has_value)
+            opts.output = argv[++i];
+        else if ((strcmp(arg, "-s") == 0 || strcmp(arg, "--scale") == 0) && has_value)
+            opts.scale = atoi(argv[++i]);
+        else if ((strcmp(arg, "-f") == 0 || strcmp(arg, "--fg") == 0) && has_value)
+            opts.fg = (uint32_t)strtoul(argv[++i], NULL, 16);
+        else if ((strcmp(arg, "-b") == 0 || strcmp(arg, "--bg") == 0) && has_value)
+            opts.bg = (uint32_t)strtoul(argv[++i], NULL, 16);
+        else if (strcmp(arg, "--frame") == 0 && has_value)
+            opts.frame = atoll(argv[++i]);
+        else if (strcmp(arg, "-i") == 0 || strcmp(arg, "--info") == 0)
+            info = true;
+        else if (arg[0] == '-')
+        {
+            print_error("Invalid option: %s", arg);
+            print_video_usage(argv[0], stderr);
+            return EXIT_FAILURE;
+        }
+        else
+            opts.input = arg;
+    }
+
+    if (!opts.input || (!info && !opts.output))
+    {
+        print_video_usage(argv[0], stderr);
+        return EXIT_FAILURE;
+    }
+    if (opts.scale < 1 || opts.scale > 64)
+    {
+        print_error("Scale must be between 1 and 64.");
+        return EXIT_FAILURE;
+    }
+
+    recording_reader_t reader;
+    if (!recording_open(&reader, opts.input))
+        return EXIT_FAILURE;
+
+    if (info)
+    {
+        int rc = print_info_summary(&reader, opts.input);
+        recording_close(&reader);
+        return rc;
+    }
+
+    const char *ext = extension(opts.output);
+    bool ok;
+    if (strcmp(ext, ".png") == 0)
+    {
+        ok = write_png(&reader, &opts);
+    }
+    else if (strcmp(ext, ".gif") == 0 || strcmp(ext, ".y4m") == 0)
+    {
+        FILE *out = fopen(opts.output, "wb");
+        if (!out)
+        {
+            print_error("Failed to create %s", opts.output);
+            recording_close(&reader);
+            return EXIT_FAILURE;
+        }
+        ok = ext[1] == 'g' ? write_gif(&reader, &opts, out) : write_y4m(&reader, &opts, out);
+        if (ferror(out))
+            ok = false;
+        if (fclose(out) != 0)
+            ok = false;
+    }
+    else
+    {
+        print_error("Unknown output format '%s' (use .gif, .y4m or .png).", ext);
+        recording_close(&reader);
+        return EXIT_FAILURE;
+    }
+
+    if (!ok)
+        print_error("Conversion failed: %s -> %s", opts.input, opts.output);
+    recording_close(&reader);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}